@@ -94,7 +94,7 @@ struct TRITONBACKEND_Batcher;
 ///   }
 ///
 #define TRITONBACKEND_API_VERSION_MAJOR 1
-#define TRITONBACKEND_API_VERSION_MINOR 12
+#define TRITONBACKEND_API_VERSION_MINOR 13
 
 /// Get the TRITONBACKEND API version supported by Triton. This value
 /// can be compared against the TRITONBACKEND_API_VERSION_MAJOR and
@@ -315,6 +315,31 @@ TRITONBACKEND_DECLSPEC TRITONSERVER_Error* TRITONBACKEND_InputBufferAttributes(
     TRITONBACKEND_Input* input, const uint32_t index, const void** buffer,
     TRITONSERVER_BufferAttributes** buffer_attributes);
 
+/// Get the element offsets of a TRITONSERVER_TYPE_BYTES input. The
+/// offsets are computed, and the input data validated, by Triton
+/// before the request is passed to the backend, so that the backend
+/// can locate the elements without parsing the data. The offsets are
+/// relative to the concatenation of the input buffers returned by
+/// TRITONBACKEND_InputBuffer, in order. For an input with N elements
+/// 'offset_count' is N + 1. Element 'i' starts with its 4-byte length
+/// at 'offsets[i]', its bytes follow at 'offsets[i] + 4' and its
+/// length is 'offsets[i + 1] - offsets[i] - 4'. 'offsets[N]' is the
+/// total byte size of the input data. The returned 'offsets' array is
+/// owned by the input and its lifetime matches that of the input.
+///
+/// TRITONSERVER_ERROR_UNAVAILABLE is returned if the input is not a
+/// BYTES input or its offsets are not available, for example because
+/// its data is not in host memory or the input was not provided with
+/// the request. The backend must then parse the input data itself.
+///
+/// \param input The input tensor.
+/// \param offsets Returns the element offsets.
+/// \param offset_count Returns the number of offsets.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONBACKEND_DECLSPEC TRITONSERVER_Error* TRITONBACKEND_InputBytesOffsets(
+    TRITONBACKEND_Input* input, const uint64_t** offsets,
+    uint64_t* offset_count);
+
 ///
 /// TRITONBACKEND_Output
 ///
@@ -91,7 +91,7 @@ struct TRITONSERVER_MetricFamily;
 ///   }
 ///
 #define TRITONSERVER_API_VERSION_MAJOR 1
-#define TRITONSERVER_API_VERSION_MINOR 22
+#define TRITONSERVER_API_VERSION_MINOR 35
 
 /// Get the TRITONBACKEND API version supported by the Triton shared
 /// library. This value can be compared against the
@@ -624,7 +624,8 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error* TRITONSERVER_MessageSerializeTo
 
 /// Metric format types
 typedef enum tritonserver_metricformat_enum {
-  TRITONSERVER_METRIC_PROMETHEUS
+  TRITONSERVER_METRIC_PROMETHEUS,
+  TRITONSERVER_METRIC_BINARY
 } TRITONSERVER_MetricFormat;
 
 /// Delete a metrics object.
@@ -640,7 +641,28 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error* TRITONSERVER_MetricsDelete(
 ///   TRITONSERVER_METRIC_PROMETHEUS: 'base' points to a single multiline
 ///   string (char*) that gives a text representation of the metrics in
 ///   prometheus format. 'byte_size' returns the length of the string
-///   in bytes.
+///   in bytes. The text of a metric family that did not change since
+///   the previous request is reused. If the "serialization_budget_ms"
+///   global metrics setting is set and serializing takes longer, the
+///   remaining changed families are returned as of their previous
+///   serialization and are refreshed first by the next request.
+///
+///   TRITONSERVER_METRIC_BINARY: 'base' points to a compact binary
+///   encoding of the metrics, without help strings, for consumers
+///   that poll often. 'byte_size' returns the length of the encoding
+///   in bytes. Values are in host byte order and a string is encoded
+///   as a uint32 byte length followed by its bytes. The encoding is
+///   the 8 bytes "TRTMETRC", a uint32 version (1) and a uint32
+///   family count. Each family is its name, a uint8 type (0 counter,
+///   1 gauge, 2 summary, 3 untyped, 4 histogram) and a uint32 metric
+///   count. Each metric is a uint32 label count, the name and value
+///   string of each label and an int64 timestamp in milliseconds,
+///   followed by: a double value for counters, gauges and untyped
+///   metrics; a uint64 sample count, a double sample sum, a uint32
+///   quantile count and a double quantile and double value per
+///   quantile for summaries; a uint64 sample count, a double sample
+///   sum, a uint32 bucket count and a double upper bound and uint64
+///   cumulative count per bucket for histograms.
 ///
 /// The buffer is owned by the 'metrics' object and should not be
 /// modified or freed by the caller. The lifetime of the buffer
@@ -810,6 +832,84 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error* TRITONSERVER_InferenceTraceTens
     TRITONSERVER_InferenceTraceTensorActivityFn_t tensor_activity_fn,
     TRITONSERVER_InferenceTraceReleaseFn_t release_fn, void* trace_userp);
 
+/// Create a new inference trace object whose tensor activities are
+/// delivered asynchronously. Reported tensors are copied into the
+/// trace tensor staging pool of the server and 'tensor_activity_fn' is
+/// called for the copies, in CPU memory, on a background thread so the
+/// request does not wait for the callback. See
+/// TRITONSERVER_ServerOptionsSetTraceTensorStagingPool. When
+/// 'tensor_byte_limit' bytes of tensors have been staged for a trace,
+/// or the staging pool is full, the remaining tensors of the trace
+/// are dropped instead of waiting for room. Timeline activities are
+/// reported as with TRITONSERVER_InferenceTraceTensorNew. The release
+/// callback is called on the background thread after the staged
+/// tensors of the trace are delivered. The caller takes ownership of
+/// the TRITONSERVER_InferenceTrace object and must call
+/// TRITONSERVER_InferenceTraceDelete to release the object.
+///
+/// \param trace Returns the new inference trace object.
+/// \param level The tracing level.
+/// \param parent_id The parent trace id for this trace. A value of 0
+/// indicates that there is not parent trace.
+/// \param activity_fn The callback function where timeline activity for the
+/// trace is reported.
+/// \param tensor_activity_fn The callback function where tensor activity for
+/// the trace is reported.
+/// \param release_fn The callback function called when all activity
+/// is complete for the trace.
+/// \param trace_userp User-provided pointer that is delivered to
+/// the activity and release callback functions.
+/// \param tensor_byte_limit The maximum byte size of the tensors
+/// staged for the trace and for each of its child traces, 0 for no
+/// limit other than the staging pool.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_InferenceTraceTensorAsyncNew(
+    struct TRITONSERVER_InferenceTrace** trace, TRITONSERVER_InferenceTraceLevel level,
+    uint64_t parent_id, TRITONSERVER_InferenceTraceActivityFn_t activity_fn,
+    TRITONSERVER_InferenceTraceTensorActivityFn_t tensor_activity_fn,
+    TRITONSERVER_InferenceTraceReleaseFn_t release_fn, void* trace_userp,
+    uint64_t tensor_byte_limit);
+
+/// Create a new inference trace object whose activities are written
+/// to the binary trace file of the server instead of being delivered
+/// to a callback. See TRITONSERVER_ServerOptionsSetTraceBinarySink.
+/// Reporting an activity only appends a fixed-size record to a buffer
+/// owned by the reporting thread, the records are written to the file
+/// by a background thread. The caller takes ownership of the
+/// TRITONSERVER_InferenceTrace object and must call
+/// TRITONSERVER_InferenceTraceDelete to release the object.
+///
+/// The release callback is called for both 'trace' and for any child
+/// traces spawned by 'trace'.
+///
+/// \param trace Returns the new inference trace object.
+/// \param level The tracing level. Only timeline activities are
+/// written to the binary trace file.
+/// \param parent_id The parent trace id for this trace. A value of 0
+/// indicates that there is not parent trace.
+/// \param release_fn The callback function called when all activity
+/// is complete for the trace.
+/// \param trace_userp User-provided pointer that is delivered to
+/// the release callback function.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error* TRITONSERVER_InferenceTraceBinaryNew(
+    struct TRITONSERVER_InferenceTrace** trace, TRITONSERVER_InferenceTraceLevel level,
+    uint64_t parent_id, TRITONSERVER_InferenceTraceReleaseFn_t release_fn,
+    void* trace_userp);
+
+/// Convert a binary trace file written by the server to a JSON file
+/// in the Chrome trace event format, which can be opened with
+/// chrome://tracing or Perfetto. Each trace is shown on its own track
+/// with the request, queue and compute spans of the trace.
+///
+/// \param binary_path The path of the binary trace file.
+/// \param json_path The path of the JSON file to write.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_InferenceTraceBinaryToJson(
+    const char* binary_path, const char* json_path);
+
 /// Delete a trace object.
 ///
 /// \param trace The trace object.
@@ -941,6 +1041,22 @@ typedef void (*TRITONSERVER_InferenceResponseCompleteFn_t)(
     struct TRITONSERVER_InferenceResponse* response, const uint32_t flags,
     void* userp);
 
+/// Type for callback function delivering a batch of completed
+/// inference responses, see
+/// TRITONSERVER_InferenceRequestSetResponseBatchCallback. The
+/// callback function takes ownership of every non-null
+/// TRITONSERVER_InferenceResponse object in 'responses'. The
+/// 'responses' and 'flags' arrays are owned by Triton and are only
+/// valid for the duration of the callback. 'responses[i]' and
+/// 'flags[i]' have the same meaning as 'response' and 'flags' in
+/// TRITONSERVER_InferenceResponseCompleteFn_t and the responses are
+/// in the order they were produced. The 'userp' data is the data
+/// provided as 'response_userp' in the call to
+/// TRITONSERVER_InferenceRequestSetResponseBatchCallback.
+typedef void (*TRITONSERVER_InferenceResponseBatchCompleteFn_t)(
+    struct TRITONSERVER_InferenceResponse** responses, const uint32_t* flags,
+    const uint32_t response_count, void* userp);
+
 /// Create a new inference request object.
 ///
 /// \param inference_request Returns the new request object.
@@ -962,6 +1078,24 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error* TRITONSERVER_InferenceRequestNe
 TRITONSERVER_DECLSPEC struct TRITONSERVER_Error* TRITONSERVER_InferenceRequestDelete(
     struct TRITONSERVER_InferenceRequest* inference_request);
 
+/// Reset an inference request object so that it can be reused for
+/// another inference. The inputs, with their names, datatypes and
+/// shapes, and the requested outputs are kept together with the
+/// result of their validation against the model configuration, so a
+/// request reused with unchanged inputs is not validated again. The
+/// data of every input, the request ID, correlation ID, flags,
+/// priority, timeout, parameters and the release and response
+/// callbacks are cleared and must be set again before the request is
+/// passed to TRITONSERVER_ServerInferAsync. A request must not be
+/// reset while it is in flight, that is until its release callback
+/// has been invoked with TRITONSERVER_REQUEST_RELEASE_ALL.
+///
+/// \param inference_request The request object.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_InferenceRequestReset(
+    struct TRITONSERVER_InferenceRequest* inference_request);
+
 /// Get the ID for a request. The returned ID is owned by
 /// 'inference_request' and must not be modified or freed by the
 /// caller.
@@ -1283,6 +1417,41 @@ TRITONSERVER_InferenceRequestSetResponseCallback(
     TRITONSERVER_InferenceResponseCompleteFn_t response_fn,
     void* response_userp);
 
+/// Set the allocator and a batched response callback for an inference
+/// request. This is an alternative to
+/// TRITONSERVER_InferenceRequestSetResponseCallback for requests that
+/// produce many responses, such as requests to decoupled models.
+/// Responses produced for the request are gathered and delivered
+/// together in one call to 'response_fn'. A batch is delivered when it
+/// holds 'max_batch_count' responses, when a response with the
+/// TRITONSERVER_RESPONSE_COMPLETE_FINAL flag is produced, or when
+/// 'max_delay_us' microseconds have passed since the first response in
+/// the batch was produced, whichever happens first. Batches for a
+/// request are delivered one at a time and in order.
+///
+/// \param inference_request The request object.
+/// \param response_allocator The TRITONSERVER_ResponseAllocator to use
+/// to allocate buffers to hold inference results.
+/// \param response_allocator_userp User-provided pointer that is
+/// delivered to the response allocator's start and allocation functions.
+/// \param response_fn The function called to deliver a batch of
+/// inference responses for this request.
+/// \param response_userp User-provided pointer that is delivered to
+/// the 'response_fn' callback.
+/// \param max_batch_count The maximum number of responses delivered
+/// in one call to 'response_fn'.
+/// \param max_delay_us The maximum time, in microseconds, that a
+/// response is held waiting for more responses.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_InferenceRequestSetResponseBatchCallback(
+    struct TRITONSERVER_InferenceRequest* inference_request,
+    struct TRITONSERVER_ResponseAllocator* response_allocator,
+    void* response_allocator_userp,
+    TRITONSERVER_InferenceResponseBatchCompleteFn_t response_fn,
+    void* response_userp, const uint32_t max_batch_count,
+    const uint64_t max_delay_us);
+
 /// Set a string parameter in the request.
 ///
 /// \param request The request.
@@ -1587,6 +1756,12 @@ typedef enum tritonserver_ratelimitmode_enum {
   TRITONSERVER_RATE_LIMIT_EXEC_COUNT
 } TRITONSERVER_RateLimitMode;
 
+/// Model eviction policies
+typedef enum tritonserver_modelevictionpolicy_enum {
+  TRITONSERVER_MODEL_EVICTION_LRU,
+  TRITONSERVER_MODEL_EVICTION_LFU
+} TRITONSERVER_ModelEvictionPolicy;
+
 /// Create a new server options object. The caller takes ownership of
 /// the TRITONSERVER_ServerOptions object and must call
 /// TRITONSERVER_ServerOptionsDelete to release the object.
@@ -1662,6 +1837,51 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
 TRITONSERVER_ServerOptionsSetStartupModel(
     struct TRITONSERVER_ServerOptions* options, const char* model_name);
 
+/// Enable or disable loading models on demand in a server options.
+/// When enabled, an inference request for a model of the model
+/// repository that is not loaded loads the model and waits for the
+/// load to complete. Requests for a model already being loaded wait
+/// for the same load. To keep the number of models served for
+/// inference within 'max_loaded_models', the idle model selected by
+/// 'policy' is unloaded before another model is loaded. Only models
+/// that received inference requests count toward this budget.
+/// Note that it only takes affect on TRITONSERVER_MODEL_CONTROL_EXPLICIT
+/// mode. Disabled by default.
+///
+/// \param options The server options object.
+/// \param enable True to enable loading models on demand, false to
+/// disable.
+/// \param max_loaded_models The maximum number of models loaded on
+/// demand, 0 for no limit.
+/// \param max_pending_requests The maximum number of requests waiting
+/// for models to load, 0 for no limit. Requests beyond it are rejected
+/// with TRITONSERVER_ERROR_UNAVAILABLE.
+/// \param policy The policy selecting the model to unload.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelLoadOnDemand(
+    struct TRITONSERVER_ServerOptions* options, bool enable,
+    uint32_t max_loaded_models, uint32_t max_pending_requests,
+    TRITONSERVER_ModelEvictionPolicy policy);
+
+/// Set the model repository snapshot in a server options. The snapshot
+/// is a local file holding the result of polling the model
+/// repositories: the normalized configuration and the modification
+/// times of each model. It is written when the server stops and by
+/// TRITONSERVER_ServerWriteModelRepositorySnapshot. On startup, the
+/// models whose files are unchanged since the snapshot was written are
+/// loaded without reading and validating their configuration again. A
+/// snapshot written by a different server version or with different
+/// options is ignored. The snapshot is disabled by default.
+///
+/// \param options The server options object.
+/// \param snapshot_path The path of the snapshot file, an empty string
+/// or nullptr disables the snapshot.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelRepositorySnapshot(
+    struct TRITONSERVER_ServerOptions* options, const char* snapshot_path);
+
 /// Enable or disable strict model configuration handling in a server
 /// options.
 ///
@@ -1721,6 +1941,78 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
 TRITONSERVER_ServerOptionsSetPinnedMemoryPoolByteSize(
     struct TRITONSERVER_ServerOptions* options, uint64_t size);
 
+/// Set the huge page memory pool in a server options. Host buffers
+/// that can not be allocated from the pinned memory pool and whose
+/// byte size is at least 'threshold_byte_size' are allocated from a
+/// pre-faulted pool backed by huge pages instead of regular system
+/// memory. Hugetlb pages are used if they are reserved on the host,
+/// transparent huge pages otherwise. The pool is disabled by default.
+///
+/// \param options The server options object.
+/// \param pool_byte_size The huge page memory pool byte size, 0 to
+/// disable the pool.
+/// \param threshold_byte_size The minimum byte size of an allocation
+/// to be served from the pool.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetHugePageMemoryPool(
+    struct TRITONSERVER_ServerOptions* options, uint64_t pool_byte_size,
+    uint64_t threshold_byte_size);
+
+/// Enable the host shared memory transport in a server options. Once
+/// the server is ready, processes on the same host can connect to the
+/// transport by 'name' using the shared memory client library,
+/// register shared memory regions holding their tensors and submit
+/// inference requests whose input tensors are read from, and output
+/// tensors written to, those regions without being copied. Requests
+/// and responses are exchanged through two rings of 'slot_count'
+/// slots that each hold a message of up to 'slot_byte_size' bytes.
+/// Only regions owned by the user running the server and named
+/// '<name>_<suffix>' can be registered. The transport is disabled by
+/// default.
+///
+/// \param options The server options object.
+/// \param name The name of the transport, an empty string or nullptr
+/// disables the transport.
+/// \param slot_count The number of slots of each ring.
+/// \param slot_byte_size The byte size of each slot.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetSharedMemoryTransport(
+    struct TRITONSERVER_ServerOptions* options, const char* name,
+    uint32_t slot_count, uint32_t slot_byte_size);
+
+/// Enable the binary trace sink in a server options. Activities of
+/// traces created with TRITONSERVER_InferenceTraceBinaryNew are
+/// buffered in a ring of 'records_per_thread' records for each
+/// reporting thread and written to 'path' by a background thread.
+/// When a ring is full new records are dropped and the number of
+/// dropped records is written instead. The sink is disabled by
+/// default.
+///
+/// \param options The server options object.
+/// \param path The path of the binary trace file, an empty string or
+/// nullptr disables the sink.
+/// \param records_per_thread The number of records buffered for each
+/// reporting thread, rounded up to a power of 2.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetTraceBinarySink(
+    struct TRITONSERVER_ServerOptions* options, const char* path,
+    uint32_t records_per_thread);
+
+/// Set the byte size of the staging pool holding the tensors of
+/// traces created with TRITONSERVER_InferenceTraceTensorAsyncNew until
+/// they are delivered. A value of 0 disables asynchronous tensor
+/// tracing, which is the default.
+///
+/// \param options The server options object.
+/// \param pool_byte_size The byte size of the staging pool.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetTraceTensorStagingPool(
+    struct TRITONSERVER_ServerOptions* options, uint64_t pool_byte_size);
+
 /// Set the total CUDA memory byte size that the server can allocate
 /// on given GPU device in a server options. The pinned memory pool
 /// will be shared across Triton itself and the backends that use
@@ -1841,6 +2133,57 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
 TRITONSERVER_ServerOptionsSetModelLoadThreadCount(
     struct TRITONSERVER_ServerOptions* options, unsigned int thread_count);
 
+/// Set the host memory budget for concurrently loading models in a
+/// server options. A model load starts only when its expected memory
+/// use fits in the budget next to the loads in progress, or when no
+/// other load is in progress. The expected memory use of a model is
+/// given by the "TRITON_LOAD_MEMORY_BYTE_SIZE" parameter in the model
+/// configuration. If that parameter is absent, it is learned from an
+/// earlier load of the model, or else taken as the size of the model
+/// version directory. The model load thread count still bounds the
+/// number of concurrent loads. The default of 0 sets no budget.
+///
+/// \param options The server options object.
+/// \param byte_size The memory budget, in bytes.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelLoadMemoryBudget(
+    struct TRITONSERVER_ServerOptions* options, uint64_t byte_size);
+
+/// Set the number of threads used to concurrently create, initialize
+/// and warm up the instances of a single model in a server options.
+/// The default is 1, which creates the instances of a model one at a
+/// time. Instances that share a device-blocking backend thread are
+/// always created one at a time.
+///
+/// \param options The server options object.
+/// \param thread_count The number of threads.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelInstanceLoadThreadCount(
+    struct TRITONSERVER_ServerOptions* options, unsigned int thread_count);
+
+/// Enable draining of the model versions replaced by a model load in a
+/// server options. Requests for the latest version are redirected to the
+/// new versions once all of them are loaded and warmed up. With swap
+/// enabled a replaced version, for example the previous latest version
+/// under the 'latest' version policy, keeps serving the requests that
+/// name it explicitly until it has no in-flight inference or
+/// 'drain_timeout_ms' has elapsed, and is then unloaded. While it drains
+/// the version is reported UNAVAILABLE with reason "draining". Otherwise
+/// a replaced version is unloaded as soon as the new versions are ready.
+/// Swap is disabled by default.
+///
+/// \param options The server options object.
+/// \param enable Whether to drain replaced model versions.
+/// \param drain_timeout_ms The longest time to wait for a replaced
+/// version to drain, in milliseconds.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelVersionSwap(
+    struct TRITONSERVER_ServerOptions* options, bool enable,
+    uint64_t drain_timeout_ms);
+
 /// Enable model namespacing to allow serving models with the same name if
 /// they are in different namespaces.
 ///
@@ -2104,6 +2447,16 @@ TRITONSERVER_ServerUnregisterModelRepository(
 TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
 TRITONSERVER_ServerPollModelRepository(struct TRITONSERVER_Server* server);
 
+/// Write the model repository snapshot set with
+/// TRITONSERVER_ServerOptionsSetModelRepositorySnapshot, replacing the
+/// previous snapshot.
+///
+/// \param server The inference server object.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerWriteModelRepositorySnapshot(
+    struct TRITONSERVER_Server* server);
+
 /// Is the server live?
 ///
 /// \param server The inference server object.
@@ -2356,6 +2709,36 @@ TRITONSERVER_DECLSPEC struct TRITONSERVER_Error* TRITONSERVER_ServerInferAsync(
     struct TRITONSERVER_InferenceRequest* inference_request,
     struct TRITONSERVER_InferenceTrace* trace);
 
+/// Perform inference on a batch of 'request_count' requests. This is
+/// equivalent to calling TRITONSERVER_ServerInferAsync for each
+/// request in order, except that consecutive requests for the same
+/// model are submitted to the model's scheduler together so that they
+/// are queued with a single synchronization and batcher wakeup.
+///
+/// If the function returns success, then the caller releases
+/// ownership of all 'inference_requests' as described for
+/// TRITONSERVER_ServerInferAsync. A request that fails validation or
+/// cannot be scheduled is completed with an error response delivered
+/// through its response callback and is then returned through its
+/// release callback. If the function returns an error, then no
+/// request was submitted and the caller retains ownership of all
+/// 'inference_requests'. Every request must have its release and
+/// response callbacks set.
+///
+/// \param server The inference server object.
+/// \param inference_requests The 'request_count' request objects.
+/// \param traces The 'request_count' trace objects, one for each
+/// request, or nullptr if no tracing. An individual trace object can
+/// be nullptr if the corresponding request is not traced.
+/// \param request_count The number of requests.
+/// \return a TRITONSERVER_Error indicating success or failure.
+TRITONSERVER_DECLSPEC struct TRITONSERVER_Error*
+TRITONSERVER_ServerInferAsyncBatch(
+    struct TRITONSERVER_Server* server,
+    struct TRITONSERVER_InferenceRequest** inference_requests,
+    struct TRITONSERVER_InferenceTrace** traces,
+    const uint32_t request_count);
+
 /// TRITONSERVER_MetricKind
 ///
 /// Types of metrics recognized by TRITONSERVER.
@@ -1427,6 +1427,28 @@ TRITONBACKEND_InputBufferAttributes(
   return nullptr;  // success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONBACKEND_InputBytesOffsets(
+    TRITONBACKEND_Input* input, const uint64_t** offsets,
+    uint64_t* offset_count)
+{
+  InferenceRequest::Input* ti =
+      reinterpret_cast<InferenceRequest::Input*>(input);
+  const std::vector<uint64_t>& bytes_offsets = ti->BytesOffsets();
+  if (bytes_offsets.empty()) {
+    *offsets = nullptr;
+    *offset_count = 0;
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_UNAVAILABLE,
+        ("element offsets are not available for input '" + ti->Name() + "'")
+            .c_str());
+  }
+
+  *offsets = bytes_offsets.data();
+  *offset_count = bytes_offsets.size();
+  return nullptr;  // success
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONBACKEND_InputBufferForHostPolicy(
     TRITONBACKEND_Input* input, const char* host_policy_name,
@@ -31,6 +31,9 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 #endif
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include "backend_config.h"
 #include "backend_model.h"
 #include "cuda_utils.h"
@@ -41,6 +44,7 @@
 #include "shared_library.h"
 #include "triton/common/logging.h"
 #include "triton/common/nvtx.h"
+#include "triton/common/thread_pool.h"
 #include "tritonserver_apis.h"
 
 // For unknown reason, windows will not export the TRITONBACKEND_*
@@ -134,6 +138,14 @@ WarmupRequestComplete(
   }
 }
 
+uint64_t
+SteadyNowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 bool
 ShareBackendThread(
     const bool device_blocking, const TRITONSERVER_InstanceGroupKind kind)
@@ -153,7 +165,8 @@ TritonModelInstance::TritonModelInstance(
     : model_(model), name_(name), signature_(signature), kind_(kind),
       device_id_(device_id), host_policy_(host_policy),
       host_policy_message_(host_policy_message), profile_names_(profile_names),
-      passive_(passive), secondary_devices_(secondary_devices), state_(nullptr)
+      passive_(passive), secondary_devices_(secondary_devices), state_(nullptr),
+      warmup_duration_ns_(0)
 {
 #ifdef TRITON_ENABLE_METRICS
   if (Metrics::Enabled()) {
@@ -178,7 +191,7 @@ TritonModelInstance::TritonModelInstance(
 TritonModelInstance::~TritonModelInstance()
 {
   if (triton_backend_thread_.get() != nullptr) {
-    triton_backend_thread_->StopBackendThread();
+    triton_backend_thread_->StopBackendThread(this);
   }
 
   LOG_STATUS_ERROR(
@@ -203,6 +216,35 @@ TritonModelInstance::SetInstances(
 {
   static triton::common::HostPolicyCmdlineConfig empty_host_policy;
 
+  // Instances sharing a backend thread find the thread through the
+  // instances already registered on the device, so those must be created
+  // one at a time.
+  const size_t thread_count =
+      model->DeviceBlocking()
+          ? 1
+          : std::max<size_t>(
+                1, model->Server()->ModelInstanceLoadThreadCount());
+
+  // The instances to be created concurrently, they are registered in
+  // config order once all of them are created.
+  struct PendingInstance {
+    PendingInstance(
+        std::function<Status(std::shared_ptr<TritonModelInstance>*)>&& create,
+        const bool passive)
+        : create_(std::move(create)), passive_(passive)
+    {
+    }
+    std::function<Status(std::shared_ptr<TritonModelInstance>*)> create_;
+    const bool passive_;
+    std::shared_ptr<TritonModelInstance> instance_;
+    Status status_;
+  };
+  std::vector<PendingInstance> pending_instances;
+
+  // Warmup data is generated on first use and shared by the instances.
+  std::vector<std::shared_ptr<const WarmupBuffers>> warmup_buffers;
+  bool warmup_buffers_generated = false;
+
   for (const auto& group : model_config.instance_group()) {
     std::vector<std::string> profile_names;
     for (const auto& profile_name : group.profile()) {
@@ -268,6 +310,10 @@ TritonModelInstance::SetInstances(
         }
 
         // No matching instance for re-using, so create the instance.
+        if (!passive && !warmup_buffers_generated) {
+          RETURN_IF_ERROR(GenerateWarmupBuffers(model, &warmup_buffers));
+          warmup_buffers_generated = true;
+        }
         const std::string& policy_name = std::get<0>(is);
         const triton::common::HostPolicyCmdlineConfig* host_policy;
         const auto policy_it = host_policy_map.find(policy_name);
@@ -276,42 +322,107 @@ TritonModelInstance::SetInstances(
         } else {
           host_policy = &empty_host_policy;
         }
+        const inference::ModelRateLimiter* rate_limiter_config =
+            std::get<3>(is);
+        auto create_instance =
+            [model, &backend_cmdline_config_map, &warmup_buffers,
+             instance_name, signature, kind, id, profile_names, passive,
+             policy_name, host_policy, rate_limiter_config, secondary_devices](
+                std::shared_ptr<TritonModelInstance>* new_instance) -> Status {
+          RETURN_IF_ERROR(SetNumaConfigOnThread(*host_policy));
+          auto err = CreateInstance(
+              model, instance_name, signature, kind, id, profile_names,
+              passive, policy_name, *host_policy, *rate_limiter_config,
+              secondary_devices, warmup_buffers, new_instance);
+          RETURN_IF_ERROR(ResetNumaMemoryPolicy());
+          RETURN_IF_ERROR(err);
+
+          // When deploying on GPU, we want to make sure the GPU memory usage
+          // is within allowed range, otherwise, stop the creation to ensure
+          // there is sufficient GPU memory for other use.
+          // We check the usage after loading the instance to better enforcing
+          // the limit. If we check before loading, we may create instance
+          // that occupies the rest of available memory which against the
+          // purpose
+          if (kind == TRITONSERVER_INSTANCEGROUPKIND_GPU) {
+            size_t free, total;
+            double memory_limit;
+            RETURN_IF_ERROR(GetDeviceMemoryInfo(id, &free, &total));
+            RETURN_IF_ERROR(BackendConfigurationModelLoadGpuFraction(
+                backend_cmdline_config_map, id, &memory_limit));
+            const size_t allow = total * memory_limit;
+            const size_t used = total - free;
+            if (used > allow) {
+              return Status(
+                  Status::Code::UNAVAILABLE,
+                  std::string("can not create model '") + instance_name +
+                      "': memory limit set for " +
+                      TRITONSERVER_InstanceGroupKindString(kind) + " " +
+                      std::to_string(id) +
+                      " has exceeded, model loading is rejected.");
+            }
+          }
+          return Status::Success;
+        };
+
+        if (thread_count > 1) {
+          pending_instances.emplace_back(std::move(create_instance), passive);
+          continue;
+        }
         std::shared_ptr<TritonModelInstance> new_instance;
-        RETURN_IF_ERROR(SetNumaConfigOnThread(*host_policy));
-        auto err = CreateInstance(
-            model, instance_name, signature, kind, id, profile_names, passive,
-            policy_name, *host_policy, *(std::get<3>(is)), secondary_devices,
-            &new_instance);
-        RETURN_IF_ERROR(ResetNumaMemoryPolicy());
-        RETURN_IF_ERROR(err);
+        RETURN_IF_ERROR(create_instance(&new_instance));
         RETURN_IF_ERROR(
             model->RegisterInstance(std::move(new_instance), passive));
+      }
+    }
+  }
 
-        // When deploying on GPU, we want to make sure the GPU memory usage
-        // is within allowed range, otherwise, stop the creation to ensure
-        // there is sufficient GPU memory for other use.
-        // We check the usage after loading the instance to better enforcing
-        // the limit. If we check before loading, we may create instance
-        // that occupies the rest of available memory which against the purpose
-        if (kind == TRITONSERVER_INSTANCEGROUPKIND_GPU) {
-          size_t free, total;
-          double memory_limit;
-          RETURN_IF_ERROR(GetDeviceMemoryInfo(id, &free, &total));
-          RETURN_IF_ERROR(BackendConfigurationModelLoadGpuFraction(
-              backend_cmdline_config_map, id, &memory_limit));
-          const size_t allow = total * memory_limit;
-          const size_t used = total - free;
-          if (used > allow) {
-            return Status(
-                Status::Code::UNAVAILABLE,
-                std::string("can not create model '") + instance_name +
-                    "': memory limit set for " +
-                    TRITONSERVER_InstanceGroupKindString(kind) + " " +
-                    std::to_string(id) +
-                    " has exceeded, model loading is rejected.");
+  if (!pending_instances.empty()) {
+    LOG_VERBOSE(1) << "Creating " << pending_instances.size()
+                   << " instances of model '" << model->Name() << "' using "
+                   << std::min(thread_count, pending_instances.size())
+                   << " threads";
+    std::mutex mu;
+    std::condition_variable cv;
+    size_t remaining = pending_instances.size();
+    bool failed = false;
+    {
+      triton::common::ThreadPool pool(
+          std::min(thread_count, pending_instances.size()));
+      for (auto& pending : pending_instances) {
+        pool.Enqueue([&pending, &mu, &cv, &remaining, &failed]() {
+          {
+            // Don't start creating more instances once one has failed
+            std::lock_guard<std::mutex> lk(mu);
+            if (failed) {
+              pending.status_ = Status(
+                  Status::Code::UNAVAILABLE,
+                  "instance creation cancelled after an earlier failure");
+              --remaining;
+              cv.notify_all();
+              return;
+            }
           }
-        }
+          Status status = pending.create_(&pending.instance_);
+          std::lock_guard<std::mutex> lk(mu);
+          pending.status_ = status;
+          failed |= !status.IsOk();
+          --remaining;
+          cv.notify_all();
+        });
       }
+      std::unique_lock<std::mutex> lk(mu);
+      cv.wait(lk, [&remaining] { return remaining == 0; });
+    }
+
+    // Report the first failure in config order, the cancelled instances
+    // are always preceded by the failure that cancelled them.
+    for (const auto& pending : pending_instances) {
+      RETURN_IF_ERROR(pending.status_);
+    }
+    for (auto& pending : pending_instances) {
+      RETURN_IF_ERROR(model->RegisterInstance(
+          std::move(pending.instance_), pending.passive_));
     }
   }
 
@@ -327,6 +438,7 @@ TritonModelInstance::CreateInstance(
     const triton::common::HostPolicyCmdlineConfig& host_policy,
     const inference::ModelRateLimiter& rate_limiter_config,
     const std::vector<SecondaryDevice>& secondary_devices,
+    const std::vector<std::shared_ptr<const WarmupBuffers>>& warmup_buffers,
     std::shared_ptr<TritonModelInstance>* triton_model_instance)
 {
   // Create the JSON representation of the backend configuration.
@@ -352,6 +464,7 @@ TritonModelInstance::CreateInstance(
   // Instance initialization is optional... We must set set shared
   // library path to point to the backend directory in case the
   // backend library attempts to load additional shared libaries.
+  const uint64_t init_start_ns = SteadyNowNs();
   if (model->Backend()->ModelInstanceInitFn() != nullptr) {
     // We must set set shared library path to point to the backend directory in
     // case the backend library attempts to load additional shared libaries.
@@ -374,15 +487,25 @@ TritonModelInstance::CreateInstance(
 #endif
     RETURN_IF_TRITONSERVER_ERROR(err);
   }
+  const uint64_t init_duration_ns = SteadyNowNs() - init_start_ns;
 
   if (!passive) {
-    RETURN_IF_ERROR(local_instance->GenerateWarmupData());
+    RETURN_IF_ERROR(local_instance->GenerateWarmupData(warmup_buffers));
     RETURN_IF_ERROR(model->Server()->GetRateLimiter()->RegisterModelInstance(
         local_instance.get(), rate_limiter_config));
     RETURN_IF_ERROR(local_instance->SetBackendThread(
         kind, device_id, model->DeviceBlocking()));
   }
 
+  LOG_VERBOSE(1) << "model '" << model->Name() << "' instance " << name
+                 << " initialized in " << (init_duration_ns / 1000000)
+                 << " ms, warmed up in "
+                 << (local_instance->warmup_duration_ns_ / 1000000) << " ms";
+#ifdef TRITON_ENABLE_STATS
+  model->MutableStatsAggregator()->UpdateInstanceLoadStats(
+      name, init_duration_ns, local_instance->warmup_duration_ns_);
+#endif  // TRITON_ENABLE_STATS
+
   triton_model_instance->reset(local_instance.release());
 
   return Status::Success;
@@ -415,21 +538,21 @@ TritonModelInstance::SetBackendThread(
 }
 
 Status
-TritonModelInstance::GenerateWarmupData()
+TritonModelInstance::GenerateWarmupBuffers(
+    TritonModel* model,
+    std::vector<std::shared_ptr<const WarmupBuffers>>* warmup_buffers)
 {
-  warmup_samples_.clear();
-  for (const auto& warmup_setting : model_->Config().model_warmup()) {
+  warmup_buffers->clear();
+  for (const auto& warmup_setting : model->Config().model_warmup()) {
     if (warmup_setting.batch_size() == 0) {
-      LOG_VERBOSE(1) << "Skipping batch 0 warmup sample '"
-                     << warmup_setting.name() << "'";
+      warmup_buffers->emplace_back();
       continue;
     }
     LOG_VERBOSE(1) << "Generating warmup sample data for '"
                    << warmup_setting.name() << "'";
 
     // Two passes. First pass to get max byte size for synthetic
-    // data. Second pass to add original inputs and override inputs
-    // for control inputs.
+    // data. Second pass to read the data provided from files.
     int64_t max_zero_byte_size = 0;
     int64_t max_random_byte_size = 0;
     for (const auto& input_meta : warmup_setting.inputs()) {
@@ -472,26 +595,66 @@ TritonModelInstance::GenerateWarmupData()
       }
     }
 
-    warmup_samples_.emplace_back(warmup_setting.name(), warmup_setting.count());
-    auto& warmup_data = warmup_samples_.back();
+    std::shared_ptr<WarmupBuffers> buffers = std::make_shared<WarmupBuffers>();
     // Create buffers for synthetic data
     TRITONSERVER_MemoryType type;
     int64_t type_id;
-    warmup_data.zero_data_.reset(new AllocatedMemory(
+    buffers->zero_data_.reset(new AllocatedMemory(
         max_zero_byte_size, TRITONSERVER_MEMORY_CPU_PINNED /* memory_type */,
         0 /* memory_type_id */));
-    char* zero_buffer = warmup_data.zero_data_->MutableBuffer(&type, &type_id);
+    char* zero_buffer = buffers->zero_data_->MutableBuffer(&type, &type_id);
     memset(zero_buffer, 0, max_zero_byte_size);
 
-    warmup_data.random_data_.reset(new AllocatedMemory(
+    buffers->random_data_.reset(new AllocatedMemory(
         max_random_byte_size, TRITONSERVER_MEMORY_CPU_PINNED /* memory_type */,
         0 /* memory_type_id */));
-    char* random_buffer =
-        warmup_data.random_data_->MutableBuffer(&type, &type_id);
+    char* random_buffer = buffers->random_data_->MutableBuffer(&type, &type_id);
     for (int64_t offset = 0; offset < max_random_byte_size; offset++) {
       random_buffer[offset] = rand();
     }
 
+    for (const auto& input_meta : warmup_setting.inputs()) {
+      if (input_meta.second.input_data_type_case() ==
+          inference::ModelWarmup_Input::InputDataTypeCase::kInputDataFile) {
+        RETURN_IF_ERROR(ReadTextFile(
+            JoinPath(
+                {model->LocalizedModelPath(), kWarmupDataFolder,
+                 input_meta.second.input_data_file()}),
+            &buffers->provided_data_[input_meta.first]));
+      }
+    }
+
+    warmup_buffers->emplace_back(std::move(buffers));
+  }
+
+  return Status::Success;
+}
+
+Status
+TritonModelInstance::GenerateWarmupData(
+    const std::vector<std::shared_ptr<const WarmupBuffers>>& warmup_buffers)
+{
+  warmup_samples_.clear();
+  const auto& model_warmup = model_->Config().model_warmup();
+  for (int idx = 0; idx < model_warmup.size(); ++idx) {
+    const auto& warmup_setting = model_warmup[idx];
+    if (warmup_setting.batch_size() == 0) {
+      LOG_VERBOSE(1) << "Skipping batch 0 warmup sample '"
+                     << warmup_setting.name() << "'";
+      continue;
+    }
+
+    warmup_samples_.emplace_back(
+        warmup_setting.name(), warmup_setting.count(), warmup_buffers[idx]);
+    auto& warmup_data = warmup_samples_.back();
+    size_t byte_size;
+    TRITONSERVER_MemoryType type;
+    int64_t type_id;
+    const char* zero_buffer = warmup_data.buffers_->zero_data_->BufferAt(
+        0 /* idx */, &byte_size, &type, &type_id);
+    const char* random_buffer = warmup_data.buffers_->random_data_->BufferAt(
+        0 /* idx */, &byte_size, &type, &type_id);
+
     // Prepare the inference request for the specified sample, not using
     // in-process C API because the request doesn't go through the same pipeline
     // (i.e. no normalization / scheduler) so we need to prepare the request to
@@ -529,18 +692,13 @@ TritonModelInstance::GenerateWarmupData()
           }
           case inference::ModelWarmup_Input::InputDataTypeCase::
               kInputDataFile: {
-            // For data provided from file, we can set buffer in first pass
-            warmup_data.provided_data_.emplace_back(new std::string());
-            auto input_data = warmup_data.provided_data_.back().get();
-            RETURN_IF_ERROR(ReadTextFile(
-                JoinPath(
-                    {model_->LocalizedModelPath(), kWarmupDataFolder,
-                     input_meta.second.input_data_file()}),
-                input_data));
+            // Data provided from file is read with the warmup buffers
+            const std::string& input_data =
+                warmup_data.buffers_->provided_data_.at(input_meta.first);
             if (input_meta.second.data_type() ==
                 inference::DataType::TYPE_STRING) {
-              batch_byte_size = input_data->size();
-            } else if (((size_t)batch_byte_size) > input_data->size()) {
+              batch_byte_size = input_data.size();
+            } else if (((size_t)batch_byte_size) > input_data.size()) {
               return Status(
                   Status::Code::INVALID_ARG,
                   lrequest->LogRequest() + "warmup setting expects " +
@@ -548,9 +706,9 @@ TritonModelInstance::GenerateWarmupData()
                       " bytes, but the data "
                       "provided from " +
                       input_meta.second.input_data_file() + "only has " +
-                      std::to_string(input_data->size()) + " bytes");
+                      std::to_string(input_data.size()) + " bytes");
             }
-            allocated_ptr = input_data->data();
+            allocated_ptr = input_data.data();
             break;
           }
           default:
@@ -760,11 +918,13 @@ TritonModelInstance::TritonBackendThread::InitAndWarmUpModelInstance(
   RETURN_IF_ERROR(init_payload->Wait());
 
   // Warm-up the instance on the backend thread
+  const uint64_t warmup_start_ns = SteadyNowNs();
   auto warmup_payload = model_->Server()->GetRateLimiter()->GetPayload(
       Payload::Operation::WARM_UP, model_instance);
   RETURN_IF_ERROR(model_->Server()->GetRateLimiter()->EnqueuePayload(
       model_, warmup_payload));
   RETURN_IF_ERROR(warmup_payload->Wait());
+  model_instance->warmup_duration_ns_ = SteadyNowNs() - warmup_start_ns;
 
   return Status::Success;
 }
@@ -778,16 +938,22 @@ TritonModelInstance::TritonBackendThread::TritonBackendThread(
 
 TritonModelInstance::TritonBackendThread::~TritonBackendThread()
 {
-  StopBackendThread();
+  if (backend_thread_.joinable()) {
+    StopBackendThread(model_instances_.back());
+  }
 }
 
 void
-TritonModelInstance::TritonBackendThread::StopBackendThread()
+TritonModelInstance::TritonBackendThread::StopBackendThread(
+    TritonModelInstance* model_instance)
 {
   if (backend_thread_.joinable()) {
-    // Signal the backend thread to exit and then wait for it...
+    // Signal the backend thread to exit and then wait for it. The exit
+    // payload is sent through 'model_instance' which must run on this
+    // thread, 'model_instances_' can't be used as the thread removes the
+    // instances from it while executing their payloads.
     auto exit_payload = model_->Server()->GetRateLimiter()->GetPayload(
-        Payload::Operation::EXIT, model_instances_.back());
+        Payload::Operation::EXIT, model_instance);
     model_->Server()->GetRateLimiter()->EnqueuePayload(model_, exit_payload);
     backend_thread_.join();
   }
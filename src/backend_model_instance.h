@@ -30,6 +30,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include "constants.h"
 #include "memory.h"
 #include "metric_model_reporter.h"
@@ -134,7 +135,7 @@ class TritonModelInstance {
         std::unique_ptr<TritonBackendThread>* triton_backend_thread);
     void AddModelInstance(TritonModelInstance* model_instance);
     Status InitAndWarmUpModelInstance(TritonModelInstance* model_instance);
-    void StopBackendThread();
+    void StopBackendThread(TritonModelInstance* model_instance);
     ~TritonBackendThread();
 
    private:
@@ -154,9 +155,22 @@ class TritonModelInstance {
     std::atomic<bool> backend_thread_exit_;
   };
 
+  // Input data of a warmup sample. The data is only read during warmup
+  // so it is generated once and shared by all instances created by the
+  // same SetInstances() call.
+  struct WarmupBuffers {
+    std::unique_ptr<AllocatedMemory> zero_data_;
+    std::unique_ptr<AllocatedMemory> random_data_;
+    // Data read from 'input_data_file', keyed by input name
+    std::unordered_map<std::string, std::string> provided_data_;
+  };
+
   struct WarmupData {
-    WarmupData(const std::string& sample_name, const size_t count)
-        : sample_name_(sample_name), count_(std::max(count, size_t{1}))
+    WarmupData(
+        const std::string& sample_name, const size_t count,
+        const std::shared_ptr<const WarmupBuffers>& buffers)
+        : sample_name_(sample_name), count_(std::max(count, size_t{1})),
+          buffers_(buffers)
     {
     }
 
@@ -168,9 +182,7 @@ class TritonModelInstance {
     std::vector<std::unique_ptr<InferenceRequest>> requests_;
 
     // Placeholder for input data
-    std::unique_ptr<AllocatedMemory> zero_data_;
-    std::unique_ptr<AllocatedMemory> random_data_;
-    std::vector<std::unique_ptr<std::string>> provided_data_;
+    std::shared_ptr<const WarmupBuffers> buffers_;
   };
 
   DISALLOW_COPY_AND_ASSIGN(TritonModelInstance);
@@ -189,11 +201,19 @@ class TritonModelInstance {
       const triton::common::HostPolicyCmdlineConfig& host_policy,
       const inference::ModelRateLimiter& rate_limiter_config,
       const std::vector<SecondaryDevice>& secondary_devices,
+      const std::vector<std::shared_ptr<const WarmupBuffers>>& warmup_buffers,
       std::shared_ptr<TritonModelInstance>* triton_model_instance);
   Status SetBackendThread(
       const TRITONSERVER_InstanceGroupKind kind, const int32_t device_id,
       const bool device_blocking);
-  Status GenerateWarmupData();
+  // Generate the input data of each warmup sample in the model config.
+  // 'warmup_buffers' has an entry for each 'model_warmup' setting, which
+  // is nullptr if the setting is skipped.
+  static Status GenerateWarmupBuffers(
+      TritonModel* model,
+      std::vector<std::shared_ptr<const WarmupBuffers>>* warmup_buffers);
+  Status GenerateWarmupData(
+      const std::vector<std::shared_ptr<const WarmupBuffers>>& warmup_buffers);
 
   void Execute(std::vector<TRITONBACKEND_Request*>& triton_requests);
 
@@ -226,6 +246,10 @@ class TritonModelInstance {
 
   // Opaque state associated with this model instance.
   void* state_;
+
+  // The time spent running the warmup samples, set by the backend thread
+  // before the instance is returned from CreateInstance().
+  uint64_t warmup_duration_ns_;
 };
 
 }}  // namespace triton::core
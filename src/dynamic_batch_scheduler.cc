@@ -74,7 +74,9 @@ DynamicBatchScheduler::DynamicBatchScheduler(
       pending_batch_size_(0), queued_batch_size_(0),
       next_preferred_batch_size_(0),
       enforce_equal_shape_tensors_(enforce_equal_shape_tensors),
-      has_optional_input_(false), preserve_ordering_(preserve_ordering)
+      has_optional_input_(false), preserve_ordering_(preserve_ordering),
+      batch_reason_(nullptr), payload_batch_reason_(nullptr),
+      reported_pending_batch_size_(0)
 {
   rate_limiter_ = model_->Server()->GetRateLimiter();
   // Both the server and model config should specify
@@ -82,8 +84,12 @@ DynamicBatchScheduler::DynamicBatchScheduler(
   response_cache_enabled_ =
       response_cache_enable && model_->Server()->ResponseCacheEnabled();
 #ifdef TRITON_ENABLE_METRICS
-  // Initialize metric reporter for cache statistics if cache enabled
-  if (response_cache_enabled_) {
+  // Initialize metric reporter for cache statistics if cache enabled,
+  // or for scheduler statistics if those are requested
+  MetricReporterConfig reporter_config;
+  reporter_config.ParseConfig(response_cache_enabled_, model_name_);
+  if (response_cache_enabled_ ||
+      (Metrics::Enabled() && reporter_config.scheduler_metrics_enabled_)) {
     MetricModelReporter::Create(
         model_name_, model_->Version(), METRIC_REPORTER_ID_RESPONSE_CACHE,
         response_cache_enabled_, model_->Config().metric_tags(), &reporter_);
@@ -101,6 +107,15 @@ DynamicBatchScheduler::DynamicBatchScheduler(
       break;
     }
   }
+
+  // Executing on the calling thread would let instances sharing a
+  // device run concurrently, so not done for device blocking models.
+  const auto& parameters = model_->Config().parameters();
+  const auto itr = parameters.find("TRITON_DIRECT_EXECUTION");
+  direct_execution_ = !dynamic_batching_enabled_ &&
+                      (model_instance_ == nullptr) &&
+                      !model_->DeviceBlocking() && (itr != parameters.end()) &&
+                      (itr->second.string_value() == "true");
 }
 
 Status
@@ -168,6 +183,18 @@ DynamicBatchScheduler::~DynamicBatchScheduler()
   if (scheduler_thread_.joinable()) {
     scheduler_thread_.join();
   }
+
+#ifdef TRITON_ENABLE_METRICS
+  // Withdraw the sizes reported by this scheduler
+  if (reporter_ != nullptr) {
+    for (const auto& level : queue_level_sizes_) {
+      reporter_->AdjustSchedulerQueueSize(
+          level.first, -static_cast<double>(level.second.second));
+    }
+    reporter_->AdjustSchedulerPendingBatchSize(
+        -static_cast<double>(reported_pending_batch_size_));
+  }
+#endif  // TRITON_ENABLE_METRICS
 }
 
 Status
@@ -180,6 +207,119 @@ DynamicBatchScheduler::Enqueue(std::unique_ptr<InferenceRequest>& request)
             "Server is stopping, scheduler for model has stopped accepting new "
             "inference requests");
   }
+
+  if (StartEnqueue(request)) {
+    return Status::Success;
+  }
+
+  if (!dynamic_batching_enabled_) {
+    if (preserve_ordering_ || response_cache_enabled_) {
+      DelegateResponse(request);
+    }
+    // If not using dynamic batching, directly enqueue the
+    // request to model for execution
+    auto payload = model_->Server()->GetRateLimiter()->GetPayload(
+        Payload::Operation::INFER_RUN, nullptr /* TritonModelInstance*/);
+    payload->AddRequest(std::move(request));
+    if (direct_execution_ &&
+        model_->Server()->GetRateLimiter()->ExecutePayloadIfIdle(
+            model_, payload)) {
+      return Status::Success;
+    }
+    RETURN_IF_ERROR(
+        model_->Server()->GetRateLimiter()->EnqueuePayload(model_, payload));
+
+  } else {
+    bool wake_batcher = true;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+
+      queued_batch_size_ += std::max(1U, request->BatchSize());
+
+      // Assuming no error is returned, this call takes ownership of
+      // 'request' and so we can't use it after this point.
+      Status status = queue_.Enqueue(request->Priority(), request);
+#ifdef TRITON_ENABLE_METRICS
+      if ((reporter_ != nullptr) && !status.IsOk()) {
+        reporter_->IncrementSchedulerRejections("max_queue_size", 1);
+      }
+#endif  // TRITON_ENABLE_METRICS
+      RETURN_IF_ERROR(status);
+      ReportQueueMetrics();
+
+      // We do the actual wake outside of the lock to avoid having the
+      // woken thread immediately block on the lock
+      wake_batcher = ShouldWakeBatcher();
+    }
+
+    if (wake_batcher) {
+      cv_.notify_one();
+    }
+  }
+
+  return Status::Success;
+}
+
+void
+DynamicBatchScheduler::EnqueueBatch(
+    std::vector<std::unique_ptr<InferenceRequest>>& requests)
+{
+  // Without dynamic batching every request becomes its own payload so
+  // there is nothing to share between the requests.
+  if (stop_ || !dynamic_batching_enabled_) {
+    Scheduler::EnqueueBatch(requests);
+    return;
+  }
+
+  std::vector<std::unique_ptr<InferenceRequest>*> queue_requests;
+  queue_requests.reserve(requests.size());
+  for (auto& request : requests) {
+    if (!StartEnqueue(request)) {
+      queue_requests.push_back(&request);
+    }
+  }
+
+  if (queue_requests.empty()) {
+    return;
+  }
+
+  // Queue all requests under a single acquisition of 'mu_' and wake
+  // the batcher at most once for the whole batch. Requests that fail
+  // to enqueue are responded to after the lock is released since the
+  // response and release callbacks may call back into the server.
+  std::vector<Status> statuses;
+  statuses.reserve(queue_requests.size());
+  bool wake_batcher = true;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+
+    for (auto request : queue_requests) {
+      queued_batch_size_ += std::max(1U, (*request)->BatchSize());
+      statuses.emplace_back(queue_.Enqueue((*request)->Priority(), *request));
+#ifdef TRITON_ENABLE_METRICS
+      if ((reporter_ != nullptr) && !statuses.back().IsOk()) {
+        reporter_->IncrementSchedulerRejections("max_queue_size", 1);
+      }
+#endif  // TRITON_ENABLE_METRICS
+    }
+    ReportQueueMetrics();
+
+    wake_batcher = ShouldWakeBatcher();
+  }
+
+  if (wake_batcher) {
+    cv_.notify_one();
+  }
+
+  for (size_t idx = 0; idx < queue_requests.size(); idx++) {
+    InferenceRequest::RespondIfError(
+        *queue_requests[idx], statuses[idx], true /* release_request */);
+  }
+}
+
+bool
+DynamicBatchScheduler::StartEnqueue(std::unique_ptr<InferenceRequest>& request)
+{
   // If queue start timestamp hasn't been set, queue timer starts at
   // the beginning of the queueing and scheduling process. Otherwise,
   // dynamic batcher is used as component of another batcher and should not
@@ -223,56 +363,67 @@ DynamicBatchScheduler::Enqueue(std::unique_ptr<InferenceRequest>& request)
     InferenceRequest::Release(
         std::move(request), TRITONSERVER_REQUEST_RELEASE_ALL);
 
-    return Status::Success;
+    return true;
   }
 
-  if (!dynamic_batching_enabled_) {
-    if (preserve_ordering_ || response_cache_enabled_) {
-      DelegateResponse(request);
-    }
-    // If not using dynamic batching, directly enqueue the
-    // request to model for execution
-    auto payload = model_->Server()->GetRateLimiter()->GetPayload(
-        Payload::Operation::INFER_RUN, nullptr /* TritonModelInstance*/);
-    payload->AddRequest(std::move(request));
-    RETURN_IF_ERROR(
-        model_->Server()->GetRateLimiter()->EnqueuePayload(model_, payload));
-
-  } else {
-    bool wake_batcher = true;
-    {
-      std::lock_guard<std::mutex> lock(mu_);
+  return false;
+}
 
-      queued_batch_size_ += std::max(1U, request->BatchSize());
+bool
+DynamicBatchScheduler::ShouldWakeBatcher()
+{
+  // If there are any idle runners and the queued batch size is greater or
+  // equal to next preferred batch size, then wake batcher up to service
+  // the queued requests.
+  bool wake_batcher =
+      model_->Server()->GetRateLimiter()->PayloadSlotAvailable(model_);
+
+  // We may wake up runner less often if we don't enforce equal shape
+  // within a batch, otherwise must always wake up runner to check it
+  if (enforce_equal_shape_tensors_.empty()) {
+    std::lock_guard<std::mutex> exec_lock(*(curr_payload_->GetExecMutex()));
+    auto payload_state = curr_payload_->GetState();
+    wake_batcher &=
+        (payload_saturated_ || IsStaleState(payload_state) ||
+         (queued_batch_size_ >= next_preferred_batch_size_));
+  }
+
+  return wake_batcher;
+}
 
-      // Assuming no error is returned, this call takes ownership of
-      // 'request' and so we can't use it after this point.
-      RETURN_IF_ERROR(queue_.Enqueue(request->Priority(), request));
-
-      // If there are any idle runners and the queued batch size is greater or
-      // equal to next preferred batch size, then wake batcher up to service
-      // this request. We do the actual wake outside of the lock to avoid
-      // having the woken thread immediately block on the lock
-      wake_batcher =
-          model_->Server()->GetRateLimiter()->PayloadSlotAvailable(model_);
-
-      // We may wake up runner less often if we don't enforce equal shape
-      // within a batch, otherwise must always wake up runner to check it
-      if (enforce_equal_shape_tensors_.empty()) {
-        std::lock_guard<std::mutex> exec_lock(*(curr_payload_->GetExecMutex()));
-        auto payload_state = curr_payload_->GetState();
-        wake_batcher &=
-            (payload_saturated_ || IsStaleState(payload_state) ||
-             (queued_batch_size_ >= next_preferred_batch_size_));
-      }
-    }
+void
+DynamicBatchScheduler::ReportQueueMetrics()
+{
+#ifdef TRITON_ENABLE_METRICS
+  if (reporter_ == nullptr) {
+    return;
+  }
 
-    if (wake_batcher) {
-      cv_.notify_one();
+  // Levels may have been removed from the queue since the last report,
+  // those are reported as empty.
+  for (auto& level : queue_level_sizes_) {
+    level.second.first = 0;
+  }
+  queue_.ForEachLevelSize([this](const uint32_t level, const size_t size) {
+    queue_level_sizes_[level].first = size;
+  });
+  for (auto& level : queue_level_sizes_) {
+    auto& sizes = level.second;
+    if (sizes.first != sizes.second) {
+      reporter_->AdjustSchedulerQueueSize(
+          level.first,
+          static_cast<double>(sizes.first) - static_cast<double>(sizes.second));
+      sizes.second = sizes.first;
     }
   }
 
-  return Status::Success;
+  if (pending_batch_size_ != reported_pending_batch_size_) {
+    reporter_->AdjustSchedulerPendingBatchSize(
+        static_cast<double>(pending_batch_size_) -
+        static_cast<double>(reported_pending_batch_size_));
+    reported_pending_batch_size_ = pending_batch_size_;
+  }
+#endif  // TRITON_ENABLE_METRICS
 }
 
 void
@@ -281,6 +432,7 @@ DynamicBatchScheduler::NewPayload()
   curr_payload_ = model_->Server()->GetRateLimiter()->GetPayload(
       Payload::Operation::INFER_RUN, model_instance_);
   payload_saturated_ = false;
+  payload_batch_reason_ = nullptr;
   CustomBatchInit();
 }
 
@@ -400,7 +552,11 @@ DynamicBatchScheduler::BatcherThread(const int nice)
 
             queued_batch_size_ -= pending_batch_size_;
             pending_batch_size_ = 0;
+            if (batch_reason_ != nullptr) {
+              payload_batch_reason_ = batch_reason_;
+            }
           }
+          ReportQueueMetrics();
         }
       }
 
@@ -419,6 +575,12 @@ DynamicBatchScheduler::BatcherThread(const int nice)
         std::lock_guard<std::mutex> exec_lock(*(curr_payload_->GetExecMutex()));
         CustomBatchFini();
       }
+#ifdef TRITON_ENABLE_METRICS
+      if ((reporter_ != nullptr) && (payload_batch_reason_ != nullptr)) {
+        reporter_->IncrementSchedulerBatches(payload_batch_reason_);
+      }
+#endif  // TRITON_ENABLE_METRICS
+      payload_batch_reason_ = nullptr;
       model_->Server()->GetRateLimiter()->EnqueuePayload(model_, curr_payload_);
     }
 
@@ -427,6 +589,12 @@ DynamicBatchScheduler::BatcherThread(const int nice)
       static Status rejected_status =
           Status(Status::Code::UNAVAILABLE, "Request timeout expired");
       for (auto& rejected_queue : *rejected_requests) {
+#ifdef TRITON_ENABLE_METRICS
+        if (reporter_ != nullptr) {
+          reporter_->IncrementSchedulerRejections(
+              "timeout", rejected_queue.size());
+        }
+#endif  // TRITON_ENABLE_METRICS
         for (auto& rejected_request : rejected_queue) {
           InferenceRequest::RespondIfError(
               rejected_request, rejected_status, true);
@@ -451,6 +619,9 @@ DynamicBatchScheduler::GetDynamicBatch()
   // batch size would be exceeded or if the shape of the next request
   // does not match the shape of the pending batch.
   bool send_now = false;
+  // Why the batch must be sent now, reported in scheduler metrics.
+  const char* send_now_reason = nullptr;
+  batch_reason_ = nullptr;
 
   // If the previous payload was not executed, reset the cursor to the start
   // of the queue to re-iterate over it and find the ideal batch.
@@ -484,6 +655,7 @@ DynamicBatchScheduler::GetDynamicBatch()
                      has_optional_input_)
                  .IsOk()) {
           send_now = true;
+          send_now_reason = "shape_mismatch";
           break;
         }
       }
@@ -502,6 +674,7 @@ DynamicBatchScheduler::GetDynamicBatch()
       if ((payload_batch_size + pending_batch_size_ + batch_size) >
           max_batch_size_) {
         send_now = true;
+        send_now_reason = "max_size";
         break;
       }
 
@@ -512,6 +685,7 @@ DynamicBatchScheduler::GetDynamicBatch()
               queue_.RequestAtCursor())) {
         curr_payload_->MarkSaturated();
         send_now = true;
+        send_now_reason = "shape_mismatch";
         break;
       }
     }
@@ -522,6 +696,7 @@ DynamicBatchScheduler::GetDynamicBatch()
       if (!should_include) {
         curr_payload_->MarkSaturated();
         send_now = true;
+        send_now_reason = "custom_batch";
         break;
       }
     }
@@ -554,6 +729,7 @@ DynamicBatchScheduler::GetDynamicBatch()
     }
     pending_batch_size_ = best_preferred_batch_size;
     queue_.SetCursorToMark();
+    batch_reason_ = "preferred_size";
     return 0;
   }
 
@@ -568,10 +744,12 @@ DynamicBatchScheduler::GetDynamicBatch()
   if (send_now || ((payload_batch_size + pending_batch_size_) >=
                    max_preferred_batch_size_)) {
     payload_saturated_ = true;
+    batch_reason_ = send_now ? send_now_reason : "max_size";
     return 0;
   }
 
   if (delay_is_exceeded || (pending_batch_delay_ns_ == 0)) {
+    batch_reason_ = delay_is_exceeded ? "delay_expired" : "no_delay";
     return 0;
   }
 
@@ -596,6 +774,7 @@ DynamicBatchScheduler::GetDynamicBatch()
   if (!payload_saturated_ && (payload_batch_size != 0) &&
       (preferred_batch_sizes_.find(payload_batch_size) ==
        preferred_batch_sizes_.end())) {
+    batch_reason_ = "grow_payload";
     return 0;
   }
 
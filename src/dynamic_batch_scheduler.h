@@ -74,6 +74,10 @@ class DynamicBatchScheduler : public Scheduler {
   // \see Scheduler::Enqueue()
   Status Enqueue(std::unique_ptr<InferenceRequest>& request) override;
 
+  // \see Scheduler::EnqueueBatch()
+  void EnqueueBatch(
+      std::vector<std::unique_ptr<InferenceRequest>>& requests) override;
+
   // \see Scheduler::InflightInferenceCount()
   size_t InflightInferenceCount() override
   {
@@ -105,6 +109,16 @@ class DynamicBatchScheduler : public Scheduler {
   void NewPayload();
   uint64_t GetDynamicBatch();
   void DelegateResponse(std::unique_ptr<InferenceRequest>& request);
+  // Record the queue start of 'request' and, if the response cache is
+  // enabled, respond to it from the cache. Returns true if 'request'
+  // was completed from the cache and released.
+  bool StartEnqueue(std::unique_ptr<InferenceRequest>& request);
+  // Returns true if the batcher should be woken up to service the
+  // queued requests. Must be called with 'mu_' held.
+  bool ShouldWakeBatcher();
+  // Report the changes of the queue and pending batch sizes since the
+  // last report. Must be called with 'mu_' held.
+  void ReportQueueMetrics();
   void CacheLookUp(
       std::unique_ptr<InferenceRequest>& request,
       std::unique_ptr<InferenceResponse>& cached_response);
@@ -132,6 +146,11 @@ class DynamicBatchScheduler : public Scheduler {
   // True if dynamic batching is enabled.
   const bool dynamic_batching_enabled_;
 
+  // True if a request may be executed on the thread that enqueues it
+  // when an instance of the model is idle, Enqueue() then returns once
+  // the request executed. Only used when dynamic batching is disabled.
+  bool direct_execution_;
+
   // Map from priority level to queue holding inference requests for the model
   // represented by this scheduler. If priority queues are not supported by the
   // scheduler, then priority zero entry is used as the single queue.
@@ -190,6 +209,21 @@ class DynamicBatchScheduler : public Scheduler {
 
   // Reporter for metrics, or nullptr if no metrics should be reported
   std::shared_ptr<MetricModelReporter> reporter_;
+
+  // The reason the current pending batch is sent, set by
+  // GetDynamicBatch() when it returns a batch to execute.
+  const char* batch_reason_;
+
+  // The reason of the last batch added to 'curr_payload_', counted once
+  // when the payload is handed to the rate limiter.
+  const char* payload_batch_reason_;
+
+  // Queue size of each priority level as last seen and as last
+  // reported, and the last reported pending batch size. The reporter
+  // is adjusted by differences so that batchers sharing a reporter
+  // report their combined sizes.
+  std::map<uint32_t, std::pair<size_t, size_t>> queue_level_sizes_;
+  size_t reported_pending_batch_size_;
 };
 
 }}  // namespace triton::core
@@ -54,7 +54,9 @@ class RequestTracker {
       InferenceStatsAggregator* stats_aggregator)
       : inflight_request_counter_(1), request_(std::move(request)),
         compute_start_ns_(compute_start_ns), metric_reporter_(metric_reporter),
-        stats_aggregator_(stats_aggregator), status_(Status::Success)
+        stats_aggregator_(stats_aggregator),
+        context_stats_aggregator_(1 /* shard_count */),
+        status_(Status::Success)
   {
   }
 
@@ -77,7 +79,7 @@ class RequestTracker {
     inflight_request_counter_--;
     if (inflight_request_counter_ == 0) {
 #ifdef TRITON_ENABLE_STATS
-      const auto& infer_stats = context_stats_aggregator_.ImmutableInferStats();
+      const auto infer_stats = context_stats_aggregator_.InferStatsSnapshot();
       request_->ReportStatisticsWithDuration(
           metric_reporter_, status_.IsOk(), compute_start_ns_,
           infer_stats.compute_input_duration_ns_,
@@ -110,6 +112,7 @@ class RequestTracker {
   uint64_t compute_start_ns_;
   MetricModelReporter* metric_reporter_;
   InferenceStatsAggregator* stats_aggregator_;
+  // Only lives for a single ensemble request so a single shard suffices.
   InferenceStatsAggregator context_stats_aggregator_;
   Status status_;
 };
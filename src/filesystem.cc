@@ -72,10 +72,13 @@
 #include <sys/types.h>
 
 #include <cerrno>
+#include <cstdlib>
 #include <fstream>
 #include <mutex>
 
 #include "constants.h"
+#include "localize_cache.h"
+#include "parallel_download.h"
 #include "status.h"
 #include "triton/common/logging.h"
 
@@ -835,6 +838,9 @@ GCSFileSystem::LocalizePath(
     contents.insert(JoinPath({path, *itr}));
   }
 
+  // Mirror the directory structure, the files are downloaded concurrently
+  // afterwards
+  std::vector<std::pair<std::string, std::string>> files;
   while (contents.size() != 0) {
     std::set<std::string> tmp_contents = contents;
     contents.clear();
@@ -869,31 +875,46 @@ GCSFileSystem::LocalizePath(
           contents.insert(JoinPath({gcs_fpath, *itr}));
         }
       } else {
-        // Create local copy of file
+        files.emplace_back(gcs_fpath, local_fpath);
+      }
+    }
+  }
+
+  return ParallelDownloader::GetSingleton()->Download(
+      files,
+      [this](const std::string& gcs_fpath, uint64_t* byte_size) -> Status {
+        std::string file_bucket, file_object;
+        RETURN_IF_ERROR(ParsePath(gcs_fpath, &file_bucket, &file_object));
+        google::cloud::StatusOr<gcs::ObjectMetadata> object_metadata =
+            client_->GetObjectMetadata(file_bucket, file_object);
+        if (!object_metadata) {
+          return Status(
+              Status::Code::INTERNAL,
+              "Failed to get metadata for " + gcs_fpath + " : " +
+                  object_metadata.status().message());
+        }
+        *byte_size = object_metadata->size();
+        return Status::Success;
+      },
+      [this](
+          const std::string& gcs_fpath, const uint64_t offset,
+          const uint64_t byte_size, std::ostream* out) -> Status {
         std::string file_bucket, file_object;
         RETURN_IF_ERROR(ParsePath(gcs_fpath, &file_bucket, &file_object));
 
-        // Send a request to read the object
-        gcs::ObjectReadStream filestream =
-            client_->ReadObject(file_bucket, file_object);
+        // Send a request to read the range of the object
+        gcs::ObjectReadStream filestream = client_->ReadObject(
+            file_bucket, file_object,
+            gcs::ReadRange(offset, offset + byte_size));
         if (!filestream) {
           return Status(
-              Status::Code::INTERNAL, "Failed to get object at " + *iter +
+              Status::Code::INTERNAL, "Failed to get object at " + gcs_fpath +
                                           " : " +
                                           filestream.status().message());
         }
-
-        std::string gcs_removed_path = (*iter).substr(path.size());
-        std::string local_file_path =
-            JoinPath({(*localized)->Path(), gcs_removed_path});
-        std::ofstream output_file(local_file_path.c_str(), std::ios::binary);
-        output_file << filestream.rdbuf();
-        output_file.close();
-      }
-    }
-  }
-
-  return Status::Success;
+        *out << filestream.rdbuf();
+        return Status::Success;
+      });
 }
 
 Status
@@ -1017,6 +1038,12 @@ class ASFileSystem : public FileSystem {
   Status DownloadFolder(
       const std::string& container, const std::string& path,
       const std::string& dest);
+  // Create the local mirror of the sub-directories in 'path' and return the
+  // pairs of blob path and local path of the files within.
+  Status MirrorFolder(
+      const std::string& container, const std::string& path,
+      const std::string& dest,
+      std::vector<std::pair<std::string, std::string>>* files);
   re2::RE2 as_regex_;
 };
 
@@ -1250,7 +1277,46 @@ ASFileSystem::DownloadFolder(
     const std::string& container, const std::string& path,
     const std::string& dest)
 {
-  as::blob_client_wrapper bc(client_);
+  std::vector<std::pair<std::string, std::string>> files;
+  RETURN_IF_ERROR(MirrorFolder(container, path, dest, &files));
+
+  return ParallelDownloader::GetSingleton()->Download(
+      files,
+      [this, &container](
+          const std::string& blob_path, uint64_t* byte_size) -> Status {
+        as::blob_client_wrapper bc(client_);
+        auto blob_property = bc.get_blob_property(container, blob_path);
+        if (errno != 0) {
+          return Status(
+              Status::Code::INTERNAL,
+              "Unable to get blob property for file at " + blob_path +
+                  ", errno:" + strerror(errno));
+        }
+        *byte_size = blob_property.size;
+        return Status::Success;
+      },
+      [this, &container](
+          const std::string& blob_path, const uint64_t offset,
+          const uint64_t byte_size, std::ostream* out) -> Status {
+        as::blob_client_wrapper bc(client_);
+        bc.download_blob_to_stream(
+            container, blob_path, offset, byte_size, *out);
+        if (errno != 0) {
+          return Status(
+              Status::Code::INTERNAL, "Failed to download file at " +
+                                          blob_path +
+                                          ", errno:" + strerror(errno));
+        }
+        return Status::Success;
+      });
+}
+
+Status
+ASFileSystem::MirrorFolder(
+    const std::string& container, const std::string& path,
+    const std::string& dest,
+    std::vector<std::pair<std::string, std::string>>* files)
+{
   auto func = [&](const as::list_blobs_segmented_item& item,
                   const std::string& dir) {
     auto local_path = JoinPath({dest, dir});
@@ -1264,18 +1330,12 @@ ASFileSystem::DownloadFolder(
             "Failed to create local folder: " + local_path +
                 ", errno:" + strerror(errno));
       }
-      auto ret = DownloadFolder(container, blob_path, local_path);
+      auto ret = MirrorFolder(container, blob_path, local_path, files);
       if (!ret.IsOk()) {
         return ret;
       }
     } else {
-      time_t last_modified;
-      bc.download_blob_to_file(container, blob_path, local_path, last_modified);
-      if (errno != 0) {
-        return Status(
-            Status::Code::INTERNAL, "Failed to download file at " + blob_path +
-                                        ", errno:" + strerror(errno));
-      }
+      files->emplace_back(blob_path, local_path);
     }
     return Status::Success;
   };
@@ -1951,7 +2011,9 @@ S3FileSystem::LocalizePath(
     contents.insert(effective_path);
   }
 
-  // Download all specified contents and nested contents
+  // Mirror the directory structure, the files are downloaded concurrently
+  // afterwards
+  std::vector<std::pair<std::string, std::string>> files;
   while (contents.size() != 0) {
     std::set<std::string> tmp_contents = contents;
     contents.clear();
@@ -1988,22 +2050,50 @@ S3FileSystem::LocalizePath(
           contents.insert(JoinPath({s3_fpath, *itr}));
         }
       } else {
-        // Create local copy of file
+        files.emplace_back(s3_fpath, local_fpath);
+      }
+    }
+  }
+
+  return ParallelDownloader::GetSingleton()->Download(
+      files,
+      [this](const std::string& s3_fpath, uint64_t* byte_size) -> Status {
+        std::string file_bucket, file_object;
+        RETURN_IF_ERROR(ParsePath(s3_fpath, &file_bucket, &file_object));
+
+        s3::Model::HeadObjectRequest head_request;
+        head_request.SetBucket(file_bucket.c_str());
+        head_request.SetKey(file_object.c_str());
+
+        auto head_object_outcome = client_->HeadObject(head_request);
+        if (!head_object_outcome.IsSuccess()) {
+          return Status(
+              Status::Code::INTERNAL,
+              "Failed to get size of object at " + s3_fpath +
+                  " due to exception: " +
+                  head_object_outcome.GetError().GetExceptionName() +
+                  ", error message: " +
+                  head_object_outcome.GetError().GetMessage());
+        }
+        *byte_size = head_object_outcome.GetResult().GetContentLength();
+        return Status::Success;
+      },
+      [this](
+          const std::string& s3_fpath, const uint64_t offset,
+          const uint64_t byte_size, std::ostream* out) -> Status {
         std::string file_bucket, file_object;
         RETURN_IF_ERROR(ParsePath(s3_fpath, &file_bucket, &file_object));
 
         s3::Model::GetObjectRequest object_request;
         object_request.SetBucket(file_bucket.c_str());
         object_request.SetKey(file_object.c_str());
+        object_request.SetRange(
+            ("bytes=" + std::to_string(offset) + "-" +
+             std::to_string(offset + byte_size - 1))
+                .c_str());
 
         auto get_object_outcome = client_->GetObject(object_request);
-        if (get_object_outcome.IsSuccess()) {
-          auto& retrieved_file =
-              get_object_outcome.GetResultWithOwnership().GetBody();
-          std::ofstream output_file(local_fpath.c_str(), std::ios::binary);
-          output_file << retrieved_file.rdbuf();
-          output_file.close();
-        } else {
+        if (!get_object_outcome.IsSuccess()) {
           return Status(
               Status::Code::INTERNAL,
               "Failed to get object at " + s3_fpath + " due to exception: " +
@@ -2011,11 +2101,11 @@ S3FileSystem::LocalizePath(
                   ", error message: " +
                   get_object_outcome.GetError().GetMessage());
         }
-      }
-    }
-  }
-
-  return Status::Success;
+        auto& retrieved_file =
+            get_object_outcome.GetResultWithOwnership().GetBody();
+        *out << retrieved_file.rdbuf();
+        return Status::Success;
+      });
 }
 
 Status
@@ -2390,6 +2480,109 @@ FileSystemManager::GetLongestMatchingNameIndex(
 
 static FileSystemManager fsm_;
 
+// Return the persistent cache for localized remote directories, nullptr if
+// not enabled.
+LocalizeCache*
+GetLocalizeCache()
+{
+  static std::unique_ptr<LocalizeCache> cache = []() {
+    std::unique_ptr<LocalizeCache> cache;
+    const char* root = std::getenv("TRITON_LOCALIZE_CACHE_PATH");
+    if (root != nullptr) {
+      uint64_t max_byte_size = 0;
+      const char* byte_size = std::getenv("TRITON_LOCALIZE_CACHE_BYTE_SIZE");
+      if (byte_size != nullptr) {
+        max_byte_size = std::strtoull(byte_size, nullptr, 10);
+      }
+      LOG_STATUS_ERROR(
+          LocalizeCache::Create(root, max_byte_size, &cache),
+          "failed to create localize cache, remote models will be localized "
+          "without caching");
+    }
+    return cache;
+  }();
+  return cache.get();
+}
+
+// Fingerprint of the content of a remote directory, the relative path and
+// the modification time of every file within. Return false in 'valid' if
+// the content can't be identified as some modification time is not
+// available.
+Status
+ContentFingerprint(
+    FileSystem* fs, const std::string& path, std::string* fingerprint,
+    bool* valid)
+{
+  *valid = true;
+  fingerprint->clear();
+
+  // Visit in sorted order so that the fingerprint is stable, the content
+  // of a directory sorts after the directory itself.
+  std::set<std::string> contents;
+  RETURN_IF_ERROR(fs->GetDirectoryContents(path, &contents));
+  while (!contents.empty()) {
+    const std::string relative_path = *contents.begin();
+    contents.erase(contents.begin());
+
+    const auto full_path = JoinPath({path, relative_path});
+    bool is_dir;
+    RETURN_IF_ERROR(fs->IsDirectory(full_path, &is_dir));
+    if (is_dir) {
+      std::set<std::string> subdir_contents;
+      RETURN_IF_ERROR(fs->GetDirectoryContents(full_path, &subdir_contents));
+      for (const auto& content : subdir_contents) {
+        contents.insert(JoinPath({relative_path, content}));
+      }
+      fingerprint->append(relative_path + "/\n");
+    } else {
+      int64_t mtime_ns;
+      RETURN_IF_ERROR(fs->FileModificationTime(full_path, &mtime_ns));
+      if (mtime_ns == 0) {
+        *valid = false;
+        return Status::Success;
+      }
+      fingerprint->append(
+          relative_path + "\t" + std::to_string(mtime_ns) + "\n");
+    }
+  }
+  return Status::Success;
+}
+
+// Move a local file or directory, copying it if it can't be renamed, i.e.
+// to a different device.
+Status
+MoveLocalPath(const std::string& src, const std::string& dst)
+{
+  if (std::rename(src.c_str(), dst.c_str()) == 0) {
+    return Status::Success;
+  }
+
+  bool is_dir;
+  RETURN_IF_ERROR(IsPathDirectory(src, &is_dir));
+  if (is_dir) {
+    RETURN_IF_ERROR(MakeDirectory(dst, false /* recursive */));
+    std::set<std::string> contents;
+    RETURN_IF_ERROR(GetDirectoryContents(src, &contents));
+    for (const auto& content : contents) {
+      RETURN_IF_ERROR(
+          MoveLocalPath(JoinPath({src, content}), JoinPath({dst, content})));
+    }
+  } else {
+    std::ifstream in(src, std::ios::in | std::ios::binary);
+    std::ofstream out(dst, std::ios::out | std::ios::binary);
+    // Inserting an empty stream sets failbit, only copy non-empty file
+    if (in && out && (in.peek() != std::ifstream::traits_type::eof())) {
+      out << in.rdbuf();
+    }
+    if (!in || !out) {
+      return Status(
+          Status::Code::INTERNAL,
+          "failed to copy file '" + src + "' to '" + dst + "'");
+    }
+  }
+  return DeletePath(src);
+}
+
 }  // namespace
 
 // FIXME: Windows support '/'? If so, the below doesn't need to change
@@ -2533,6 +2726,32 @@ GetDirectoryFiles(
   return Status::Success;
 }
 
+Status
+LocalDirectoryByteSize(const std::string& path, uint64_t* byte_size)
+{
+  *byte_size = 0;
+  std::set<std::string> contents;
+  RETURN_IF_ERROR(GetDirectoryContents(path, &contents));
+  for (const auto& content : contents) {
+    const std::string full_path = JoinPath({path, content});
+    bool is_dir = false;
+    RETURN_IF_ERROR(IsDirectory(full_path, &is_dir));
+    if (is_dir) {
+      uint64_t dir_byte_size = 0;
+      RETURN_IF_ERROR(LocalDirectoryByteSize(full_path, &dir_byte_size));
+      *byte_size += dir_byte_size;
+    } else {
+      struct stat st;
+      if (stat(full_path.c_str(), &st) != 0) {
+        return Status(
+            Status::Code::INTERNAL, "failed to stat file " + full_path);
+      }
+      *byte_size += st.st_size;
+    }
+  }
+  return Status::Success;
+}
+
 Status
 ReadTextFile(const std::string& path, std::string* contents)
 {
@@ -2563,7 +2782,50 @@ LocalizePath(const std::string& path, std::shared_ptr<LocalizedPath>* localized)
 {
   std::shared_ptr<FileSystem> fs;
   RETURN_IF_ERROR(fsm_.GetFileSystem(path, fs));
-  return fs->LocalizePath(path, localized);
+
+  FileSystemType type;
+  RETURN_IF_ERROR(GetFileSystemType(path, &type));
+  LocalizeCache* cache = GetLocalizeCache();
+  if ((type == FileSystemType::LOCAL) || (cache == nullptr)) {
+    return fs->LocalizePath(path, localized);
+  }
+
+  // Only directories with identifiable content are cached, the
+  // file system reports other cases, i.e. path doesn't exist.
+  bool exists = false;
+  bool is_dir = false;
+  RETURN_IF_ERROR(fs->FileExists(path, &exists));
+  if (exists) {
+    RETURN_IF_ERROR(fs->IsDirectory(path, &is_dir));
+  }
+  std::string fingerprint;
+  bool valid = false;
+  if (is_dir) {
+    RETURN_IF_ERROR(ContentFingerprint(fs.get(), path, &fingerprint, &valid));
+  }
+  if (!valid) {
+    return fs->LocalizePath(path, localized);
+  }
+
+  std::shared_ptr<const std::string> cached_path;
+  RETURN_IF_ERROR(cache->Get(
+      path, fingerprint,
+      [&fs, &path](const std::string& local_dir) -> Status {
+        std::shared_ptr<LocalizedPath> remote_localized;
+        RETURN_IF_ERROR(fs->LocalizePath(path, &remote_localized));
+        std::set<std::string> contents;
+        RETURN_IF_ERROR(
+            GetDirectoryContents(remote_localized->Path(), &contents));
+        for (const auto& content : contents) {
+          RETURN_IF_ERROR(MoveLocalPath(
+              JoinPath({remote_localized->Path(), content}),
+              JoinPath({local_dir, content})));
+        }
+        return Status::Success;
+      },
+      &cached_path));
+  localized->reset(new LocalizedPath(path, cached_path));
+  return Status::Success;
 }
 
 Status
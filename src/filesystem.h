@@ -32,6 +32,7 @@
 #undef GetObject
 #endif  // _WIN32
 
+#include <memory>
 #include <string>
 #include "google/protobuf/message.h"
 #include "status.h"
@@ -58,6 +59,15 @@ class LocalizedPath {
   {
   }
 
+  // Create an object for a remote path that is localized in the persistent
+  // localize cache. The cached copy is not removed on destruction.
+  LocalizedPath(
+      const std::string& original_path,
+      const std::shared_ptr<const std::string>& cached_path)
+      : original_path_(original_path), cached_path_(cached_path)
+  {
+  }
+
   // Destructor. Remove temporary local storage associated with the object.
   // If the local path is a directory, delete the directory.
   // If the local path is a file, delete the directory containing the file.
@@ -66,6 +76,9 @@ class LocalizedPath {
   // Return the localized path represented by this object.
   const std::string& Path() const
   {
+    if (cached_path_ != nullptr) {
+      return *cached_path_;
+    }
     return (local_path_.empty()) ? original_path_ : local_path_;
   }
 
@@ -77,6 +90,7 @@ class LocalizedPath {
  private:
   std::string original_path_;
   std::string local_path_;
+  std::shared_ptr<const std::string> cached_path_;
 };
 
 /// Is a path an absolute path?
@@ -143,13 +157,23 @@ Status GetDirectoryFiles(
     const std::string& path, const bool skip_hidden_files,
     std::set<std::string>* files);
 
+/// Get the total byte size of the files in a directory on the local
+/// file system and in all of its sub-directories.
+/// \param path The directory.
+/// \param byte_size Returns the total byte size.
+/// \return Error status
+Status LocalDirectoryByteSize(const std::string& path, uint64_t* byte_size);
+
 /// Read a text file into a string.
 /// \param path The path of the file.
 /// \param contents Returns the contents of the file.
 /// \return Error status
 Status ReadTextFile(const std::string& path, std::string* contents);
 
-/// Create an object representing a local copy of a path.
+/// Create an object representing a local copy of a path. If
+/// TRITON_LOCALIZE_CACHE_PATH is set, remote directories are localized into a
+/// persistent cache in that directory and reused while their content is
+/// unchanged. TRITON_LOCALIZE_CACHE_BYTE_SIZE limits the size of the cache.
 /// \param path The path of the directory or file.
 /// \param localized Returns the LocalizedPath object
 /// representing the local copy of the path.
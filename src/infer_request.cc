@@ -27,6 +27,7 @@
 #include "infer_request.h"
 
 #include <algorithm>
+#include <cstring>
 #include <deque>
 
 #include "model.h"
@@ -104,7 +105,13 @@ InferenceRequest::InferenceRequest(
     Model* model, const int64_t requested_model_version)
     : needs_normalization_(true), model_raw_(model),
       requested_model_version_(requested_model_version), flags_(0),
-      correlation_id_(0), batch_size_(0), timeout_us_(0), collect_stats_(true)
+      correlation_id_(0), batch_size_(0), timeout_us_(0),
+      original_inputs_(MetadataArenaAllocator<char>(&arena_)),
+      override_inputs_(MetadataArenaAllocator<char>(&arena_)),
+      inputs_(MetadataArenaAllocator<char>(&arena_)),
+      original_requested_outputs_(MetadataArenaAllocator<char>(&arena_)),
+      requested_outputs_(MetadataArenaAllocator<char>(&arena_)),
+      collect_stats_(true), parameters_(MetadataArenaAllocator<char>(&arena_))
 {
   SetPriority(0);
 }
@@ -283,6 +290,29 @@ InferenceRequest::Run(std::unique_ptr<InferenceRequest>& request)
   return request->model_raw_->Enqueue(request);
 }
 
+void
+InferenceRequest::RunBatch(
+    std::vector<std::unique_ptr<InferenceRequest>>& requests)
+{
+  size_t start = 0;
+  while (start < requests.size()) {
+    Model* model = requests[start]->model_raw_;
+    size_t end = start + 1;
+    while ((end < requests.size()) && (requests[end]->model_raw_ == model)) {
+      end++;
+    }
+
+    std::vector<std::unique_ptr<InferenceRequest>> model_requests;
+    model_requests.reserve(end - start);
+    for (size_t idx = start; idx < end; idx++) {
+      model_requests.emplace_back(std::move(requests[idx]));
+    }
+    model->EnqueueBatch(model_requests);
+
+    start = end;
+  }
+}
+
 void
 InferenceRequest::RespondIfError(
     std::unique_ptr<InferenceRequest>& request, const Status& status,
@@ -735,10 +765,19 @@ InferenceRequest::PrepareForInference()
 
   // Initially show the actual inputs to be only the original
   // inputs. If overrides are added later they will be added to
-  // 'inputs_'.
+  // 'inputs_'. The data of BYTES inputs is validated and indexed on
+  // every inference since it changes even when the shapes don't.
   for (auto& pr : original_inputs_) {
-    inputs_.emplace(
-        std::make_pair(pr.second.Name(), std::addressof(pr.second)));
+    auto& input = pr.second;
+    if ((input.DType() == inference::DataType::TYPE_STRING) &&
+        !input.IsShapeTensor()) {
+      const Status status = input.IndexBytesData(
+          triton::common::GetElementCount(input.ShapeWithBatchDim()));
+      if (!status.IsOk()) {
+        return Status(status.StatusCode(), LogRequest() + status.Message());
+      }
+    }
+    inputs_.emplace(std::make_pair(input.Name(), std::addressof(input)));
   }
 
   // Clear the timestamps
@@ -753,9 +792,58 @@ InferenceRequest::PrepareForInference()
   return Status::Success;
 }
 
+Status
+InferenceRequest::Reset()
+{
+  // Overrides and the actual inputs are rebuilt by the next
+  // PrepareForInference().
+  inputs_.clear();
+  override_inputs_.clear();
+  for (auto& pr : original_inputs_) {
+    RETURN_IF_ERROR(pr.second.RemoveAllData());
+  }
+
+  // The shape of a raw input is deduced from its data and a BYTES raw
+  // input gets its byte size prepended during normalization, so a raw
+  // input must always be normalized again.
+  if (!raw_input_name_.empty()) {
+    needs_normalization_ = true;
+  }
+
+  id_.clear();
+  flags_ = 0;
+  correlation_id_ = SequenceId(0);
+  SetPriority(0);
+  timeout_us_ = 0;
+  cache_key_.clear();
+  cache_key_is_set_ = false;
+  parameters_.clear();
+
+  release_fn_ = nullptr;
+  release_userp_ = nullptr;
+  release_callbacks_.clear();
+  response_delegator_ = nullptr;
+  response_factory_.reset();
+  sequence_states_.reset();
+
+#ifdef TRITON_ENABLE_STATS
+  secondary_stats_aggregator_ = nullptr;
+#endif  // TRITON_ENABLE_STATS
+#ifdef TRITON_ENABLE_TRACING
+  trace_ = nullptr;
+#endif  // TRITON_ENABLE_TRACING
+
+  return Status::Success;
+}
+
 Status
 InferenceRequest::Normalize()
 {
+  // Capture the cache generation before reading the configuration so
+  // that a result derived from a configuration that is replaced while
+  // normalizing is not cached.
+  const uint64_t cache_generation =
+      model_raw_->MutableNormalizeCache()->Generation();
   const inference::ModelConfig& model_config = model_raw_->Config();
 
   // Fill metadata for raw input
@@ -833,6 +921,34 @@ InferenceRequest::Normalize()
     raw_input.SetMetadata(config_input.name(), config_input.data_type(), shape);
   }
 
+  // A request with the same inputs and requested outputs as one that
+  // was already normalized for the model reuses that result. Raw
+  // inputs are deduced from their data and so are never cached.
+  std::vector<std::pair<const std::string*, Input*>> sorted_inputs;
+  std::string signature;
+  std::shared_ptr<const NormalizeCache::Entry> cached;
+  if (raw_input_name_.empty()) {
+    sorted_inputs.reserve(original_inputs_.size());
+    for (auto& pr : original_inputs_) {
+      sorted_inputs.emplace_back(&pr.first, &pr.second);
+    }
+    std::sort(
+        sorted_inputs.begin(), sorted_inputs.end(),
+        [](const std::pair<const std::string*, Input*>& a,
+           const std::pair<const std::string*, Input*>& b) {
+          return *a.first < *b.first;
+        });
+    for (const auto& pr : sorted_inputs) {
+      NormalizeCache::AppendInputSignature(
+          *pr.first, pr.second->DType(), pr.second->OriginalShape(),
+          &signature);
+    }
+    for (const auto& output_name : original_requested_outputs_) {
+      NormalizeCache::AppendOutputSignature(output_name, &signature);
+    }
+    cached = model_raw_->MutableNormalizeCache()->Lookup(signature);
+  }
+
   // Initialize the requested outputs to be used during inference. If
   // original_requested_outputs_ is empty assume all outputs specified
   // in model config are being requested.
@@ -841,7 +957,7 @@ InferenceRequest::Normalize()
     for (const auto& output : model_config.output()) {
       requested_outputs_.insert(output.name());
     }
-  } else {
+  } else if (cached == nullptr) {
     // Validate if the original requested output name exists in the
     // model configuration.
     for (const auto& output_name : original_requested_outputs_) {
@@ -849,6 +965,21 @@ InferenceRequest::Normalize()
       RETURN_IF_ERROR(model_raw_->GetOutput(output_name, &output_config));
     }
   }
+  if (cached != nullptr) {
+    batch_size_ = cached->batch_size_;
+    for (size_t idx = 0; idx < sorted_inputs.size(); idx++) {
+      const auto& cached_input = cached->inputs_[idx];
+      auto& input = *sorted_inputs[idx].second;
+      *input.MutableShape() = cached_input.shape_;
+      *input.MutableShapeWithBatchDim() = cached_input.shape_with_batch_dim_;
+      if (cached_input.is_shape_tensor_) {
+        input.SetIsShapeTensor(true);
+      }
+    }
+
+    return Status::Success;
+  }
+
   // Make sure that the request is providing the number of inputs
   // as is expected by the model.
   if ((original_inputs_.size() > (size_t)model_config.input_size()) ||
@@ -1042,6 +1173,20 @@ InferenceRequest::Normalize()
     }
   }
 
+  if (!sorted_inputs.empty()) {
+    std::shared_ptr<NormalizeCache::Entry> entry =
+        std::make_shared<NormalizeCache::Entry>();
+    entry->batch_size_ = batch_size_;
+    entry->inputs_.reserve(sorted_inputs.size());
+    for (const auto& pr : sorted_inputs) {
+      const Input& input = *pr.second;
+      entry->inputs_.emplace_back(NormalizeCache::Input{
+          input.Shape(), input.ShapeWithBatchDim(), input.IsShapeTensor()});
+    }
+    model_raw_->MutableNormalizeCache()->Insert(
+        signature, cache_generation, std::move(entry));
+  }
+
   return Status::Success;
 }
 
@@ -1158,7 +1303,7 @@ InferenceRequest::ReportStatisticsCacheHit(MetricModelReporter* metric_reporter)
 // Input
 //
 InferenceRequest::Input::Input()
-    : is_shape_tensor_(false), data_(new MemoryReference),
+    : is_shape_tensor_(false), data_(std::make_shared<MemoryReference>()),
       has_host_policy_specific_data_(false)
 {
 }
@@ -1168,7 +1313,8 @@ InferenceRequest::Input::Input(
     const int64_t* shape, const uint64_t dim_count)
     : name_(name), datatype_(datatype),
       original_shape_(shape, shape + dim_count), is_shape_tensor_(false),
-      data_(new MemoryReference), has_host_policy_specific_data_(false)
+      data_(std::make_shared<MemoryReference>()),
+      has_host_policy_specific_data_(false)
 {
 }
 
@@ -1176,7 +1322,7 @@ InferenceRequest::Input::Input(
     const std::string& name, const inference::DataType datatype,
     const std::vector<int64_t>& shape)
     : name_(name), datatype_(datatype), original_shape_(shape),
-      is_shape_tensor_(false), data_(new MemoryReference),
+      is_shape_tensor_(false), data_(std::make_shared<MemoryReference>()),
       has_host_policy_specific_data_(false)
 {
 }
@@ -1306,6 +1452,90 @@ InferenceRequest::Input::RemoveAllData()
   data_ = std::make_shared<MemoryReference>();
   host_policy_data_map_.clear();
   has_host_policy_specific_data_ = false;
+  bytes_offsets_.clear();
+  return Status::Success;
+}
+
+Status
+InferenceRequest::Input::IndexBytesData(const int64_t element_count)
+{
+  bytes_offsets_.clear();
+  for (size_t idx = 0; idx < data_->BufferCount(); idx++) {
+    size_t byte_size;
+    TRITONSERVER_MemoryType memory_type;
+    int64_t memory_type_id;
+    data_->BufferAt(idx, &byte_size, &memory_type, &memory_type_id);
+    if (memory_type == TRITONSERVER_MEMORY_GPU) {
+      return Status::Success;
+    }
+  }
+
+  bytes_offsets_.reserve(element_count + 1);
+
+  // The start of each element depends on the length of the previous
+  // one so the scan is a single pass over the length prefixes, only
+  // touching the 4 bytes of each prefix and not the element data. A
+  // prefix that straddles two buffers is assembled in 'prefix'.
+  char prefix[sizeof(uint32_t)];
+  size_t prefix_filled = 0;
+  uint64_t buffer_start = 0;
+  uint64_t next = 0;
+  for (size_t idx = 0; idx < data_->BufferCount(); idx++) {
+    size_t byte_size;
+    TRITONSERVER_MemoryType memory_type;
+    int64_t memory_type_id;
+    const char* base =
+        data_->BufferAt(idx, &byte_size, &memory_type, &memory_type_id);
+    const uint64_t buffer_end = buffer_start + byte_size;
+
+    while (next < buffer_end) {
+      uint32_t len;
+      if ((prefix_filled == 0) && ((next + sizeof(uint32_t)) <= buffer_end)) {
+        memcpy(&len, base + (next - buffer_start), sizeof(uint32_t));
+      } else {
+        const uint64_t copy_start = next + prefix_filled;
+        const size_t copy_size = std::min(
+            sizeof(uint32_t) - prefix_filled,
+            static_cast<size_t>(buffer_end - copy_start));
+        memcpy(
+            prefix + prefix_filled, base + (copy_start - buffer_start),
+            copy_size);
+        prefix_filled += copy_size;
+        if (prefix_filled < sizeof(uint32_t)) {
+          break;
+        }
+        prefix_filled = 0;
+        memcpy(&len, prefix, sizeof(uint32_t));
+      }
+
+      if (bytes_offsets_.size() == static_cast<size_t>(element_count)) {
+        bytes_offsets_.clear();
+        return Status(
+            Status::Code::INVALID_ARG,
+            "input '" + name_ + "' BYTES data holds more than the expected " +
+                std::to_string(element_count) + " elements");
+      }
+      bytes_offsets_.push_back(next);
+      next += sizeof(uint32_t) + len;
+    }
+
+    buffer_start = buffer_end;
+  }
+
+  if ((prefix_filled != 0) || (next != buffer_start) ||
+      (bytes_offsets_.size() != static_cast<size_t>(element_count))) {
+    const size_t found = bytes_offsets_.size();
+    bytes_offsets_.clear();
+    return Status(
+        Status::Code::INVALID_ARG,
+        "input '" + name_ + "' BYTES data is malformed, expected " +
+            std::to_string(element_count) + " elements in " +
+            std::to_string(buffer_start) + " bytes but found " +
+            std::to_string(found) + " elements" +
+            ((next != buffer_start) ? " with a truncated last element" : ""));
+  }
+
+  bytes_offsets_.push_back(next);
   return Status::Success;
 }
 
@@ -34,6 +34,7 @@
 #include "infer_stats.h"
 #include "infer_trace.h"
 #include "memory.h"
+#include "metadata_arena.h"
 #include "response_allocator.h"
 #include "sequence_state.h"
 #include "status.h"
@@ -159,6 +160,18 @@ class InferenceRequest {
     // Remove all existing data for the input.
     Status RemoveAllData();
 
+    // Validate that the data of a BYTES input holds exactly
+    // 'element_count' length-prefixed elements and record the offset
+    // of each element. Data that is not in host memory is not
+    // validated or indexed.
+    Status IndexBytesData(const int64_t element_count);
+
+    // The offsets of the elements of a BYTES input within the
+    // concatenation of its data buffers. Element 'i' starts with its
+    // 4-byte length at offset 'i' and the last offset is the total
+    // byte size of the data. Empty if the input has not been indexed.
+    const std::vector<uint64_t>& BytesOffsets() const { return bytes_offsets_; }
+
     // Get the number of buffers containing the input tensor data.
     size_t DataBufferCount() const { return data_->BufferCount(); }
 
@@ -219,6 +232,7 @@ class InferenceRequest {
     std::vector<int64_t> shape_with_batch_dim_;
     bool is_shape_tensor_;
     std::shared_ptr<Memory> data_;
+    std::vector<uint64_t> bytes_offsets_;
 
     bool has_host_policy_specific_data_;
     // A map of host policy to input data memory
@@ -260,6 +274,17 @@ class InferenceRequest {
     DataType id_type_;
   };
 
+  // The containers holding the request metadata, allocated from the
+  // request's metadata arena.
+  template <typename T>
+  using InputMap = std::unordered_map<
+      std::string, T, std::hash<std::string>, std::equal_to<std::string>,
+      MetadataArenaAllocator<std::pair<const std::string, T>>>;
+  using OutputSet = std::set<
+      std::string, std::less<std::string>, MetadataArenaAllocator<std::string>>;
+  using ParameterDeque = std::deque<
+      InferenceParameter, MetadataArenaAllocator<InferenceParameter>>;
+
   // InferenceRequest
   //
   // The two constructors are identical except one takes model as a
@@ -343,10 +368,7 @@ class InferenceRequest {
   Status AddParameter(const char* name, const char* value);
   Status AddParameter(const char* name, const int64_t value);
   Status AddParameter(const char* name, const bool value);
-  const std::deque<InferenceParameter>& Parameters() const
-  {
-    return parameters_;
-  }
+  const ParameterDeque& Parameters() const { return parameters_; }
 
 
   // The original inputs are the inputs added to the request before
@@ -356,14 +378,8 @@ class InferenceRequest {
   // execution completes (and those modifications will apply to the
   // next inference execution).
   Status MutableOriginalInput(const std::string& name, Input** input);
-  std::unordered_map<std::string, Input>* MutableOriginalInputs()
-  {
-    return &original_inputs_;
-  }
-  const std::unordered_map<std::string, Input>& OriginalInputs() const
-  {
-    return original_inputs_;
-  }
+  InputMap<Input>* MutableOriginalInputs() { return &original_inputs_; }
+  const InputMap<Input>& OriginalInputs() const { return original_inputs_; }
 
   // The override inputs are the inputs added to the request after
   // inference execution has started (that is after
@@ -378,13 +394,11 @@ class InferenceRequest {
   // change to be reflected in all requests that hold that override
   // input. Override inputs within a specific request are not
   // persisted across inference calls.
-  std::unordered_map<std::string, std::shared_ptr<Input>>*
-  MutableOverrideInputs()
+  InputMap<std::shared_ptr<Input>>* MutableOverrideInputs()
   {
     return &override_inputs_;
   }
-  const std::unordered_map<std::string, std::shared_ptr<Input>>&
-  OverrideInputs() const
+  const InputMap<std::shared_ptr<Input>>& OverrideInputs() const
   {
     return override_inputs_;
   }
@@ -394,10 +408,7 @@ class InferenceRequest {
   // use the original input. Accessing inputs via this method is not
   // valid until after PrepareForInference is called.
   Status ImmutableInput(const std::string& name, const Input** input) const;
-  const std::unordered_map<std::string, Input*>& ImmutableInputs() const
-  {
-    return inputs_;
-  }
+  const InputMap<Input*>& ImmutableInputs() const { return inputs_; }
 
   // The original requested outputs are the requested outputs added to
   // the request before the inference execution (that is before
@@ -405,7 +416,7 @@ class InferenceRequest {
   // started the original requested outputs should not be modified
   // until execution completes (and those modifications will apply to
   // the next inference execution).
-  const std::set<std::string>& OriginalRequestedOutputs() const
+  const OutputSet& OriginalRequestedOutputs() const
   {
     return original_requested_outputs_;
   }
@@ -413,7 +424,7 @@ class InferenceRequest {
   // Get the requested outputs that should be used during
   // inference. Accessing outputs via this method is not valid until
   // after PrepareForInference is called.
-  const std::set<std::string>& ImmutableRequestedOutputs() const
+  const OutputSet& ImmutableRequestedOutputs() const
   {
     return (requested_outputs_.empty()) ? original_requested_outputs_
                                         : requested_outputs_;
@@ -464,6 +475,9 @@ class InferenceRequest {
   Status RemoveOriginalRequestedOutput(const std::string& name);
   Status RemoveAllOriginalRequestedOutputs();
 
+  // Return true if a release callback is set for the request.
+  bool HasReleaseCallback() const { return release_fn_ != nullptr; }
+
   // Initialize the release callback for the request.
   Status SetReleaseCallback(
       TRITONSERVER_InferenceRequestReleaseFn_t release_fn, void* release_userp)
@@ -486,6 +500,23 @@ class InferenceRequest {
     return Status::Success;
   }
 
+  // Initialize the response factory so that the responses to this
+  // request are delivered in batches to 'response_fn'.
+  Status SetResponseBatchCallback(
+      const ResponseAllocator* allocator, void* alloc_userp,
+      TRITONSERVER_InferenceResponseBatchCompleteFn_t response_fn,
+      void* response_userp, const uint32_t max_batch_count,
+      const uint64_t max_delay_us)
+  {
+    response_factory_.reset(new InferenceResponseFactory(
+        model_shared_, id_, allocator, alloc_userp,
+        nullptr /* response_fn */, nullptr /* response_userp */,
+        response_delegator_,
+        std::make_shared<ResponseBatcher>(
+            response_fn, response_userp, max_batch_count, max_delay_us)));
+    return Status::Success;
+  }
+
   // Returns the preferred memory type and memory type ID of the output buffer
   // for the request. 'name' and 'byte_size' are optional and set to nullptr
   // if not specified, if provided, they give the allocator more information.
@@ -534,6 +565,13 @@ class InferenceRequest {
   // Prepare this request for inference.
   Status PrepareForInference();
 
+  // Reset this request for reuse in another inference. The original
+  // inputs and requested outputs, and so the result of the last
+  // normalization, are kept. Input data, ID, correlation ID, flags,
+  // priority, timeout, parameters, callbacks and sequence states are
+  // cleared. Must not be called while the request is in flight.
+  Status Reset();
+
   // Run this inference request using the model associated with the
   // request. If Status::Success is returned then the call has taken
   // ownership of the request object and so 'request' will be
@@ -541,6 +579,14 @@ class InferenceRequest {
   // ownership of 'request'.
   static Status Run(std::unique_ptr<InferenceRequest>& request);
 
+  // Run a batch of inference requests, each using the model associated
+  // with that request. Consecutive requests for the same model are
+  // submitted to the model together. This call always takes ownership
+  // of all 'requests', a request that cannot be run is completed with
+  // an error response and released.
+  static void RunBatch(
+      std::vector<std::unique_ptr<InferenceRequest>>& requests);
+
   // Send an error response for this request. If 'status' is Success
   // then no response is sent and the request is not released (even if
   // 'release_request' is true). Because this is sending an error it
@@ -698,21 +744,25 @@ class InferenceRequest {
   // and cache_key_ field is valid
   bool cache_key_is_set_ = false;
 
-  std::unordered_map<std::string, Input> original_inputs_;
-  std::unordered_map<std::string, std::shared_ptr<Input>> override_inputs_;
-  std::unordered_map<std::string, Input*> inputs_;
-  std::set<std::string> original_requested_outputs_;
+  // Arena for the request metadata below. Must be declared before
+  // the containers using it so that it outlives them.
+  MetadataArena arena_;
+
+  InputMap<Input> original_inputs_;
+  InputMap<std::shared_ptr<Input>> override_inputs_;
+  InputMap<Input*> inputs_;
+  OutputSet original_requested_outputs_;
   std::string raw_input_name_;
   uint32_t raw_input_size_;
 
   // requested_outputs_ is to be used post-normalization. It will be
   // empty unless it differs from original_requested_outputs_, so
   // typically should access it through ImmutableRequestedOutputs.
-  std::set<std::string> requested_outputs_;
+  OutputSet requested_outputs_;
 
   // The release function and user pointer for this request.
-  TRITONSERVER_InferenceRequestReleaseFn_t release_fn_;
-  void* release_userp_;
+  TRITONSERVER_InferenceRequestReleaseFn_t release_fn_ = nullptr;
+  void* release_userp_ = nullptr;
 
   // Additional release callbacks invoked before 'release_fn_'.
   std::vector<std::function<void()>> release_callbacks_;
@@ -748,7 +798,7 @@ class InferenceRequest {
 
   // The parameters of the request. Use a deque so that there is no
   // reallocation.
-  std::deque<InferenceParameter> parameters_;
+  ParameterDeque parameters_;
 
 #ifdef TRITON_ENABLE_STATS
   uint64_t request_start_ns_;
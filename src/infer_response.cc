@@ -42,7 +42,7 @@ InferenceResponseFactory::CreateResponse(
 {
   response->reset(new InferenceResponse(
       model_, id_, allocator_, alloc_userp_, response_fn_, response_userp_,
-      response_delegator_));
+      response_delegator_, batcher_));
 #ifdef TRITON_ENABLE_TRACING
   (*response)->SetTrace(trace_);
 #endif  // TRITON_ENABLE_TRACING
@@ -54,8 +54,10 @@ InferenceResponseFactory::SendFlags(const uint32_t flags) const
 {
   if (response_delegator_ != nullptr) {
     std::unique_ptr<InferenceResponse> response(
-        new InferenceResponse(response_fn_, response_userp_));
+        new InferenceResponse(response_fn_, response_userp_, batcher_));
     response_delegator_(std::move(response), flags);
+  } else if (batcher_ != nullptr) {
+    batcher_->Send(nullptr /* response */, flags);
   } else {
     void* userp = response_userp_;
     response_fn_(nullptr /* response */, flags, userp);
@@ -72,10 +74,14 @@ InferenceResponse::InferenceResponse(
     TRITONSERVER_InferenceResponseCompleteFn_t response_fn,
     void* response_userp,
     const std::function<
-        void(std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator)
-    : model_(model), id_(id), allocator_(allocator), alloc_userp_(alloc_userp),
-      response_fn_(response_fn), response_userp_(response_userp),
-      response_delegator_(delegator), null_response_(false)
+        void(std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator,
+    const std::shared_ptr<ResponseBatcher>& batcher)
+    : model_(model), id_(id),
+      parameters_(MetadataArenaAllocator<char>(&arena_)),
+      outputs_(MetadataArenaAllocator<char>(&arena_)), allocator_(allocator),
+      alloc_userp_(alloc_userp), response_fn_(response_fn),
+      response_userp_(response_userp), response_delegator_(delegator),
+      batcher_(batcher), null_response_(false)
 {
   // If the allocator has a start_fn then invoke it.
   TRITONSERVER_ResponseAllocatorStartFn_t start_fn = allocator_->StartFn();
@@ -91,9 +97,11 @@ InferenceResponse::InferenceResponse(
 
 InferenceResponse::InferenceResponse(
     TRITONSERVER_InferenceResponseCompleteFn_t response_fn,
-    void* response_userp)
-    : response_fn_(response_fn), response_userp_(response_userp),
-      null_response_(true)
+    void* response_userp, const std::shared_ptr<ResponseBatcher>& batcher)
+    : parameters_(MetadataArenaAllocator<char>(&arena_)),
+      outputs_(MetadataArenaAllocator<char>(&arena_)),
+      response_fn_(response_fn), response_userp_(response_userp),
+      batcher_(batcher), null_response_(true)
 {
 }
 
@@ -212,6 +220,18 @@ InferenceResponse::Send(
     ldelegator(std::move(response), flags);
     return Status::Success;
   }
+  if (response->batcher_ != nullptr) {
+    // The batcher must not be kept alive by the responses it holds.
+    std::shared_ptr<ResponseBatcher> batcher = std::move(response->batcher_);
+    if (response->null_response_) {
+      batcher->Send(nullptr /* response */, flags);
+    } else {
+      batcher->Send(
+          reinterpret_cast<TRITONSERVER_InferenceResponse*>(response.release()),
+          flags);
+    }
+    return Status::Success;
+  }
   void* userp = response->response_userp_;
   if (response->null_response_) {
     response->response_fn_(nullptr /* response */, flags, userp);
@@ -33,7 +33,9 @@
 #include "constants.h"
 #include "infer_parameter.h"
 #include "infer_trace.h"
+#include "metadata_arena.h"
 #include "response_allocator.h"
+#include "response_batcher.h"
 #include "status.h"
 #include "triton/common/model_config.h"
 #include "tritonserver_apis.h"
@@ -55,10 +57,12 @@ class InferenceResponseFactory {
       TRITONSERVER_InferenceResponseCompleteFn_t response_fn,
       void* response_userp,
       const std::function<void(
-          std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator)
+          std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator,
+      const std::shared_ptr<ResponseBatcher>& batcher = nullptr)
       : model_(model), id_(id), allocator_(allocator),
         alloc_userp_(alloc_userp), response_fn_(response_fn),
-        response_userp_(response_userp), response_delegator_(delegator)
+        response_userp_(response_userp), response_delegator_(delegator),
+        batcher_(batcher)
   {
   }
 
@@ -117,6 +121,9 @@ class InferenceResponseFactory {
   std::function<void(std::unique_ptr<InferenceResponse>&&, const uint32_t)>
       response_delegator_;
 
+  // If set, responses are gathered by 'batcher_' and delivered in
+  // batches instead of through 'response_fn_'.
+  std::shared_ptr<ResponseBatcher> batcher_;
 
 #ifdef TRITON_ENABLE_TRACING
   // Inference trace associated with this response.
@@ -219,6 +226,12 @@ class InferenceResponse {
     void* allocated_userp_;
   };
 
+  // The containers holding the response metadata, allocated from the
+  // response's metadata arena.
+  using ParameterDeque = std::deque<
+      InferenceParameter, MetadataArenaAllocator<InferenceParameter>>;
+  using OutputDeque = std::deque<Output, MetadataArenaAllocator<Output>>;
+
   // InferenceResponse
   InferenceResponse(
       const std::shared_ptr<Model>& model, const std::string& id,
@@ -226,7 +239,8 @@ class InferenceResponse {
       TRITONSERVER_InferenceResponseCompleteFn_t response_fn,
       void* response_userp,
       const std::function<void(
-          std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator);
+          std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator,
+      const std::shared_ptr<ResponseBatcher>& batcher = nullptr);
 
   // "null" InferenceResponse is a special instance of InferenceResponse which
   // contains minimal information for calling InferenceResponse::Send,
@@ -234,7 +248,8 @@ class InferenceResponse {
   // 'response_fn'.
   InferenceResponse(
       TRITONSERVER_InferenceResponseCompleteFn_t response_fn,
-      void* response_userp);
+      void* response_userp,
+      const std::shared_ptr<ResponseBatcher>& batcher = nullptr);
 
   const std::string& Id() const { return id_; }
   const std::string& ModelName() const;
@@ -242,10 +257,7 @@ class InferenceResponse {
   const Status& ResponseStatus() const { return status_; }
 
   // The response parameters.
-  const std::deque<InferenceParameter>& Parameters() const
-  {
-    return parameters_;
-  }
+  const ParameterDeque& Parameters() const { return parameters_; }
 
   // Add an parameter to the response.
   Status AddParameter(const char* name, const char* value);
@@ -253,7 +265,7 @@ class InferenceResponse {
   Status AddParameter(const char* name, const bool value);
 
   // The response outputs.
-  const std::deque<Output>& Outputs() const { return outputs_; }
+  const OutputDeque& Outputs() const { return outputs_; }
 
   // Add an output to the response. If 'output' is non-null
   // return a pointer to the newly added output.
@@ -317,12 +329,16 @@ class InferenceResponse {
   // Error status for the response.
   Status status_;
 
+  // Arena for the response metadata below. Must be declared before
+  // the containers using it so that it outlives them.
+  MetadataArena arena_;
+
   // The parameters of the response. Use a deque so that there is no
   // reallocation.
-  std::deque<InferenceParameter> parameters_;
+  ParameterDeque parameters_;
 
   // The result tensors. Use a deque so that there is no reallocation.
-  std::deque<Output> outputs_;
+  OutputDeque outputs_;
 
   // The response allocator and user pointer.
   const ResponseAllocator* allocator_;
@@ -336,6 +352,9 @@ class InferenceResponse {
   std::function<void(std::unique_ptr<InferenceResponse>&&, const uint32_t)>
       response_delegator_;
 
+  // The batcher that delivers this response, if any.
+  std::shared_ptr<ResponseBatcher> batcher_;
+
   bool null_response_;
 
 #ifdef TRITON_ENABLE_TRACING
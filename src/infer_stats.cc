@@ -27,6 +27,8 @@
 #include "infer_stats.h"
 
 #include <time.h>
+#include <algorithm>
+#include <atomic>
 #include "metric_model_reporter.h"
 #include "metrics.h"
 #include "triton/common/logging.h"
@@ -35,15 +37,101 @@ namespace triton { namespace core {
 
 #ifdef TRITON_ENABLE_STATS
 
+namespace {
+
+// Upper bound on the default number of shards of an aggregator.
+constexpr size_t kMaxDefaultShardCount = 32;
+
+// Return a small, stable index for the calling thread. Indices are
+// handed out in the order threads first record statistics so that
+// threads spread evenly across the shards of an aggregator.
+size_t
+ThreadShardIndex()
+{
+  static std::atomic<size_t> next_index(0);
+  thread_local size_t index = next_index++;
+  return index;
+}
+
+}  // namespace
+
+size_t
+InferenceStatsAggregator::DefaultShardCount()
+{
+  const size_t concurrency = std::thread::hardware_concurrency();
+  return std::max<size_t>(
+      1, std::min<size_t>(concurrency, kMaxDefaultShardCount));
+}
+
+InferenceStatsAggregator::InferenceStatsAggregator(const size_t shard_count)
+    : shard_count_(std::max<size_t>(1, shard_count)),
+      shards_(new Shard[std::max<size_t>(1, shard_count)])
+{
+}
+
+InferenceStatsAggregator::Shard&
+InferenceStatsAggregator::LocalShard()
+{
+  if (shard_count_ == 1) {
+    return shards_[0];
+  }
+  return shards_[ThreadShardIndex() % shard_count_];
+}
+
+InferenceStatsAggregator::Snapshot
+InferenceStatsAggregator::MergedSnapshot() const
+{
+  Snapshot snapshot;
+  for (size_t i = 0; i < shard_count_; ++i) {
+    Shard& shard = shards_[i];
+    std::lock_guard<std::mutex> lock(shard.mu_);
+    snapshot.last_inference_ms_ =
+        std::max(snapshot.last_inference_ms_, shard.last_inference_ms_);
+    snapshot.inference_count_ += shard.inference_count_;
+    snapshot.execution_count_ += shard.execution_count_;
+
+    InferStats& merged = snapshot.infer_stats_;
+    const InferStats& stats = shard.infer_stats_;
+    merged.failure_count_ += stats.failure_count_;
+    merged.failure_duration_ns_ += stats.failure_duration_ns_;
+    merged.success_count_ += stats.success_count_;
+    merged.request_duration_ns_ += stats.request_duration_ns_;
+    merged.queue_duration_ns_ += stats.queue_duration_ns_;
+    merged.compute_input_duration_ns_ += stats.compute_input_duration_ns_;
+    merged.compute_infer_duration_ns_ += stats.compute_infer_duration_ns_;
+    merged.compute_output_duration_ns_ += stats.compute_output_duration_ns_;
+    merged.cache_hit_count_ += stats.cache_hit_count_;
+    merged.cache_hit_duration_ns_ += stats.cache_hit_duration_ns_;
+    merged.cache_miss_count_ += stats.cache_miss_count_;
+    merged.cache_miss_duration_ns_ += stats.cache_miss_duration_ns_;
+
+    for (const auto& batch : shard.batch_stats_) {
+      InferBatchStats& merged_batch = snapshot.batch_stats_[batch.first];
+      merged_batch.count_ += batch.second.count_;
+      merged_batch.compute_input_duration_ns_ +=
+          batch.second.compute_input_duration_ns_;
+      merged_batch.compute_infer_duration_ns_ +=
+          batch.second.compute_infer_duration_ns_;
+      merged_batch.compute_output_duration_ns_ +=
+          batch.second.compute_output_duration_ns_;
+    }
+  }
+
+  return snapshot;
+}
+
 void
 InferenceStatsAggregator::UpdateFailure(
     MetricModelReporter* metric_reporter, const uint64_t request_start_ns,
     const uint64_t request_end_ns)
 {
-  std::lock_guard<std::mutex> lock(mu_);
-
-  infer_stats_.failure_count_++;
-  infer_stats_.failure_duration_ns_ += (request_end_ns - request_start_ns);
+  Shard& shard = LocalShard();
+  {
+    std::lock_guard<std::mutex> lock(shard.mu_);
+    shard.infer_stats_.failure_count_++;
+    shard.infer_stats_.failure_duration_ns_ +=
+        (request_end_ns - request_start_ns);
+  }
 
 #ifdef TRITON_ENABLE_METRICS
   if (metric_reporter != nullptr) {
@@ -84,16 +172,20 @@ InferenceStatsAggregator::UpdateSuccessWithDuration(
   const uint64_t request_duration_ns = request_end_ns - request_start_ns;
   const uint64_t queue_duration_ns = compute_start_ns - queue_start_ns;
 
-  std::lock_guard<std::mutex> lock(mu_);
+  Shard& shard = LocalShard();
+  {
+    std::lock_guard<std::mutex> lock(shard.mu_);
 
-  inference_count_ += batch_size;
+    shard.inference_count_ += batch_size;
 
-  infer_stats_.success_count_++;
-  infer_stats_.request_duration_ns_ += request_duration_ns;
-  infer_stats_.queue_duration_ns_ += queue_duration_ns;
-  infer_stats_.compute_input_duration_ns_ += compute_input_duration_ns;
-  infer_stats_.compute_infer_duration_ns_ += compute_infer_duration_ns;
-  infer_stats_.compute_output_duration_ns_ += compute_output_duration_ns;
+    InferStats& stats = shard.infer_stats_;
+    stats.success_count_++;
+    stats.request_duration_ns_ += request_duration_ns;
+    stats.queue_duration_ns_ += queue_duration_ns;
+    stats.compute_input_duration_ns_ += compute_input_duration_ns;
+    stats.compute_infer_duration_ns_ += compute_infer_duration_ns;
+    stats.compute_output_duration_ns_ += compute_output_duration_ns;
+  }
 
 #ifdef TRITON_ENABLE_METRICS
   if (metric_reporter != nullptr) {
@@ -124,6 +216,17 @@ InferenceStatsAggregator::UpdateSuccessWithDuration(
         "compute_infer_duration", compute_infer_duration_ns / 1000);
     metric_reporter->ObserveSummary(
         "compute_output_duration", compute_output_duration_ns / 1000);
+    // Histogram Latencies, request histogram only exists without cache
+    metric_reporter->ObserveHistogram(
+        "request_duration", request_duration_ns / 1000);
+    metric_reporter->ObserveHistogram(
+        "queue_duration", queue_duration_ns / 1000);
+    metric_reporter->ObserveHistogram(
+        "compute_input_duration", compute_input_duration_ns / 1000);
+    metric_reporter->ObserveHistogram(
+        "compute_infer_duration", compute_infer_duration_ns / 1000);
+    metric_reporter->ObserveHistogram(
+        "compute_output_duration", compute_output_duration_ns / 1000);
   }
 #endif  // TRITON_ENABLE_METRICS
 }
@@ -141,13 +244,17 @@ InferenceStatsAggregator::UpdateSuccessCacheHit(
   const uint64_t request_duration_ns = request_end_ns - request_start_ns;
   const uint64_t queue_duration_ns = cache_lookup_start_ns - queue_start_ns;
 
-  std::lock_guard<std::mutex> lock(mu_);
+  Shard& shard = LocalShard();
+  {
+    std::lock_guard<std::mutex> lock(shard.mu_);
 
-  infer_stats_.success_count_++;
-  infer_stats_.request_duration_ns_ += request_duration_ns;
-  infer_stats_.queue_duration_ns_ += queue_duration_ns;
-  infer_stats_.cache_hit_count_++;
-  infer_stats_.cache_hit_duration_ns_ += cache_hit_duration_ns;
+    InferStats& stats = shard.infer_stats_;
+    stats.success_count_++;
+    stats.request_duration_ns_ += request_duration_ns;
+    stats.queue_duration_ns_ += queue_duration_ns;
+    stats.cache_hit_count_++;
+    stats.cache_hit_duration_ns_ += cache_hit_duration_ns;
+  }
 
 #ifdef TRITON_ENABLE_METRICS
   if (metric_reporter != nullptr) {
@@ -168,6 +275,11 @@ InferenceStatsAggregator::UpdateSuccessCacheHit(
     metric_reporter->ObserveSummary("queue_duration", queue_duration_ns / 1000);
     metric_reporter->ObserveSummary(
         "cache_hit_duration", cache_hit_duration_ns / 1000);
+    // Histogram Latencies
+    metric_reporter->ObserveHistogram(
+        "queue_duration", queue_duration_ns / 1000);
+    metric_reporter->ObserveHistogram(
+        "cache_hit_duration", cache_hit_duration_ns / 1000);
   }
 #endif  // TRITON_ENABLE_METRICS
 }
@@ -180,11 +292,15 @@ void
 InferenceStatsAggregator::UpdateSuccessCacheMiss(
     MetricModelReporter* metric_reporter, const uint64_t cache_miss_duration_ns)
 {
-  std::lock_guard<std::mutex> lock(mu_);
+  Shard& shard = LocalShard();
+  {
+    std::lock_guard<std::mutex> lock(shard.mu_);
 
-  infer_stats_.request_duration_ns_ += cache_miss_duration_ns;
-  infer_stats_.cache_miss_count_++;
-  infer_stats_.cache_miss_duration_ns_ += cache_miss_duration_ns;
+    InferStats& stats = shard.infer_stats_;
+    stats.request_duration_ns_ += cache_miss_duration_ns;
+    stats.cache_miss_count_++;
+    stats.cache_miss_duration_ns_ += cache_miss_duration_ns;
+  }
 
 #ifdef TRITON_ENABLE_METRICS
   if (metric_reporter != nullptr) {
@@ -205,6 +321,8 @@ InferenceStatsAggregator::UpdateSuccessCacheMiss(
     //    "request_duration", cache_miss_duration_ns / 1000);
     metric_reporter->ObserveSummary(
         "cache_miss_duration", cache_miss_duration_ns / 1000);
+    metric_reporter->ObserveHistogram(
+        "cache_miss_duration", cache_miss_duration_ns / 1000);
   }
 #endif  // TRITON_ENABLE_METRICS
 }
@@ -236,30 +354,52 @@ InferenceStatsAggregator::UpdateInferBatchStatsWithDuration(
           std::chrono::system_clock::now().time_since_epoch())
           .count();
 
-  std::lock_guard<std::mutex> lock(mu_);
+  Shard& shard = LocalShard();
+  {
+    std::lock_guard<std::mutex> lock(shard.mu_);
 
-  if (inference_ms > last_inference_ms_) {
-    last_inference_ms_ = inference_ms;
-  }
+    if (inference_ms > shard.last_inference_ms_) {
+      shard.last_inference_ms_ = inference_ms;
+    }
 
-  execution_count_++;
+    shard.execution_count_++;
 
-  auto it = batch_stats_.find(batch_size);
-  if (it == batch_stats_.end()) {
-    it = batch_stats_.emplace(batch_size, InferBatchStats()).first;
+    auto it = shard.batch_stats_.find(batch_size);
+    if (it == shard.batch_stats_.end()) {
+      it = shard.batch_stats_.emplace(batch_size, InferBatchStats()).first;
+    }
+    it->second.count_++;
+    it->second.compute_input_duration_ns_ += compute_input_duration_ns;
+    it->second.compute_infer_duration_ns_ += compute_infer_duration_ns;
+    it->second.compute_output_duration_ns_ += compute_output_duration_ns;
   }
-  it->second.count_++;
-  it->second.compute_input_duration_ns_ += compute_input_duration_ns;
-  it->second.compute_infer_duration_ns_ += compute_infer_duration_ns;
-  it->second.compute_output_duration_ns_ += compute_output_duration_ns;
 
 #ifdef TRITON_ENABLE_METRICS
   if (metric_reporter != nullptr) {
     metric_reporter->IncrementCounter("inf_exec_count", 1);
+    metric_reporter->ObserveBatchSize(batch_size);
   }
 #endif  // TRITON_ENABLE_METRICS
 }
 
+std::map<std::string, InferenceStatsAggregator::InstanceLoadStats>
+InferenceStatsAggregator::InstanceLoadStatsSnapshot() const
+{
+  std::lock_guard<std::mutex> lock(load_mu_);
+  return instance_load_stats_;
+}
+
+void
+InferenceStatsAggregator::UpdateInstanceLoadStats(
+    const std::string& instance_name, const uint64_t init_duration_ns,
+    const uint64_t warmup_duration_ns)
+{
+  std::lock_guard<std::mutex> lock(load_mu_);
+  auto& stats = instance_load_stats_[instance_name];
+  stats.init_duration_ns_ = init_duration_ns;
+  stats.warmup_duration_ns_ = warmup_duration_ns;
+}
+
 #endif  // TRITON_ENABLE_STATS
 
 }}  // namespace triton::core
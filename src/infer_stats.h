@@ -29,6 +29,8 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <string>
 #include <vector>
 #include "constants.h"
 #include "infer_response.h"
@@ -88,21 +90,64 @@ class InferenceStatsAggregator {
     uint64_t compute_output_duration_ns_;
   };
 
-  // Create an aggregator for model statistics
-  InferenceStatsAggregator()
-      : last_inference_ms_(0), inference_count_(0), execution_count_(0)
+  struct InstanceLoadStats {
+    InstanceLoadStats() : init_duration_ns_(0), warmup_duration_ns_(0) {}
+    uint64_t init_duration_ns_;
+    uint64_t warmup_duration_ns_;
+  };
+
+  // The statistics of all shards merged together.
+  struct Snapshot {
+    Snapshot() : last_inference_ms_(0), inference_count_(0), execution_count_(0)
+    {
+    }
+    uint64_t last_inference_ms_;
+    uint64_t inference_count_;
+    uint64_t execution_count_;
+    InferStats infer_stats_;
+    std::map<size_t, InferBatchStats> batch_stats_;
+  };
+
+  // Create an aggregator for model statistics. Updates are spread
+  // across 'shard_count' independently locked shards, by default one
+  // per hardware thread up to a limit, so that concurrent updates from
+  // different threads rarely contend. The shards are merged when the
+  // statistics are read.
+  explicit InferenceStatsAggregator(
+      const size_t shard_count = DefaultShardCount());
+
+  // Return the statistics merged across all shards. Each shard is
+  // merged consistently but the snapshot as a whole is not atomic with
+  // respect to concurrent updates.
+  Snapshot MergedSnapshot() const;
+
+  uint64_t LastInferenceMs() const
   {
+    return MergedSnapshot().last_inference_ms_;
   }
-
-  uint64_t LastInferenceMs() const { return last_inference_ms_; }
-  uint64_t InferenceCount() const { return inference_count_; }
-  uint64_t ExecutionCount() const { return execution_count_; }
-  const InferStats& ImmutableInferStats() const { return infer_stats_; }
-  const std::map<size_t, InferBatchStats>& ImmutableInferBatchStats() const
+  uint64_t InferenceCount() const { return MergedSnapshot().inference_count_; }
+  uint64_t ExecutionCount() const { return MergedSnapshot().execution_count_; }
+  InferStats InferStatsSnapshot() const
+  {
+    return MergedSnapshot().infer_stats_;
+  }
+  std::map<size_t, InferBatchStats> InferBatchStatsSnapshot() const
   {
-    return batch_stats_;
+    return MergedSnapshot().batch_stats_;
   }
 
+  size_t ShardCount() const { return shard_count_; }
+
+  // Return a copy of the initialization and warmup durations of each
+  // model instance, keyed by instance name.
+  std::map<std::string, InstanceLoadStats> InstanceLoadStatsSnapshot() const;
+
+  // Record the durations of the most recent initialization and warmup
+  // of the named model instance.
+  void UpdateInstanceLoadStats(
+      const std::string& instance_name, const uint64_t init_duration_ns,
+      const uint64_t warmup_duration_ns);
+
   // Add durations to Infer stats for a failed inference request.
   void UpdateFailure(
       MetricModelReporter* metric_reporter, const uint64_t request_start_ns,
@@ -156,12 +201,35 @@ class InferenceStatsAggregator {
       const uint64_t compute_output_duration_ns);
 
  private:
-  std::mutex mu_;
-  uint64_t last_inference_ms_;
-  uint64_t inference_count_;
-  uint64_t execution_count_;
-  InferStats infer_stats_;
-  std::map<size_t, InferBatchStats> batch_stats_;
+  // A shard holds plain counters protected by a lock that is, in the
+  // common case, only ever taken by the threads mapped to the shard.
+  // The trailing padding keeps the hot fields of neighbouring shards
+  // off the same cache line.
+  struct Shard {
+    Shard() : last_inference_ms_(0), inference_count_(0), execution_count_(0)
+    {
+    }
+    std::mutex mu_;
+    uint64_t last_inference_ms_;
+    uint64_t inference_count_;
+    uint64_t execution_count_;
+    InferStats infer_stats_;
+    std::map<size_t, InferBatchStats> batch_stats_;
+    char padding_[64];
+  };
+
+  static size_t DefaultShardCount();
+
+  // Return the shard assigned to the calling thread.
+  Shard& LocalShard();
+
+  const size_t shard_count_;
+  std::unique_ptr<Shard[]> shards_;
+
+  // Instances may be created concurrently and reported while inference
+  // is running, so the load stats have their own lock.
+  mutable std::mutex load_mu_;
+  std::map<std::string, InstanceLoadStats> instance_load_stats_;
 #endif  // TRITON_ENABLE_STATS
 };
 
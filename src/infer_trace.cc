@@ -26,6 +26,15 @@
 
 #include "infer_trace.h"
 
+#include <cstring>
+#include <vector>
+#include "trace_tensor_stager.h"
+#include "triton/common/logging.h"
+
+#ifdef TRITON_ENABLE_GPU
+#include <cuda_runtime_api.h>
+#endif  // TRITON_ENABLE_GPU
+
 namespace triton { namespace core {
 
 #ifdef TRITON_ENABLE_TRACING
@@ -39,15 +48,114 @@ InferenceTrace::SpawnChildTrace()
 {
   InferenceTrace* trace = new InferenceTrace(
       level_, id_, activity_fn_, tensor_activity_fn_, release_fn_, userp_);
+  if (async_tensors_) {
+    trace->SetAsyncTensors(tensor_byte_limit_);
+  }
   return trace;
 }
 
 void
 InferenceTrace::Release()
 {
+  // The binary trace file has no callback to query the model of the
+  // trace so record it once the trace is complete.
+  if ((activity_fn_ == nullptr) &&
+      ((level_ & TRITONSERVER_TRACE_LEVEL_TIMESTAMPS) > 0) &&
+      !model_name_.empty()) {
+    TraceBinarySink::Get()->WriteModel(
+        id_, model_name_, model_version_,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  // Queued behind the staged tensors of the trace so the trace
+  // outlives their delivery.
+  if (async_tensors_ &&
+      TraceTensorStager::Get()->Enqueue(
+          [this] {
+            release_fn_(
+                reinterpret_cast<TRITONSERVER_InferenceTrace*>(this), userp_);
+          },
+          0 /* reserved_byte_size */)) {
+    return;
+  }
   release_fn_(reinterpret_cast<TRITONSERVER_InferenceTrace*>(this), userp_);
 }
 
+void
+InferenceTrace::StageTensor(
+    const TRITONSERVER_InferenceTraceActivity activity, const char* name,
+    TRITONSERVER_DataType datatype, const void* base, size_t byte_size,
+    const int64_t* shape, uint64_t dim_count,
+    TRITONSERVER_MemoryType memory_type, int64_t memory_type_id)
+{
+  if (tensors_dropped_) {
+    return;
+  }
+  TraceTensorStager* stager = TraceTensorStager::Get();
+  const uint64_t staged_byte_size = staged_byte_size_ += byte_size;
+  if (((tensor_byte_limit_ != 0) && (staged_byte_size > tensor_byte_limit_)) ||
+      !stager->Reserve(byte_size)) {
+    DropTensors();
+    return;
+  }
+
+  struct StagedTensor {
+    std::string name_;
+    std::vector<int64_t> shape_;
+    std::unique_ptr<char[]> buffer_;
+  };
+  std::shared_ptr<StagedTensor> tensor = std::make_shared<StagedTensor>();
+  tensor->name_ = name;
+  tensor->shape_.assign(shape, shape + dim_count);
+  tensor->buffer_.reset(new char[byte_size]);
+
+  bool copied = true;
+  if (memory_type == TRITONSERVER_MEMORY_GPU) {
+#ifdef TRITON_ENABLE_GPU
+    const cudaError_t err = cudaMemcpy(
+        tensor->buffer_.get(), base, byte_size, cudaMemcpyDeviceToHost);
+    if (err != cudaSuccess) {
+      LOG_ERROR << "failed to stage tensor '" << name << "' of trace " << id_
+                << ": " << cudaGetErrorString(err);
+      copied = false;
+    }
+#else
+    copied = false;
+#endif  // TRITON_ENABLE_GPU
+  } else {
+    memcpy(tensor->buffer_.get(), base, byte_size);
+  }
+  if (!copied) {
+    stager->Unreserve(byte_size);
+    DropTensors();
+    return;
+  }
+
+  if (!stager->Enqueue(
+          [this, activity, datatype, byte_size, tensor] {
+            tensor_activity_fn_(
+                reinterpret_cast<TRITONSERVER_InferenceTrace*>(this),
+                activity, tensor->name_.c_str(), datatype,
+                tensor->buffer_.get(), byte_size, tensor->shape_.data(),
+                tensor->shape_.size(), TRITONSERVER_MEMORY_CPU,
+                0 /* memory_type_id */, userp_);
+          },
+          byte_size)) {
+    DropTensors();
+  }
+}
+
+void
+InferenceTrace::DropTensors()
+{
+  if (!tensors_dropped_.exchange(true)) {
+    TraceTensorStager::Get()->RecordDroppedTrace();
+    LOG_VERBOSE(1) << "dropping the tensors of trace " << id_;
+  }
+}
+
 std::shared_ptr<InferenceTraceProxy>
 InferenceTraceProxy::SpawnChildTrace()
 {
@@ -30,6 +30,7 @@
 #include <memory>
 #include "constants.h"
 #include "status.h"
+#include "trace_binary_sink.h"
 #include "tritonserver_apis.h"
 
 namespace triton { namespace core {
@@ -39,7 +40,10 @@ namespace triton { namespace core {
 //
 // InferenceTrace
 //
-// Interface to TRITONSERVER_InferenceTrace to report trace events.
+// Interface to TRITONSERVER_InferenceTrace to report trace events. A
+// trace without an activity callback reports its activities to the
+// TraceBinarySink. A trace with asynchronous tensors stages its tensors
+// with the TraceTensorStager.
 //
 class InferenceTrace {
  public:
@@ -50,7 +54,8 @@ class InferenceTrace {
       TRITONSERVER_InferenceTraceReleaseFn_t release_fn, void* userp)
       : level_(level), id_(next_id_++), parent_id_(parent_id),
         activity_fn_(activity_fn), tensor_activity_fn_(tensor_activity_fn),
-        release_fn_(release_fn), userp_(userp)
+        release_fn_(release_fn), userp_(userp), async_tensors_(false),
+        tensor_byte_limit_(0), staged_byte_size_(0), tensors_dropped_(false)
   {
   }
 
@@ -67,14 +72,28 @@ class InferenceTrace {
   void SetModelVersion(int64_t v) { model_version_ = v; }
   void SetRequestId(const std::string& request_id) { request_id_ = request_id; }
 
+  // Deliver tensor activities asynchronously through the
+  // TraceTensorStager. At most 'byte_limit' bytes of tensors are staged
+  // for the trace, 0 for no limit other than the staging pool.
+  void SetAsyncTensors(const uint64_t byte_limit)
+  {
+    async_tensors_ = true;
+    tensor_byte_limit_ = byte_limit;
+  }
+
   // Report trace activity.
   void Report(
       const TRITONSERVER_InferenceTraceActivity activity, uint64_t timestamp_ns)
   {
     if ((level_ & TRITONSERVER_TRACE_LEVEL_TIMESTAMPS) > 0) {
-      activity_fn_(
-          reinterpret_cast<TRITONSERVER_InferenceTrace*>(this), activity,
-          timestamp_ns, userp_);
+      if (activity_fn_ == nullptr) {
+        TraceBinarySink::Get()->WriteActivity(
+            id_, parent_id_, activity, timestamp_ns);
+      } else {
+        activity_fn_(
+            reinterpret_cast<TRITONSERVER_InferenceTrace*>(this), activity,
+            timestamp_ns, userp_);
+      }
     }
   }
 
@@ -97,17 +116,34 @@ class InferenceTrace {
       TRITONSERVER_MemoryType memory_type, int64_t memory_type_id)
   {
     if ((level_ & TRITONSERVER_TRACE_LEVEL_TENSORS) > 0) {
-      tensor_activity_fn_(
-          reinterpret_cast<TRITONSERVER_InferenceTrace*>(this), activity, name,
-          datatype, base, byte_size, shape, dim_count, memory_type,
-          memory_type_id, userp_);
+      if (async_tensors_) {
+        StageTensor(
+            activity, name, datatype, base, byte_size, shape, dim_count,
+            memory_type, memory_type_id);
+      } else {
+        tensor_activity_fn_(
+            reinterpret_cast<TRITONSERVER_InferenceTrace*>(this), activity,
+            name, datatype, base, byte_size, shape, dim_count, memory_type,
+            memory_type_id, userp_);
+      }
     }
   }
 
-  // Release the trace. Call the trace release callback.
+  // Release the trace. Call the trace release callback, for a trace
+  // with asynchronous tensors once its staged tensors are delivered.
   void Release();
 
  private:
+  // Copy the tensor into the staging pool and queue its delivery. The
+  // remaining tensors of the trace are dropped instead of waiting when
+  // the byte limit of the trace is reached or the pool is full.
+  void StageTensor(
+      const TRITONSERVER_InferenceTraceActivity activity, const char* name,
+      TRITONSERVER_DataType datatype, const void* base, size_t byte_size,
+      const int64_t* shape, uint64_t dim_count,
+      TRITONSERVER_MemoryType memory_type, int64_t memory_type_id);
+  void DropTensors();
+
   const TRITONSERVER_InferenceTraceLevel level_;
   const uint64_t id_;
   const uint64_t parent_id_;
@@ -121,6 +157,11 @@ class InferenceTrace {
   int64_t model_version_;
   std::string request_id_;
 
+  bool async_tensors_;
+  uint64_t tensor_byte_limit_;
+  std::atomic<uint64_t> staged_byte_size_;
+  std::atomic<bool> tensors_dropped_;
+
   // Maintain next id statically so that trace id is unique even
   // across traces
   static std::atomic<uint64_t> next_id_;
@@ -0,0 +1,119 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "load_admission.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif  // __linux__
+
+#include <fstream>
+#include "filesystem.h"
+#include "triton/common/logging.h"
+
+namespace triton { namespace core {
+
+namespace {
+
+// Return the resident memory of this process, 0 if not available.
+uint64_t
+ResidentByteSize()
+{
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size_pages = 0, resident_pages = 0;
+  if (statm >> size_pages >> resident_pages) {
+    return resident_pages * sysconf(_SC_PAGESIZE);
+  }
+#endif  // __linux__
+  return 0;
+}
+
+}  // namespace
+
+LoadAdmission::LoadAdmission(const uint64_t budget_byte_size)
+    : budget_byte_size_(budget_byte_size), reserved_byte_size_(0),
+      inflight_count_(0), admitted_count_(0)
+{
+}
+
+uint64_t
+LoadAdmission::LearnedByteSize(const std::string& key)
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  const auto it = learned_byte_sizes_.find(key);
+  return (it == learned_byte_sizes_.end()) ? 0 : it->second;
+}
+
+std::unique_ptr<LoadAdmission::Ticket>
+LoadAdmission::Admit(const std::string& key, uint64_t byte_size)
+{
+  std::unique_ptr<Ticket> ticket(new Ticket(key, byte_size));
+  std::unique_lock<std::mutex> lk(mu_);
+  if (budget_byte_size_ != 0) {
+    cv_.wait(lk, [this, byte_size] {
+      return (inflight_count_ == 0) ||
+             (reserved_byte_size_ + byte_size <= budget_byte_size_);
+    });
+  }
+  ticket->alone_ = (inflight_count_ == 0);
+  ticket->admitted_count_ = ++admitted_count_;
+  ++inflight_count_;
+  reserved_byte_size_ += byte_size;
+  if (ticket->alone_) {
+    ticket->start_resident_byte_size_ = ResidentByteSize();
+  }
+  LOG_VERBOSE(1) << "admitted load of '" << key << "' reserving " << byte_size
+                 << " bytes, " << reserved_byte_size_ << " of "
+                 << budget_byte_size_ << " bytes reserved";
+  return ticket;
+}
+
+void
+LoadAdmission::Release(std::unique_ptr<Ticket>&& ticket)
+{
+  // The growth of resident memory is only attributed to the load if no
+  // other load was admitted while it was running.
+  const uint64_t end_resident_byte_size =
+      ticket->alone_ ? ResidentByteSize() : 0;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (ticket->alone_ && (ticket->admitted_count_ == admitted_count_) &&
+        (ticket->start_resident_byte_size_ != 0) &&
+        (end_resident_byte_size > ticket->start_resident_byte_size_)) {
+      learned_byte_sizes_[ticket->key_] =
+          end_resident_byte_size - ticket->start_resident_byte_size_;
+      LOG_VERBOSE(1) << "learned load footprint of '" << ticket->key_
+                     << "' as " << learned_byte_sizes_[ticket->key_]
+                     << " bytes";
+    }
+    --inflight_count_;
+    reserved_byte_size_ -= ticket->byte_size_;
+  }
+  cv_.notify_all();
+}
+
+}}  // namespace triton::core
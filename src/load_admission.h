@@ -0,0 +1,103 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "status.h"
+
+namespace triton { namespace core {
+
+//
+// Admits model loads against a host memory budget. Each load reserves
+// its estimated footprint and waits until the reservation fits in the
+// budget next to the loads in flight, so small models load at full
+// concurrency while large ones don't load together beyond the budget.
+// A load is always admitted when no other load is in flight, so a model
+// larger than the budget still loads on its own.
+//
+// The footprint of a load that ran alone is learned from the growth of
+// the process resident memory over the load, and is used as the
+// estimate of later loads of the same key.
+//
+class LoadAdmission {
+ public:
+  class Ticket;
+
+  // Create an admission with 'budget_byte_size' of host memory, 0 means
+  // no budget and every load is admitted immediately.
+  explicit LoadAdmission(const uint64_t budget_byte_size);
+
+  uint64_t BudgetByteSize() const { return budget_byte_size_; }
+
+  // Return the footprint learned for 'key', 0 if not known.
+  uint64_t LearnedByteSize(const std::string& key);
+
+  // Block until a load of 'byte_size' bytes is admitted.
+  std::unique_ptr<Ticket> Admit(const std::string& key, uint64_t byte_size);
+
+  // Return the reservation of a completed load and learn its footprint
+  // if it ran alone.
+  void Release(std::unique_ptr<Ticket>&& ticket);
+
+ private:
+  const uint64_t budget_byte_size_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  uint64_t reserved_byte_size_;
+  size_t inflight_count_;
+  // Number of loads admitted so far, to tell if a load ran alone.
+  uint64_t admitted_count_;
+  std::map<std::string, uint64_t> learned_byte_sizes_;
+};
+
+class LoadAdmission::Ticket {
+ public:
+  const std::string& Key() const { return key_; }
+  uint64_t ByteSize() const { return byte_size_; }
+
+ private:
+  friend class LoadAdmission;
+  Ticket(const std::string& key, const uint64_t byte_size)
+      : key_(key), byte_size_(byte_size), alone_(false), admitted_count_(0),
+        start_resident_byte_size_(0)
+  {
+  }
+
+  const std::string key_;
+  const uint64_t byte_size_;
+  // Whether no other load was in flight when this load was admitted.
+  bool alone_;
+  uint64_t admitted_count_;
+  uint64_t start_resident_byte_size_;
+};
+
+}}  // namespace triton::core
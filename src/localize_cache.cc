@@ -0,0 +1,351 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "localize_cache.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <vector>
+#include "filesystem.h"
+#include "triton/common/logging.h"
+
+namespace triton { namespace core {
+
+namespace {
+
+constexpr char kContentDir[] = "content";
+constexpr char kMetadataFile[] = "metadata";
+constexpr char kStagingPrefix[] = ".staging-";
+
+// Name of the entry directory, FNV-1a hash of the path and the
+// fingerprint.
+std::string
+EntryKey(const std::string& path, const std::string& fingerprint)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  auto update = [&hash](const std::string& str) {
+    for (const char c : str) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 1099511628211ULL;
+    }
+  };
+  update(path);
+  update("\n");
+  update(fingerprint);
+
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+  return key;
+}
+
+// Metadata file content is "<path>\n<byte size>\n<fingerprint>"
+std::string
+SerializeMetadata(
+    const std::string& path, const std::string& fingerprint,
+    const uint64_t byte_size)
+{
+  return path + "\n" + std::to_string(byte_size) + "\n" + fingerprint;
+}
+
+bool
+ParseMetadata(
+    const std::string& metadata, std::string* path, std::string* fingerprint,
+    uint64_t* byte_size)
+{
+  const size_t path_end = metadata.find('\n');
+  if (path_end == std::string::npos) {
+    return false;
+  }
+  const size_t size_end = metadata.find('\n', path_end + 1);
+  if (size_end == std::string::npos) {
+    return false;
+  }
+  const std::string size_str =
+      metadata.substr(path_end + 1, size_end - path_end - 1);
+  if (size_str.empty() ||
+      (size_str.find_first_not_of("0123456789") != std::string::npos)) {
+    return false;
+  }
+  *path = metadata.substr(0, path_end);
+  *byte_size = std::stoull(size_str);
+  *fingerprint = metadata.substr(size_end + 1);
+  return true;
+}
+
+}  // namespace
+
+Status
+LocalizeCache::Create(
+    const std::string& root, const uint64_t max_byte_size,
+    std::unique_ptr<LocalizeCache>* cache)
+{
+  std::unique_ptr<LocalizeCache> local_cache(
+      new LocalizeCache(root, max_byte_size));
+  RETURN_IF_ERROR(local_cache->Init());
+  *cache = std::move(local_cache);
+  return Status::Success;
+}
+
+LocalizeCache::LocalizeCache(
+    const std::string& root, const uint64_t max_byte_size)
+    : root_(root), max_byte_size_(max_byte_size), byte_size_(0),
+      staging_id_(0)
+{
+}
+
+Status
+LocalizeCache::Init()
+{
+  bool exists = false;
+  RETURN_IF_ERROR(FileExists(root_, &exists));
+  if (!exists) {
+    RETURN_IF_ERROR(MakeDirectory(root_, true /* recursive */));
+  }
+
+  std::set<std::string> contents;
+  RETURN_IF_ERROR(GetDirectoryContents(root_, &contents));
+  std::vector<std::pair<int64_t, std::pair<std::string, Entry>>> entries;
+  for (const auto& content : contents) {
+    const auto entry_dir = JoinPath({root_, content});
+    // Staging directories are left by a process that was terminated
+    // while populating an entry, and entries without valid metadata
+    // are not produced by the cache.
+    Entry entry;
+    std::string metadata;
+    int64_t mtime_ns = 0;
+    if ((content.rfind(kStagingPrefix, 0) != 0) &&
+        ReadTextFile(JoinPath({entry_dir, kMetadataFile}), &metadata)
+            .IsOk() &&
+        ParseMetadata(
+            metadata, &entry.path_, &entry.fingerprint_, &entry.byte_size_) &&
+        (content == EntryKey(entry.path_, entry.fingerprint_)) &&
+        FileModificationTime(JoinPath({entry_dir, kMetadataFile}), &mtime_ns)
+            .IsOk()) {
+      entries.emplace_back(mtime_ns, std::make_pair(content, entry));
+    } else {
+      LOG_VERBOSE(1) << "removing incomplete localize cache entry '"
+                     << entry_dir << "'";
+      LOG_STATUS_ERROR(
+          DeletePath(entry_dir), "failed to remove localize cache entry");
+    }
+  }
+
+  // The metadata file is rewritten whenever the entry is used, so its
+  // modification time orders the entries by their last use.
+  std::sort(
+      entries.begin(), entries.end(),
+      [](const std::pair<int64_t, std::pair<std::string, Entry>>& lhs,
+         const std::pair<int64_t, std::pair<std::string, Entry>>& rhs) {
+        return lhs.first < rhs.first;
+      });
+  for (auto& entry : entries) {
+    const std::string key = entry.second.first;
+    byte_size_ += entry.second.second.byte_size_;
+    entries_[key] = lru_.insert(lru_.end(), std::move(entry.second));
+  }
+  Evict("");
+
+  LOG_VERBOSE(1) << "localize cache '" << root_ << "' has " << lru_.size()
+                 << " entries, " << byte_size_ << " bytes";
+  return Status::Success;
+}
+
+Status
+LocalizeCache::Get(
+    const std::string& path, const std::string& fingerprint,
+    const PopulateFn& populate, std::shared_ptr<const std::string>* local_path)
+{
+  const std::string key = EntryKey(path, fingerprint);
+  std::string staging_dir;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    *local_path = Lookup(key, path, fingerprint);
+    if (*local_path != nullptr) {
+      return Status::Success;
+    }
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = getpid();
+#endif
+    staging_dir = JoinPath(
+        {root_, kStagingPrefix + key + "-" + std::to_string(pid) + "-" +
+                    std::to_string(staging_id_++)});
+  }
+
+  // Populate the entry without holding the lock, a concurrent request
+  // for the same content may populate another staging directory in
+  // the meantime, in which case only the first one is published.
+  const auto staging_content_dir = JoinPath({staging_dir, kContentDir});
+  uint64_t byte_size = 0;
+  Status status = MakeDirectory(staging_content_dir, true /* recursive */);
+  if (status.IsOk()) {
+    status = populate(staging_content_dir);
+  }
+  if (status.IsOk()) {
+    status = LocalDirectoryByteSize(staging_content_dir, &byte_size);
+  }
+  if (status.IsOk()) {
+    const auto metadata = SerializeMetadata(path, fingerprint, byte_size);
+    status = WriteBinaryFile(
+        JoinPath({staging_dir, kMetadataFile}), metadata.data(),
+        metadata.size());
+  }
+  if (!status.IsOk()) {
+    LOG_STATUS_ERROR(
+        DeletePath(staging_dir), "failed to remove localize cache staging");
+    return status;
+  }
+
+  std::lock_guard<std::mutex> lk(mu_);
+  *local_path = Lookup(key, path, fingerprint);
+  if (*local_path != nullptr) {
+    LOG_STATUS_ERROR(
+        DeletePath(staging_dir), "failed to remove localize cache staging");
+    return Status::Success;
+  }
+
+  const auto entry_dir = JoinPath({root_, key});
+  if (std::rename(staging_dir.c_str(), entry_dir.c_str()) != 0) {
+    status = Status(
+        Status::Code::INTERNAL, "failed to publish localize cache entry '" +
+                                    entry_dir + "': " + strerror(errno));
+    LOG_STATUS_ERROR(
+        DeletePath(staging_dir), "failed to remove localize cache staging");
+    return status;
+  }
+
+  // The older content of the path is no longer needed
+  for (auto it = lru_.begin(); it != lru_.end();) {
+    auto curr = it++;
+    if ((curr->second.path_ == path) && curr->second.local_path_.expired()) {
+      Remove(curr);
+    }
+  }
+
+  Entry entry;
+  entry.path_ = path;
+  entry.fingerprint_ = fingerprint;
+  entry.byte_size_ = byte_size;
+  local_path->reset(new std::string(JoinPath({entry_dir, kContentDir})));
+  entry.local_path_ = *local_path;
+  entries_[key] = lru_.insert(lru_.end(), std::make_pair(key, entry));
+  byte_size_ += byte_size;
+  Evict(key);
+
+  LOG_VERBOSE(1) << "added localize cache entry '" << entry_dir << "' for '"
+                 << path << "', " << byte_size << " bytes";
+  return Status::Success;
+}
+
+std::shared_ptr<const std::string>
+LocalizeCache::Lookup(
+    const std::string& key, const std::string& path,
+    const std::string& fingerprint)
+{
+  auto eit = entries_.find(key);
+  if (eit == entries_.end()) {
+    return nullptr;
+  }
+  auto it = eit->second;
+  if ((it->second.path_ != path) || (it->second.fingerprint_ != fingerprint)) {
+    if (it->second.local_path_.expired()) {
+      Remove(it);
+    }
+    return nullptr;
+  }
+
+  // Mark the entry as most recently used, also in the persisted order
+  const auto entry_dir = JoinPath({root_, key});
+  lru_.splice(lru_.end(), lru_, it);
+  const auto metadata =
+      SerializeMetadata(path, fingerprint, it->second.byte_size_);
+  LOG_STATUS_ERROR(
+      WriteBinaryFile(
+          JoinPath({entry_dir, kMetadataFile}), metadata.data(),
+          metadata.size()),
+      "failed to update localize cache entry");
+
+  auto local_path = it->second.local_path_.lock();
+  if (local_path == nullptr) {
+    local_path.reset(new std::string(JoinPath({entry_dir, kContentDir})));
+    it->second.local_path_ = local_path;
+  }
+  return local_path;
+}
+
+void
+LocalizeCache::Remove(EntryList::iterator it)
+{
+  const auto entry_dir = JoinPath({root_, it->first});
+  LOG_VERBOSE(1) << "removing localize cache entry '" << entry_dir
+                 << "' for '" << it->second.path_ << "'";
+  LOG_STATUS_ERROR(
+      DeletePath(entry_dir), "failed to remove localize cache entry");
+  byte_size_ -= it->second.byte_size_;
+  entries_.erase(it->first);
+  lru_.erase(it);
+}
+
+void
+LocalizeCache::Evict(const std::string& keep)
+{
+  if (max_byte_size_ == 0) {
+    return;
+  }
+  for (auto it = lru_.begin();
+       (byte_size_ > max_byte_size_) && (it != lru_.end());) {
+    auto curr = it++;
+    if ((curr->first != keep) && curr->second.local_path_.expired()) {
+      Remove(curr);
+    }
+  }
+}
+
+uint64_t
+LocalizeCache::ByteSize()
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  return byte_size_;
+}
+
+size_t
+LocalizeCache::EntryCount()
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  return lru_.size();
+}
+
+}}  // namespace triton::core
@@ -0,0 +1,122 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "status.h"
+
+namespace triton { namespace core {
+
+//
+// Persistent cache of localized remote directories. An entry is
+// identified by the remote path and a fingerprint of its content (i.e.
+// the modification times of the objects within), so a remote
+// directory that is localized again, by a reload or after a restart,
+// reuses the local copy as long as its content is unchanged.
+//
+// Each entry is a directory under the cache root holding the content
+// and a metadata file. A new entry is populated in a staging directory
+// and published with a rename, so an entry is either complete or not
+// visible at all, even if the process is terminated while populating.
+// The total size of the entries is kept within a limit by evicting the
+// least recently used entries that are not in use.
+//
+class LocalizeCache {
+ public:
+  // Function to populate the content of a new entry into the given
+  // (empty) local directory.
+  using PopulateFn = std::function<Status(const std::string& local_dir)>;
+
+  // Create a cache in 'root', picking up the entries that are already
+  // there. 'max_byte_size' is the limit of the total size of the
+  // entries, 0 for no limit.
+  static Status Create(
+      const std::string& root, const uint64_t max_byte_size,
+      std::unique_ptr<LocalizeCache>* cache);
+
+  // Get the local copy of 'path' with content identified by
+  // 'fingerprint'. If there is no such entry, a new entry is populated
+  // with 'populate' and any entry of an older content of 'path' is
+  // removed. Return the local directory holding the content in
+  // 'local_path', the entry is not evicted while 'local_path' is held.
+  Status Get(
+      const std::string& path, const std::string& fingerprint,
+      const PopulateFn& populate,
+      std::shared_ptr<const std::string>* local_path);
+
+  // The total size of the entries, in bytes.
+  uint64_t ByteSize();
+
+  // The number of entries.
+  size_t EntryCount();
+
+ private:
+  struct Entry {
+    // The remote path and the fingerprint of the content
+    std::string path_;
+    std::string fingerprint_;
+    uint64_t byte_size_;
+    // Held by the users of the entry.
+    std::weak_ptr<const std::string> local_path_;
+  };
+  // Entries in the order from least to most recently used.
+  using EntryList = std::list<std::pair<std::string, Entry>>;
+
+  LocalizeCache(const std::string& root, const uint64_t max_byte_size);
+
+  // Load the existing entries and remove incomplete ones.
+  Status Init();
+
+  // Return the local path of the entry if it is present. Must be
+  // called with 'mu_' held.
+  std::shared_ptr<const std::string> Lookup(
+      const std::string& key, const std::string& path,
+      const std::string& fingerprint);
+
+  // Remove an entry that is not in use. Must be called with 'mu_' held.
+  void Remove(EntryList::iterator it);
+
+  // Evict least recently used entries, other than 'keep', until the
+  // total size is within the limit. Must be called with 'mu_' held.
+  void Evict(const std::string& keep);
+
+  const std::string root_;
+  const uint64_t max_byte_size_;
+
+  std::mutex mu_;
+  EntryList lru_;
+  std::unordered_map<std::string, EntryList::iterator> entries_;
+  uint64_t byte_size_;
+  // For unique staging directory names within the process.
+  uint64_t staging_id_;
+};
+
+}}  // namespace triton::core
@@ -0,0 +1,112 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "metadata_arena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace triton { namespace core {
+
+namespace {
+
+size_t
+RoundUp(size_t byte_size, size_t alignment)
+{
+  return ((byte_size + alignment - 1) / alignment) * alignment;
+}
+
+}  // namespace
+
+MetadataArena::MetadataArena()
+    : cursor_(inline_buffer_), end_(inline_buffer_ + kInlineByteSize),
+      free_lists_(), heap_blocks_(nullptr), heap_allocation_count_(0)
+{
+}
+
+MetadataArena::~MetadataArena()
+{
+  while (heap_blocks_ != nullptr) {
+    FreeBlock* next = heap_blocks_->next_;
+    ::operator delete(heap_blocks_);
+    heap_blocks_ = next;
+  }
+}
+
+void*
+MetadataArena::Allocate(size_t byte_size)
+{
+  const size_t rounded_size =
+      RoundUp(std::max(byte_size, size_t(1)), kAlignment);
+  if (rounded_size > kMaxRecycledByteSize) {
+    heap_allocation_count_++;
+    return ::operator new(byte_size);
+  }
+
+  FreeBlock*& free_list = free_lists_[(rounded_size / kAlignment) - 1];
+  if (free_list != nullptr) {
+    FreeBlock* block = free_list;
+    free_list = block->next_;
+    return block;
+  }
+
+  if ((size_t)(end_ - cursor_) < rounded_size) {
+    // The remainder of the current block is abandoned, it is at most
+    // 'kMaxRecycledByteSize' bytes.
+    char* block = static_cast<char*>(::operator new(kBlockByteSize));
+    heap_allocation_count_++;
+    reinterpret_cast<FreeBlock*>(block)->next_ = heap_blocks_;
+    heap_blocks_ = reinterpret_cast<FreeBlock*>(block);
+    cursor_ = block + kAlignment;
+    end_ = block + kBlockByteSize;
+  }
+
+  void* ptr = cursor_;
+  cursor_ += rounded_size;
+  return ptr;
+}
+
+void
+MetadataArena::Deallocate(void* ptr, size_t byte_size)
+{
+  if (ptr == nullptr) {
+    return;
+  }
+
+  const size_t rounded_size =
+      RoundUp(std::max(byte_size, size_t(1)), kAlignment);
+  if (rounded_size > kMaxRecycledByteSize) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+  FreeBlock*& free_list = free_lists_[(rounded_size / kAlignment) - 1];
+  block->next_ = free_list;
+  free_list = block;
+}
+
+}}  // namespace triton::core
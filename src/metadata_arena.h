@@ -0,0 +1,139 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "constants.h"
+
+namespace triton { namespace core {
+
+//
+// Arena for the small, short-lived metadata allocations of a request
+// or response, such as container nodes for inputs, outputs and
+// parameters. The first allocations are served from storage inline
+// with the arena so that the metadata of a typical request does not
+// touch the heap. Freed blocks are kept in per-size free lists and
+// recycled, so that an object that is reused does not grow its arena.
+// The arena is not thread-safe and must outlive everything allocated
+// from it.
+//
+class MetadataArena {
+ public:
+  MetadataArena();
+  ~MetadataArena();
+
+  // Allocate 'byte_size' bytes aligned to the fundamental alignment.
+  void* Allocate(size_t byte_size);
+
+  // Return memory obtained by Allocate() with the same 'byte_size'.
+  void Deallocate(void* ptr, size_t byte_size);
+
+  // Number of allocations that had to be served from the heap, either
+  // to grow the arena or because they were too large to be recycled.
+  size_t HeapAllocationCount() const { return heap_allocation_count_; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(MetadataArena);
+
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+  static constexpr size_t kInlineByteSize = 2048;
+  static constexpr size_t kBlockByteSize = 4096;
+  static constexpr size_t kMaxRecycledByteSize = 512;
+
+  struct FreeBlock {
+    FreeBlock* next_;
+  };
+
+  alignas(kAlignment) char inline_buffer_[kInlineByteSize];
+  char* cursor_;
+  char* end_;
+
+  // Free lists indexed by size class, size classes are multiples of
+  // 'kAlignment' up to 'kMaxRecycledByteSize'.
+  FreeBlock* free_lists_[kMaxRecycledByteSize / kAlignment];
+
+  // Heap blocks used to grow the arena, chained through their first
+  // bytes.
+  FreeBlock* heap_blocks_;
+  size_t heap_allocation_count_;
+};
+
+//
+// Standard allocator that allocates from a MetadataArena, used to
+// place standard containers on the arena.
+//
+template <typename T>
+class MetadataArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit MetadataArenaAllocator(MetadataArena* arena) : arena_(arena) {}
+
+  template <typename U>
+  MetadataArenaAllocator(const MetadataArenaAllocator<U>& other)
+      : arena_(other.arena_)
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    static_assert(
+        alignof(T) <= alignof(std::max_align_t),
+        "over-aligned types can not be allocated from MetadataArena");
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) { arena_->Deallocate(ptr, n * sizeof(T)); }
+
+ private:
+  template <typename U>
+  friend class MetadataArenaAllocator;
+  template <typename U, typename V>
+  friend bool operator==(
+      const MetadataArenaAllocator<U>& lhs,
+      const MetadataArenaAllocator<V>& rhs);
+
+  MetadataArena* arena_;
+};
+
+template <typename U, typename V>
+bool
+operator==(
+    const MetadataArenaAllocator<U>& lhs, const MetadataArenaAllocator<V>& rhs)
+{
+  return lhs.arena_ == rhs.arena_;
+}
+
+template <typename U, typename V>
+bool
+operator!=(
+    const MetadataArenaAllocator<U>& lhs, const MetadataArenaAllocator<V>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+}}  // namespace triton::core
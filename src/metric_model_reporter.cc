@@ -28,6 +28,7 @@
 
 #ifdef TRITON_ENABLE_METRICS
 
+#include <algorithm>
 #include "constants.h"
 #include "triton/common/logging.h"
 
@@ -40,7 +41,8 @@ namespace triton { namespace core {
 // MetricReporterConfig
 //
 void
-MetricReporterConfig::ParseConfig(bool response_cache_enabled)
+MetricReporterConfig::ParseConfig(
+    bool response_cache_enabled, const std::string& model_name)
 {
   // Global config only for now in config map
   auto metrics_config_map = Metrics::ConfigMap();
@@ -65,6 +67,33 @@ MetricReporterConfig::ParseConfig(bool response_cache_enabled)
     }
   }
 
+  // Histogram and scheduler settings may be given globally and
+  // overridden per model
+  std::vector<const MetricsConfig*> configs{&metrics_config};
+  const auto model_itr = metrics_config_map.find(model_name);
+  if (!model_name.empty() && (model_itr != metrics_config_map.end())) {
+    configs.push_back(&model_itr->second);
+  }
+  for (const auto config : configs) {
+    for (const auto& pair : *config) {
+      if (pair.first == "histogram_latencies") {
+        latency_histograms_enabled_ = (pair.second == "true");
+      }
+
+      if (pair.first == "scheduler_metrics") {
+        scheduler_metrics_enabled_ = (pair.second == "true");
+      }
+
+      // ex: histogram_buckets="100,1000,10000,100000"
+      if (pair.first == "histogram_buckets") {
+        const auto& buckets = ParseBuckets(pair.second);
+        if (!buckets.empty()) {
+          buckets_ = buckets;
+        }
+      }
+    }
+  }
+
   // Set flag to signal to stats aggregator if caching is enabled or not
   cache_enabled_ = response_cache_enabled;
 }
@@ -98,6 +127,76 @@ MetricReporterConfig::ParseQuantiles(std::string options)
   return qpairs;
 }
 
+prometheus::Histogram::BucketBoundaries
+MetricReporterConfig::ParseBuckets(std::string options)
+{
+  prometheus::Histogram::BucketBoundaries buckets;
+  std::stringstream ss(options);
+  std::string bound_str;
+  while (std::getline(ss, bound_str, ',')) {
+    try {
+      const double bound = std::stod(bound_str);
+      if (!buckets.empty() && (bound <= buckets.back())) {
+        LOG_ERROR << "Invalid option: [" << options
+                  << "]. Histogram bucket boundaries must be strictly "
+                     "increasing";
+        return {};
+      }
+      buckets.push_back(bound);
+    }
+    catch (const std::exception& e) {
+      LOG_ERROR << "Invalid option: [" << options << "]. Error: " << e.what();
+      return {};
+    }
+  }
+
+  return buckets;
+}
+
+//
+// AtomicHistogram
+//
+AtomicHistogram::AtomicHistogram(
+    prometheus::Histogram* histogram,
+    const prometheus::Histogram::BucketBoundaries& buckets)
+    : histogram_(histogram), buckets_(buckets),
+      counts_(new std::atomic<uint64_t>[buckets.size() + 1]), sum_(0)
+{
+  for (size_t i = 0; i <= buckets_.size(); ++i) {
+    counts_[i].store(0);
+  }
+}
+
+void
+AtomicHistogram::Observe(uint64_t value)
+{
+  // Bucket 'i' counts the values in (buckets_[i - 1], buckets_[i]], with
+  // the last counter holding the values above every boundary.
+  const size_t bucket =
+      std::lower_bound(
+          buckets_.begin(), buckets_.end(), static_cast<double>(value)) -
+      buckets_.begin();
+  counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void
+AtomicHistogram::Flush()
+{
+  // Observations racing with the flush are published by the next one,
+  // possibly with their sum and bucket published by different flushes.
+  std::vector<double> increments(buckets_.size() + 1);
+  bool observed = false;
+  for (size_t i = 0; i < increments.size(); ++i) {
+    increments[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+    observed |= (increments[i] != 0);
+  }
+  const uint64_t sum = sum_.exchange(0, std::memory_order_relaxed);
+  if (observed || (sum != 0)) {
+    histogram_->ObserveMultiple(increments, sum);
+  }
+}
+
 //
 // MetricModelReporter
 //
@@ -142,20 +241,37 @@ MetricModelReporter::MetricModelReporter(
     const std::string& model_name, const int64_t model_version,
     const int device, bool response_cache_enabled,
     const triton::common::MetricTagsMap& model_tags)
+    : collect_callback_id_(0), pending_batch_size_gauge_(nullptr),
+      sequence_backlog_gauge_(nullptr)
 {
   std::map<std::string, std::string> labels;
   GetMetricLabels(&labels, model_name, model_version, device, model_tags);
 
   // Parse metrics config to control metric setup and behavior
-  config_.ParseConfig(response_cache_enabled);
+  config_.ParseConfig(response_cache_enabled, model_name);
 
   // Initialize families and metrics
   InitializeCounters(labels);
   InitializeSummaries(labels);
+  InitializeHistograms(labels);
+  InitializeSchedulerMetrics(labels);
+
+  if (!atomic_histograms_.empty()) {
+    collect_callback_id_ = Metrics::RegisterCollectCallback([this]() {
+      for (auto& iter : atomic_histograms_) {
+        iter.second->Flush();
+      }
+    });
+  }
 }
 
 MetricModelReporter::~MetricModelReporter()
 {
+  // Stop flushing before the histograms are removed from their families
+  if (!atomic_histograms_.empty()) {
+    Metrics::UnregisterCollectCallback(collect_callback_id_);
+  }
+
   // Cleanup metrics for each family
   for (auto& iter : counter_families_) {
     const auto& name = iter.first;
@@ -172,6 +288,29 @@ MetricModelReporter::~MetricModelReporter()
       family_ptr->Remove(summaries_[name]);
     }
   }
+
+  for (auto& iter : histogram_families_) {
+    const auto& name = iter.first;
+    auto family_ptr = iter.second;
+    if (family_ptr) {
+      family_ptr->Remove(histograms_[name]);
+    }
+  }
+
+  if (config_.scheduler_metrics_enabled_) {
+    for (auto& iter : queue_size_gauges_) {
+      Metrics::FamilySchedulerQueueSize().Remove(iter.second);
+    }
+    Metrics::FamilySchedulerPendingBatchSize().Remove(
+        pending_batch_size_gauge_);
+    Metrics::FamilySchedulerSequenceBacklog().Remove(sequence_backlog_gauge_);
+    for (auto& iter : batch_counters_) {
+      Metrics::FamilySchedulerBatches().Remove(iter.second);
+    }
+    for (auto& iter : rejection_counters_) {
+      Metrics::FamilySchedulerRejections().Remove(iter.second);
+    }
+  }
 }
 
 void
@@ -263,6 +402,91 @@ MetricModelReporter::InitializeSummaries(
   }
 }
 
+void
+MetricModelReporter::InitializeHistograms(
+    const std::map<std::string, std::string>& labels)
+{
+  // Latency metrics will be initialized based on config
+  if (config_.latency_histograms_enabled_) {
+    // Request
+    if (!config_.cache_enabled_) {
+      // Same as the request_duration summary, the histogram is disabled
+      // when cache is enabled because cache insertion is reported
+      // separately from the rest of the request duration.
+      histogram_families_["request_duration"] =
+          &Metrics::FamilyInferenceRequestHistogram();
+    }
+    histogram_families_["queue_duration"] =
+        &Metrics::FamilyInferenceQueueHistogram();
+    // Compute
+    histogram_families_["compute_input_duration"] =
+        &Metrics::FamilyInferenceComputeInputHistogram();
+    histogram_families_["compute_infer_duration"] =
+        &Metrics::FamilyInferenceComputeInferHistogram();
+    histogram_families_["compute_output_duration"] =
+        &Metrics::FamilyInferenceComputeOutputHistogram();
+    // Only create cache metrics if cache is enabled to reduce metric output
+    if (config_.cache_enabled_) {
+      histogram_families_["cache_hit_duration"] =
+          &Metrics::FamilyCacheHitHistogram();
+      histogram_families_["cache_miss_duration"] =
+          &Metrics::FamilyCacheMissHistogram();
+    }
+  }
+
+  // Create metrics for each family
+  for (auto& iter : histogram_families_) {
+    const auto& name = iter.first;
+    auto family_ptr = iter.second;
+    if (family_ptr) {
+      histograms_[name] = CreateMetric<prometheus::Histogram>(
+          *family_ptr, labels, config_.buckets_);
+      atomic_histograms_[name].reset(
+          new AtomicHistogram(histograms_[name], config_.buckets_));
+    }
+  }
+}
+
+const std::vector<const char*> MetricModelReporter::kSchedulerBatchReasons{
+    "preferred_size", "max_size", "shape_mismatch", "custom_batch",
+    "delay_expired",  "no_delay", "grow_payload"};
+const std::vector<const char*> MetricModelReporter::kSchedulerRejectionReasons{
+    "max_queue_size", "timeout", "sequence_timeout"};
+
+void
+MetricModelReporter::InitializeSchedulerMetrics(
+    const std::map<std::string, std::string>& labels)
+{
+  if (!config_.scheduler_metrics_enabled_) {
+    return;
+  }
+
+  labels_ = labels;
+  pending_batch_size_gauge_ = CreateMetric<prometheus::Gauge>(
+      Metrics::FamilySchedulerPendingBatchSize(), labels);
+  sequence_backlog_gauge_ = CreateMetric<prometheus::Gauge>(
+      Metrics::FamilySchedulerSequenceBacklog(), labels);
+
+  auto reason_labels = labels;
+  for (const auto reason : kSchedulerBatchReasons) {
+    reason_labels[kMetricsLabelReason] = reason;
+    batch_counters_[reason] = CreateMetric<prometheus::Counter>(
+        Metrics::FamilySchedulerBatches(), reason_labels);
+  }
+  for (const auto reason : kSchedulerRejectionReasons) {
+    reason_labels[kMetricsLabelReason] = reason;
+    rejection_counters_[reason] = CreateMetric<prometheus::Counter>(
+        Metrics::FamilySchedulerRejections(), reason_labels);
+  }
+
+  histogram_families_["batch_size"] = &Metrics::FamilySchedulerBatchSize();
+  histograms_["batch_size"] = CreateMetric<prometheus::Histogram>(
+      Metrics::FamilySchedulerBatchSize(), labels,
+      config_.batch_size_buckets_);
+  atomic_histograms_["batch_size"].reset(new AtomicHistogram(
+      histograms_["batch_size"], config_.batch_size_buckets_));
+}
+
 void
 MetricModelReporter::GetMetricLabels(
     std::map<std::string, std::string>* labels, const std::string& model_name,
@@ -346,6 +570,102 @@ MetricModelReporter::ObserveSummary(const std::string& name, double value)
   summary->Observe(value);
 }
 
+void
+MetricModelReporter::ObserveHistogram(const std::string& name, uint64_t value)
+{
+  if (!config_.latency_histograms_enabled_) {
+    return;
+  }
+
+  auto iter = atomic_histograms_.find(name);
+  if (iter == atomic_histograms_.end()) {
+    // No histogram metric exists with this name
+    return;
+  }
+
+  iter->second->Observe(value);
+}
+
+void
+MetricModelReporter::AdjustSchedulerQueueSize(
+    const uint32_t priority_level, double delta)
+{
+  if (!config_.scheduler_metrics_enabled_ || (delta == 0)) {
+    return;
+  }
+
+  prometheus::Gauge* gauge = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(queue_size_mu_);
+    auto& entry = queue_size_gauges_[priority_level];
+    if (entry == nullptr) {
+      auto priority_labels = labels_;
+      priority_labels[kMetricsLabelPriority] = std::to_string(priority_level);
+      entry = CreateMetric<prometheus::Gauge>(
+          Metrics::FamilySchedulerQueueSize(), priority_labels);
+    }
+    gauge = entry;
+  }
+  gauge->Increment(delta);
+}
+
+void
+MetricModelReporter::AdjustSchedulerPendingBatchSize(double delta)
+{
+  if (!config_.scheduler_metrics_enabled_ || (delta == 0)) {
+    return;
+  }
+  pending_batch_size_gauge_->Increment(delta);
+}
+
+void
+MetricModelReporter::IncrementSchedulerBatches(const char* reason)
+{
+  if (!config_.scheduler_metrics_enabled_) {
+    return;
+  }
+
+  auto iter = batch_counters_.find(reason);
+  if (iter != batch_counters_.end()) {
+    iter->second->Increment();
+  }
+}
+
+void
+MetricModelReporter::IncrementSchedulerRejections(
+    const char* reason, double count)
+{
+  if (!config_.scheduler_metrics_enabled_ || (count == 0)) {
+    return;
+  }
+
+  auto iter = rejection_counters_.find(reason);
+  if (iter != rejection_counters_.end()) {
+    iter->second->Increment(count);
+  }
+}
+
+void
+MetricModelReporter::SetSchedulerSequenceBacklog(double size)
+{
+  if (!config_.scheduler_metrics_enabled_) {
+    return;
+  }
+  sequence_backlog_gauge_->Set(size);
+}
+
+void
+MetricModelReporter::ObserveBatchSize(uint64_t batch_size)
+{
+  if (!config_.scheduler_metrics_enabled_) {
+    return;
+  }
+  auto iter = atomic_histograms_.find("batch_size");
+  if (iter != atomic_histograms_.end()) {
+    iter->second->Observe(batch_size);
+  }
+}
+
 }}  // namespace triton::core
 
 #endif  // TRITON_ENABLE_METRICS
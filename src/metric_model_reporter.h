@@ -29,6 +29,8 @@
 #include "triton/common/model_config.h"
 
 #ifdef TRITON_ENABLE_METRICS
+#include <atomic>
+#include <mutex>
 #include "metrics.h"
 #include "prometheus/registry.h"
 #endif  // TRITON_ENABLE_METRICS
@@ -40,11 +42,17 @@ namespace triton { namespace core {
 //
 struct MetricReporterConfig {
 #ifdef TRITON_ENABLE_METRICS
-  // Parses Metrics::ConfigMap and sets fields if specified
-  void ParseConfig(bool response_cache_enabled);
+  // Parses Metrics::ConfigMap and sets fields if specified. Histogram and
+  // scheduler settings may also be given in a config group named after
+  // the model, which take precedence over the global settings for that
+  // model.
+  void ParseConfig(bool response_cache_enabled, const std::string& model_name);
   // Parses pairs of quantiles "quantile1:error1, quantile2:error2, ..."
   // and overwrites quantiles_ field if successful.
   prometheus::Summary::Quantiles ParseQuantiles(std::string options);
+  // Parses strictly increasing bucket boundaries "bound1, bound2, ...".
+  // Returns an empty vector if the boundaries are invalid.
+  prometheus::Histogram::BucketBoundaries ParseBuckets(std::string options);
 
   // Create and use Counters for per-model latency related metrics
   bool latency_counters_enabled_ = true;
@@ -56,6 +64,17 @@ struct MetricReporterConfig {
   // percentile value will be between the 89th and 91st percentiles.
   prometheus::Summary::Quantiles quantiles_ = {
       {0.5, 0.05}, {0.9, 0.01}, {0.95, 0.001}, {0.99, 0.001}, {0.999, 0.001}};
+  // Create and use Histograms for per-model latency related metrics
+  bool latency_histograms_enabled_ = false;
+  // Upper bounds, in microseconds, of the histogram buckets.
+  prometheus::Histogram::BucketBoundaries buckets_ = {
+      100,   250,    500,    1000,   2500,    5000,   10000,
+      25000, 50000, 100000, 250000, 500000, 1000000};
+  // Create and use metrics describing the scheduler queues and batching
+  bool scheduler_metrics_enabled_ = false;
+  // Upper bounds of the histogram buckets of the executed batch sizes.
+  prometheus::Histogram::BucketBoundaries batch_size_buckets_ = {
+      1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
 
   // Whether this reporter's model has caching enabled or not.
   // This helps handle infer_stats aggregation for summaries on cache misses.
@@ -63,6 +82,33 @@ struct MetricReporterConfig {
 #endif  // TRITON_ENABLE_METRICS
 };
 
+#ifdef TRITON_ENABLE_METRICS
+//
+// AtomicHistogram
+//
+// Accumulates histogram observations in atomic bucket counters so that
+// observing does not take a lock. The accumulated observations are
+// moved into the backing prometheus histogram by Flush(), which is
+// called before metrics are collected.
+//
+class AtomicHistogram {
+ public:
+  AtomicHistogram(
+      prometheus::Histogram* histogram,
+      const prometheus::Histogram::BucketBoundaries& buckets);
+
+  void Observe(uint64_t value);
+  void Flush();
+
+ private:
+  prometheus::Histogram* histogram_;
+  const prometheus::Histogram::BucketBoundaries buckets_;
+  // One counter per bucket plus one for the implicit +Inf bucket.
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+  std::atomic<uint64_t> sum_;
+};
+#endif  // TRITON_ENABLE_METRICS
+
 //
 // Interface for a metric reporter for a given version of a model.
 //
@@ -83,6 +129,26 @@ class MetricModelReporter {
   void IncrementCounter(const std::string& name, double value);
   // Lookup summary metric by name, and observe the value if it exists.
   void ObserveSummary(const std::string& name, double value);
+  // Lookup histogram metric by name, and observe the value if it exists.
+  void ObserveHistogram(const std::string& name, uint64_t value);
+
+  // Scheduler metrics, no-ops unless scheduler metrics are enabled.
+  // Queue sizes are adjusted by deltas since several schedulers, e.g.
+  // the per-instance batchers of a sequence batcher, may report into
+  // the same reporter.
+  void AdjustSchedulerQueueSize(const uint32_t priority_level, double delta);
+  void AdjustSchedulerPendingBatchSize(double delta);
+  // Increment the number of batches sent for 'reason', which must be
+  // one of kSchedulerBatchReasons.
+  void IncrementSchedulerBatches(const char* reason);
+  // Increment the number of requests rejected for 'reason', which must
+  // be one of kSchedulerRejectionReasons.
+  void IncrementSchedulerRejections(const char* reason, double count);
+  void SetSchedulerSequenceBacklog(double size);
+  void ObserveBatchSize(uint64_t batch_size);
+
+  static const std::vector<const char*> kSchedulerBatchReasons;
+  static const std::vector<const char*> kSchedulerRejectionReasons;
 
  private:
   MetricModelReporter(
@@ -102,16 +168,36 @@ class MetricModelReporter {
 
   void InitializeCounters(const std::map<std::string, std::string>& labels);
   void InitializeSummaries(const std::map<std::string, std::string>& labels);
+  void InitializeHistograms(const std::map<std::string, std::string>& labels);
+  void InitializeSchedulerMetrics(
+      const std::map<std::string, std::string>& labels);
 
   // Metric Families
   std::unordered_map<std::string, prometheus::Family<prometheus::Counter>*>
       counter_families_;
   std::unordered_map<std::string, prometheus::Family<prometheus::Summary>*>
       summary_families_;
+  std::unordered_map<std::string, prometheus::Family<prometheus::Histogram>*>
+      histogram_families_;
 
   // Metrics
   std::unordered_map<std::string, prometheus::Counter*> counters_;
   std::unordered_map<std::string, prometheus::Summary*> summaries_;
+  std::unordered_map<std::string, prometheus::Histogram*> histograms_;
+  std::unordered_map<std::string, std::unique_ptr<AtomicHistogram>>
+      atomic_histograms_;
+  // Id of the callback flushing 'atomic_histograms_' on collection.
+  uint64_t collect_callback_id_;
+
+  // Scheduler metrics. The queue size gauges are created on first use
+  // of each priority level.
+  std::map<std::string, std::string> labels_;
+  std::mutex queue_size_mu_;
+  std::map<uint32_t, prometheus::Gauge*> queue_size_gauges_;
+  prometheus::Gauge* pending_batch_size_gauge_;
+  prometheus::Gauge* sequence_backlog_gauge_;
+  std::unordered_map<std::string, prometheus::Counter*> batch_counters_;
+  std::unordered_map<std::string, prometheus::Counter*> rejection_counters_;
 
   // Config
   MetricReporterConfig config_;
@@ -29,6 +29,9 @@
 
 #include "metrics.h"
 
+#include <chrono>
+#include <cstring>
+#include <deque>
 #include <thread>
 #include "constants.h"
 #include "prometheus/detail/utils.h"
@@ -44,6 +47,102 @@
 
 namespace triton { namespace core {
 
+namespace {
+
+// Whether two collections of a metric family serialize the same.
+bool
+SameFamily(
+    const prometheus::MetricFamily& lhs, const prometheus::MetricFamily& rhs)
+{
+  if ((lhs.help != rhs.help) || (lhs.type != rhs.type) ||
+      (lhs.metric.size() != rhs.metric.size())) {
+    return false;
+  }
+  for (size_t idx = 0; idx < lhs.metric.size(); ++idx) {
+    const auto& lm = lhs.metric[idx];
+    const auto& rm = rhs.metric[idx];
+    if ((lm.timestamp_ms != rm.timestamp_ms) ||
+        (lm.label.size() != rm.label.size())) {
+      return false;
+    }
+    for (size_t ldx = 0; ldx < lm.label.size(); ++ldx) {
+      if ((lm.label[ldx].name != rm.label[ldx].name) ||
+          (lm.label[ldx].value != rm.label[ldx].value)) {
+        return false;
+      }
+    }
+    switch (lhs.type) {
+      case prometheus::MetricType::Counter:
+        if (lm.counter.value != rm.counter.value) {
+          return false;
+        }
+        break;
+      case prometheus::MetricType::Gauge:
+        if (lm.gauge.value != rm.gauge.value) {
+          return false;
+        }
+        break;
+      case prometheus::MetricType::Untyped:
+        if (lm.untyped.value != rm.untyped.value) {
+          return false;
+        }
+        break;
+      case prometheus::MetricType::Summary: {
+        const auto& ls = lm.summary;
+        const auto& rs = rm.summary;
+        if ((ls.sample_count != rs.sample_count) ||
+            (ls.sample_sum != rs.sample_sum) ||
+            (ls.quantile.size() != rs.quantile.size())) {
+          return false;
+        }
+        for (size_t qdx = 0; qdx < ls.quantile.size(); ++qdx) {
+          if ((ls.quantile[qdx].quantile != rs.quantile[qdx].quantile) ||
+              (ls.quantile[qdx].value != rs.quantile[qdx].value)) {
+            return false;
+          }
+        }
+        break;
+      }
+      case prometheus::MetricType::Histogram: {
+        const auto& lh = lm.histogram;
+        const auto& rh = rm.histogram;
+        if ((lh.sample_count != rh.sample_count) ||
+            (lh.sample_sum != rh.sample_sum) ||
+            (lh.bucket.size() != rh.bucket.size())) {
+          return false;
+        }
+        for (size_t bdx = 0; bdx < lh.bucket.size(); ++bdx) {
+          if ((lh.bucket[bdx].upper_bound != rh.bucket[bdx].upper_bound) ||
+              (lh.bucket[bdx].cumulative_count !=
+               rh.bucket[bdx].cumulative_count)) {
+            return false;
+          }
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void
+AppendBinary(std::string* out, const T value)
+{
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void
+AppendBinaryString(std::string* out, const std::string& str)
+{
+  AppendBinary<uint32_t>(out, str.size());
+  out->append(str);
+}
+
+}  // namespace
+
 Metrics::Metrics()
     : registry_(std::make_shared<prometheus::Registry>()),
       serializer_(new prometheus::TextSerializer()),
@@ -122,6 +221,44 @@ Metrics::Metrics()
                     "microseconds")
               .Register(*registry_)),
 
+      // Remote model download metric families
+      model_download_files_family_(
+          prometheus::BuildCounter()
+              .Name("nv_model_download_files")
+              .Help("Number of files downloaded from remote model repositories")
+              .Register(*registry_)),
+      model_download_bytes_family_(
+          prometheus::BuildCounter()
+              .Name("nv_model_download_bytes")
+              .Help("Number of bytes downloaded from remote model repositories")
+              .Register(*registry_)),
+      model_download_duration_us_family_(
+          prometheus::BuildCounter()
+              .Name("nv_model_download_duration_us")
+              .Help("Cumulative duration of downloads from remote model "
+                    "repositories, in microseconds")
+              .Register(*registry_)),
+
+      // Model version swap metric families
+      model_version_swap_count_family_(
+          prometheus::BuildCounter()
+              .Name("nv_model_version_swap_count")
+              .Help("Number of times new model versions replaced the serving "
+                    "versions")
+              .Register(*registry_)),
+      model_version_swap_duration_us_family_(
+          prometheus::BuildCounter()
+              .Name("nv_model_version_swap_duration_us")
+              .Help("Cumulative duration from a model load request to the new "
+                    "versions serving requests, in microseconds")
+              .Register(*registry_)),
+      model_version_drain_duration_us_family_(
+          prometheus::BuildCounter()
+              .Name("nv_model_version_drain_duration_us")
+              .Help("Cumulative duration of replaced model versions draining "
+                    "before being unloaded, in microseconds")
+              .Register(*registry_)),
+
       // Summaries
       inf_request_summary_us_family_(
           prometheus::BuildSummary()
@@ -168,6 +305,86 @@ Metrics::Metrics()
                     "microseconds.")
               .Register(*registry_)),
 
+      // Histograms
+      inf_request_histogram_us_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_inference_request_histogram_us")
+              .Help("Histogram of inference request duration in microseconds "
+                    "(includes cached requests)")
+              .Register(*registry_)),
+      inf_queue_histogram_us_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_inference_queue_histogram_us")
+              .Help("Histogram of inference queuing duration in microseconds "
+                    "(includes cached requests)")
+              .Register(*registry_)),
+      inf_compute_input_histogram_us_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_inference_compute_input_histogram_us")
+              .Help("Histogram of compute input duration in microseconds "
+                    "(does not include cached requests)")
+              .Register(*registry_)),
+      inf_compute_infer_histogram_us_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_inference_compute_infer_histogram_us")
+              .Help("Histogram of compute inference duration in microseconds "
+                    "(does not include cached requests)")
+              .Register(*registry_)),
+      inf_compute_output_histogram_us_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_inference_compute_output_histogram_us")
+              .Help("Histogram of compute output duration in microseconds "
+                    "(does not include cached requests)")
+              .Register(*registry_)),
+      cache_hit_histogram_us_model_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_cache_hit_histogram_per_model")
+              .Help("Histogram of cache hit durations per model, in "
+                    "microseconds.")
+              .Register(*registry_)),
+      cache_miss_histogram_us_model_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_cache_miss_histogram_per_model")
+              .Help("Histogram of cache miss durations per model, in "
+                    "microseconds.")
+              .Register(*registry_)),
+
+      // Scheduler metrics
+      scheduler_queue_size_family_(
+          prometheus::BuildGauge()
+              .Name("nv_scheduler_queue_size")
+              .Help("Number of requests waiting in the scheduler queue, per "
+                    "priority level")
+              .Register(*registry_)),
+      scheduler_pending_batch_size_family_(
+          prometheus::BuildGauge()
+              .Name("nv_scheduler_pending_batch_size")
+              .Help("Batch size of the batches being formed by the dynamic "
+                    "batcher")
+              .Register(*registry_)),
+      scheduler_batches_family_(
+          prometheus::BuildCounter()
+              .Name("nv_scheduler_batches")
+              .Help("Number of batches sent by the dynamic batcher, by the "
+                    "reason the batch was sent")
+              .Register(*registry_)),
+      scheduler_rejections_family_(
+          prometheus::BuildCounter()
+              .Name("nv_scheduler_rejected_requests")
+              .Help("Number of requests rejected by the scheduler, by the "
+                    "reason of the rejection")
+              .Register(*registry_)),
+      scheduler_batch_size_family_(
+          prometheus::BuildHistogram()
+              .Name("nv_scheduler_batch_size")
+              .Help("Histogram of the batch sizes executed by the model")
+              .Register(*registry_)),
+      scheduler_sequence_backlog_family_(
+          prometheus::BuildGauge()
+              .Name("nv_scheduler_sequence_backlog")
+              .Help("Number of sequences waiting for a free sequence slot")
+              .Register(*registry_)),
+
 #ifdef TRITON_ENABLE_METRICS_GPU
       gpu_utilization_family_(prometheus::BuildGauge()
                                   .Name("nv_gpu_utilization")
@@ -213,7 +430,9 @@ Metrics::Metrics()
 #endif  // TRITON_ENABLE_METRICS_CPU
 
       metrics_enabled_(false), gpu_metrics_enabled_(false),
-      cpu_metrics_enabled_(false), metrics_interval_ms_(2000)
+      cpu_metrics_enabled_(false), metrics_interval_ms_(2000),
+      next_collect_callback_id_(0), serialization_budget_ms_(0),
+      scrape_count_(0), next_refresh_index_(0), last_serialized_size_(0)
 {
 }
 
@@ -272,6 +491,25 @@ Metrics::SetConfigMap(MetricsConfigMap cfg)
 {
   auto singleton = GetSingleton();
   singleton->config_ = cfg;
+
+  // ex: serialization_budget_ms="20"
+  uint64_t serialization_budget_ms = 0;
+  const auto global_itr = singleton->config_.find("");
+  if (global_itr != singleton->config_.end()) {
+    for (const auto& pair : global_itr->second) {
+      if (pair.first == "serialization_budget_ms") {
+        try {
+          serialization_budget_ms = std::stoull(pair.second);
+        }
+        catch (const std::exception& e) {
+          LOG_WARNING << "Ignoring invalid serialization_budget_ms '"
+                      << pair.second << "': " << e.what();
+        }
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(singleton->serialize_mu_);
+  singleton->serialization_budget_ms_ = serialization_budget_ms;
 }
 
 bool
@@ -963,8 +1201,200 @@ const std::string
 Metrics::SerializedMetrics()
 {
   auto singleton = Metrics::GetSingleton();
-  return singleton->serializer_->Serialize(
-      singleton->registry_.get()->Collect());
+  singleton->InvokeCollectCallbacks();
+  return singleton->SerializeFamilies(singleton->registry_.get()->Collect());
+}
+
+const std::string
+Metrics::SerializedMetricsBinary()
+{
+  auto singleton = Metrics::GetSingleton();
+  singleton->InvokeCollectCallbacks();
+  const auto families = singleton->registry_.get()->Collect();
+
+  std::string serialized;
+  serialized.append("TRTMETRC", 8);
+  AppendBinary<uint32_t>(&serialized, 1 /* version */);
+  const size_t family_count_offset = serialized.size();
+  AppendBinary<uint32_t>(&serialized, 0 /* family_count */);
+
+  uint32_t family_count = 0;
+  for (const auto& family : families) {
+    uint8_t type;
+    switch (family.type) {
+      case prometheus::MetricType::Counter:
+        type = 0;
+        break;
+      case prometheus::MetricType::Gauge:
+        type = 1;
+        break;
+      case prometheus::MetricType::Summary:
+        type = 2;
+        break;
+      case prometheus::MetricType::Untyped:
+        type = 3;
+        break;
+      case prometheus::MetricType::Histogram:
+        type = 4;
+        break;
+      default:
+        continue;
+    }
+    ++family_count;
+    AppendBinaryString(&serialized, family.name);
+    AppendBinary<uint8_t>(&serialized, type);
+    AppendBinary<uint32_t>(&serialized, family.metric.size());
+    for (const auto& metric : family.metric) {
+      AppendBinary<uint32_t>(&serialized, metric.label.size());
+      for (const auto& label : metric.label) {
+        AppendBinaryString(&serialized, label.name);
+        AppendBinaryString(&serialized, label.value);
+      }
+      AppendBinary<int64_t>(&serialized, metric.timestamp_ms);
+      switch (family.type) {
+        case prometheus::MetricType::Counter:
+          AppendBinary<double>(&serialized, metric.counter.value);
+          break;
+        case prometheus::MetricType::Gauge:
+          AppendBinary<double>(&serialized, metric.gauge.value);
+          break;
+        case prometheus::MetricType::Untyped:
+          AppendBinary<double>(&serialized, metric.untyped.value);
+          break;
+        case prometheus::MetricType::Summary:
+          AppendBinary<uint64_t>(&serialized, metric.summary.sample_count);
+          AppendBinary<double>(&serialized, metric.summary.sample_sum);
+          AppendBinary<uint32_t>(&serialized, metric.summary.quantile.size());
+          for (const auto& quantile : metric.summary.quantile) {
+            AppendBinary<double>(&serialized, quantile.quantile);
+            AppendBinary<double>(&serialized, quantile.value);
+          }
+          break;
+        case prometheus::MetricType::Histogram:
+          AppendBinary<uint64_t>(&serialized, metric.histogram.sample_count);
+          AppendBinary<double>(&serialized, metric.histogram.sample_sum);
+          AppendBinary<uint32_t>(&serialized, metric.histogram.bucket.size());
+          for (const auto& bucket : metric.histogram.bucket) {
+            AppendBinary<double>(&serialized, bucket.upper_bound);
+            AppendBinary<uint64_t>(&serialized, bucket.cumulative_count);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  memcpy(
+      &serialized[family_count_offset], &family_count, sizeof(family_count));
+
+  return serialized;
+}
+
+void
+Metrics::InvokeCollectCallbacks()
+{
+  std::lock_guard<std::mutex> lock(collect_callbacks_mu_);
+  for (const auto& callback : collect_callbacks_) {
+    callback.second();
+  }
+}
+
+std::string
+Metrics::SerializeFamilies(std::vector<prometheus::MetricFamily>&& families)
+{
+  std::lock_guard<std::mutex> lock(serialize_mu_);
+  const auto start = std::chrono::steady_clock::now();
+  const auto budget = std::chrono::milliseconds(serialization_budget_ms_);
+  const uint64_t scrape = ++scrape_count_;
+
+  // Start with the families left stale by the previous scrape so that
+  // every family is eventually refreshed under a tight budget.
+  const size_t family_count = families.size();
+  const size_t first =
+      (next_refresh_index_ < family_count) ? next_refresh_index_ : 0;
+  next_refresh_index_ = 0;
+
+  std::vector<const std::string*> texts(family_count, nullptr);
+  std::deque<std::string> uncached;
+  bool over_budget = false;
+  size_t stale_count = 0;
+  for (size_t count = 0; count < family_count; ++count) {
+    const size_t idx = (first + count) % family_count;
+    auto& family = families[idx];
+    auto& cached = serialized_families_[family.name];
+    if (cached.scrape_ == scrape) {
+      // Families sharing a name can not share the cache entry.
+      uncached.emplace_back(serializer_->Serialize({family}));
+      texts[idx] = &uncached.back();
+      continue;
+    }
+
+    bool reuse = false;
+    if (cached.scrape_ != 0) {
+      if (SameFamily(cached.family_, family)) {
+        reuse = true;
+      } else if (over_budget) {
+        reuse = true;
+        if (stale_count++ == 0) {
+          next_refresh_index_ = idx;
+        }
+      }
+    }
+    if (!reuse) {
+      cached.text_ = serializer_->Serialize({family});
+      cached.family_ = std::move(family);
+    }
+    cached.scrape_ = scrape;
+    texts[idx] = &cached.text_;
+
+    if (!over_budget && (serialization_budget_ms_ > 0) &&
+        ((std::chrono::steady_clock::now() - start) >= budget)) {
+      over_budget = true;
+    }
+  }
+
+  // Drop the families that are no longer registered.
+  for (auto it = serialized_families_.begin();
+       it != serialized_families_.end();) {
+    if (it->second.scrape_ != scrape) {
+      it = serialized_families_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (stale_count > 0) {
+    LOG_VERBOSE(1) << "Metrics serialization budget of "
+                   << serialization_budget_ms_ << " ms exceeded, reusing "
+                   << "the previous text of " << stale_count
+                   << " metric families";
+  }
+
+  std::string serialized;
+  serialized.reserve(last_serialized_size_);
+  for (const auto text : texts) {
+    serialized += *text;
+  }
+  last_serialized_size_ = serialized.size();
+  return serialized;
+}
+
+uint64_t
+Metrics::RegisterCollectCallback(std::function<void()> callback)
+{
+  auto singleton = Metrics::GetSingleton();
+  std::lock_guard<std::mutex> lock(singleton->collect_callbacks_mu_);
+  const uint64_t id = singleton->next_collect_callback_id_++;
+  singleton->collect_callbacks_.emplace(id, std::move(callback));
+  return id;
+}
+
+void
+Metrics::UnregisterCollectCallback(const uint64_t id)
+{
+  auto singleton = Metrics::GetSingleton();
+  std::lock_guard<std::mutex> lock(singleton->collect_callbacks_mu_);
+  singleton->collect_callbacks_.erase(id);
 }
 
 Metrics*
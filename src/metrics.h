@@ -29,11 +29,15 @@
 #ifdef TRITON_ENABLE_METRICS
 
 #include <atomic>
+#include <functional>
+#include <map>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include "cache_manager.h"
 #include "prometheus/counter.h"
 #include "prometheus/gauge.h"
+#include "prometheus/histogram.h"
 #include "prometheus/registry.h"
 #include "prometheus/serializer.h"
 #include "prometheus/summary.h"
@@ -136,9 +140,25 @@ class Metrics {
   // Get the prometheus registry
   static std::shared_ptr<prometheus::Registry> GetRegistry();
 
-  // Get serialized metrics
+  // Get serialized metrics. The text of a metric family that has not
+  // changed since the previous call is reused. When the
+  // "serialization_budget_ms" setting of the global metrics config is
+  // exceeded the previous text of the remaining changed families is
+  // reused, those families are serialized first by the next call.
   static const std::string SerializedMetrics();
 
+  // Get the metrics in the compact binary format described for
+  // TRITONSERVER_METRIC_BINARY.
+  static const std::string SerializedMetricsBinary();
+
+  // Register a callback that is invoked before metrics are collected
+  // for serialization, so that metrics accumulated outside of the
+  // prometheus registry can be published. Returns an id that must be
+  // passed to UnregisterCollectCallback before the callback becomes
+  // invalid.
+  static uint64_t RegisterCollectCallback(std::function<void()> callback);
+  static void UnregisterCollectCallback(const uint64_t id);
+
   // Get the UUID for a CUDA device. Return true and initialize 'uuid'
   // if a UUID is found, return false if a UUID cannot be returned.
   static bool UUIDForCudaDevice(int cuda_device, std::string* uuid);
@@ -221,6 +241,38 @@ class Metrics {
     return GetSingleton()->cache_miss_duration_us_model_family_;
   }
 
+  // Metric families of the downloads from remote model repositories, the
+  // download throughput is the rate of bytes over the rate of duration.
+  static prometheus::Family<prometheus::Counter>& FamilyModelDownloadFiles()
+  {
+    return GetSingleton()->model_download_files_family_;
+  }
+  static prometheus::Family<prometheus::Counter>& FamilyModelDownloadBytes()
+  {
+    return GetSingleton()->model_download_bytes_family_;
+  }
+  static prometheus::Family<prometheus::Counter>& FamilyModelDownloadDuration()
+  {
+    return GetSingleton()->model_download_duration_us_family_;
+  }
+
+  // Metric families of the model version swaps, the swap duration is from
+  // the load request to the new versions serving requests.
+  static prometheus::Family<prometheus::Counter>& FamilyModelVersionSwapCount()
+  {
+    return GetSingleton()->model_version_swap_count_family_;
+  }
+  static prometheus::Family<prometheus::Counter>&
+  FamilyModelVersionSwapDuration()
+  {
+    return GetSingleton()->model_version_swap_duration_us_family_;
+  }
+  static prometheus::Family<prometheus::Counter>&
+  FamilyModelVersionDrainDuration()
+  {
+    return GetSingleton()->model_version_drain_duration_us_family_;
+  }
+
   // Summaries
   static prometheus::Family<prometheus::Summary>&
   FamilyInferenceRequestSummary()
@@ -255,6 +307,70 @@ class Metrics {
     return GetSingleton()->cache_miss_summary_us_model_family_;
   }
 
+  // Histograms
+  static prometheus::Family<prometheus::Histogram>&
+  FamilyInferenceRequestHistogram()
+  {
+    return GetSingleton()->inf_request_histogram_us_family_;
+  }
+  static prometheus::Family<prometheus::Histogram>&
+  FamilyInferenceQueueHistogram()
+  {
+    return GetSingleton()->inf_queue_histogram_us_family_;
+  }
+  static prometheus::Family<prometheus::Histogram>&
+  FamilyInferenceComputeInputHistogram()
+  {
+    return GetSingleton()->inf_compute_input_histogram_us_family_;
+  }
+  static prometheus::Family<prometheus::Histogram>&
+  FamilyInferenceComputeInferHistogram()
+  {
+    return GetSingleton()->inf_compute_infer_histogram_us_family_;
+  }
+  static prometheus::Family<prometheus::Histogram>&
+  FamilyInferenceComputeOutputHistogram()
+  {
+    return GetSingleton()->inf_compute_output_histogram_us_family_;
+  }
+  static prometheus::Family<prometheus::Histogram>& FamilyCacheHitHistogram()
+  {
+    return GetSingleton()->cache_hit_histogram_us_model_family_;
+  }
+  static prometheus::Family<prometheus::Histogram>& FamilyCacheMissHistogram()
+  {
+    return GetSingleton()->cache_miss_histogram_us_model_family_;
+  }
+
+  // Scheduler metrics
+  static prometheus::Family<prometheus::Gauge>& FamilySchedulerQueueSize()
+  {
+    return GetSingleton()->scheduler_queue_size_family_;
+  }
+  static prometheus::Family<prometheus::Gauge>&
+  FamilySchedulerPendingBatchSize()
+  {
+    return GetSingleton()->scheduler_pending_batch_size_family_;
+  }
+  static prometheus::Family<prometheus::Counter>& FamilySchedulerBatches()
+  {
+    return GetSingleton()->scheduler_batches_family_;
+  }
+  static prometheus::Family<prometheus::Counter>& FamilySchedulerRejections()
+  {
+    return GetSingleton()->scheduler_rejections_family_;
+  }
+  static prometheus::Family<prometheus::Histogram>&
+  FamilySchedulerBatchSize()
+  {
+    return GetSingleton()->scheduler_batch_size_family_;
+  }
+  static prometheus::Family<prometheus::Gauge>&
+  FamilySchedulerSequenceBacklog()
+  {
+    return GetSingleton()->scheduler_sequence_backlog_family_;
+  }
+
  private:
   Metrics();
   virtual ~Metrics();
@@ -268,6 +384,18 @@ class Metrics {
   std::string dcgmValueToErrorMessage(double val);
   std::string dcgmValueToErrorMessage(int64_t val);
 
+  // A metric family and its text as of the scrape that last
+  // serialized it.
+  struct SerializedFamily {
+    prometheus::MetricFamily family_;
+    std::string text_;
+    uint64_t scrape_ = 0;
+  };
+
+  void InvokeCollectCallbacks();
+  std::string SerializeFamilies(
+      std::vector<prometheus::MetricFamily>&& families);
+
   std::shared_ptr<prometheus::Registry> registry_;
   std::unique_ptr<prometheus::Serializer> serializer_;
 
@@ -294,6 +422,18 @@ class Metrics {
   prometheus::Family<prometheus::Counter>& cache_num_misses_model_family_;
   prometheus::Family<prometheus::Counter>& cache_miss_duration_us_model_family_;
 
+  // Remote model download metrics
+  prometheus::Family<prometheus::Counter>& model_download_files_family_;
+  prometheus::Family<prometheus::Counter>& model_download_bytes_family_;
+  prometheus::Family<prometheus::Counter>& model_download_duration_us_family_;
+
+  // Model version swap metrics
+  prometheus::Family<prometheus::Counter>& model_version_swap_count_family_;
+  prometheus::Family<prometheus::Counter>&
+      model_version_swap_duration_us_family_;
+  prometheus::Family<prometheus::Counter>&
+      model_version_drain_duration_us_family_;
+
   // Summaries
   prometheus::Family<prometheus::Summary>& inf_request_summary_us_family_;
   prometheus::Family<prometheus::Summary>& inf_queue_summary_us_family_;
@@ -304,6 +444,28 @@ class Metrics {
   prometheus::Family<prometheus::Summary>& cache_hit_summary_us_model_family_;
   prometheus::Family<prometheus::Summary>& cache_miss_summary_us_model_family_;
 
+  // Histograms
+  prometheus::Family<prometheus::Histogram>& inf_request_histogram_us_family_;
+  prometheus::Family<prometheus::Histogram>& inf_queue_histogram_us_family_;
+  prometheus::Family<prometheus::Histogram>&
+      inf_compute_input_histogram_us_family_;
+  prometheus::Family<prometheus::Histogram>&
+      inf_compute_infer_histogram_us_family_;
+  prometheus::Family<prometheus::Histogram>&
+      inf_compute_output_histogram_us_family_;
+  prometheus::Family<prometheus::Histogram>&
+      cache_hit_histogram_us_model_family_;
+  prometheus::Family<prometheus::Histogram>&
+      cache_miss_histogram_us_model_family_;
+
+  // Scheduler metrics
+  prometheus::Family<prometheus::Gauge>& scheduler_queue_size_family_;
+  prometheus::Family<prometheus::Gauge>& scheduler_pending_batch_size_family_;
+  prometheus::Family<prometheus::Counter>& scheduler_batches_family_;
+  prometheus::Family<prometheus::Counter>& scheduler_rejections_family_;
+  prometheus::Family<prometheus::Histogram>& scheduler_batch_size_family_;
+  prometheus::Family<prometheus::Gauge>& scheduler_sequence_backlog_family_;
+
 #ifdef TRITON_ENABLE_METRICS_GPU
   prometheus::Family<prometheus::Gauge>& gpu_utilization_family_;
   prometheus::Family<prometheus::Gauge>& gpu_memory_total_family_;
@@ -351,6 +513,18 @@ class Metrics {
   std::mutex poll_thread_starting_;
   uint64_t metrics_interval_ms_;
   MetricsConfigMap config_;
+
+  std::mutex collect_callbacks_mu_;
+  uint64_t next_collect_callback_id_;
+  std::map<uint64_t, std::function<void()>> collect_callbacks_;
+
+  // Serialization cache, keyed by family name.
+  std::mutex serialize_mu_;
+  uint64_t serialization_budget_ms_;
+  uint64_t scrape_count_;
+  size_t next_refresh_index_;
+  size_t last_serialized_size_;
+  std::unordered_map<std::string, SerializedFamily> serialized_families_;
 };
 
 }}  // namespace triton::core
@@ -72,6 +72,10 @@ Model::SetModelConfig(const inference::ModelConfig& config)
   config_ = config;
   set_model_config_ = true;
 
+  // Requests normalized against the previous configuration may not be
+  // valid for the new one.
+  normalize_cache_.Clear();
+
   return Status::Success;
 }
 
@@ -99,6 +103,8 @@ Model::Init(const bool is_config_provided)
   RETURN_IF_ERROR(ValidateModelConfig(config_, min_compute_capability_));
   RETURN_IF_ERROR(ValidateModelIOConfig(config_));
 
+  normalize_cache_.Clear();
+
   // Initialize the input map
   for (const auto& io : config_.input()) {
     input_map_.insert(std::make_pair(io.name(), io));
@@ -28,6 +28,7 @@
 #include "infer_stats.h"
 #include "label_provider.h"
 #include "model_config.pb.h"
+#include "normalize_cache.h"
 #include "scheduler.h"
 #include "status.h"
 
@@ -154,6 +155,9 @@ class Model {
   Status GetOutput(
       const std::string& name, const inference::ModelOutput** output) const;
 
+  // Get the cache of request normalization results for the model.
+  NormalizeCache* MutableNormalizeCache() { return &normalize_cache_; }
+
   // Get a label provider for the model.
   const std::shared_ptr<LabelProvider>& GetLabelProvider() const
   {
@@ -172,6 +176,14 @@ class Model {
     return scheduler_->Enqueue(request);
   }
 
+  // Enqueue a batch of requests for execution. The model always takes
+  // ownership of all 'requests', a request that cannot be enqueued is
+  // completed with an error response and released.
+  void EnqueueBatch(std::vector<std::unique_ptr<InferenceRequest>>& requests)
+  {
+    scheduler_->EnqueueBatch(requests);
+  }
+
   // Return the number of in-flight inferences.
   size_t InflightInferenceCount()
   {
@@ -212,6 +224,9 @@ class Model {
   // Label provider for this model.
   std::shared_ptr<LabelProvider> label_provider_;
 
+  // Results of normalizing requests against 'config_'.
+  NormalizeCache normalize_cache_;
+
   size_t required_input_count_;
 
   // Map from input name to the model configuration for that input.
@@ -0,0 +1,273 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "model_demand_loader.h"
+
+#include <chrono>
+#include "model_repository_manager.h"
+#include "triton/common/logging.h"
+
+namespace triton { namespace core {
+
+Status
+ModelDemandLoader::Create(
+    ModelRepositoryManager* manager, const uint32_t max_loaded_models,
+    const uint32_t max_pending_requests, const ModelEvictionPolicy policy,
+    std::unique_ptr<ModelDemandLoader>* loader)
+{
+  loader->reset(new ModelDemandLoader(
+      manager, max_loaded_models, max_pending_requests, policy));
+  return Status::Success;
+}
+
+ModelDemandLoader::ModelDemandLoader(
+    ModelRepositoryManager* manager, const uint32_t max_loaded_models,
+    const uint32_t max_pending_requests, const ModelEvictionPolicy policy)
+    : manager_(manager), max_loaded_models_(max_loaded_models),
+      max_pending_requests_(max_pending_requests), policy_(policy),
+      pending_requests_(0)
+{
+}
+
+Status
+ModelDemandLoader::GetModel(
+    const std::string& model_name, const int64_t model_version,
+    std::shared_ptr<Model>* model)
+{
+  Status status = manager_->GetModel(model_name, model_version, model);
+  if (status.IsOk()) {
+    RecordUse(model_name);
+    return status;
+  }
+
+  // Only load the model if no version of it is being served, otherwise
+  // the failure is specific to the requested version.
+  for (const auto& version_state : manager_->VersionStates(model_name)) {
+    const ModelReadyState state = version_state.second.first;
+    if ((state == ModelReadyState::READY) ||
+        (state == ModelReadyState::LOADING)) {
+      return status;
+    }
+  }
+
+  RETURN_IF_ERROR(Load(model_name));
+  RETURN_IF_ERROR(manager_->GetModel(model_name, model_version, model));
+  RecordUse(model_name);
+  return Status::Success;
+}
+
+void
+ModelDemandLoader::RecordUse(const std::string& model_name)
+{
+  const uint64_t now_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+
+  std::lock_guard<std::mutex> lk(mu_);
+  auto& usage = usage_[model_name];
+  usage.last_use_ns_ = now_ns;
+  ++usage.use_count_;
+}
+
+Status
+ModelDemandLoader::Load(const std::string& model_name)
+{
+  std::shared_ptr<PendingLoad> load;
+  bool leader = false;
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    if ((max_pending_requests_ != 0) &&
+        (pending_requests_ >= max_pending_requests_)) {
+      return Status(
+          Status::Code::UNAVAILABLE,
+          "Request for model '" + model_name +
+              "' rejected, too many requests are waiting for models to load");
+    }
+
+    auto it = loads_.find(model_name);
+    if (it == loads_.end()) {
+      load = std::make_shared<PendingLoad>();
+      loads_.emplace(model_name, load);
+      leader = true;
+    } else {
+      load = it->second;
+    }
+
+    ++pending_requests_;
+    if (!leader) {
+      cv_.wait(lk, [&load] { return load->done_; });
+      --pending_requests_;
+      return load->status_;
+    }
+  }
+
+  // Don't unload other models for a model that can't be loaded.
+  Status status = CheckInRepository(model_name);
+  if (status.IsOk()) {
+    LOG_VERBOSE(1) << "loading '" << model_name << "' on demand";
+    Reserve(model_name, load.get());
+    status = manager_->LoadUnloadModel(
+        {{model_name, {}}}, ActionType::LOAD, false /* unload_dependents */);
+    if (!status.IsOk()) {
+      status = Status(
+          status.ErrorCode(), "failed to load '" + model_name +
+                                  "' on demand: " + status.Message());
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    // Track the model from now on so that it counts toward the budget
+    // of the loads reserving after this one.
+    if (status.IsOk()) {
+      usage_[model_name];
+    }
+    load->done_ = true;
+    load->status_ = status;
+    loads_.erase(model_name);
+    --pending_requests_;
+  }
+  cv_.notify_all();
+
+  return status;
+}
+
+Status
+ModelDemandLoader::CheckInRepository(const std::string& model_name)
+{
+  std::vector<ModelRepositoryManager::ModelIndex> index;
+  RETURN_IF_ERROR(manager_->RepositoryIndex(false /* ready_only */, &index));
+  for (const auto& entry : index) {
+    if (entry.name_ == model_name) {
+      return Status::Success;
+    }
+  }
+  return Status(
+      Status::Code::NOT_FOUND,
+      "Request for unknown model: '" + model_name + "' is not found");
+}
+
+void
+ModelDemandLoader::Reserve(const std::string& model_name, PendingLoad* load)
+{
+  if (max_loaded_models_ == 0) {
+    return;
+  }
+
+  while (true) {
+    std::string victim;
+    {
+      // The model states are read under the lock, so that a load
+      // completing meanwhile is either still admitted or already
+      // tracked as ready, and the budget check and the admission are
+      // atomic with respect to other loads.
+      std::lock_guard<std::mutex> lk(mu_);
+      std::set<std::string> ready_models;
+      for (const auto& model_state : manager_->LiveModelStates(true)) {
+        ready_models.insert(model_state.first.name_);
+      }
+      std::set<std::string> busy_models;
+      for (const auto& inflight : manager_->InflightStatus()) {
+        if (std::get<2>(inflight) > 0) {
+          busy_models.insert(std::get<0>(inflight).name_);
+        }
+      }
+
+      std::set<std::string> occupying;
+      const Usage* victim_usage = nullptr;
+      for (auto it = usage_.begin(); it != usage_.end();) {
+        const bool loading = (loads_.find(it->first) != loads_.end());
+        if (ready_models.find(it->first) == ready_models.end()) {
+          // Forget models unloaded by other means.
+          if (loading) {
+            ++it;
+          } else {
+            it = usage_.erase(it);
+          }
+          continue;
+        }
+
+        if (it->first != model_name) {
+          occupying.insert(it->first);
+          if (!loading && (busy_models.find(it->first) == busy_models.end()) &&
+              (evicting_.find(it->first) == evicting_.end())) {
+            const Usage& usage = it->second;
+            bool better = (victim_usage == nullptr);
+            if (!better && (policy_ == ModelEvictionPolicy::LFU) &&
+                (usage.use_count_ != victim_usage->use_count_)) {
+              better = (usage.use_count_ < victim_usage->use_count_);
+            } else if (!better) {
+              better = (usage.last_use_ns_ < victim_usage->last_use_ns_);
+            }
+            if (better) {
+              victim = it->first;
+              victim_usage = &usage;
+            }
+          }
+        }
+        ++it;
+      }
+      for (const auto& other : loads_) {
+        if ((other.first != model_name) && other.second->admitted_) {
+          occupying.insert(other.first);
+        }
+      }
+
+      if (occupying.size() < max_loaded_models_) {
+        load->admitted_ = true;
+        return;
+      }
+      if (victim.empty()) {
+        LOG_WARNING << "no idle model can be unloaded to load '" << model_name
+                    << "' within the budget of " << max_loaded_models_
+                    << " models";
+        load->admitted_ = true;
+        return;
+      }
+      evicting_.insert(victim);
+    }
+
+    LOG_VERBOSE(1) << "unloading '" << victim << "' to load '" << model_name
+                   << "' on demand";
+    Status status = manager_->LoadUnloadModel(
+        {{victim, {}}}, ActionType::UNLOAD, false /* unload_dependents */);
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      evicting_.erase(victim);
+      usage_.erase(victim);
+    }
+    if (!status.IsOk()) {
+      LOG_WARNING << "failed to unload '" << victim
+                  << "': " << status.Message();
+      std::lock_guard<std::mutex> lk(mu_);
+      load->admitted_ = true;
+      return;
+    }
+  }
+}
+
+}}  // namespace triton::core
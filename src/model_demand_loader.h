@@ -0,0 +1,124 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "constants.h"
+#include "status.h"
+
+namespace triton { namespace core {
+
+class Model;
+class ModelRepositoryManager;
+
+// Policy used to select the model to unload when the number of models
+// loaded on demand exceeds its budget.
+enum class ModelEvictionPolicy { LRU, LFU };
+
+//
+// Loads models on demand when an inference request targets a model
+// that is present in the model repository but not loaded, and unloads
+// idle models to keep the number of models served for inference within
+// a budget. Concurrent requests for a model being loaded wait for the
+// same load, up to a bounded number of waiting requests.
+//
+// Only models that received inference requests through the loader
+// count toward the budget and are candidates for eviction, so models
+// loaded explicitly and never targeted directly, for example the
+// composing models of an ensemble, are left untouched.
+//
+class ModelDemandLoader {
+ public:
+  // Create a loader for the models of 'manager'. 'max_loaded_models'
+  // is the budget of loaded models, 0 for no limit, and
+  // 'max_pending_requests' the maximum number of requests waiting for
+  // a model to load, 0 for no limit.
+  static Status Create(
+      ModelRepositoryManager* manager, const uint32_t max_loaded_models,
+      const uint32_t max_pending_requests, const ModelEvictionPolicy policy,
+      std::unique_ptr<ModelDemandLoader>* loader);
+
+  // Return the requested model, loading it first if it is not loaded.
+  // Blocks until the load completes.
+  Status GetModel(
+      const std::string& model_name, const int64_t model_version,
+      std::shared_ptr<Model>* model);
+
+ private:
+  // A load in progress, shared by the requests waiting for it.
+  struct PendingLoad {
+    PendingLoad() : admitted_(false), done_(false) {}
+    // Whether the load holds a place in the budget.
+    bool admitted_;
+    bool done_;
+    Status status_;
+  };
+
+  // Usage of a model that received inference requests.
+  struct Usage {
+    Usage() : last_use_ns_(0), use_count_(0) {}
+    uint64_t last_use_ns_;
+    uint64_t use_count_;
+  };
+
+  DISALLOW_COPY_AND_ASSIGN(ModelDemandLoader);
+  ModelDemandLoader(
+      ModelRepositoryManager* manager, const uint32_t max_loaded_models,
+      const uint32_t max_pending_requests, const ModelEvictionPolicy policy);
+
+  void RecordUse(const std::string& model_name);
+  Status Load(const std::string& model_name);
+
+  // Return NOT_FOUND if 'model_name' is not in the model repository.
+  Status CheckInRepository(const std::string& model_name);
+
+  // Unload the least valuable idle models, according to the policy,
+  // until loading 'model_name' keeps the loaded models within the
+  // budget, and admit 'load' into the budget. Models with inference
+  // requests in flight are never unloaded.
+  void Reserve(const std::string& model_name, PendingLoad* load);
+
+  ModelRepositoryManager* manager_;
+  const uint32_t max_loaded_models_;
+  const uint32_t max_pending_requests_;
+  const ModelEvictionPolicy policy_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::unordered_map<std::string, Usage> usage_;
+  std::unordered_map<std::string, std::shared_ptr<PendingLoad>> loads_;
+  // The models being unloaded to make room for a load.
+  std::set<std::string> evicting_;
+  uint32_t pending_requests_;
+};
+
+}}  // namespace triton::core
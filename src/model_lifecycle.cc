@@ -44,6 +44,9 @@
 #ifdef TRITON_ENABLE_ENSEMBLE
 #include "ensemble_model.h"
 #endif  // TRITON_ENABLE_ENSEMBLE
+#ifdef TRITON_ENABLE_METRICS
+#include "metrics.h"
+#endif  // TRITON_ENABLE_METRICS
 #include "server.h"
 
 namespace triton { namespace core {
@@ -80,6 +83,12 @@ ModelReadyStateString(ModelReadyState state)
 
 namespace {
 
+// Interval to check whether the draining versions can be unloaded
+constexpr std::chrono::milliseconds kDrainPollInterval(100);
+
+// Model config parameter declaring the host memory used to load the model
+constexpr char kLoadMemoryByteSizeParameter[] = "TRITON_LOAD_MEMORY_BYTE_SIZE";
+
 Status
 VersionsToLoad(
     const std::string model_path, const ModelIdentifier& model_id,
@@ -365,7 +374,9 @@ ModelLifeCycle::GetModel(
     }
   } else {
     std::lock_guard<std::mutex> lock(vit->second->mtx_);
-    if (vit->second->state_ == ModelReadyState::READY) {
+    // A draining version still serves the requests naming it.
+    if ((vit->second->state_ == ModelReadyState::READY) ||
+        vit->second->draining_) {
       *model = vit->second->model_;
     } else {
       return Status(
@@ -400,7 +411,8 @@ ModelLifeCycle::AsyncUnload(const ModelIdentifier& model_id)
     // Unload serving model, for model that is in LOADING state,
     // the updated timestamp will be recognized that there is newer update
     // on the model info and the load should be aborted
-    if (model_info->state_ == ModelReadyState::READY) {
+    if ((model_info->state_ == ModelReadyState::READY) ||
+        model_info->draining_) {
       if (model_info->agent_model_list_ != nullptr) {
         // Only log the error because the model should be unloaded regardless
         auto status = model_info->agent_model_list_->InvokeAgentModels(
@@ -475,6 +487,12 @@ ModelLifeCycle::AsyncLoad(
       // Otherwise, swap and monitor state for newly loading model.
       auto& serving_model = res.first->second;
       std::lock_guard<std::mutex> lock(serving_model->mtx_);
+      // The version is requested again, so it should no longer drain.
+      if (serving_model->draining_) {
+        serving_model->draining_ = false;
+        serving_model->state_ = ModelReadyState::READY;
+        serving_model->state_reason_.clear();
+      }
       if (serving_model->state_ == ModelReadyState::READY) {
         // The model is currently being served. Check if the model load could
         // be completed with a simple config update.
@@ -515,10 +533,20 @@ ModelLifeCycle::AsyncLoad(
       }
     }
 
-    // Load model asynchronously via thread pool
+    // Load model asynchronously via thread pool, once the load fits in
+    // the memory budget. Ensembles don't load anything themselves.
     load_pool_->Enqueue([this, model_id, version, model_info, OnComplete,
                          load_tracker, is_config_provided]() {
+      std::unique_ptr<LoadAdmission::Ticket> ticket;
+      if ((load_admission_ != nullptr) && !model_info->is_ensemble_) {
+        ticket = load_admission_->Admit(
+            model_id.str() + ":" + std::to_string(version),
+            LoadByteSize(model_id, version, model_info));
+      }
       CreateModel(model_id, version, model_info, is_config_provided);
+      if (ticket != nullptr) {
+        load_admission_->Release(std::move(ticket));
+      }
       OnLoadComplete(
           model_id, version, model_info, false /* is_update */, OnComplete,
           load_tracker);
@@ -752,12 +780,33 @@ ModelLifeCycle::OnLoadFinal(
     }
     LOG_INFO << "failed to load '" << model_id << "'";
   } else {
+    const uint64_t now_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    bool swapped = false;
+    bool draining = false;
+
     // Unload any previous loaded versions that are still available
     for (auto& version_info : it->second) {
       auto& mi = version_info.second;
       std::lock_guard<std::mutex> info_lk(mi->mtx_);
       if (mi->state_ == ModelReadyState::READY &&
           mi->last_update_ns_ < load_tracker->last_update_ns_) {
+        swapped = true;
+        // In swap mode a version that is not reloaded drains before it is
+        // unloaded. A reloaded version is replaced by its new load below,
+        // its in-flight inferences still complete on the previous model.
+        if (version_swap_enabled_ &&
+            (load_tracker->load_set_.count(version_info.first) == 0)) {
+          // The version is reported unavailable while it drains.
+          mi->draining_ = true;
+          mi->drain_start_ns_ = now_ns;
+          mi->state_ = ModelReadyState::UNAVAILABLE;
+          mi->state_reason_ = "draining";
+          draining = true;
+          continue;
+        }
         if (mi->agent_model_list_ != nullptr) {
           auto status = mi->agent_model_list_->InvokeAgentModels(
               TRITONREPOAGENT_ACTION_UNLOAD);
@@ -783,6 +832,7 @@ ModelLifeCycle::OnLoadFinal(
       // Check if the version model is loaded in background, if so,
       // replace and unload the current serving version
       if (bit != background_models_.end()) {
+        swapped = true;
         auto vit = it->second.find(loaded.first);
 
         // Need to lock the previous model info for in case the model is
@@ -813,6 +863,30 @@ ModelLifeCycle::OnLoadFinal(
       }
     }
     LOG_INFO << "successfully loaded '" << model_id << "'";
+
+    // Requests for the latest version are served by the new versions from
+    // here, report how long it took since the load was requested.
+    if (swapped) {
+      const uint64_t swap_ns = now_ns - load_tracker->last_update_ns_;
+      LOG_VERBOSE(1) << "swapped '" << model_id << "' to the new version(s) in "
+                     << (swap_ns / 1000000) << " ms";
+#ifdef TRITON_ENABLE_METRICS
+      if (Metrics::Enabled()) {
+        const std::map<std::string, std::string> labels{
+            {"model", model_id.str()}};
+        Metrics::FamilyModelVersionSwapCount().Add(labels).Increment(1);
+        Metrics::FamilyModelVersionSwapDuration().Add(labels).Increment(
+            swap_ns / 1000);
+      }
+#endif  // TRITON_ENABLE_METRICS
+    }
+    if (draining) {
+      {
+        std::lock_guard<std::mutex> lk(drain_mtx_);
+        drain_pending_ = true;
+      }
+      drain_cv_.notify_all();
+    }
   }
 
   if (OnComplete) {
@@ -823,4 +897,122 @@ ModelLifeCycle::OnLoadFinal(
   }
 }
 
+uint64_t
+ModelLifeCycle::LoadByteSize(
+    const ModelIdentifier& model_id, const int64_t version,
+    const ModelInfo* model_info)
+{
+  const auto& parameters = model_info->model_config_.parameters();
+  const auto it = parameters.find(kLoadMemoryByteSizeParameter);
+  if (it != parameters.end()) {
+    // std::stoull accepts a sign and wraps a negative value around, so
+    // only plain digits are a byte size.
+    const auto& value = it->second.string_value();
+    if (!value.empty() &&
+        (value.find_first_not_of("0123456789") == std::string::npos)) {
+      try {
+        return std::stoull(value);
+      }
+      catch (...) {
+      }
+    }
+    LOG_WARNING << "ignoring invalid " << kLoadMemoryByteSizeParameter
+                << " of '" << model_id << "': " << value;
+  }
+
+  const uint64_t learned_byte_size = load_admission_->LearnedByteSize(
+      model_id.str() + ":" + std::to_string(version));
+  if (learned_byte_size != 0) {
+    return learned_byte_size;
+  }
+
+  // Only the local model files can be measured without fetching them.
+  FileSystemType type;
+  uint64_t byte_size = 0;
+  if (GetFileSystemType(model_info->model_path_, &type).IsOk() &&
+      (type == FileSystemType::LOCAL)) {
+    const auto status = LocalDirectoryByteSize(
+        JoinPath({model_info->model_path_, std::to_string(version)}),
+        &byte_size);
+    if (!status.IsOk()) {
+      LOG_VERBOSE(1) << "failed to measure '" << model_id << "' version "
+                     << version << ": " << status.AsString();
+    }
+  }
+  return byte_size;
+}
+
+bool
+ModelLifeCycle::ReleaseDrainedVersions()
+{
+  const uint64_t now_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  bool draining = false;
+
+  std::lock_guard<std::mutex> map_lock(map_mtx_);
+  for (auto& model_version : map_) {
+    for (auto& version_model : model_version.second) {
+      auto& mi = version_model.second;
+      std::lock_guard<std::mutex> lock(mi->mtx_);
+      if (!mi->draining_) {
+        continue;
+      }
+      const uint64_t drain_ns = now_ns - mi->drain_start_ns_;
+      const bool timed_out = (drain_ns >= version_drain_timeout_ns_);
+      if (!timed_out && (mi->model_ != nullptr) &&
+          (mi->model_->InflightInferenceCount() != 0)) {
+        draining = true;
+        continue;
+      }
+
+      LOG_INFO << "drained '" << model_version.first << "' version "
+               << version_model.first << " in " << (drain_ns / 1000000)
+               << " ms" << (timed_out ? " (timed out)" : "");
+#ifdef TRITON_ENABLE_METRICS
+      if (Metrics::Enabled()) {
+        Metrics::FamilyModelVersionDrainDuration()
+            .Add({{"model", model_version.first.str()}})
+            .Increment(drain_ns / 1000);
+      }
+#endif  // TRITON_ENABLE_METRICS
+
+      if (mi->agent_model_list_ != nullptr) {
+        auto status = mi->agent_model_list_->InvokeAgentModels(
+            TRITONREPOAGENT_ACTION_UNLOAD);
+        if (!status.IsOk()) {
+          LOG_ERROR << "Agent model returns error on "
+                       "TRITONREPOAGENT_ACTION_UNLOAD: "
+                    << status.AsString();
+        }
+      }
+      mi->Release();
+    }
+  }
+
+  return draining;
+}
+
+void
+ModelLifeCycle::DrainThread()
+{
+  std::unique_lock<std::mutex> lk(drain_mtx_);
+  while (true) {
+    drain_cv_.wait(lk, [this] { return drain_pending_ || drain_exit_; });
+    if (drain_exit_) {
+      break;
+    }
+    drain_pending_ = false;
+    lk.unlock();
+    const bool draining = ReleaseDrainedVersions();
+    lk.lock();
+    if (draining) {
+      drain_cv_.wait_for(
+          lk, kDrainPollInterval, [this] { return drain_exit_; });
+      drain_pending_ = true;
+    }
+  }
+}
+
 }}  // namespace triton::core
@@ -26,11 +26,14 @@
 //
 #pragma once
 
+#include <condition_variable>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <mutex>
+#include <thread>
 #include "infer_parameter.h"
+#include "load_admission.h"
 #include "model.h"
 #include "model_config.pb.h"
 #include "repo_agent.h"
@@ -44,11 +47,16 @@ struct ModelLifeCycleOptions {
       const double min_compute_capability,
       const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
       const triton::common::HostPolicyCmdlineConfigMap& host_policy_map,
-      const unsigned int model_load_thread_count)
+      const unsigned int model_load_thread_count,
+      const bool version_swap_enabled, const uint64_t version_drain_timeout_ms,
+      const uint64_t model_load_memory_budget)
       : min_compute_capability_(min_compute_capability),
         backend_cmdline_config_map_(backend_cmdline_config_map),
         host_policy_map_(host_policy_map),
-        model_load_thread_count_(model_load_thread_count)
+        model_load_thread_count_(model_load_thread_count),
+        version_swap_enabled_(version_swap_enabled),
+        version_drain_timeout_ms_(version_drain_timeout_ms),
+        model_load_memory_budget_(model_load_memory_budget)
   {
   }
   // The minimum supported CUDA compute capability.
@@ -59,6 +67,13 @@ struct ModelLifeCycleOptions {
   const triton::common::HostPolicyCmdlineConfigMap& host_policy_map_;
   // Number of the threads to use for concurrently loading models
   const unsigned int model_load_thread_count_;
+  // Whether the versions replaced by a load are drained before they are
+  // unloaded, and the longest time to wait for a version to drain.
+  const bool version_swap_enabled_;
+  const uint64_t version_drain_timeout_ms_;
+  // The host memory that the models being loaded concurrently may use,
+  // 0 if loads are only limited by 'model_load_thread_count_'.
+  const uint64_t model_load_memory_budget_;
 };
 
 
@@ -171,9 +186,20 @@ class ModelLifeCycle {
     // Explicitly clean up thread pool first to clean up any pending callbacks
     // that may modify model lifecycle members
     load_pool_.reset();
+    if (drain_thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lk(drain_mtx_);
+        drain_exit_ = true;
+      }
+      drain_cv_.notify_all();
+      drain_thread_.join();
+    }
     map_.clear();
   }
 
+  // Return the number of models that can be loaded concurrently.
+  unsigned int LoadThreadCount() const { return load_thread_count_; }
+
   // Start loading model with specified versions asynchronously.
   // All versions that are being served will be unloaded only after
   // the load is finished sucessfully.
@@ -188,8 +214,9 @@ class ModelLifeCycle {
   Status AsyncUnload(const ModelIdentifier& model_id);
 
   // Get specified version of the model. Latest ready version will
-  // be retrieved if 'version' is -1. Return error if the version specified is
-  // not found or it is not ready.
+  // be retrieved if 'version' is -1, versions being drained are only
+  // retrieved when requested explicitly. Return error if the version
+  // specified is not found or it is not ready.
   Status GetModel(
       const ModelIdentifier& model_id, const int64_t version,
       std::shared_ptr<Model>* model);
@@ -230,7 +257,8 @@ class ModelLifeCycle {
 #else
           is_ensemble_(false),
 #endif  // TRITON_ENABLE_ENSEMBLE
-          last_update_ns_(last_update_ns), state_(ModelReadyState::UNKNOWN)
+          last_update_ns_(last_update_ns), state_(ModelReadyState::UNKNOWN),
+          draining_(false), drain_start_ns_(0)
     {
     }
 
@@ -241,6 +269,7 @@ class ModelLifeCycle {
     {
       state_ = ModelReadyState::UNLOADING;
       state_reason_.clear();
+      draining_ = false;
       agent_model_list_.reset();
       model_.reset();
     }
@@ -256,6 +285,13 @@ class ModelLifeCycle {
     ModelReadyState state_;
     std::string state_reason_;
 
+    // Whether the version has been replaced by a load and is waiting for
+    // its in-flight inferences to complete before it is unloaded. A
+    // draining version is UNAVAILABLE with reason "draining" but still
+    // serves the requests naming it.
+    bool draining_;
+    uint64_t drain_start_ns_;
+
     // flyweight
     std::shared_ptr<TritonRepoAgentModelList> agent_model_list_;
     std::shared_ptr<Model> model_;
@@ -285,10 +321,20 @@ class ModelLifeCycle {
       : server_(server),
         min_compute_capability_(options.min_compute_capability_),
         cmdline_config_map_(options.backend_cmdline_config_map_),
-        host_policy_map_(options.host_policy_map_)
+        host_policy_map_(options.host_policy_map_),
+        load_thread_count_(std::max(1u, options.model_load_thread_count_)),
+        version_swap_enabled_(options.version_swap_enabled_),
+        version_drain_timeout_ns_(options.version_drain_timeout_ms_ * 1000000),
+        drain_pending_(false), drain_exit_(false)
   {
-    load_pool_.reset(new triton::common::ThreadPool(
-        std::max(1u, options.model_load_thread_count_)));
+    load_pool_.reset(new triton::common::ThreadPool(load_thread_count_));
+    if (options.model_load_memory_budget_ != 0) {
+      load_admission_.reset(
+          new LoadAdmission(options.model_load_memory_budget_));
+    }
+    if (version_swap_enabled_) {
+      drain_thread_ = std::thread([this]() { DrainThread(); });
+    }
   }
 
   // Create a new model, the 'model_id' can either be a new or existing model.
@@ -314,6 +360,19 @@ class ModelLifeCycle {
       const ModelIdentifier& model_id, ModelInfo* model_info,
       const std::function<void(Status)>& OnComplete,
       std::shared_ptr<LoadTracker> load_tracker);
+  // Return the host memory expected to be used by loading the model
+  // version. The footprint declared in the model config is used if any,
+  // otherwise the footprint learned from an earlier load, otherwise the
+  // size of the version directory on the local file system.
+  uint64_t LoadByteSize(
+      const ModelIdentifier& model_id, const int64_t version,
+      const ModelInfo* model_info);
+  // Unload the draining versions that have no in-flight inference or
+  // have reached the drain timeout. Return true if any version is still
+  // draining.
+  bool ReleaseDrainedVersions();
+  // Periodically release drained versions while any version is draining.
+  void DrainThread();
 
 
   // Mutex for 'map_' and 'background_models_'
@@ -331,7 +390,20 @@ class ModelLifeCycle {
   const triton::common::HostPolicyCmdlineConfigMap host_policy_map_;
 
   // Fixed-size thread pool to load models at specified concurrency
+  const unsigned int load_thread_count_;
   std::unique_ptr<triton::common::ThreadPool> load_pool_;
+  // Admits the loads against the host memory budget, nullptr if there is
+  // no budget.
+  std::unique_ptr<LoadAdmission> load_admission_;
+
+  // Replaced versions are drained by 'drain_thread_' if swap is enabled.
+  const bool version_swap_enabled_;
+  const uint64_t version_drain_timeout_ns_;
+  std::mutex drain_mtx_;
+  std::condition_variable drain_cv_;
+  bool drain_pending_;
+  bool drain_exit_;
+  std::thread drain_thread_;
 };
 
 }}  // namespace triton::core
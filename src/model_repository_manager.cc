@@ -27,11 +27,17 @@
 
 #include "model_repository_manager.h"
 
+#include <google/protobuf/text_format.h>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <future>
+#include <mutex>
+#include <sstream>
 #include <stdexcept>
 #include <thread>
+#include <unordered_map>
 #include "backend_model.h"
 #include "constants.h"
 #include "ensemble_utils.h"
@@ -47,6 +53,14 @@ namespace triton { namespace core {
 
 namespace {
 
+uint64_t
+CurrentTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 template <typename T>
 void
 AddToSet(const std::set<T>& src, std::set<T>* dest)
@@ -60,6 +74,35 @@ AddToSet(const std::set<T>& src, std::set<T>* dest)
 
 static std::string file_prefix = "file:";
 
+// Return in 'signature' a description of the parts of the model
+// directory that AutoCompleteBackendFields() inspects: the version
+// directories and the entries of the first version directory, with
+// their subdirectories marked.
+Status
+ModelLayoutSignature(const std::string& model_path, std::string* signature)
+{
+  std::set<std::string> version_dirs;
+  RETURN_IF_ERROR(GetDirectorySubdirs(model_path, &version_dirs));
+  *signature = model_path;
+  for (const auto& version_dir : version_dirs) {
+    signature->append("\n").append(version_dir);
+  }
+  if (!version_dirs.empty()) {
+    const auto version_path = JoinPath({model_path, *version_dirs.begin()});
+    std::set<std::string> contents, subdirs;
+    RETURN_IF_ERROR(GetDirectoryContents(version_path, &contents));
+    RETURN_IF_ERROR(GetDirectorySubdirs(version_path, &subdirs));
+    signature->append("\n");
+    for (const auto& content : contents) {
+      signature->append("\n").append(content);
+      if (subdirs.find(content) != subdirs.end()) {
+        signature->append("/");
+      }
+    }
+  }
+  return Status::Success;
+}
+
 // Internal repo agent used for model file override
 class LocalizeRepoAgent : public TritonRepoAgent {
  public:
@@ -370,7 +413,7 @@ ModelRepositoryManager::Create(
     const std::set<std::string>& startup_models, const bool strict_model_config,
     const bool polling_enabled, const bool model_control_enabled,
     const ModelLifeCycleOptions& life_cycle_options,
-    const bool enable_model_namespacing,
+    const bool enable_model_namespacing, const std::string& snapshot_path,
     std::unique_ptr<ModelRepositoryManager>* model_repository_manager)
 {
   // The rest only matters if repository path is valid directory
@@ -400,6 +443,25 @@ ModelRepositoryManager::Create(
           repository_paths, !strict_model_config, polling_enabled,
           model_control_enabled, life_cycle_options.min_compute_capability_,
           enable_model_namespacing, std::move(life_cycle)));
+  if (!snapshot_path.empty()) {
+    // The configurations depend on the server and on the options they
+    // are normalized with.
+    local_manager->snapshot_path_ = snapshot_path;
+    local_manager->snapshot_key_ =
+        server_version + ";autofill=" + std::to_string(!strict_model_config) +
+        ";min_compute_capability=" +
+        std::to_string(life_cycle_options.min_compute_capability_) +
+        ";namespacing=" + std::to_string(enable_model_namespacing);
+    local_manager->ReadSnapshot();
+  }
+  if (polling_enabled) {
+    Status status = RepositoryWatcher::Create(
+        repository_paths, &local_manager->repository_watcher_);
+    if (!status.IsOk()) {
+      LOG_VERBOSE(1) << "polling all models on every model repository poll: "
+                     << status.Message();
+    }
+  }
   *model_repository_manager = std::move(local_manager);
 
   // Support loading all models on startup in explicit model control mode with
@@ -487,12 +549,16 @@ ModelRepositoryManager::PollAndUpdateInternal(bool* all_models_polled)
   ModelInfoMap new_infos;
 
   // Each subdirectory of repository path is a model directory from
-  // which we read the model configuration.
+  // which we read the model configuration. If the repositories are watched,
+  // only the model directories that changed need to be read.
+  std::set<std::string> changed_paths;
+  const bool watched = (repository_watcher_ != nullptr) &&
+                       repository_watcher_->CollectChanges(&changed_paths);
   std::unordered_map<std::string, std::vector<const InferenceParameter*>>
       model_names;
   RETURN_IF_ERROR(Poll(
       model_names, &added, &deleted, &modified, &unmodified, &new_infos,
-      all_models_polled));
+      all_models_polled, watched ? &changed_paths : nullptr));
 
   // Anything in 'infos_' that is not in "added", "modified", or
   // "unmodified" is deleted.
@@ -518,7 +584,13 @@ ModelRepositoryManager::PollAndUpdateInternal(bool* all_models_polled)
   }
 
   // model loading / unloading error will be printed but ignored
-  LoadModelByDependency(&dependency_graph_, &infos_);
+  const auto load_status = LoadModelByDependency(&dependency_graph_, &infos_);
+  poll_retry_models_.clear();
+  for (const auto& status : load_status) {
+    if (!status.second.IsOk()) {
+      poll_retry_models_.insert(status.first);
+    }
+  }
 
   return Status::Success;
 }
@@ -530,7 +602,6 @@ ModelRepositoryManager::LoadModelByDependency(
   // [FIXME] This function involves iterative interaction between
   // ModelLifeCycle object and DependencyGraph object, should better
   // encapsulate the interaction:
-  // Each iteration:
   //  - Check dependency graph for nodes that are ready for lifecycle changes:
   //      - load if all dependencies are satisfied and the node is 'heathy'
   //      - unload otherwise (should revisit this, logically will only happen in
@@ -540,76 +611,181 @@ ModelRepositoryManager::LoadModelByDependency(
   //        the model availibility claim: if re-load results in model not
   //        available, the model state will be reverted)
   //  - Apply changes to lifecycle
-  //  - Reflect the lifecycle change result to the dependency graph so that the
-  //    downstream nodes may be ready for lifecycle changes.
-  // Repeat until no more changes can be made.
+  //  - Each time a load completes, reflect the result to the dependency graph
+  //    so that the downstream nodes may be ready for lifecycle changes, without
+  //    waiting for other loads in progress.
+  // Repeat until no more changes can be made. The dependency graph is only
+  // accessed from this thread, the load threads only report completions.
   std::map<ModelIdentifier, Status> res;
   struct ModelState {
-    ModelState(DependencyNode* node) : node_(node), status_(Status::Success) {}
+    ModelState(DependencyNode* node, const uint64_t start_ns)
+        : node_(node), status_(Status::Success), start_ns_(start_ns),
+          end_ns_(0)
+    {
+    }
     DependencyNode* node_;
     Status status_;
-    std::promise<void> ready_;
+    uint64_t start_ns_;
+    uint64_t end_ns_;
   };
-  NodeSet loaded_models;
-  auto set_pair = ModelsToLoadUnload(loaded_models, res, dependency_graph);
-  // Loop until all model are loaded / unloaded
-  while ((!set_pair.first.empty()) || (!set_pair.second.empty())) {
-    loaded_models.clear();
-    // Unload invalid models first
-    for (auto& invalid_model : set_pair.second) {
-      model_life_cycle_->AsyncUnload(invalid_model->model_id_);
-      res[invalid_model->model_id_] = invalid_model->status_;
-      LOG_ERROR << invalid_model->status_.AsString();
-      invalid_model->loaded_versions_ = std::set<int64_t>();
-      loaded_models.emplace(invalid_model);
-    }
-    // load valid models and wait for load results
-    std::vector<std::unique_ptr<ModelState>> model_states;
-    for (auto& valid_model : set_pair.first) {
-      model_states.emplace_back(new ModelState(valid_model));
+  std::vector<std::unique_ptr<ModelState>> model_states;
+  std::mutex completed_mu;
+  std::condition_variable completed_cv;
+  std::deque<ModelState*> completed_states;
+  auto complete = [&completed_mu, &completed_cv, &completed_states](
+                      ModelState* model_state, const Status& status) {
+    std::lock_guard<std::mutex> lk(completed_mu);
+    model_state->status_ = status;
+    model_state->end_ns_ = CurrentTimeNs();
+    completed_states.push_back(model_state);
+    completed_cv.notify_one();
+  };
+
+  // Models ready to be loaded, models that others depend on are loaded
+  // first as they gate the most work.
+  std::deque<DependencyNode*> ready_models;
+  NodeSet loading_models;
+  const size_t max_loading_count = model_life_cycle_->LoadThreadCount();
+  size_t inflight_count = 0;
+
+  // Longest chain of dependent loads ending at each loaded model, as the
+  // accumulated load time and the previous model in the chain.
+  std::unordered_map<DependencyNode*, std::pair<uint64_t, DependencyNode*>>
+      critical_paths;
+  const uint64_t start_ns = CurrentTimeNs();
+
+  NodeSet finished_models;
+  auto set_pair = ModelsToLoadUnload(
+      finished_models, res, dependency_graph, loading_models);
+  while (true) {
+    // Unload invalid models, which may in turn settle their downstreams.
+    while ((!set_pair.first.empty()) || (!set_pair.second.empty())) {
+      finished_models.clear();
+      for (auto& invalid_model : set_pair.second) {
+        model_life_cycle_->AsyncUnload(invalid_model->model_id_);
+        res[invalid_model->model_id_] = invalid_model->status_;
+        LOG_ERROR << invalid_model->status_.AsString();
+        invalid_model->loaded_versions_ = std::set<int64_t>();
+        finished_models.emplace(invalid_model);
+      }
+      for (auto& valid_model : set_pair.first) {
+        if (valid_model->downstreams_.empty()) {
+          ready_models.push_back(valid_model);
+        } else {
+          ready_models.push_front(valid_model);
+        }
+        loading_models.emplace(valid_model);
+      }
+      if (finished_models.empty()) {
+        break;
+      }
+      set_pair = ModelsToLoadUnload(
+          finished_models, res, dependency_graph, loading_models);
+    }
+
+    // Start loads while there are load threads to run them.
+    while (!ready_models.empty() && (inflight_count < max_loading_count)) {
+      DependencyNode* node = ready_models.front();
+      ready_models.pop_front();
+      model_states.emplace_back(new ModelState(node, CurrentTimeNs()));
       auto model_state = model_states.back().get();
-      const auto itr = infos->Find(valid_model->model_id_);
+      ++inflight_count;
+      const auto itr = infos->Find(node->model_id_);
       auto status = model_life_cycle_->AsyncLoad(
-          valid_model->model_id_, itr->second->model_path_,
-          valid_model->model_config_, itr->second->is_config_provided_,
+          node->model_id_, itr->second->model_path_, node->model_config_,
+          itr->second->is_config_provided_,
           itr->second->mtime_nsec_.second > itr->second->prev_mtime_ns_.second,
-          itr->second->agent_model_list_, [model_state](Status load_status) {
-            model_state->status_ = load_status;
-            model_state->ready_.set_value();
+          itr->second->agent_model_list_,
+          [model_state, &complete](Status load_status) {
+            complete(model_state, load_status);
           });
       if (!status.IsOk()) {
-        model_state->status_ = status;
-        model_state->ready_.set_value();
-        LOG_ERROR << "failed to load model '" << valid_model->model_id_.str()
+        LOG_ERROR << "failed to load model '" << node->model_id_.str()
                   << "': " << status.Message();
+        complete(model_state, status);
       }
-      loaded_models.emplace(valid_model);
-    }
-    for (auto& model_state : model_states) {
-      model_state->ready_.get_future().wait();
-      res[model_state->node_->model_id_] = model_state->status_;
-      const auto version_state =
-          model_life_cycle_->VersionStates(model_state->node_->model_id_);
-      model_state->node_->loaded_versions_.clear();
-      for (const auto& vs : version_state) {
-        if (vs.second.first == ModelReadyState::READY) {
-          model_state->node_->loaded_versions_.emplace(vs.first);
-        }
+    }
+
+    if (inflight_count == 0) {
+      break;
+    }
+
+    // Wait for any load to complete and release the models depending on it.
+    ModelState* model_state = nullptr;
+    {
+      std::unique_lock<std::mutex> lk(completed_mu);
+      completed_cv.wait(
+          lk, [&completed_states]() { return !completed_states.empty(); });
+      model_state = completed_states.front();
+      completed_states.pop_front();
+    }
+    --inflight_count;
+
+    DependencyNode* node = model_state->node_;
+    res[node->model_id_] = model_state->status_;
+    const auto version_state =
+        model_life_cycle_->VersionStates(node->model_id_);
+    node->loaded_versions_.clear();
+    for (const auto& vs : version_state) {
+      if (vs.second.first == ModelReadyState::READY) {
+        node->loaded_versions_.emplace(vs.first);
       }
-      // If the model failed to load, should revert the timestamp to
-      // ensure the next load request will attempt to load the model again
-      // for operation idempotence. See comment on 'infos_'
-      if (!model_state->status_.IsOk()) {
-        auto& model_info = infos->Find(model_state->node_->model_id_)->second;
-        model_info->mtime_nsec_ = model_info->prev_mtime_ns_;
+    }
+    // If the model failed to load, should revert the timestamp to
+    // ensure the next load request will attempt to load the model again
+    // for operation idempotence. See comment on 'infos_'
+    if (!model_state->status_.IsOk()) {
+      auto& model_info = infos->Find(node->model_id_)->second;
+      model_info->mtime_nsec_ = model_info->prev_mtime_ns_;
+    }
+
+    auto& critical_path = critical_paths[node];
+    critical_path = std::make_pair(0, nullptr);
+    for (const auto& upstream : node->upstreams_) {
+      const auto uitr = critical_paths.find(upstream.first);
+      if ((uitr != critical_paths.end()) &&
+          (uitr->second.first > critical_path.first)) {
+        critical_path = std::make_pair(uitr->second.first, upstream.first);
       }
     }
-    set_pair = ModelsToLoadUnload(loaded_models, res, dependency_graph);
+    critical_path.first += (model_state->end_ns_ - model_state->start_ns_);
+
+    loading_models.erase(node);
+    finished_models.clear();
+    finished_models.emplace(node);
+    set_pair = ModelsToLoadUnload(
+        finished_models, res, dependency_graph, loading_models);
   }
   // Clear temporary stored agent model list after all loads are triggerred
   for (auto& info : *infos) {
     info.second->agent_model_list_.reset();
   }
+
+  // Report the chain of dependent loads that bounded the total load time.
+  if (!critical_paths.empty()) {
+    auto longest = critical_paths.begin();
+    for (auto itr = critical_paths.begin(); itr != critical_paths.end();
+         ++itr) {
+      if (itr->second.first > longest->second.first) {
+        longest = itr;
+      }
+    }
+    std::string chain = longest->first->model_id_.str();
+    for (DependencyNode* prev = longest->second.second; prev != nullptr;
+         prev = critical_paths[prev].second) {
+      chain = prev->model_id_.str() + " -> " + chain;
+    }
+    std::stringstream ss;
+    ss << "Loaded " << critical_paths.size() << " model(s) in "
+       << (CurrentTimeNs() - start_ns) / NANOS_PER_MILLIS
+       << " ms, critical path " << longest->second.first / NANOS_PER_MILLIS
+       << " ms: " << chain;
+    if (critical_paths.size() > 1) {
+      LOG_INFO << ss.str();
+    } else {
+      LOG_VERBOSE(1) << ss.str();
+    }
+  }
   return res;
 }
 
@@ -1126,7 +1302,8 @@ ModelRepositoryManager::Poll(
         std::string, std::vector<const InferenceParameter*>>& models,
     std::set<ModelIdentifier>* added, std::set<ModelIdentifier>* deleted,
     std::set<ModelIdentifier>* modified, std::set<ModelIdentifier>* unmodified,
-    ModelInfoMap* updated_infos, bool* all_models_polled)
+    ModelInfoMap* updated_infos, bool* all_models_polled,
+    const std::set<std::string>* changed_paths)
 {
   *all_models_polled = true;
   // empty path is the special case to indicate the model should be loaded
@@ -1172,6 +1349,15 @@ ModelRepositoryManager::Poll(
       LOG_ERROR << "failed to poll model '" << model
                 << "': not unique across all model repositories";
     }
+    // Forget the configurations of the models no longer in the
+    // repositories.
+    for (auto it = config_cache_.begin(); it != config_cache_.end();) {
+      if (model_to_path.find(it->first) == model_to_path.end()) {
+        it = config_cache_.erase(it);
+      } else {
+        ++it;
+      }
+    }
   }
   // If models are specified, this is explicit model control mode.
   else {
@@ -1268,6 +1454,22 @@ ModelRepositoryManager::Poll(
   // Poll each of the models. If error happens during polling the model,
   // its state will fallback to the state before the polling.
   for (const auto& pair : model_to_path) {
+    const auto& iitr = infos_.Find(pair.first);
+    // Skip examining the model if it is known to be unchanged
+    if ((changed_paths != nullptr) && (iitr != infos_.end()) &&
+        (changed_paths->find(pair.second) == changed_paths->end()) &&
+        (poll_retry_models_.find(pair.first) == poll_retry_models_.end())) {
+      const auto& ret = updated_infos->Emplace(
+          pair.first, std::unique_ptr<ModelInfo>(new ModelInfo(*iitr->second)));
+      if (!ret.second) {
+        return Status(
+            Status::Code::ALREADY_EXISTS,
+            "unexpected model info for model '" + pair.first.str() + "'");
+      }
+      unmodified->insert(pair.first);
+      continue;
+    }
+
     std::unique_ptr<ModelInfo> model_info;
     // Load with parameters will be appiled to all models with the same
     // name (namespace can be different), unless namespace is specified
@@ -1278,7 +1480,6 @@ ModelRepositoryManager::Poll(
         pair.first, pair.second,
         ((mit == models.end()) ? empty_params : mit->second), &model_info);
 
-    const auto& iitr = infos_.Find(pair.first);
     const bool invalid_add = (!status.IsOk()) && (iitr == infos_.end());
     if (!invalid_add) {
       const auto& ret = updated_infos->Emplace(pair.first, nullptr);
@@ -1424,6 +1625,38 @@ ModelRepositoryManager::InitializeModelInfo(
     return Status::Success;
   }
 
+  // A model polled for the first time is restored from the repository
+  // snapshot if its files are unchanged since the snapshot was taken.
+  const auto sitr = snapshot_models_.find(model_id);
+  if (sitr != snapshot_models_.end()) {
+    const bool restore = !parsed_config && (iitr == infos_.end()) &&
+                         (linfo->mtime_nsec_.second != 0) &&
+                         (sitr->second.first == linfo->model_path_) &&
+                         (sitr->second.second == linfo->mtime_nsec_);
+    snapshot_models_.erase(sitr);
+    const auto cit = config_cache_.find(model_id);
+    if (restore && (cit != config_cache_.end())) {
+      LOG_VERBOSE(1) << "restored model '" << model_id
+                     << "' from repository snapshot";
+      linfo->is_config_provided_ = cit->second.is_config_provided_;
+      linfo->model_config_ = cit->second.normalized_config_;
+      RETURN_IF_ERROR(CheckModelName(model_id, &linfo->model_config_));
+      *info = std::move(linfo);
+      return Status::Success;
+    }
+  }
+
+  // A configuration read from the model directory is served from
+  // 'config_cache_' while its content is unchanged, an overriding
+  // configuration is always parsed.
+  const bool cacheable = !parsed_config;
+  std::string config_content;
+  auto cit = config_cache_.find(model_id);
+  if ((cit != config_cache_.end()) && !cacheable) {
+    config_cache_.erase(cit);
+    cit = config_cache_.end();
+  }
+
   // Create the associated repo agent models when a model is to be loaded,
   // this must be done before normalizing model config as agents might
   // redirect to use the model config at a different location
@@ -1435,7 +1668,16 @@ ModelRepositoryManager::InitializeModelInfo(
     if (autofill_ && !model_config_exists) {
       linfo->model_config_.Clear();
     } else {
-      RETURN_IF_ERROR(ReadTextProto(config_path, &linfo->model_config_));
+      RETURN_IF_ERROR(ReadTextFile(config_path, &config_content));
+      if ((cit != config_cache_.end()) && cit->second.is_config_provided_ &&
+          (cit->second.config_content_ == config_content)) {
+        linfo->model_config_ = cit->second.parsed_config_;
+      } else if (!google::protobuf::TextFormat::ParseFromString(
+                     config_content, &linfo->model_config_)) {
+        return Status(
+            Status::Code::INTERNAL,
+            "failed to read text proto from " + config_path);
+      }
       parsed_config = true;
     }
   }
@@ -1460,44 +1702,168 @@ ModelRepositoryManager::InitializeModelInfo(
   // Repo agent / config overwrite may provide different configs than
   // the one in storage.
 
-  // Try to automatically generate missing parts of the model
-  // configuration (autofill) that don't require model detail
-  RETURN_IF_ERROR(GetNormalizedModelConfig(
-      model_id.name_, linfo->model_path_, min_compute_capability_,
-      &linfo->model_config_));
+  // The normalized configuration only depends on the configuration, the
+  // layout of the model directory and the options of the manager, so it
+  // is reused while neither of the first two changed.
+  std::string layout;
+  if (cacheable) {
+    RETURN_IF_ERROR(ModelLayoutSignature(linfo->model_path_, &layout));
+  }
+  if ((cit != config_cache_.end()) &&
+      (cit->second.is_config_provided_ == linfo->is_config_provided_) &&
+      (cit->second.config_content_ == config_content) &&
+      (cit->second.layout_ == layout)) {
+    LOG_VERBOSE(1) << "reusing normalized config of model '" << model_id
+                   << "'";
+    linfo->model_config_ = cit->second.normalized_config_;
+  } else {
+    inference::ModelConfig parsed;
+    if (cacheable) {
+      parsed = linfo->model_config_;
+    }
 
-  // Note that the model inputs and outputs are not validated until
-  // the model model is intialized as they may not be auto-completed
-  // until model is intialized.
-  RETURN_IF_ERROR(
-      ValidateModelConfig(linfo->model_config_, min_compute_capability_));
-  if (!autofill_) {
-    RETURN_IF_ERROR(ValidateModelIOConfig(linfo->model_config_));
+    // Try to automatically generate missing parts of the model
+    // configuration (autofill) that don't require model detail
+    RETURN_IF_ERROR(GetNormalizedModelConfig(
+        model_id.name_, linfo->model_path_, min_compute_capability_,
+        &linfo->model_config_));
+
+    // Note that the model inputs and outputs are not validated until
+    // the model model is intialized as they may not be auto-completed
+    // until model is intialized.
+    RETURN_IF_ERROR(
+        ValidateModelConfig(linfo->model_config_, min_compute_capability_));
+    if (!autofill_) {
+      RETURN_IF_ERROR(ValidateModelIOConfig(linfo->model_config_));
+    }
+
+    if (cacheable) {
+      auto& entry = config_cache_[model_id];
+      entry.is_config_provided_ = linfo->is_config_provided_;
+      entry.config_content_ = std::move(config_content);
+      entry.layout_ = std::move(layout);
+      entry.parsed_config_ = std::move(parsed);
+      entry.normalized_config_ = linfo->model_config_;
+    }
   }
 
+  RETURN_IF_ERROR(CheckModelName(model_id, &linfo->model_config_));
+
+  *info = std::move(linfo);
+  return Status::Success;
+}
+
+Status
+ModelRepositoryManager::CheckModelName(
+    const ModelIdentifier& model_id, inference::ModelConfig* config)
+{
   // If the model is mapped, update its config name based on the
   // mapping.
   if (model_mappings_.find(model_id.name_) != model_mappings_.end()) {
-    linfo->model_config_.set_name(model_id.name_);
+    config->set_name(model_id.name_);
   } else {
     // If there is no model mapping, make sure the name of the model
     // matches the name of the directory. This is a somewhat arbitrary
     // requirement but seems like good practice to require it of the user.
     // It also acts as a check to make sure we don't have two different
     // models with the same name.
-    if (linfo->model_config_.name() != model_id.name_) {
+    if (config->name() != model_id.name_) {
       return Status(
           Status::Code::INVALID_ARG,
           "unexpected directory name '" + model_id.name_ + "' for model '" +
-              linfo->model_config_.name() +
-              "', directory name must equal model name");
+              config->name() + "', directory name must equal model name");
     }
   }
 
-  *info = std::move(linfo);
   return Status::Success;
 }
 
+Status
+ModelRepositoryManager::WriteSnapshot()
+{
+  if (snapshot_path_.empty()) {
+    return Status(
+        Status::Code::UNAVAILABLE, "repository snapshot is not enabled");
+  }
+
+  std::vector<RepositorySnapshot::Entry> entries;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& info : infos_) {
+      const auto& model_info = *info.second;
+      const auto cit = config_cache_.find(info.first);
+      // Only the models whose configuration is read from the model
+      // directory, without repository agents, can be restored.
+      if ((model_info.mtime_nsec_.second == 0) ||
+          (cit == config_cache_.end()) ||
+          (cit->second.parsed_config_.model_repository_agents().agents_size() !=
+           0)) {
+        continue;
+      }
+      RepositorySnapshot::Entry entry;
+      entry.namespace_ = info.first.namespace_;
+      entry.name_ = info.first.name_;
+      entry.model_path_ = model_info.model_path_;
+      entry.mtime_nsec_ = model_info.mtime_nsec_;
+      entry.is_config_provided_ = cit->second.is_config_provided_;
+      entry.config_content_ = cit->second.config_content_;
+      entry.layout_ = cit->second.layout_;
+      if (!cit->second.parsed_config_.SerializeToString(
+              &entry.parsed_config_) ||
+          !cit->second.normalized_config_.SerializeToString(
+              &entry.normalized_config_)) {
+        continue;
+      }
+      entries.emplace_back(std::move(entry));
+    }
+  }
+
+  RETURN_IF_ERROR(
+      RepositorySnapshot::Write(snapshot_path_, snapshot_key_, entries));
+  LOG_VERBOSE(1) << "wrote " << entries.size()
+                 << " models to repository snapshot '" << snapshot_path_
+                 << "'";
+  return Status::Success;
+}
+
+void
+ModelRepositoryManager::ReadSnapshot()
+{
+  std::vector<RepositorySnapshot::Entry> entries;
+  Status status =
+      RepositorySnapshot::Read(snapshot_path_, snapshot_key_, &entries);
+  if (!status.IsOk()) {
+    if (status.StatusCode() == Status::Code::NOT_FOUND) {
+      LOG_VERBOSE(1) << status.Message();
+    } else {
+      LOG_WARNING << "ignoring repository snapshot: " << status.Message();
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  for (auto& entry : entries) {
+    const ModelIdentifier model_id(entry.namespace_, entry.name_);
+    ConfigCacheEntry cache_entry;
+    if (!cache_entry.parsed_config_.ParseFromString(entry.parsed_config_) ||
+        !cache_entry.normalized_config_.ParseFromString(
+            entry.normalized_config_)) {
+      LOG_WARNING << "ignoring repository snapshot of model '" << model_id
+                  << "': malformed configuration";
+      continue;
+    }
+    cache_entry.is_config_provided_ = entry.is_config_provided_;
+    cache_entry.config_content_ = std::move(entry.config_content_);
+    cache_entry.layout_ = std::move(entry.layout_);
+    config_cache_[model_id] = std::move(cache_entry);
+    snapshot_models_[model_id] =
+        std::make_pair(std::move(entry.model_path_), entry.mtime_nsec_);
+  }
+  LOG_VERBOSE(1) << "read " << snapshot_models_.size()
+                 << " models from repository snapshot '" << snapshot_path_
+                 << "'";
+}
+
 Status
 ModelRepositoryManager::RegisterModelRepository(
     const std::string& repository,
@@ -1588,7 +1954,7 @@ std::pair<ModelRepositoryManager::NodeSet, ModelRepositoryManager::NodeSet>
 ModelRepositoryManager::ModelsToLoadUnload(
     const NodeSet& loaded_models,
     const std::map<ModelIdentifier, Status>& model_load_status,
-    DependencyGraph* dependency_graph)
+    DependencyGraph* dependency_graph, const NodeSet& loading_models)
 {
   // <valid model set, invalid model set>
   std::pair<NodeSet, NodeSet> res;
@@ -1599,7 +1965,7 @@ ModelRepositoryManager::ModelsToLoadUnload(
       // only care about nodes that are affected by the update
       // nodes is locked if and only if it is being updated by another thread
       if (!node->checked_ && !node->is_locked_) {
-        if (CheckNode(node, model_load_status)) {
+        if (CheckNode(node, model_load_status, loading_models)) {
           if (node->status_.IsOk()) {
             res.first.emplace(node);
           } else {
@@ -1614,7 +1980,7 @@ ModelRepositoryManager::ModelsToLoadUnload(
         // only care about nodes that are affected by the update
         // nodes is locked if and only if it is being updated by another thread
         if (!node->checked_ && !node->is_locked_) {
-          if (CheckNode(node, model_load_status)) {
+          if (CheckNode(node, model_load_status, loading_models)) {
             if (node->status_.IsOk()) {
               res.first.emplace(node);
             } else {
@@ -1637,14 +2003,16 @@ ModelRepositoryManager::ModelsToLoadUnload(
 bool
 ModelRepositoryManager::CheckNode(
     DependencyNode* node,
-    const std::map<ModelIdentifier, Status>& model_load_status)
+    const std::map<ModelIdentifier, Status>& model_load_status,
+    const NodeSet& loading_models)
 {
   bool node_ready = true;
   // if the node is in invalid status, mark as ready as we know
   // it should not be loaded
   if (node->status_.IsOk()) {
     for (auto& upstream : node->upstreams_) {
-      if (!upstream.first->checked_) {
+      if (!upstream.first->checked_ ||
+          (loading_models.find(upstream.first) != loading_models.end())) {
         node_ready = false;
         break;
       }
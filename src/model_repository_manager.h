@@ -34,6 +34,8 @@
 #include "infer_parameter.h"
 #include "model_config.pb.h"
 #include "model_lifecycle.h"
+#include "repository_snapshot.h"
+#include "repository_watcher.h"
 #include "status.h"
 #include "triton/common/model_config.h"
 
@@ -103,6 +105,18 @@ class ModelRepositoryManager {
     bool is_config_provided_;
   };
 
+  // The configuration of a model as read from its directory, parsed
+  // and normalized, with the directory layout it was normalized
+  // against.
+  struct ConfigCacheEntry {
+    ConfigCacheEntry() : is_config_provided_(false) {}
+    bool is_config_provided_;
+    std::string config_content_;
+    std::string layout_;
+    inference::ModelConfig parsed_config_;
+    inference::ModelConfig normalized_config_;
+  };
+
   // Map from model name to information about the model.
   class ModelInfoMap {
    public:
@@ -383,6 +397,11 @@ class ModelRepositoryManager {
   /// Otherwise, LoadUnloadModel() is not allowed and the models will be loaded.
   /// Cannot be set to true if polling_enabled is true.
   /// \param life_cycle_options The options to configure ModelLifeCycle.
+  /// \param enable_model_namespacing If true, models with the same name
+  /// in different repositories are allowed.
+  /// \param snapshot_path The local path of the repository snapshot, the
+  /// models unchanged since the snapshot are restored from it. Empty to
+  /// disable the snapshot.
   /// \param model_repository_manager Return the model repository manager.
   /// \return The error status.
   static Status Create(
@@ -392,9 +411,15 @@ class ModelRepositoryManager {
       const bool strict_model_config, const bool polling_enabled,
       const bool model_control_enabled,
       const ModelLifeCycleOptions& life_cycle_options,
-      const bool enable_model_namespacing,
+      const bool enable_model_namespacing, const std::string& snapshot_path,
       std::unique_ptr<ModelRepositoryManager>* model_repository_manager);
 
+  /// Write the repository snapshot with the current polling result of
+  /// the models.
+  /// \return error status. Return "UNAVAILABLE" if the snapshot is not
+  /// enabled.
+  Status WriteSnapshot();
+
   /// Poll the model repository to determine the new set of models and
   /// compare with the current set. And serve the new set of models based
   /// on their version policy.
@@ -542,6 +567,10 @@ class ModelRepositoryManager {
   /// their model configuration are validated successfully. Instead of aborting
   /// the polling, the models that fail will be ignored and their model infos
   /// will stay in the previous state.
+  /// \param changed_paths If provided, the model directories that may have
+  /// changed since the last poll. Known models in other directories that did
+  /// not fail to load in the last poll are considered unmodified without being
+  /// examined.
   /// \return The error status.
   Status Poll(
       const std::unordered_map<
@@ -549,7 +578,8 @@ class ModelRepositoryManager {
       std::set<ModelIdentifier>* added, std::set<ModelIdentifier>* deleted,
       std::set<ModelIdentifier>* modified,
       std::set<ModelIdentifier>* unmodified, ModelInfoMap* updated_infos,
-      bool* all_models_polled);
+      bool* all_models_polled,
+      const std::set<std::string>* changed_paths = nullptr);
 
   /// Helper function for Poll() to initialize ModelInfo for the model.
   /// \param model_id The identifier of the model.
@@ -564,9 +594,10 @@ class ModelRepositoryManager {
       const std::vector<const InferenceParameter*>& params,
       std::unique_ptr<ModelInfo>* info);
 
-  /// Load models based on the dependency graph. The function will iteratively
-  /// load models that all the models they depend on has been loaded, and unload
-  /// models if their dependencies are no longer satisfied.
+  /// Load models based on the dependency graph. A model starts loading as soon
+  /// as all the models it depends on have been loaded, and is unloaded if its
+  /// dependencies are no longer satisfied. At most as many models as there are
+  /// model load threads are loading at any time.
   /// \param dependency_graph The dependency graph.
   /// \param infos Model infos to be updated along the load.
   /// \return The status of the model loads.
@@ -579,26 +610,39 @@ class ModelRepositoryManager {
   /// Unloaded models will be represented as models with no loaded versions.
   /// \param model_load_status For checking ensemble dependency(s) status.
   /// \param dependency_graph The dependency graph corresponds to this load.
+  /// \param loading_models The models whose load has started but not yet
+  /// completed, models depending on them are not ready.
   /// \return A pair of node set containing models to be loaded and models to be
   /// unloaded for the next iteration.
   std::pair<NodeSet, NodeSet> ModelsToLoadUnload(
       const NodeSet& loaded_models,
       const std::map<ModelIdentifier, Status>& model_load_status,
-      DependencyGraph* dependency_graph);
+      DependencyGraph* dependency_graph, const NodeSet& loading_models);
 
   /// Check if the node is ready for the next iteration. A node is ready if the
   /// node is invalid (containing invalid model config or its depdencies failed
   /// to load) or all of its dependencies are satisfied.
   /// \param node The node to be checked.
   /// \param model_load_status For checking ensemble dependency(s) status.
+  /// \param loading_models The models whose load has not yet completed.
   /// \return True if the node is ready. False otherwise.
   bool CheckNode(
       DependencyNode* node,
-      const std::map<ModelIdentifier, Status>& model_load_status);
+      const std::map<ModelIdentifier, Status>& model_load_status,
+      const NodeSet& loading_models);
 
   bool ModelDirectoryOverride(
       const std::vector<const InferenceParameter*>& model_params);
 
+  /// Check the name in the model configuration against the model
+  /// identifier, or set it if the model is mapped.
+  Status CheckModelName(
+      const ModelIdentifier& model_id, inference::ModelConfig* config);
+
+  /// Read the repository snapshot, if any, into 'config_cache_' and
+  /// 'snapshot_models_'.
+  void ReadSnapshot();
+
   const bool autofill_;
   const bool polling_enabled_;
   const bool model_control_enabled_;
@@ -650,6 +694,26 @@ class ModelRepositoryManager {
   std::unordered_map<std::string, std::pair<std::string, std::string>>
       model_mappings_;
 
+  // Tracks the changed model directories in POLL mode, nullptr if the
+  // repositories must be fully polled.
+  std::unique_ptr<RepositoryWatcher> repository_watcher_;
+  // The models that failed to load in the last poll, they are polled again
+  // even if unchanged.
+  std::set<ModelIdentifier> poll_retry_models_;
+  // The last configuration read for each model, to skip parsing and
+  // validating the configurations that are unchanged across polls.
+  std::unordered_map<ModelIdentifier, ConfigCacheEntry> config_cache_;
+  // The local path of the repository snapshot and the key identifying
+  // the server and options it is valid for.
+  std::string snapshot_path_;
+  std::string snapshot_key_;
+  // The path and modification time of the models in the repository
+  // snapshot that are not polled yet.
+  std::unordered_map<
+      ModelIdentifier,
+      std::pair<std::string, std::pair<int64_t, int64_t>>>
+      snapshot_models_;
+
   // Model lifecycle
 
   std::unique_ptr<ModelLifeCycle> model_life_cycle_;
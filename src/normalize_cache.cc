@@ -0,0 +1,122 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "normalize_cache.h"
+
+namespace triton { namespace core {
+
+namespace {
+
+template <typename T>
+void
+AppendValue(const T& value, std::string* signature)
+{
+  signature->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}  // namespace
+
+void
+NormalizeCache::AppendInputSignature(
+    const std::string& name, const int32_t datatype,
+    const std::vector<int64_t>& shape, std::string* signature)
+{
+  // Length-prefix the variable sized fields so that distinct inputs
+  // can never produce the same signature.
+  AppendValue(static_cast<uint32_t>(name.size()), signature);
+  signature->append(name);
+  AppendValue(datatype, signature);
+  AppendValue(static_cast<uint32_t>(shape.size()), signature);
+  if (!shape.empty()) {
+    signature->append(
+        reinterpret_cast<const char*>(shape.data()),
+        shape.size() * sizeof(int64_t));
+  }
+}
+
+void
+NormalizeCache::AppendOutputSignature(
+    const std::string& name, std::string* signature)
+{
+  // Mark outputs so that they can't be confused with inputs.
+  AppendValue(UINT32_MAX, signature);
+  AppendValue(static_cast<uint32_t>(name.size()), signature);
+  signature->append(name);
+}
+
+std::shared_ptr<const NormalizeCache::Entry>
+NormalizeCache::Lookup(const std::string& signature)
+{
+  std::lock_guard<std::mutex> lock(mu_);
+  const auto itr = entries_.find(signature);
+  if (itr == entries_.end()) {
+    return nullptr;
+  }
+
+  return itr->second;
+}
+
+uint64_t
+NormalizeCache::Generation()
+{
+  std::lock_guard<std::mutex> lock(mu_);
+  return generation_;
+}
+
+void
+NormalizeCache::Insert(
+    const std::string& signature, const uint64_t generation,
+    std::shared_ptr<const Entry>&& entry)
+{
+  std::lock_guard<std::mutex> lock(mu_);
+  if (generation != generation_) {
+    return;
+  }
+
+  if ((entries_.size() >= max_entry_count_) &&
+      (entries_.find(signature) == entries_.end())) {
+    entries_.clear();
+  }
+
+  entries_[signature] = std::move(entry);
+}
+
+void
+NormalizeCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(mu_);
+  entries_.clear();
+  ++generation_;
+}
+
+size_t
+NormalizeCache::Size()
+{
+  std::lock_guard<std::mutex> lock(mu_);
+  return entries_.size();
+}
+
+}}  // namespace triton::core
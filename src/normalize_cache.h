@@ -0,0 +1,112 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "constants.h"
+
+namespace triton { namespace core {
+
+//
+// Cache of the results of InferenceRequest normalization for a
+// model. A request is identified by a compact signature of its input
+// names, datatypes and shapes and of its requested outputs, so that a
+// request with the same signature as one that was already validated
+// against the model configuration can reuse the derived batch size
+// and shapes instead of being validated again. The cache must be
+// cleared whenever the model configuration changes. Clearing starts a
+// new generation so that a result computed against the previous
+// configuration, while the cache was being cleared, is not added back.
+//
+class NormalizeCache {
+ public:
+  // The normalized shapes of an input.
+  struct Input {
+    std::vector<int64_t> shape_;
+    std::vector<int64_t> shape_with_batch_dim_;
+    bool is_shape_tensor_;
+  };
+
+  // The result of normalizing a request. 'inputs_' is ordered as the
+  // inputs appear in the signature.
+  struct Entry {
+    uint64_t batch_size_;
+    std::vector<Input> inputs_;
+  };
+
+  // Create a cache holding at most 'max_entry_count' signatures. When
+  // the cache is full it is emptied before a new signature is added,
+  // so that a workload whose shapes drift does not grow the cache.
+  explicit NormalizeCache(const size_t max_entry_count = 1024)
+      : max_entry_count_(max_entry_count), generation_(0)
+  {
+  }
+
+  // Append the signature of an input to 'signature'.
+  static void AppendInputSignature(
+      const std::string& name, const int32_t datatype,
+      const std::vector<int64_t>& shape, std::string* signature);
+
+  // Append the signature of a requested output to 'signature'.
+  static void AppendOutputSignature(
+      const std::string& name, std::string* signature);
+
+  // Return the entry for 'signature', or nullptr if there is none.
+  std::shared_ptr<const Entry> Lookup(const std::string& signature);
+
+  // The current generation. Capture it before reading the model
+  // configuration that an entry is derived from.
+  uint64_t Generation();
+
+  // Add the entry for 'signature', derived from the configuration of
+  // 'generation'. The entry is dropped if the cache has been cleared
+  // since.
+  void Insert(
+      const std::string& signature, const uint64_t generation,
+      std::shared_ptr<const Entry>&& entry);
+
+  // Remove all entries and start a new generation.
+  void Clear();
+
+  // The number of entries in the cache.
+  size_t Size();
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(NormalizeCache);
+
+  const size_t max_entry_count_;
+
+  std::mutex mu_;
+  uint64_t generation_;
+  std::unordered_map<std::string, std::shared_ptr<const Entry>> entries_;
+};
+
+}}  // namespace triton::core
@@ -0,0 +1,288 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "parallel_download.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include "triton/common/logging.h"
+
+#ifdef TRITON_ENABLE_METRICS
+#include "metrics.h"
+#endif  // TRITON_ENABLE_METRICS
+
+namespace triton { namespace core {
+
+namespace {
+
+constexpr size_t kDefaultThreadCount = 8;
+constexpr uint64_t kDefaultPartByteSize = 32 * 1024 * 1024;
+
+uint64_t
+EnvOrDefault(const char* name, const uint64_t default_value)
+{
+  const char* value = std::getenv(name);
+  if (value != nullptr) {
+    const uint64_t parsed = std::strtoull(value, nullptr, 10);
+    if (parsed > 0) {
+      return parsed;
+    }
+    LOG_ERROR << "ignoring invalid " << name << " '" << value << "'";
+  }
+  return default_value;
+}
+
+// Create or truncate the file at 'path' and extend it to 'byte_size'
+// bytes, reserving the storage where supported so that concurrently
+// written parts don't fragment the file.
+Status
+Preallocate(const std::string& path, const uint64_t byte_size)
+{
+#ifdef __linux__
+  const int fd = open(
+      path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+      S_IRUSR | S_IWUSR);
+  if (fd == -1) {
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to create local file " + path + ", errno:" + strerror(errno));
+  }
+  int err = 0;
+  if (byte_size > 0) {
+    // Not all file systems support allocation, fall back to extending
+    // the size only.
+    if (posix_fallocate(fd, 0, byte_size) != 0) {
+      if (ftruncate(fd, byte_size) != 0) {
+        err = errno;
+      }
+    }
+  }
+  close(fd);
+  if (err != 0) {
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to allocate local file " + path + ", errno:" + strerror(err));
+  }
+#else
+  std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (file && (byte_size > 0)) {
+    file.seekp(byte_size - 1);
+    file.put('\0');
+  }
+  if (!file) {
+    return Status(
+        Status::Code::INTERNAL, "failed to allocate local file " + path);
+  }
+#endif  // __linux__
+  return Status::Success;
+}
+
+}  // namespace
+
+struct ParallelDownloader::Batch {
+  Batch(const ByteSizeFn& byte_size_fn, const ReadRangeFn& read_range_fn)
+      : byte_size_fn_(byte_size_fn), read_range_fn_(read_range_fn),
+        pending_(0), byte_size_(0)
+  {
+  }
+
+  bool Failed()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return !status_.IsOk();
+  }
+
+  // Valid until all tasks of the batch are completed, Download() waits
+  // for that before returning.
+  const ByteSizeFn& byte_size_fn_;
+  const ReadRangeFn& read_range_fn_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  // The number of download tasks not yet completed
+  size_t pending_;
+  // The first error, remaining tasks are skipped after an error
+  Status status_;
+  // The number of bytes downloaded
+  uint64_t byte_size_;
+};
+
+ParallelDownloader*
+ParallelDownloader::GetSingleton()
+{
+  static ParallelDownloader downloader(
+      EnvOrDefault("TRITON_LOCALIZE_THREAD_COUNT", kDefaultThreadCount),
+      EnvOrDefault("TRITON_LOCALIZE_PART_BYTE_SIZE", kDefaultPartByteSize));
+  return &downloader;
+}
+
+ParallelDownloader::ParallelDownloader(
+    const size_t thread_count, const uint64_t part_byte_size)
+    : thread_count_(std::max<size_t>(1, thread_count)),
+      part_byte_size_(std::max<uint64_t>(1, part_byte_size)),
+      pool_(new triton::common::ThreadPool(thread_count_))
+{
+}
+
+Status
+ParallelDownloader::Download(
+    const std::vector<std::pair<std::string, std::string>>& files,
+    const ByteSizeFn& byte_size_fn, const ReadRangeFn& read_range_fn)
+{
+  if (files.empty()) {
+    return Status::Success;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::shared_ptr<Batch> batch =
+      std::make_shared<Batch>(byte_size_fn, read_range_fn);
+  batch->pending_ = files.size();
+  for (const auto& file : files) {
+    pool_->Enqueue([this, batch, file]() {
+      DownloadFile(batch, file.first, file.second);
+    });
+  }
+
+  std::unique_lock<std::mutex> lk(batch->mu_);
+  batch->cv_.wait(lk, [&batch] { return batch->pending_ == 0; });
+  if (!batch->status_.IsOk()) {
+    return batch->status_;
+  }
+
+  const uint64_t duration_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+  LOG_VERBOSE(1) << "downloaded " << files.size() << " files, "
+                 << batch->byte_size_ << " bytes in " << (duration_us / 1000)
+                 << " ms using " << thread_count_ << " threads";
+#ifdef TRITON_ENABLE_METRICS
+  if (Metrics::Enabled()) {
+    Metrics::FamilyModelDownloadFiles().Add({}).Increment(files.size());
+    Metrics::FamilyModelDownloadBytes().Add({}).Increment(batch->byte_size_);
+    Metrics::FamilyModelDownloadDuration().Add({}).Increment(duration_us);
+  }
+#endif  // TRITON_ENABLE_METRICS
+  return Status::Success;
+}
+
+void
+ParallelDownloader::DownloadFile(
+    const std::shared_ptr<Batch>& batch, const std::string& remote_path,
+    const std::string& local_path)
+{
+  if (batch->Failed()) {
+    Complete(batch.get(), Status::Success);
+    return;
+  }
+
+  uint64_t byte_size = 0;
+  Status status = batch->byte_size_fn_(remote_path, &byte_size);
+  if (status.IsOk()) {
+    status = Preallocate(local_path, byte_size);
+  }
+  if (status.IsOk() && (byte_size > part_byte_size_)) {
+    // Hold this task as pending until all parts are enqueued so the
+    // batch can't complete in the meantime.
+    {
+      std::lock_guard<std::mutex> lk(batch->mu_);
+      batch->pending_ +=
+          (byte_size + part_byte_size_ - 1) / part_byte_size_;
+    }
+    for (uint64_t offset = 0; offset < byte_size; offset += part_byte_size_) {
+      const uint64_t part_size = std::min(part_byte_size_, byte_size - offset);
+      pool_->Enqueue(
+          [this, batch, remote_path, local_path, offset, part_size]() {
+            Complete(
+                batch.get(), DownloadPart(
+                                 batch.get(), remote_path, local_path, offset,
+                                 part_size));
+          });
+    }
+  } else if (status.IsOk() && (byte_size > 0)) {
+    status = DownloadPart(batch.get(), remote_path, local_path, 0, byte_size);
+  }
+  Complete(batch.get(), status);
+}
+
+Status
+ParallelDownloader::DownloadPart(
+    Batch* batch, const std::string& remote_path, const std::string& local_path,
+    const uint64_t offset, const uint64_t byte_size)
+{
+  if (batch->Failed()) {
+    return Status::Success;
+  }
+
+  std::fstream file(
+      local_path, std::ios::in | std::ios::out | std::ios::binary);
+  if (!file) {
+    return Status(
+        Status::Code::INTERNAL, "failed to open local file " + local_path);
+  }
+  file.seekp(offset);
+  RETURN_IF_ERROR(
+      batch->read_range_fn_(remote_path, offset, byte_size, &file));
+  file.flush();
+  const std::streamoff end = file ? static_cast<std::streamoff>(file.tellp())
+                                  : static_cast<std::streamoff>(-1);
+  if (end != static_cast<std::streamoff>(offset + byte_size)) {
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to download bytes [" + std::to_string(offset) + ", " +
+            std::to_string(offset + byte_size) + ") of " + remote_path +
+            " to " + local_path);
+  }
+
+  std::lock_guard<std::mutex> lk(batch->mu_);
+  batch->byte_size_ += byte_size;
+  return Status::Success;
+}
+
+void
+ParallelDownloader::Complete(Batch* batch, const Status& status)
+{
+  std::lock_guard<std::mutex> lk(batch->mu_);
+  if (batch->status_.IsOk() && !status.IsOk()) {
+    batch->status_ = status;
+  }
+  if (--batch->pending_ == 0) {
+    batch->cv_.notify_all();
+  }
+}
+
+}}  // namespace triton::core
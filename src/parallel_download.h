@@ -0,0 +1,95 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "status.h"
+#include "triton/common/thread_pool.h"
+
+namespace triton { namespace core {
+
+//
+// Downloads the files of a remote model directory concurrently. The
+// remote file systems provide the functions to query the size of an
+// object and to read a byte range of it. Objects larger than the part
+// size are fetched in parts of that size concurrently, each part is
+// written to its offset in a local file preallocated to the object
+// size.
+//
+class ParallelDownloader {
+ public:
+  // Return the size of the remote object at 'remote_path'.
+  using ByteSizeFn = std::function<Status(
+      const std::string& remote_path, uint64_t* byte_size)>;
+  // Write 'byte_size' bytes of the remote object at 'remote_path'
+  // starting from 'offset' to 'out'.
+  using ReadRangeFn = std::function<Status(
+      const std::string& remote_path, const uint64_t offset,
+      const uint64_t byte_size, std::ostream* out)>;
+
+  // Return the downloader shared by the remote file systems. The
+  // number of download threads and the part size can be set with
+  // TRITON_LOCALIZE_THREAD_COUNT and TRITON_LOCALIZE_PART_BYTE_SIZE.
+  static ParallelDownloader* GetSingleton();
+
+  ParallelDownloader(const size_t thread_count, const uint64_t part_byte_size);
+
+  // Download each remote object in 'files', pairs of remote path and
+  // local path. The directories of the local paths must exist. Block
+  // until all downloads are completed and return the first error.
+  Status Download(
+      const std::vector<std::pair<std::string, std::string>>& files,
+      const ByteSizeFn& byte_size_fn, const ReadRangeFn& read_range_fn);
+
+ private:
+  struct Batch;
+
+  // Download the file or, if it is large, enqueue the download of its
+  // parts.
+  void DownloadFile(
+      const std::shared_ptr<Batch>& batch, const std::string& remote_path,
+      const std::string& local_path);
+
+  // Download a part of the file into the existing local file.
+  Status DownloadPart(
+      Batch* batch, const std::string& remote_path,
+      const std::string& local_path, const uint64_t offset,
+      const uint64_t byte_size);
+
+  // Record the completion of a download task.
+  void Complete(Batch* batch, const Status& status);
+
+  const size_t thread_count_;
+  const uint64_t part_byte_size_;
+  std::unique_ptr<triton::common::ThreadPool> pool_;
+};
+
+}}  // namespace triton::core
@@ -31,6 +31,11 @@
 #include "numa_utils.h"
 #include "triton/common/logging.h"
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
 #ifdef TRITON_ENABLE_GPU
 #include <cuda_runtime_api.h>
 #endif  // TRITON_ENABLE_GPU
@@ -39,6 +44,10 @@ namespace triton { namespace core {
 
 namespace {
 
+// Byte size of the default and of the gigantic huge page on Linux.
+constexpr uint64_t kHugePageByteSize = uint64_t(1) << 21;
+constexpr uint64_t kGiganticPageByteSize = uint64_t(1) << 30;
+
 std::string
 PointerToString(void* ptr)
 {
@@ -61,14 +70,66 @@ ParseIntOption(const std::string& msg, const std::string& arg, int* value)
   return Status::Success;
 }
 
+#ifndef _WIN32
+// Map 'size' bytes of anonymous memory backed by huge pages. Explicit
+// hugetlb pages are tried first, 1GB pages if 'size' is a multiple of
+// 1GB and then the default huge page size. If no hugetlb pages are
+// reserved on the host, fall back to regular pages advised for
+// transparent huge pages. The returned mapping is always pre-faulted.
+void*
+MapHugePages(uint64_t size, std::string* page_desc)
+{
+  const int prot = PROT_READ | PROT_WRITE;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  void* buffer = MAP_FAILED;
+#ifdef MAP_HUGETLB
+#ifdef MAP_HUGE_1GB
+  if ((size % kGiganticPageByteSize) == 0) {
+    buffer = mmap(
+        nullptr, size, prot, flags | MAP_POPULATE | MAP_HUGETLB | MAP_HUGE_1GB,
+        -1, 0);
+    if (buffer != MAP_FAILED) {
+      *page_desc = "1GB hugetlb pages";
+      return buffer;
+    }
+  }
+#endif  // MAP_HUGE_1GB
+  buffer =
+      mmap(nullptr, size, prot, flags | MAP_POPULATE | MAP_HUGETLB, -1, 0);
+  if (buffer != MAP_FAILED) {
+    *page_desc = "hugetlb pages";
+    return buffer;
+  }
+#endif  // MAP_HUGETLB
+
+  buffer = mmap(nullptr, size, prot, flags, -1, 0);
+  if (buffer == MAP_FAILED) {
+    return nullptr;
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(buffer, size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+
+  // Pre-fault after the advice so that the range can be backed by
+  // transparent huge pages instead of being populated with small pages.
+  const long page_size = sysconf(_SC_PAGESIZE);
+  for (uint64_t offset = 0; offset < size; offset += page_size) {
+    reinterpret_cast<volatile char*>(buffer)[offset] = 0;
+  }
+  *page_desc = "transparent huge pages";
+  return buffer;
+}
+#endif  // !_WIN32
+
 }  // namespace
 
 std::unique_ptr<PinnedMemoryManager> PinnedMemoryManager::instance_;
 uint64_t PinnedMemoryManager::pinned_memory_byte_size_;
 
 PinnedMemoryManager::PinnedMemory::PinnedMemory(
-    void* pinned_memory_buffer, uint64_t size)
-    : pinned_memory_buffer_(pinned_memory_buffer)
+    void* pinned_memory_buffer, uint64_t size, bool is_huge_page)
+    : pinned_memory_buffer_(pinned_memory_buffer), size_(size),
+      is_huge_page_(is_huge_page)
 {
   if (pinned_memory_buffer_ != nullptr) {
     managed_pinned_memory_ = boost::interprocess::managed_external_buffer(
@@ -79,10 +140,17 @@ PinnedMemoryManager::PinnedMemory::PinnedMemory(
 
 PinnedMemoryManager::PinnedMemory::~PinnedMemory()
 {
-#ifdef TRITON_ENABLE_GPU
-  if (pinned_memory_buffer_ != nullptr) {
-    cudaFreeHost(pinned_memory_buffer_);
+  if (pinned_memory_buffer_ == nullptr) {
+    return;
   }
+  if (is_huge_page_) {
+#ifndef _WIN32
+    munmap(pinned_memory_buffer_, size_);
+#endif  // !_WIN32
+    return;
+  }
+#ifdef TRITON_ENABLE_GPU
+  cudaFreeHost(pinned_memory_buffer_);
 #endif  // TRITON_ENABLE_GPU
 }
 
@@ -90,8 +158,8 @@ PinnedMemoryManager::~PinnedMemoryManager()
 {
   // Clean up
   for (const auto& memory_info : memory_info_) {
-    const auto& is_pinned = memory_info.second.first;
-    if (!is_pinned) {
+    const auto& memory_buffer = memory_info.second.second;
+    if (memory_buffer == nullptr) {
       free(memory_info.first);
     }
   }
@@ -105,6 +173,47 @@ PinnedMemoryManager::AddPinnedMemoryBuffer(
   pinned_memory_buffers_[node_mask] = pinned_memory_buffer;
 }
 
+Status
+PinnedMemoryManager::CreateHugePageMemoryBuffer(
+    uint64_t pool_byte_size, uint64_t threshold_byte_size)
+{
+#ifdef _WIN32
+  return Status(
+      Status::Code::UNSUPPORTED,
+      "huge page memory pool is not supported on Windows");
+#else
+  // Huge page mappings must be sized in whole huge pages.
+  const uint64_t size =
+      ((pool_byte_size + kHugePageByteSize - 1) / kHugePageByteSize) *
+      kHugePageByteSize;
+  std::string page_desc;
+  void* buffer = MapHugePages(size, &page_desc);
+  if (buffer == nullptr) {
+    return Status(
+        Status::Code::INTERNAL, "failed to map " + std::to_string(size) +
+                                    " bytes for huge page memory pool");
+  }
+
+  try {
+    huge_page_memory_buffer_.reset(
+        new PinnedMemory(buffer, size, true /* is_huge_page */));
+  }
+  catch (const std::exception& ex) {
+    munmap(buffer, size);
+    return Status(
+        Status::Code::INTERNAL,
+        "Failed to add huge page memory buffer: " + std::string(ex.what()));
+  }
+  huge_page_threshold_byte_size_ = threshold_byte_size;
+
+  LOG_INFO << "Huge page memory pool is created at '"
+           << PointerToString(buffer) << "' with size " << size << " using "
+           << page_desc << ", serving allocations of at least "
+           << threshold_byte_size << " bytes";
+  return Status::Success;
+#endif  // _WIN32
+}
+
 Status
 PinnedMemoryManager::AllocInternal(
     void** ptr, uint64_t size, TRITONSERVER_MemoryType* allocated_type,
@@ -134,9 +243,22 @@ PinnedMemoryManager::AllocInternal(
                   << ", falling back to non-pinned system memory";
       warning_logged = true;
     }
-    *ptr = malloc(size);
+    *ptr = nullptr;
     *allocated_type = TRITONSERVER_MEMORY_CPU;
     is_pinned = false;
+    pinned_memory_buffer = nullptr;
+    if ((huge_page_memory_buffer_ != nullptr) &&
+        (size >= huge_page_threshold_byte_size_)) {
+      std::lock_guard<std::mutex> lk(huge_page_memory_buffer_->buffer_mtx_);
+      *ptr = huge_page_memory_buffer_->managed_pinned_memory_.allocate(
+          size, std::nothrow_t{});
+      if (*ptr != nullptr) {
+        pinned_memory_buffer = huge_page_memory_buffer_.get();
+      }
+    }
+    if (*ptr == nullptr) {
+      *ptr = malloc(size);
+    }
     if (*ptr == nullptr) {
       status = Status(
           Status::Code::INTERNAL,
@@ -159,13 +281,16 @@ PinnedMemoryManager::AllocInternal(
                                         "' has been managed");
       }
       LOG_VERBOSE(1) << (is_pinned ? "" : "non-")
-                     << "pinned memory allocation: "
-                     << "size " << size << ", addr " << *ptr;
+                     << "pinned memory allocation"
+                     << (((!is_pinned) && (pinned_memory_buffer != nullptr))
+                             ? " from huge page pool"
+                             : "")
+                     << ": size " << size << ", addr " << *ptr;
     }
   }
 
   if ((!status.IsOk()) && (*ptr != nullptr)) {
-    if (is_pinned) {
+    if (pinned_memory_buffer != nullptr) {
       std::lock_guard<std::mutex> lk(pinned_memory_buffer->buffer_mtx_);
       pinned_memory_buffer->managed_pinned_memory_.deallocate(*ptr);
     } else {
@@ -199,7 +324,7 @@ PinnedMemoryManager::FreeInternal(void* ptr)
     }
   }
 
-  if (is_pinned) {
+  if (pinned_memory_buffer != nullptr) {
     std::lock_guard<std::mutex> lk(pinned_memory_buffer->buffer_mtx_);
     pinned_memory_buffer->managed_pinned_memory_.deallocate(ptr);
   } else {
@@ -214,6 +339,20 @@ PinnedMemoryManager::Reset()
   instance_.reset();
 }
 
+bool
+PinnedMemoryManager::IsHugePageMemory(const void* ptr)
+{
+  if ((instance_ == nullptr) ||
+      (instance_->huge_page_memory_buffer_ == nullptr)) {
+    return false;
+  }
+  const char* base = static_cast<const char*>(
+      instance_->huge_page_memory_buffer_->pinned_memory_buffer_);
+  const char* p = static_cast<const char*>(ptr);
+  return (p >= base) &&
+         (p < base + instance_->huge_page_memory_buffer_->size_);
+}
+
 Status
 PinnedMemoryManager::Create(const Options& options)
 {
@@ -333,6 +472,20 @@ PinnedMemoryManager::Create(const Options& options)
       }
     }
   }
+
+  if (options.huge_page_pool_byte_size_ != 0) {
+    // The huge page pool is an optimization of the non-pinned fallback,
+    // the server can still function properly without it.
+    auto status = instance_->CreateHugePageMemoryBuffer(
+        options.huge_page_pool_byte_size_,
+        options.huge_page_threshold_byte_size_);
+    if (!status.IsOk()) {
+      LOG_WARNING << "Unable to create huge page memory pool, large "
+                     "non-pinned allocations will use regular pages: "
+                  << status.Message();
+    }
+  }
+
   pinned_memory_byte_size_ = options.pinned_memory_pool_byte_size_;
   return Status::Success;
 }
@@ -44,13 +44,25 @@ class PinnedMemoryManager {
   struct Options {
     Options(
         uint64_t b = 0,
-        const triton::common::HostPolicyCmdlineConfigMap& host_policy_map = {})
-        : pinned_memory_pool_byte_size_(b), host_policy_map_(host_policy_map)
+        const triton::common::HostPolicyCmdlineConfigMap& host_policy_map = {},
+        uint64_t huge_page_pool_byte_size = 0,
+        uint64_t huge_page_threshold_byte_size = 0)
+        : pinned_memory_pool_byte_size_(b), host_policy_map_(host_policy_map),
+          huge_page_pool_byte_size_(huge_page_pool_byte_size),
+          huge_page_threshold_byte_size_(huge_page_threshold_byte_size)
     {
     }
 
     uint64_t pinned_memory_pool_byte_size_;
     triton::common::HostPolicyCmdlineConfigMap host_policy_map_;
+
+    // Byte size of the pre-faulted, huge-page backed pool used to serve
+    // large non-pinned allocations. Zero disables the pool.
+    uint64_t huge_page_pool_byte_size_;
+
+    // Non-pinned allocations of at least this byte size are served from
+    // the huge-page pool while it has room.
+    uint64_t huge_page_threshold_byte_size_;
   };
 
   ~PinnedMemoryManager();
@@ -62,7 +74,8 @@ class PinnedMemoryManager {
   // Allocate pinned memory with the requested 'size' and return the pointer
   // in 'ptr'. If 'allow_nonpinned_fallback' is true, regular system memory
   // will be allocated as fallback in the case where pinned memory fails to
-  // be allocated.
+  // be allocated. Large fallback allocations are taken from the huge-page
+  // pool if one has been configured.
   // Return Status object indicating success or failure.
   static Status Alloc(
       void** ptr, uint64_t size, TRITONSERVER_MemoryType* allocated_type,
@@ -77,12 +90,22 @@ class PinnedMemoryManager {
   // for testing only.
   static void Reset();
 
+  // Return true if 'ptr' lies within the huge-page pool, for testing
+  // only.
+  static bool IsHugePageMemory(const void* ptr);
+
  private:
+  // A host buffer managed as a memory pool. The buffer is either pinned
+  // memory allocated by CUDA or, if 'is_huge_page' is true, an anonymous
+  // mapping backed by huge pages.
   class PinnedMemory {
    public:
-    PinnedMemory(void* pinned_memory_buffer, uint64_t size);
+    PinnedMemory(
+        void* pinned_memory_buffer, uint64_t size, bool is_huge_page = false);
     ~PinnedMemory();
     void* pinned_memory_buffer_;
+    uint64_t size_;
+    bool is_huge_page_;
     std::mutex buffer_mtx_;
     boost::interprocess::managed_external_buffer managed_pinned_memory_;
   };
@@ -96,13 +119,20 @@ class PinnedMemoryManager {
   void AddPinnedMemoryBuffer(
       const std::shared_ptr<PinnedMemory>& pinned_memory_buffer,
       unsigned long node_mask);
+  Status CreateHugePageMemoryBuffer(
+      uint64_t pool_byte_size, uint64_t threshold_byte_size);
 
   static std::unique_ptr<PinnedMemoryManager> instance_;
   static uint64_t pinned_memory_byte_size_;
 
   std::mutex info_mtx_;
+  // Map from allocated address to whether the allocation is pinned and
+  // the pool it is allocated from, nullptr if allocated with malloc().
   std::map<void*, std::pair<bool, PinnedMemory*>> memory_info_;
   std::map<unsigned long, std::shared_ptr<PinnedMemory>> pinned_memory_buffers_;
+
+  std::shared_ptr<PinnedMemory> huge_page_memory_buffer_;
+  uint64_t huge_page_threshold_byte_size_ = 0;
 };
 
 }}  // namespace triton::core
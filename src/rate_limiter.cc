@@ -26,6 +26,11 @@
 
 #include "rate_limiter.h"
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include <limits>
 #include "triton/common/logging.h"
 
@@ -33,6 +38,16 @@ namespace triton { namespace core {
 
 constexpr size_t MAX_PAYLOAD_BUCKET_COUNT = 1000;
 
+namespace {
+
+// True on the threads that execute payloads, the backend threads and a
+// thread while it executes a payload directly. Such a thread runs at
+// the nice value and NUMA binding of its own instance, which must not
+// be used to execute a payload of another instance.
+thread_local bool executes_payloads = false;
+
+}  // namespace
+
 //=========================================================================
 //  Core Implementation
 //=========================================================================
@@ -195,15 +210,19 @@ RateLimiter::EnqueuePayload(
     }
     payload_queue = payload_queues_[model].get();
   }
+  // A backend thread whose instance executes a payload directly can
+  // not take the payload, so wake all of them in that case.
+  bool wake_all = false;
   {
     std::lock_guard<std::mutex> lk(payload_queue->mu_);
     payload->SetState(Payload::State::REQUESTED);
     if (ignore_resources_and_priority_) {
       SchedulePayload(pinstance, payload_queue, payload);
     }
+    wake_all = !payload_queue->direct_instances_.empty();
   }
   if (ignore_resources_and_priority_) {
-    if (pinstance == nullptr) {
+    if ((pinstance == nullptr) && !wake_all) {
       payload_queue->cv_.notify_one();
     } else {
       payload_queue->cv_.notify_all();
@@ -233,6 +252,7 @@ RateLimiter::DequeuePayload(
     std::deque<TritonModelInstance*>& instances,
     std::shared_ptr<Payload>* payload)
 {
+  executes_payloads = true;
   payload->reset();
   PayloadQueue* payload_queue = nullptr;
   {
@@ -243,32 +263,50 @@ RateLimiter::DequeuePayload(
     payload_queue = payload_queues_[instances[0]->Model()].get();
   }
   std::vector<std::shared_ptr<Payload>> merged_payloads;
-  size_t instance_index = std::numeric_limits<std::size_t>::max();
+  size_t instance_index = 0;
+  bool generic = false;
   {
     std::unique_lock<std::mutex> lk(payload_queue->mu_);
-    payload_queue->cv_.wait(lk, [&instances, &instance_index, payload_queue]() {
-      bool empty = payload_queue->queue_->Empty();
-      if (empty) {
-        instance_index = 0;
-        for (const auto instance : instances) {
-          empty = payload_queue->specific_queues_[instance]->Empty();
-          if (empty) {
-            instance_index++;
-          } else {
-            break;
+    payload_queue->waiting_instances_.insert(
+        instances.begin(), instances.end());
+    payload_queue->cv_.wait(
+        lk, [&instances, &instance_index, &generic, payload_queue]() {
+          // Instances executing a payload on the thread that enqueued it
+          // can not be given another payload.
+          const auto& direct_instances = payload_queue->direct_instances_;
+          bool available = false;
+          for (instance_index = 0; instance_index < instances.size();
+               instance_index++) {
+            if (direct_instances.find(instances[instance_index]) ==
+                direct_instances.end()) {
+              available = true;
+              break;
+            }
           }
-        }
-      }
-      return !empty;
-    });
-    if (instance_index < instances.size()) {
-      TritonModelInstance* instance = instances[instance_index];
-      if (!payload_queue->specific_queues_[instance]->Empty()) {
-        payload_queue->specific_queues_[instance]->Dequeue(
-            payload, &merged_payloads);
-      }
-    } else {
+          if (!available) {
+            return false;
+          }
+          generic = !payload_queue->queue_->Empty();
+          if (generic) {
+            return true;
+          }
+          for (; instance_index < instances.size(); instance_index++) {
+            TritonModelInstance* instance = instances[instance_index];
+            if ((direct_instances.find(instance) == direct_instances.end()) &&
+                !payload_queue->specific_queues_[instance]->Empty()) {
+              return true;
+            }
+          }
+          return false;
+        });
+    for (const auto instance : instances) {
+      payload_queue->waiting_instances_.erase(instance);
+    }
+    if (generic) {
       payload_queue->queue_->Dequeue(payload, &merged_payloads);
+    } else {
+      payload_queue->specific_queues_[instances[instance_index]]->Dequeue(
+          payload, &merged_payloads);
     }
   }
   for (auto& merge_payload : merged_payloads) {
@@ -276,11 +314,98 @@ RateLimiter::DequeuePayload(
   }
   (*payload)->Callback();
   if ((*payload)->GetInstance() == nullptr) {
-    (*payload)->SetInstance(instances.front());
-    instances.pop_front();
-  } else {
-    instances.erase(instances.begin() + instance_index);
+    (*payload)->SetInstance(instances[instance_index]);
+  }
+  instances.erase(instances.begin() + instance_index);
+}
+
+bool
+RateLimiter::ExecutePayloadIfIdle(
+    const TritonModel* model, std::shared_ptr<Payload>& payload)
+{
+  // Executing directly skips staging the instance so the resources
+  // and priority would not be accounted for.
+  if (!ignore_resources_and_priority_) {
+    return false;
+  }
+
+  // Only execute on threads that run like a backend thread would, so
+  // not on a thread already executing a payload, e.g. an ensemble
+  // step enqueued from the response callback of another model, nor on
+  // a thread whose nice value differs from the default the backend
+  // threads run at.
+  if (executes_payloads) {
+    return false;
   }
+#ifndef _WIN32
+  if (getpriority(PRIO_PROCESS, syscall(SYS_gettid)) != 0) {
+    return false;
+  }
+#endif
+
+  PayloadQueue* payload_queue = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(payload_queues_mu_);
+    auto itr = payload_queues_.find(model);
+    if (itr == payload_queues_.end()) {
+      return false;
+    }
+    payload_queue = itr->second.get();
+  }
+
+  TritonModelInstance* instance = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(payload_queue->mu_);
+    // Don't overtake payloads that are already waiting for the model.
+    if (!payload_queue->queue_->Empty()) {
+      return false;
+    }
+    for (const auto candidate : payload_queue->waiting_instances_) {
+      // The NUMA binding of a host policy can't be applied to the
+      // calling thread without changing it for the caller.
+      if (!candidate->HostPolicy().empty()) {
+        continue;
+      }
+      const auto sitr = payload_queue->specific_queues_.find(candidate);
+      if ((sitr != payload_queue->specific_queues_.end()) &&
+          sitr->second->Empty() &&
+          (payload_queue->direct_instances_.find(candidate) ==
+           payload_queue->direct_instances_.end())) {
+        instance = candidate;
+        break;
+      }
+    }
+    if (instance == nullptr) {
+      return false;
+    }
+    payload_queue->direct_instances_.insert(instance);
+  }
+
+  {
+    std::lock_guard<std::mutex> exec_lock(*(payload->GetExecMutex()));
+    payload->SetState(Payload::State::EXECUTING);
+  }
+  payload->SetInstance(instance);
+  payload->Callback();
+  bool should_exit;
+  executes_payloads = true;
+  payload->Execute(&should_exit);
+  executes_payloads = false;
+
+  // Payloads enqueued meanwhile may be waiting for the instance.
+  bool pending;
+  {
+    std::lock_guard<std::mutex> lk(payload_queue->mu_);
+    payload_queue->direct_instances_.erase(instance);
+    pending = !payload_queue->queue_->Empty() ||
+              !payload_queue->specific_queues_[instance]->Empty();
+  }
+  if (pending) {
+    payload_queue->cv_.notify_all();
+  }
+
+  PayloadRelease(payload);
+  return true;
 }
 
 std::shared_ptr<Payload>
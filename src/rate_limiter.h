@@ -29,6 +29,7 @@
 #include <functional>
 #include <mutex>
 #include <queue>
+#include <set>
 #include <vector>
 
 #include "backend_model.h"
@@ -115,6 +116,21 @@ class RateLimiter {
       std::deque<TritonModelInstance*>& instance,
       std::shared_ptr<Payload>* payload);
 
+  /// Executes the payload on the calling thread if an instance of the
+  /// model is idle and no other payload is waiting for the model. The
+  /// payload is executed and released exactly as if it had been
+  /// dequeued by the backend thread of the instance, which can not
+  /// dequeue other payloads for the instance meanwhile. Only possible
+  /// when resource constraints and priorities are ignored, for
+  /// instances without a host policy and from a thread at the default
+  /// nice value that is not executing a payload itself.
+  /// \param model The pointer to TritonModel object the payload is for.
+  /// \param payload The shared pointer to the payload object.
+  /// \return true if the payload was executed, false if it must be
+  /// enqueued instead.
+  bool ExecutePayloadIfIdle(
+      const TritonModel* model, std::shared_ptr<Payload>& payload);
+
   /// Returns a new payload object.
   /// \param op_type The operation type for the payload.
   /// \param instance Optional field that providess the model instance that must
@@ -344,6 +360,10 @@ class RateLimiter {
     std::unique_ptr<InstanceQueue> queue_;
     std::map<const TritonModelInstance*, std::unique_ptr<InstanceQueue>>
         specific_queues_;
+    // Instances whose backend thread is waiting for a payload.
+    std::set<TritonModelInstance*> waiting_instances_;
+    // Instances executing a payload on the thread that enqueued it.
+    std::set<const TritonModelInstance*> direct_instances_;
     std::mutex mu_;
     std::condition_variable cv_;
   };
@@ -0,0 +1,232 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "repository_snapshot.h"
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace triton { namespace core {
+
+namespace {
+
+// Identifies the file format, to be changed with the format.
+constexpr char kSnapshotMagic[] = "TRITON_REPOSITORY_SNAPSHOT_1";
+
+void
+AppendUInt64(uint64_t value, std::string* buffer)
+{
+  for (size_t idx = 0; idx < sizeof(value); ++idx) {
+    buffer->push_back(static_cast<char>((value >> (8 * idx)) & 0xff));
+  }
+}
+
+void
+AppendString(const std::string& value, std::string* buffer)
+{
+  AppendUInt64(value.size(), buffer);
+  buffer->append(value);
+}
+
+// Reads the fields of a snapshot, checking that they are within the
+// snapshot.
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(const std::string& buffer)
+      : buffer_(buffer), offset_(0)
+  {
+  }
+
+  bool ReadUInt64(uint64_t* value)
+  {
+    if ((buffer_.size() - offset_) < sizeof(*value)) {
+      return false;
+    }
+    *value = 0;
+    for (size_t idx = 0; idx < sizeof(*value); ++idx) {
+      *value |= static_cast<uint64_t>(
+                    static_cast<unsigned char>(buffer_[offset_ + idx]))
+                << (8 * idx);
+    }
+    offset_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadInt64(int64_t* value)
+  {
+    uint64_t uvalue;
+    if (!ReadUInt64(&uvalue)) {
+      return false;
+    }
+    *value = static_cast<int64_t>(uvalue);
+    return true;
+  }
+
+  bool ReadString(std::string* value)
+  {
+    uint64_t size;
+    if (!ReadUInt64(&size) || ((buffer_.size() - offset_) < size)) {
+      return false;
+    }
+    value->assign(buffer_, offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool AtEnd() const { return offset_ == buffer_.size(); }
+
+ private:
+  const std::string& buffer_;
+  size_t offset_;
+};
+
+}  // namespace
+
+Status
+RepositorySnapshot::Write(
+    const std::string& path, const std::string& key,
+    const std::vector<Entry>& entries)
+{
+  std::string buffer;
+  AppendString(kSnapshotMagic, &buffer);
+  AppendString(key, &buffer);
+  AppendUInt64(entries.size(), &buffer);
+  for (const auto& entry : entries) {
+    AppendString(entry.namespace_, &buffer);
+    AppendString(entry.name_, &buffer);
+    AppendString(entry.model_path_, &buffer);
+    AppendUInt64(static_cast<uint64_t>(entry.mtime_nsec_.first), &buffer);
+    AppendUInt64(static_cast<uint64_t>(entry.mtime_nsec_.second), &buffer);
+    AppendUInt64(entry.is_config_provided_ ? 1 : 0, &buffer);
+    AppendString(entry.config_content_, &buffer);
+    AppendString(entry.layout_, &buffer);
+    AppendString(entry.parsed_config_, &buffer);
+    AppendString(entry.normalized_config_, &buffer);
+  }
+
+  // Write to a temporary file first so that a snapshot being written
+  // is never read.
+  const std::string temp_path = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out(temp_path, std::ios::out | std::ios::binary);
+    if (!out) {
+      return Status(
+          Status::Code::INTERNAL,
+          "failed to open repository snapshot '" + temp_path +
+              "': " + strerror(errno));
+    }
+    out.write(buffer.data(), buffer.size());
+    out.close();
+    if (out.fail()) {
+      std::remove(temp_path.c_str());
+      return Status(
+          Status::Code::INTERNAL,
+          "failed to write repository snapshot '" + temp_path + "'");
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    const std::string error = strerror(errno);
+    std::remove(temp_path.c_str());
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to write repository snapshot '" + path + "': " + error);
+  }
+
+  return Status::Success;
+}
+
+Status
+RepositorySnapshot::Read(
+    const std::string& path, const std::string& key,
+    std::vector<Entry>* entries)
+{
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  if (!in) {
+    return Status(
+        Status::Code::NOT_FOUND,
+        "repository snapshot '" + path + "' does not exist");
+  }
+  std::stringstream contents;
+  contents << in.rdbuf();
+  if (in.bad()) {
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to read repository snapshot '" + path + "'");
+  }
+  const std::string buffer = contents.str();
+
+  const Status malformed(
+      Status::Code::INVALID_ARG,
+      "repository snapshot '" + path + "' is malformed");
+  SnapshotReader reader(buffer);
+  std::string magic, snapshot_key;
+  if (!reader.ReadString(&magic) || (magic != kSnapshotMagic) ||
+      !reader.ReadString(&snapshot_key)) {
+    return malformed;
+  }
+  if (snapshot_key != key) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "repository snapshot '" + path +
+            "' was taken by a different server or with different options");
+  }
+
+  uint64_t count;
+  if (!reader.ReadUInt64(&count)) {
+    return malformed;
+  }
+  std::vector<Entry> read_entries;
+  for (uint64_t idx = 0; idx < count; ++idx) {
+    Entry entry;
+    uint64_t is_config_provided;
+    if (!reader.ReadString(&entry.namespace_) ||
+        !reader.ReadString(&entry.name_) ||
+        !reader.ReadString(&entry.model_path_) ||
+        !reader.ReadInt64(&entry.mtime_nsec_.first) ||
+        !reader.ReadInt64(&entry.mtime_nsec_.second) ||
+        !reader.ReadUInt64(&is_config_provided) ||
+        !reader.ReadString(&entry.config_content_) ||
+        !reader.ReadString(&entry.layout_) ||
+        !reader.ReadString(&entry.parsed_config_) ||
+        !reader.ReadString(&entry.normalized_config_)) {
+      return malformed;
+    }
+    entry.is_config_provided_ = (is_config_provided != 0);
+    read_entries.emplace_back(std::move(entry));
+  }
+  if (!reader.AtEnd()) {
+    return malformed;
+  }
+
+  *entries = std::move(read_entries);
+  return Status::Success;
+}
+
+}}  // namespace triton::core
@@ -0,0 +1,79 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "status.h"
+
+namespace triton { namespace core {
+
+//
+// File holding the result of polling the model repositories, so that a
+// restarted server can skip reading, normalizing and validating the
+// configurations of the models whose files are unchanged. The snapshot
+// is tagged with a key describing the server and the options the
+// configurations were normalized with, a snapshot with a different key
+// is ignored.
+//
+class RepositorySnapshot {
+ public:
+  // The polling result of a model.
+  struct Entry {
+    Entry() : mtime_nsec_(0, 0), is_config_provided_(false) {}
+
+    std::string namespace_;
+    std::string name_;
+    std::string model_path_;
+    // Last modified time in ns, for '<config.pbtxt, model files>'
+    std::pair<int64_t, int64_t> mtime_nsec_;
+    bool is_config_provided_;
+    // The content of the configuration file and the layout of the
+    // model directory the configuration was normalized against.
+    std::string config_content_;
+    std::string layout_;
+    // The serialized parsed and normalized configurations.
+    std::string parsed_config_;
+    std::string normalized_config_;
+  };
+
+  // Write 'entries' tagged with 'key' to the local file 'path'. The
+  // file is replaced atomically.
+  static Status Write(
+      const std::string& path, const std::string& key,
+      const std::vector<Entry>& entries);
+
+  // Read the entries of the snapshot in the local file 'path'. Return
+  // NOT_FOUND if there is no snapshot, and INVALID_ARG if the snapshot
+  // is malformed or not tagged with 'key'.
+  static Status Read(
+      const std::string& path, const std::string& key,
+      std::vector<Entry>* entries);
+};
+
+}}  // namespace triton::core
@@ -0,0 +1,245 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "repository_watcher.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <cstring>
+#include "filesystem.h"
+#include "triton/common/logging.h"
+
+namespace triton { namespace core {
+
+#ifdef __linux__
+namespace {
+
+// Events that change the modification time of a model directory or of
+// the files within, which is what full polling compares.
+constexpr uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                IN_MOVED_TO | IN_MODIFY | IN_ATTRIB |
+                                IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+}  // namespace
+#endif  // __linux__
+
+Status
+RepositoryWatcher::Create(
+    const std::set<std::string>& repository_paths,
+    std::unique_ptr<RepositoryWatcher>* watcher)
+{
+#ifdef __linux__
+  for (const auto& path : repository_paths) {
+    FileSystemType type;
+    RETURN_IF_ERROR(GetFileSystemType(path, &type));
+    if (type != FileSystemType::LOCAL) {
+      return Status(
+          Status::Code::UNSUPPORTED,
+          "changes to " + FileSystemTypeString(type) + " repository '" + path +
+              "' can't be watched");
+    }
+  }
+
+  std::unique_ptr<RepositoryWatcher> local_watcher(
+      new RepositoryWatcher(repository_paths));
+  RETURN_IF_ERROR(local_watcher->ResetWatches());
+  *watcher = std::move(local_watcher);
+  return Status::Success;
+#else
+  return Status(
+      Status::Code::UNSUPPORTED,
+      "changes to model repositories can't be watched on this platform");
+#endif  // __linux__
+}
+
+RepositoryWatcher::RepositoryWatcher(
+    const std::set<std::string>& repository_paths)
+    : repository_paths_(repository_paths), fd_(-1), rescan_(false),
+      disabled_(false)
+{
+}
+
+RepositoryWatcher::~RepositoryWatcher()
+{
+#ifdef __linux__
+  if (fd_ != -1) {
+    close(fd_);
+  }
+#endif  // __linux__
+}
+
+bool
+RepositoryWatcher::CollectChanges(std::set<std::string>* changed_paths)
+{
+  if (disabled_) {
+    return false;
+  }
+
+  ReadEvents();
+  if (rescan_) {
+    // Re-establish the watches before the caller rescans so that no
+    // change made during the rescan is missed.
+    changed_paths_.clear();
+    rescan_ = false;
+    Status status = ResetWatches();
+    if (!status.IsOk()) {
+      LOG_WARNING << "failed to watch model repositories, falling back to "
+                     "full repository polling: "
+                  << status.Message();
+      disabled_ = true;
+    }
+    return false;
+  }
+
+  changed_paths->swap(changed_paths_);
+  changed_paths_.clear();
+  return true;
+}
+
+Status
+RepositoryWatcher::ResetWatches()
+{
+#ifdef __linux__
+  if (fd_ != -1) {
+    close(fd_);
+  }
+  watches_.clear();
+
+  fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ == -1) {
+    return Status(
+        Status::Code::UNSUPPORTED,
+        "failed to initialize inotify: " + std::string(strerror(errno)));
+  }
+  for (const auto& path : repository_paths_) {
+    RETURN_IF_ERROR(AddWatches(path, ""));
+  }
+#endif  // __linux__
+  return Status::Success;
+}
+
+Status
+RepositoryWatcher::AddWatches(
+    const std::string& path, const std::string& model_path)
+{
+#ifdef __linux__
+  const int wd = inotify_add_watch(fd_, path.c_str(), kWatchMask);
+  if (wd == -1) {
+    // The directory may have been removed since it was listed, the
+    // removal is reported on its parent.
+    if ((errno == ENOENT) || (errno == ENOTDIR)) {
+      return Status::Success;
+    }
+    return Status(
+        Status::Code::UNSUPPORTED, "failed to watch '" + path +
+                                       "': " + std::string(strerror(errno)));
+  }
+  // Watching a directory that is already watched, i.e. one that was
+  // moved, returns the existing descriptor, so always update the entry.
+  watches_[wd] = Watch{path, model_path};
+
+  std::set<std::string> subdirs;
+  if (!GetDirectorySubdirs(path, &subdirs).IsOk()) {
+    return Status::Success;
+  }
+  for (const auto& subdir : subdirs) {
+    const auto subdir_path = JoinPath({path, subdir});
+    RETURN_IF_ERROR(AddWatches(
+        subdir_path, model_path.empty() ? subdir_path : model_path));
+  }
+#endif  // __linux__
+  return Status::Success;
+}
+
+void
+RepositoryWatcher::ReadEvents()
+{
+#ifdef __linux__
+  alignas(struct inotify_event) char buffer[16 * 1024];
+  while (true) {
+    const ssize_t len = read(fd_, buffer, sizeof(buffer));
+    if (len <= 0) {
+      // EAGAIN, no more pending events
+      break;
+    }
+
+    for (char* ptr = buffer; ptr < buffer + len;) {
+      const struct inotify_event* event =
+          reinterpret_cast<const struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+
+      if ((event->mask & IN_Q_OVERFLOW) != 0) {
+        rescan_ = true;
+        continue;
+      }
+      auto it = watches_.find(event->wd);
+      if (it == watches_.end()) {
+        continue;
+      }
+      if ((event->mask & IN_IGNORED) != 0) {
+        watches_.erase(it);
+        continue;
+      }
+
+      // Copy as adding watches below may invalidate 'it'
+      const Watch watch = it->second;
+      const std::string name = (event->len > 0) ? event->name : "";
+      if (watch.model_path_.empty()) {
+        // The repository itself is gone or moved, can't tell which
+        // models are affected.
+        if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0) {
+          rescan_ = true;
+          continue;
+        }
+        if (name.empty()) {
+          continue;
+        }
+      }
+
+      const auto path =
+          name.empty() ? watch.path_ : JoinPath({watch.path_, name});
+      const auto& model_path =
+          watch.model_path_.empty() ? path : watch.model_path_;
+      changed_paths_.insert(model_path);
+
+      if (((event->mask & IN_ISDIR) != 0) &&
+          ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)) {
+        Status status = AddWatches(path, model_path);
+        if (!status.IsOk()) {
+          LOG_WARNING << status.Message();
+          rescan_ = true;
+        }
+      }
+    }
+  }
+#endif  // __linux__
+}
+
+}}  // namespace triton::core
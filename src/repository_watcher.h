@@ -0,0 +1,106 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "status.h"
+
+namespace triton { namespace core {
+
+//
+// Tracks changes to local model repositories so that polling only
+// needs to re-examine the model directories that have changed. The
+// repository directories and every directory below them are watched
+// (using inotify on Linux). An event anywhere within a model directory
+// marks that model directory as changed, an event on a repository
+// directory entry marks the corresponding model directory as changed.
+//
+// If the events can't be tracked precisely, for example when the event
+// queue overflows, the watches are re-established and the caller is
+// asked to fall back to a full rescan of the repositories.
+//
+class RepositoryWatcher {
+ public:
+  // Create a watcher for 'repository_paths'. Return UNSUPPORTED if
+  // changes to any of the repositories can't be watched, in which case
+  // the repositories must be fully polled.
+  static Status Create(
+      const std::set<std::string>& repository_paths,
+      std::unique_ptr<RepositoryWatcher>* watcher);
+
+  ~RepositoryWatcher();
+
+  // Collect the changes since the last call. Return true and the
+  // paths of the changed model directories in 'changed_paths' if the
+  // changes are tracked precisely. Return false if the repositories
+  // must be fully rescanned instead, 'changed_paths' is unchanged in
+  // that case.
+  bool CollectChanges(std::set<std::string>* changed_paths);
+
+ private:
+  struct Watch {
+    // The watched directory.
+    std::string path_;
+    // The model directory containing the watched directory, empty if
+    // the watched directory is a repository.
+    std::string model_path_;
+  };
+
+  RepositoryWatcher(const std::set<std::string>& repository_paths);
+
+  // (Re)establish the watches on all repositories.
+  Status ResetWatches();
+
+  // Watch 'path' and all directories below it.
+  Status AddWatches(const std::string& path, const std::string& model_path);
+
+  // Read all pending events and update 'changed_paths_'.
+  void ReadEvents();
+
+  const std::set<std::string> repository_paths_;
+
+  // The inotify instance, -1 if not initialized.
+  int fd_;
+
+  // Map from watch descriptor to the watched directory.
+  std::unordered_map<int, Watch> watches_;
+
+  // The model directories changed since the last CollectChanges().
+  std::set<std::string> changed_paths_;
+
+  // Whether the events since the last CollectChanges() are incomplete
+  // and the repositories must be fully rescanned.
+  bool rescan_;
+
+  // Whether the watches can't be maintained, in which case every poll
+  // is a full rescan.
+  bool disabled_;
+};
+
+}}  // namespace triton::core
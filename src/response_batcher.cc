@@ -0,0 +1,202 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "response_batcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <thread>
+
+namespace triton { namespace core {
+
+namespace {
+
+uint64_t
+NowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+//
+// Single thread that flushes response batches whose delay has expired,
+// shared by all batchers so that batching doesn't cost a thread per
+// request.
+//
+class ResponseBatchTimer {
+ public:
+  // The timer is never destroyed so that its thread can't outlive it
+  // during process exit.
+  static ResponseBatchTimer* Instance()
+  {
+    static ResponseBatchTimer* timer = new ResponseBatchTimer();
+    return timer;
+  }
+
+  // Call FlushIfDue() on 'batcher' at 'deadline_ns' if it is still
+  // alive.
+  void Schedule(
+      const std::weak_ptr<ResponseBatcher>& batcher, const uint64_t deadline_ns)
+  {
+    bool wake = false;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      wake = deadlines_.empty() || (deadline_ns < deadlines_.begin()->first);
+      deadlines_.emplace(deadline_ns, batcher);
+    }
+    if (wake) {
+      cv_.notify_one();
+    }
+  }
+
+ private:
+  ResponseBatchTimer()
+  {
+    std::thread([this]() { TimerThread(); }).detach();
+  }
+
+  void TimerThread()
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (true) {
+      if (deadlines_.empty()) {
+        cv_.wait(lock);
+        continue;
+      }
+
+      const uint64_t now_ns = NowNs();
+      const uint64_t deadline_ns = deadlines_.begin()->first;
+      if (deadline_ns > now_ns) {
+        cv_.wait_for(lock, std::chrono::nanoseconds(deadline_ns - now_ns));
+        continue;
+      }
+
+      std::shared_ptr<ResponseBatcher> batcher =
+          deadlines_.begin()->second.lock();
+      deadlines_.erase(deadlines_.begin());
+      if (batcher != nullptr) {
+        // Deliver outside of the lock as the client callback may take
+        // arbitrarily long and other batchers must still be scheduled.
+        lock.unlock();
+        batcher->FlushIfDue(now_ns);
+        batcher.reset();
+        lock.lock();
+      }
+    }
+  }
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::multimap<uint64_t, std::weak_ptr<ResponseBatcher>> deadlines_;
+};
+
+}  // namespace
+
+ResponseBatcher::ResponseBatcher(
+    TRITONSERVER_InferenceResponseBatchCompleteFn_t batch_fn, void* userp,
+    const uint32_t max_batch_count, const uint64_t max_delay_us)
+    : batch_fn_(batch_fn), userp_(userp),
+      max_batch_count_(std::max(1U, max_batch_count)),
+      max_delay_ns_(max_delay_us * 1000), batch_start_ns_(0)
+{
+  responses_.reserve(max_batch_count_);
+  flags_.reserve(max_batch_count_);
+}
+
+ResponseBatcher::~ResponseBatcher()
+{
+  Flush();
+}
+
+void
+ResponseBatcher::Send(
+    TRITONSERVER_InferenceResponse* response, const uint32_t flags)
+{
+  bool flush = false;
+  bool schedule = false;
+  uint64_t deadline_ns = 0;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (responses_.empty()) {
+      batch_start_ns_ = NowNs();
+      deadline_ns = batch_start_ns_ + max_delay_ns_;
+      schedule = true;
+    }
+    responses_.push_back(response);
+    flags_.push_back(flags);
+    flush = (responses_.size() >= max_batch_count_) ||
+            ((flags & TRITONSERVER_RESPONSE_COMPLETE_FINAL) != 0);
+  }
+
+  if (flush) {
+    Flush();
+  } else if (schedule) {
+    ResponseBatchTimer::Instance()->Schedule(shared_from_this(), deadline_ns);
+  }
+}
+
+void
+ResponseBatcher::FlushIfDue(const uint64_t now_ns)
+{
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    // The batch the timer was scheduled for may already have been
+    // delivered, in which case a newer batch has its own deadline.
+    if (responses_.empty() || ((batch_start_ns_ + max_delay_ns_) > now_ns)) {
+      return;
+    }
+  }
+
+  Flush();
+}
+
+void
+ResponseBatcher::Flush()
+{
+  std::lock_guard<std::mutex> delivery_lock(delivery_mu_);
+
+  std::vector<TRITONSERVER_InferenceResponse*> responses;
+  std::vector<uint32_t> flags;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (responses_.empty()) {
+      return;
+    }
+    responses.reserve(max_batch_count_);
+    flags.reserve(max_batch_count_);
+    responses.swap(responses_);
+    flags.swap(flags_);
+  }
+
+  batch_fn_(
+      responses.data(), flags.data(), static_cast<uint32_t>(responses.size()),
+      userp_);
+}
+
+}}  // namespace triton::core
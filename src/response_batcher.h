@@ -0,0 +1,85 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "constants.h"
+#include "tritonserver_apis.h"
+
+namespace triton { namespace core {
+
+//
+// Gathers the responses sent for a request and delivers them to the
+// client in one batch callback. A batch is delivered when it holds
+// 'max_batch_count' responses, when a response carrying the
+// TRITONSERVER_RESPONSE_COMPLETE_FINAL flag is sent, or when
+// 'max_delay_us' has passed since the first response of the batch
+// was sent, whichever happens first. Responses are delivered in the
+// order they were sent and batches are delivered one at a time.
+//
+class ResponseBatcher : public std::enable_shared_from_this<ResponseBatcher> {
+ public:
+  ResponseBatcher(
+      TRITONSERVER_InferenceResponseBatchCompleteFn_t batch_fn, void* userp,
+      const uint32_t max_batch_count, const uint64_t max_delay_us);
+
+  // Any responses still pending are delivered.
+  ~ResponseBatcher();
+
+  // Send 'response', which may be nullptr for a response that only
+  // carries 'flags'. The batcher takes ownership of 'response'.
+  void Send(TRITONSERVER_InferenceResponse* response, const uint32_t flags);
+
+  // Deliver the pending responses if the oldest has waited for at
+  // least 'max_delay_us' at 'now_ns'.
+  void FlushIfDue(const uint64_t now_ns);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ResponseBatcher);
+
+  // Deliver all pending responses.
+  void Flush();
+
+  const TRITONSERVER_InferenceResponseBatchCompleteFn_t batch_fn_;
+  void* const userp_;
+  const uint32_t max_batch_count_;
+  const uint64_t max_delay_ns_;
+
+  // Serializes delivery so batches reach the client in order. Always
+  // acquired before 'mu_'.
+  std::mutex delivery_mu_;
+
+  // Protects the pending responses.
+  std::mutex mu_;
+  std::vector<TRITONSERVER_InferenceResponse*> responses_;
+  std::vector<uint32_t> flags_;
+  uint64_t batch_start_ns_;
+};
+
+}}  // namespace triton::core
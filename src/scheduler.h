@@ -69,6 +69,19 @@ class Scheduler {
   // caller still retains ownership of 'request'.
   virtual Status Enqueue(std::unique_ptr<InferenceRequest>& request) = 0;
 
+  // Enqueue a batch of requests with the scheduler. The scheduler
+  // always takes ownership of all 'requests'. A request that cannot be
+  // enqueued is completed with an error response and released. The
+  // default implementation enqueues the requests one at a time.
+  virtual void EnqueueBatch(
+      std::vector<std::unique_ptr<InferenceRequest>>& requests)
+  {
+    for (auto& request : requests) {
+      InferenceRequest::RespondIfError(
+          request, Enqueue(request), true /* release_request */);
+    }
+  }
+
   // Return the number of in-flight inferences tracked by the scheduler.
   virtual size_t InflightInferenceCount() = 0;
 
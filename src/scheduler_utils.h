@@ -96,6 +96,16 @@ class PriorityQueue {
   // Is the queue is empty? Rejected requests are not included.
   bool Empty() { return Size() == 0; }
 
+  // Invoke 'fn(priority_level, size)' for each instantiated priority
+  // level, rejected requests are not included in 'size'.
+  template <typename F>
+  void ForEachLevelSize(F fn)
+  {
+    for (auto& queue : queues_) {
+      fn(queue.first, queue.second.Size());
+    }
+  }
+
   // Reset the cursor such that it is representing an empty pending batch.
   void ResetCursor() { pending_cursor_ = Cursor(queues_.begin()); }
 
@@ -81,6 +81,21 @@ SequenceBatchScheduler::Create(
 
   sched->max_batch_size_ = config.max_batch_size();
 
+#ifdef TRITON_ENABLE_METRICS
+  // The sequence backlog is reported at the model level, without a
+  // device label.
+  const bool response_cache_enabled =
+      config.response_cache().enable() &&
+      model->Server()->ResponseCacheEnabled();
+  MetricReporterConfig reporter_config;
+  reporter_config.ParseConfig(response_cache_enabled, model->Name());
+  if (Metrics::Enabled() && reporter_config.scheduler_metrics_enabled_) {
+    MetricModelReporter::Create(
+        model->Name(), model->Version(), METRIC_REPORTER_ID_CPU,
+        response_cache_enabled, config.metric_tags(), &sched->reporter_);
+  }
+#endif  // TRITON_ENABLE_METRICS
+
   // Implicit States
   auto& states = config.sequence_batching().state();
 
@@ -687,6 +702,7 @@ SequenceBatchScheduler::Enqueue(std::unique_ptr<InferenceRequest>& irequest)
       }
     }
     backlog_queues_.push_back(backlog);
+    ReportBacklog();
     backlog->queue_->emplace_back(std::move(irequest));
     if (!seq_end) {
       sequence_to_backlog_map_[correlation_id] = std::move(backlog);
@@ -737,6 +753,7 @@ SequenceBatchScheduler::ReleaseSequenceSlot(
     auto& backlog = backlog_queues_.front()->queue_;
     *requests = std::move(*backlog);
     backlog_queues_.pop_front();
+    ReportBacklog();
     if (!requests->empty()) {  // should never be empty...
       const auto& irequest = requests->back();
       const InferenceRequest::SequenceId& correlation_id =
@@ -781,6 +798,16 @@ SequenceBatchScheduler::ReleaseSequenceSlot(
   return InferenceRequest::SequenceId();
 }
 
+void
+SequenceBatchScheduler::ReportBacklog()
+{
+#ifdef TRITON_ENABLE_METRICS
+  if (reporter_ != nullptr) {
+    reporter_->SetSchedulerSequenceBacklog(backlog_queues_.size());
+  }
+#endif  // TRITON_ENABLE_METRICS
+}
+
 bool
 SequenceBatchScheduler::DelayScheduler(
     const uint32_t batcher_idx, const size_t cnt, const size_t total)
@@ -947,6 +974,7 @@ SequenceBatchScheduler::ReaperThread(const int nice)
             it = backlog_queues_.erase(it);
           }
         }
+        ReportBacklog();
       }
 
       // Reject timeout requests
@@ -954,6 +982,12 @@ SequenceBatchScheduler::ReaperThread(const int nice)
           Status::Code::UNAVAILABLE,
           "timeout of the corresponding sequence has been expired");
       for (auto& backlog : expired_backlogs) {
+#ifdef TRITON_ENABLE_METRICS
+        if (reporter_ != nullptr) {
+          reporter_->IncrementSchedulerRejections(
+              "sequence_timeout", backlog->queue_->size());
+        }
+#endif  // TRITON_ENABLE_METRICS
         for (auto& req : *backlog->queue_) {
           InferenceRequest::RespondIfError(req, rejected_status, true);
         }
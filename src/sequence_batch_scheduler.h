@@ -36,6 +36,7 @@
 #include <unordered_map>
 #include "backend_model.h"
 #include "backend_model_instance.h"
+#include "metric_model_reporter.h"
 #include "model_config.pb.h"
 #include "rate_limiter.h"
 #include "scheduler.h"
@@ -115,6 +116,10 @@ class SequenceBatchScheduler : public Scheduler {
  private:
   void ReaperThread(const int nice);
 
+  // Report the number of backlogged sequences. Must be called with
+  // 'mu_' held.
+  void ReportBacklog();
+
   Status CreateBooleanControlTensors(
       const inference::ModelConfig& config,
       std::shared_ptr<ControlInputs>* start_input_overrides,
@@ -205,6 +210,9 @@ class SequenceBatchScheduler : public Scheduler {
   // Initial state used for implicit state.
   std::unordered_map<std::string, SequenceStates::InitialStateData>
       initial_state_;
+
+  // Reporter for scheduler metrics, or nullptr if they are not reported
+  std::shared_ptr<MetricModelReporter> reporter_;
 };
 
 // Base class for a scheduler that implements a particular scheduling
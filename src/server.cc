@@ -43,6 +43,8 @@
 #include "model_repository_manager.h"
 #include "pinned_memory_manager.h"
 #include "repo_agent.h"
+#include "trace_binary_sink.h"
+#include "trace_tensor_stager.h"
 #include "triton/common/async_work_queue.h"
 #include "triton/common/logging.h"
 #include "triton/common/model_config.h"
@@ -99,12 +101,28 @@ InferenceServer::InferenceServer()
 #ifdef TRITON_ENABLE_LOGGING
   extensions_.push_back("logging");
 #endif  // TRITON_ENABLE_LOGGING
+  load_on_demand_ = false;
+  load_on_demand_max_models_ = 0;
+  load_on_demand_max_pending_ = 0;
+  model_eviction_policy_ = ModelEvictionPolicy::LRU;
   strict_model_config_ = true;
   strict_readiness_ = true;
   exit_timeout_secs_ = 30;
   pinned_memory_pool_size_ = 1 << 28;
+  huge_page_memory_pool_size_ = 0;
+  huge_page_memory_threshold_ = 0;
+  shm_transport_slot_count_ = 0;
+  shm_transport_slot_byte_size_ = 0;
+  trace_binary_sink_records_per_thread_ = 0;
+  trace_binary_sink_started_ = false;
+  trace_tensor_staging_pool_size_ = 0;
+  trace_tensor_stager_started_ = false;
   buffer_manager_thread_count_ = 0;
   model_load_thread_count_ = 4;
+  model_load_memory_budget_ = 0;
+  model_instance_load_thread_count_ = 1;
+  version_swap_ = false;
+  version_drain_timeout_ms_ = 0;
   enable_model_namespacing_ = false;
 
 #ifdef TRITON_ENABLE_GPU
@@ -116,6 +134,20 @@ InferenceServer::InferenceServer()
   inflight_request_counter_ = 0;
 }
 
+InferenceServer::~InferenceServer()
+{
+#ifdef TRITON_ENABLE_TRACING
+  // Write out the activities of the requests that completed while
+  // stopping.
+  if (trace_binary_sink_started_) {
+    TraceBinarySink::Get()->Stop();
+  }
+  if (trace_tensor_stager_started_) {
+    TraceTensorStager::Get()->Stop();
+  }
+#endif  // TRITON_ENABLE_TRACING
+}
+
 Status
 InferenceServer::Init()
 {
@@ -129,6 +161,14 @@ InferenceServer::Init()
         Status::Code::INVALID_ARG, "--model-repository must be specified");
   }
 
+  if (load_on_demand_ &&
+      (model_control_mode_ != ModelControlMode::MODE_EXPLICIT)) {
+    ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
+    return Status(
+        Status::Code::INVALID_ARG,
+        "loading models on demand requires explicit model control mode");
+  }
+
   // RepoAgentManager
   if (repoagent_dir_.empty()) {
     ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
@@ -142,6 +182,37 @@ InferenceServer::Init()
     return status;
   }
 
+  if (!trace_binary_sink_path_.empty()) {
+#ifdef TRITON_ENABLE_TRACING
+    status = TraceBinarySink::Get()->Start(
+        trace_binary_sink_path_, trace_binary_sink_records_per_thread_);
+    if (!status.IsOk()) {
+      ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
+      return status;
+    }
+    trace_binary_sink_started_ = true;
+#else
+    ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
+    return Status(
+        Status::Code::UNSUPPORTED, "inference tracing not supported");
+#endif  // TRITON_ENABLE_TRACING
+  }
+
+  if (trace_tensor_staging_pool_size_ > 0) {
+#ifdef TRITON_ENABLE_TRACING
+    status = TraceTensorStager::Get()->Start(trace_tensor_staging_pool_size_);
+    if (!status.IsOk()) {
+      ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
+      return status;
+    }
+    trace_tensor_stager_started_ = true;
+#else
+    ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
+    return Status(
+        Status::Code::UNSUPPORTED, "inference tracing not supported");
+#endif  // TRITON_ENABLE_TRACING
+  }
+
   // BackendManager
   status = TritonBackendManager::Create(&backend_manager_);
   if (!status.IsOk()) {
@@ -199,7 +270,9 @@ InferenceServer::Init()
     return status;
   }
 
-  PinnedMemoryManager::Options options(pinned_memory_pool_size_);
+  PinnedMemoryManager::Options options(
+      pinned_memory_pool_size_, {} /* host_policy_map */,
+      huge_page_memory_pool_size_, huge_page_memory_threshold_);
   status = PinnedMemoryManager::Create(options);
   if (!status.IsOk()) {
     ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
@@ -243,11 +316,12 @@ InferenceServer::Init()
       (model_control_mode_ == ModelControlMode::MODE_EXPLICIT);
   const ModelLifeCycleOptions life_cycle_options(
       min_supported_compute_capability_, backend_cmdline_config_map_,
-      host_policy_map_, model_load_thread_count_);
+      host_policy_map_, model_load_thread_count_, version_swap_,
+      version_drain_timeout_ms_, model_load_memory_budget_);
   status = ModelRepositoryManager::Create(
       this, version_, model_repository_paths_, startup_models_,
       strict_model_config_, polling_enabled, model_control_enabled,
-      life_cycle_options, enable_model_namespacing_,
+      life_cycle_options, enable_model_namespacing_, snapshot_path_,
       &model_repository_manager_);
   if (!status.IsOk()) {
     if (model_repository_manager_ == nullptr) {
@@ -264,6 +338,29 @@ InferenceServer::Init()
     PrintBackendAndModelSummary();
   }
 
+  if ((model_repository_manager_ != nullptr) && load_on_demand_) {
+    Status loader_status = ModelDemandLoader::Create(
+        model_repository_manager_.get(), load_on_demand_max_models_,
+        load_on_demand_max_pending_, model_eviction_policy_, &demand_loader_);
+    if (!loader_status.IsOk()) {
+      ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
+      return loader_status;
+    }
+  }
+
+  // Start accepting requests from co-located processes once the
+  // models are available.
+  if ((ready_state_ == ServerReadyState::SERVER_READY) &&
+      !shm_transport_name_.empty()) {
+    Status transport_status = SharedMemoryTransport::Create(
+        this, shm_transport_name_, shm_transport_slot_count_,
+        shm_transport_slot_byte_size_, &shm_transport_);
+    if (!transport_status.IsOk()) {
+      ready_state_ = ServerReadyState::SERVER_FAILED_TO_INITIALIZE;
+      return transport_status;
+    }
+  }
+
   return status;
 }
 
@@ -276,6 +373,10 @@ InferenceServer::Stop(const bool force)
 
   ready_state_ = ServerReadyState::SERVER_EXITING;
 
+  if (shm_transport_ != nullptr) {
+    shm_transport_->Stop();
+  }
+
   if (model_repository_manager_ == nullptr) {
     LOG_INFO << "No server context available. Exiting immediately.";
     return Status::Success;
@@ -283,6 +384,13 @@ InferenceServer::Stop(const bool force)
     LOG_INFO << "Waiting for in-flight requests to complete.";
   }
 
+  if (!snapshot_path_.empty()) {
+    Status snapshot_status = model_repository_manager_->WriteSnapshot();
+    if (!snapshot_status.IsOk()) {
+      LOG_ERROR << snapshot_status.Message();
+    }
+  }
+
   Status status = model_repository_manager_->StopAllModels();
   if (!status.IsOk()) {
     LOG_ERROR << status.Message();
@@ -362,6 +470,17 @@ InferenceServer::PollModelRepository()
   return Status::Success;
 }
 
+Status
+InferenceServer::WriteModelRepositorySnapshot()
+{
+  if (ready_state_ != ServerReadyState::SERVER_READY) {
+    return Status(Status::Code::UNAVAILABLE, "Server not ready");
+  }
+
+  ScopedAtomicIncrement inflight(inflight_request_counter_);
+  return model_repository_manager_->WriteSnapshot();
+}
+
 Status
 InferenceServer::IsLive(bool* live)
 {
@@ -528,6 +647,28 @@ InferenceServer::InferAsync(std::unique_ptr<InferenceRequest>& request)
   return InferenceRequest::Run(request);
 }
 
+Status
+InferenceServer::InferAsyncBatch(
+    std::vector<std::unique_ptr<InferenceRequest>>& requests)
+{
+  if ((ready_state_ != ServerReadyState::SERVER_READY) &&
+      (ready_state_ != ServerReadyState::SERVER_EXITING)) {
+    return Status(Status::Code::UNAVAILABLE, "Server not ready");
+  }
+
+#ifdef TRITON_ENABLE_STATS
+  for (auto& request : requests) {
+    request->CaptureRequestStartNs();
+    INFER_TRACE_ACTIVITY(
+        request->Trace(), TRITONSERVER_TRACE_REQUEST_START,
+        request->RequestStartNs());
+  }
+#endif  // TRITON_ENABLE_STATS
+
+  InferenceRequest::RunBatch(requests);
+  return Status::Success;
+}
+
 Status
 InferenceServer::LoadModel(
     const std::unordered_map<
@@ -544,6 +685,20 @@ InferenceServer::LoadModel(
       models, action_type, false /* unload_dependents */);
 }
 
+Status
+InferenceServer::GetModelForInference(
+    const std::string& model_name, const int64_t model_version,
+    std::shared_ptr<Model>* model)
+{
+  if ((demand_loader_ == nullptr) ||
+      (ready_state_ != ServerReadyState::SERVER_READY)) {
+    return GetModel(model_name, model_version, model);
+  }
+
+  ScopedAtomicIncrement inflight(inflight_request_counter_);
+  return demand_loader_->GetModel(model_name, model_version, model);
+}
+
 Status
 InferenceServer::UnloadModel(
     const std::string& model_name, const bool unload_dependents)
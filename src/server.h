@@ -37,8 +37,10 @@
 #include "cache_manager.h"
 #include "infer_parameter.h"
 #include "model_config.pb.h"
+#include "model_demand_loader.h"
 #include "model_repository_manager.h"
 #include "rate_limiter.h"
+#include "shared_memory_transport.h"
 #include "status.h"
 #include "triton/common/model_config.h"
 
@@ -79,6 +81,8 @@ class InferenceServer {
   // Construct an inference server.
   InferenceServer();
 
+  ~InferenceServer();
+
   // Initialize the server. Return true on success, false otherwise.
   Status Init();
 
@@ -91,6 +95,9 @@ class InferenceServer {
   // based on those changes.
   Status PollModelRepository();
 
+  // Write the model repository snapshot.
+  Status WriteModelRepositorySnapshot();
+
   // Server health
   Status IsLive(bool* live);
   Status IsReady(bool* ready);
@@ -121,6 +128,14 @@ class InferenceServer {
   // ownership of 'request'.
   Status InferAsync(std::unique_ptr<InferenceRequest>& request);
 
+  // Inference on a batch of requests. If Status::Success is returned
+  // then this function has taken ownership of all 'requests' and any
+  // request that could not be run has been completed with an error
+  // response and released. If non-success is returned then the caller
+  // still retains ownership of all 'requests'.
+  Status InferAsyncBatch(
+      std::vector<std::unique_ptr<InferenceRequest>>& requests);
+
   // Load the corresponding model. Reload the model if it has been loaded.
   Status LoadModel(
       const std::unordered_map<
@@ -170,6 +185,35 @@ class InferenceServer {
   const std::set<std::string>& StartupModels() const { return startup_models_; }
   void SetStartupModels(const std::set<std::string>& m) { startup_models_ = m; }
 
+  // Get / set whether models are loaded on demand, the maximum number
+  // of models loaded on demand and of requests waiting for them to
+  // load, and the policy selecting the model to unload.
+  bool ModelLoadOnDemandEnabled() const { return load_on_demand_; }
+  uint32_t ModelLoadOnDemandMaxModels() const
+  {
+    return load_on_demand_max_models_;
+  }
+  void SetModelLoadOnDemand(
+      bool e, uint32_t max_models, uint32_t max_pending,
+      ModelEvictionPolicy policy)
+  {
+    load_on_demand_ = e;
+    load_on_demand_max_models_ = max_models;
+    load_on_demand_max_pending_ = max_pending;
+    model_eviction_policy_ = policy;
+  }
+
+  // Get / set the path of the model repository snapshot, empty if the
+  // snapshot is disabled.
+  const std::string& ModelRepositorySnapshotPath() const
+  {
+    return snapshot_path_;
+  }
+  void SetModelRepositorySnapshotPath(const std::string& p)
+  {
+    snapshot_path_ = p;
+  }
+
   // Get / set strict model configuration enable.
   bool StrictModelConfigEnabled() const { return strict_model_config_; }
   void SetStrictModelConfigEnabled(bool e) { strict_model_config_ = e; }
@@ -195,6 +239,69 @@ class InferenceServer {
     pinned_memory_pool_size_ = std::max((int64_t)0, s);
   }
 
+  // Get / set the huge page memory pool byte size and the minimum byte
+  // size of an allocation served from the pool.
+  uint64_t HugePageMemoryPoolByteSize() const
+  {
+    return huge_page_memory_pool_size_;
+  }
+  void SetHugePageMemoryPool(uint64_t s, uint64_t t)
+  {
+    huge_page_memory_pool_size_ = s;
+    huge_page_memory_threshold_ = t;
+  }
+
+  // Get / set the name of the host shared memory transport and the
+  // number and byte size of the slots of its rings. An empty name
+  // disables the transport.
+  const std::string& SharedMemoryTransportName() const
+  {
+    return shm_transport_name_;
+  }
+  uint32_t SharedMemoryTransportSlotCount() const
+  {
+    return shm_transport_slot_count_;
+  }
+  uint32_t SharedMemoryTransportSlotByteSize() const
+  {
+    return shm_transport_slot_byte_size_;
+  }
+  void SetSharedMemoryTransport(
+      const std::string& name, uint32_t slot_count, uint32_t slot_byte_size)
+  {
+    shm_transport_name_ = name;
+    shm_transport_slot_count_ = slot_count;
+    shm_transport_slot_byte_size_ = slot_byte_size;
+  }
+
+  // Get / set the path of the binary trace file and the number of
+  // records buffered for each reporting thread. An empty path
+  // disables the binary trace sink.
+  const std::string& TraceBinarySinkPath() const
+  {
+    return trace_binary_sink_path_;
+  }
+  uint32_t TraceBinarySinkRecordsPerThread() const
+  {
+    return trace_binary_sink_records_per_thread_;
+  }
+  void SetTraceBinarySink(const std::string& path, uint32_t records)
+  {
+    trace_binary_sink_path_ = path;
+    trace_binary_sink_records_per_thread_ = records;
+  }
+
+  // Get / set the byte size of the staging pool for asynchronous
+  // tensor traces, 0 disables them.
+  uint64_t TraceTensorStagingPoolByteSize() const
+  {
+    return trace_tensor_staging_pool_size_;
+  }
+  void SetTraceTensorStagingPoolByteSize(uint64_t s)
+  {
+    trace_tensor_staging_pool_size_ = s;
+  }
+
   // Get / set whether response cache will be enabled server-wide.
   // NOTE: Models still need caching enabled in individual model configs.
   bool ResponseCacheEnabled()
@@ -243,6 +350,34 @@ class InferenceServer {
 
   void SetModelLoadThreadCount(unsigned int c) { model_load_thread_count_ = c; }
 
+  // Get / set the host memory budget for concurrent model loads.
+  uint64_t ModelLoadMemoryBudget() const { return model_load_memory_budget_; }
+  void SetModelLoadMemoryBudget(uint64_t s) { model_load_memory_budget_ = s; }
+
+  // Get / set the number of threads used to create the instances of a
+  // single model concurrently.
+  uint32_t ModelInstanceLoadThreadCount() const
+  {
+    return model_instance_load_thread_count_;
+  }
+  void SetModelInstanceLoadThreadCount(unsigned int c)
+  {
+    model_instance_load_thread_count_ = c;
+  }
+
+  // Get / set whether the model versions replaced by a load are drained
+  // before they are unloaded, and the longest time to drain.
+  bool ModelVersionSwapEnabled() const { return version_swap_; }
+  uint64_t ModelVersionDrainTimeoutMs() const
+  {
+    return version_drain_timeout_ms_;
+  }
+  void SetModelVersionSwap(const bool enable, const uint64_t drain_timeout_ms)
+  {
+    version_swap_ = enable;
+    version_drain_timeout_ms_ = drain_timeout_ms;
+  }
+
   void SetModelNamespacingEnabled(const bool e)
   {
     enable_model_namespacing_ = e;
@@ -278,6 +413,12 @@ class InferenceServer {
         model_name, model_version, model);
   }
 
+  // Return the requested model object to run inference on. If models
+  // are loaded on demand the model is loaded if it is not.
+  Status GetModelForInference(
+      const std::string& model_name, const int64_t model_version,
+      std::shared_ptr<Model>* model);
+
   // Return the requested model object.
   Status GetModel(
       const ModelIdentifier& model_id, const int64_t model_version,
@@ -315,13 +456,32 @@ class InferenceServer {
   std::set<std::string> model_repository_paths_;
   std::set<std::string> startup_models_;
   ModelControlMode model_control_mode_;
+  bool load_on_demand_;
+  uint32_t load_on_demand_max_models_;
+  uint32_t load_on_demand_max_pending_;
+  ModelEvictionPolicy model_eviction_policy_;
+  std::string snapshot_path_;
   bool strict_model_config_;
   bool strict_readiness_;
   uint32_t exit_timeout_secs_;
   uint32_t buffer_manager_thread_count_;
   uint32_t model_load_thread_count_;
+  uint64_t model_load_memory_budget_;
+  uint32_t model_instance_load_thread_count_;
+  bool version_swap_;
+  uint64_t version_drain_timeout_ms_;
   bool enable_model_namespacing_;
   uint64_t pinned_memory_pool_size_;
+  uint64_t huge_page_memory_pool_size_;
+  uint64_t huge_page_memory_threshold_;
+  std::string shm_transport_name_;
+  uint32_t shm_transport_slot_count_;
+  uint32_t shm_transport_slot_byte_size_;
+  std::string trace_binary_sink_path_;
+  uint32_t trace_binary_sink_records_per_thread_;
+  bool trace_binary_sink_started_;
+  uint64_t trace_tensor_staging_pool_size_;
+  bool trace_tensor_stager_started_;
   bool response_cache_enabled_;
   CacheConfigMap cache_config_map_;
   std::string cache_dir_;
@@ -344,8 +504,13 @@ class InferenceServer {
 
   std::shared_ptr<RateLimiter> rate_limiter_;
   std::unique_ptr<ModelRepositoryManager> model_repository_manager_;
+  std::unique_ptr<ModelDemandLoader> demand_loader_;
   std::shared_ptr<TritonBackendManager> backend_manager_;
   std::shared_ptr<TritonCacheManager> cache_manager_;
+
+  // Requests submitted through the transport hold a reference to it,
+  // so it outlives the server while they are in flight.
+  std::shared_ptr<SharedMemoryTransport> shm_transport_;
 };
 
 }}  // namespace triton::core
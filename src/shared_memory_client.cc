@@ -0,0 +1,331 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "shared_memory_client.h"
+
+#include <chrono>
+#include <condition_variable>
+
+namespace triton { namespace core {
+
+namespace {
+
+// How long the receive thread waits for a reply before checking
+// whether the client is closing.
+constexpr uint64_t kReceiveTimeoutMs = 100;
+
+// How long a request waits for space in the request ring.
+constexpr uint64_t kSendTimeoutMs = 5000;
+
+// How long a region registration waits for its reply.
+constexpr uint64_t kCallTimeoutMs = 5000;
+
+// The state shared by a caller waiting for the final reply to a
+// message and the receive thread, which may deliver the reply after
+// the caller stopped waiting.
+struct ReplyWaiter {
+  ReplyWaiter() : received_(false), done_(false) {}
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool received_;
+  bool done_;
+  SharedMemoryClient::Response response_;
+};
+
+}  // namespace
+
+constexpr uint64_t SharedMemoryClient::kDefaultInferTimeoutMs;
+
+Status
+SharedMemoryClient::Connect(
+    const std::string& name, std::unique_ptr<SharedMemoryClient>* client)
+{
+  using Layout = SharedMemoryTransportLayout;
+
+  std::unique_ptr<SharedMemoryClient> lclient(new SharedMemoryClient());
+  RETURN_IF_ERROR(SharedMemoryRegion::Open(name, &lclient->region_));
+  char* base = lclient->region_->Base();
+  uint32_t slot_count, slot_byte_size;
+  RETURN_IF_ERROR(Layout::ReadHeader(
+      base, lclient->region_->ByteSize(), &slot_count, &slot_byte_size));
+  const size_t ring_byte_size =
+      Layout::RingByteSize(slot_count, slot_byte_size);
+  RETURN_IF_ERROR(SharedMemoryRing::Attach(
+      base + Layout::RequestRingOffset(), ring_byte_size,
+      &lclient->requests_));
+  RETURN_IF_ERROR(SharedMemoryRing::Attach(
+      base + Layout::ResponseRingOffset(slot_count, slot_byte_size),
+      ring_byte_size, &lclient->responses_));
+
+  SharedMemoryClient* raw = lclient.get();
+  lclient->receive_thread_.reset(
+      new std::thread([raw]() { raw->ReceiveThread(); }));
+
+  *client = std::move(lclient);
+  return Status::Success;
+}
+
+SharedMemoryClient::~SharedMemoryClient()
+{
+  exiting_ = true;
+  if ((receive_thread_ != nullptr) && receive_thread_->joinable()) {
+    receive_thread_->join();
+  }
+}
+
+Status
+SharedMemoryClient::RegisterRegion(
+    const std::string& name, uint64_t* region_id)
+{
+  const uint64_t tag = next_tag_++;
+  SharedMemoryMessageWriter writer;
+  writer.Append(
+      static_cast<uint32_t>(SharedMemoryTransportLayout::REGISTER_REGION));
+  writer.Append(tag);
+  writer.AppendString(name);
+
+  Response response;
+  RETURN_IF_ERROR(Call(writer.Message(), tag, &response));
+  RETURN_IF_ERROR(response.status_);
+  *region_id = response.region_id_;
+  return Status::Success;
+}
+
+Status
+SharedMemoryClient::UnregisterRegion(const uint64_t region_id)
+{
+  const uint64_t tag = next_tag_++;
+  SharedMemoryMessageWriter writer;
+  writer.Append(
+      static_cast<uint32_t>(SharedMemoryTransportLayout::UNREGISTER_REGION));
+  writer.Append(tag);
+  writer.Append(region_id);
+
+  Response response;
+  RETURN_IF_ERROR(Call(writer.Message(), tag, &response));
+  return response.status_;
+}
+
+Status
+SharedMemoryClient::InferAsync(const Request& request, ResponseFn response_fn)
+{
+  return InferAsync(request, next_tag_++, std::move(response_fn));
+}
+
+Status
+SharedMemoryClient::InferAsync(
+    const Request& request, const uint64_t tag, ResponseFn response_fn)
+{
+  SharedMemoryMessageWriter writer;
+  writer.Append(static_cast<uint32_t>(SharedMemoryTransportLayout::INFER));
+  writer.Append(tag);
+  writer.AppendString(request.model_name_);
+  writer.Append(request.model_version_);
+  writer.AppendString(request.id_);
+  writer.Append(static_cast<uint32_t>(request.inputs_.size()));
+  for (const auto& input : request.inputs_) {
+    writer.AppendString(input.name_);
+    writer.Append(static_cast<uint32_t>(input.datatype_));
+    writer.AppendShape(input.shape_);
+    writer.Append(input.region_id_);
+    writer.Append(input.offset_);
+    writer.Append(input.byte_size_);
+  }
+  writer.Append(static_cast<uint32_t>(request.requested_outputs_.size()));
+  for (const auto& name : request.requested_outputs_) {
+    writer.AppendString(name);
+  }
+  writer.Append(request.output_region_id_);
+  writer.Append(
+      (request.output_region_id_ == 0) ? static_cast<uint64_t>(0)
+                                       : request.output_offset_);
+  writer.Append(
+      (request.output_region_id_ == 0) ? static_cast<uint64_t>(0)
+                                       : request.output_byte_size_);
+
+  // Outputs are always placed in the output region of the request.
+  const uint64_t output_region_id = request.output_region_id_;
+  return Send(
+      writer.Message(), tag,
+      [output_region_id, response_fn](Response&& response) {
+        for (auto& output : response.outputs_) {
+          output.region_id_ = output_region_id;
+        }
+        response_fn(std::move(response));
+      });
+}
+
+Status
+SharedMemoryClient::Infer(
+    const Request& request, Response* response, const uint64_t timeout_ms)
+{
+  const uint64_t tag = next_tag_++;
+  std::shared_ptr<ReplyWaiter> waiter(new ReplyWaiter());
+  RETURN_IF_ERROR(InferAsync(request, tag, [waiter](Response&& reply) {
+    std::lock_guard<std::mutex> lock(waiter->mu_);
+    const bool final =
+        ((reply.flags_ & TRITONSERVER_RESPONSE_COMPLETE_FINAL) != 0);
+    // A final reply without outputs only completes the request and
+    // must not hide the response received before it.
+    if (!waiter->received_ || !final || !reply.status_.IsOk() ||
+        !reply.outputs_.empty()) {
+      waiter->response_ = std::move(reply);
+      waiter->received_ = true;
+    }
+    if (final) {
+      waiter->response_.flags_ |= TRITONSERVER_RESPONSE_COMPLETE_FINAL;
+      waiter->done_ = true;
+      waiter->cv_.notify_one();
+    }
+  }));
+
+  std::unique_lock<std::mutex> lock(waiter->mu_);
+  if (!waiter->cv_.wait_for(
+          lock, std::chrono::milliseconds(timeout_ms),
+          [&waiter]() { return waiter->done_; })) {
+    lock.unlock();
+    Cancel(tag);
+    return Status(
+        Status::Code::UNAVAILABLE,
+        "timed out waiting for the response to inference request '" +
+            request.id_ + "'");
+  }
+  *response = std::move(waiter->response_);
+  return Status::Success;
+}
+
+Status
+SharedMemoryClient::Call(
+    const std::string& message, const uint64_t tag, Response* response)
+{
+  std::shared_ptr<ReplyWaiter> waiter(new ReplyWaiter());
+  RETURN_IF_ERROR(Send(message, tag, [waiter](Response&& reply) {
+    std::lock_guard<std::mutex> lock(waiter->mu_);
+    waiter->response_ = std::move(reply);
+    waiter->done_ = true;
+    waiter->cv_.notify_one();
+  }));
+
+  std::unique_lock<std::mutex> lock(waiter->mu_);
+  if (!waiter->cv_.wait_for(
+          lock, std::chrono::milliseconds(kCallTimeoutMs),
+          [&waiter]() { return waiter->done_; })) {
+    lock.unlock();
+    Cancel(tag);
+    return Status(
+        Status::Code::UNAVAILABLE, "timed out waiting for the server reply");
+  }
+  *response = std::move(waiter->response_);
+  return Status::Success;
+}
+
+void
+SharedMemoryClient::Cancel(const uint64_t tag)
+{
+  std::lock_guard<std::mutex> lock(mu_);
+  pending_.erase(tag);
+}
+
+Status
+SharedMemoryClient::Send(
+    const std::string& message, const uint64_t tag, ResponseFn response_fn)
+{
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    pending_.emplace(tag, std::move(response_fn));
+  }
+
+  Status status = requests_->Produce(message, kSendTimeoutMs);
+  if (!status.IsOk()) {
+    std::lock_guard<std::mutex> lock(mu_);
+    pending_.erase(tag);
+  }
+  return status;
+}
+
+void
+SharedMemoryClient::ReceiveThread()
+{
+  std::string message;
+  while (!exiting_) {
+    if (!responses_->Consume(&message, kReceiveTimeoutMs).IsOk()) {
+      continue;
+    }
+
+    SharedMemoryMessageReader reader(message);
+    uint32_t type, status_code, output_count;
+    uint64_t tag;
+    std::string status_message;
+    Response response;
+    if (!reader.Read(&type) || (type != SharedMemoryTransportLayout::REPLY) ||
+        !reader.Read(&tag) || !reader.Read(&response.flags_) ||
+        !reader.Read(&status_code) || !reader.ReadString(&status_message) ||
+        !reader.Read(&response.region_id_) || !reader.Read(&output_count)) {
+      continue;
+    }
+    response.status_ =
+        Status(static_cast<Status::Code>(status_code), status_message);
+
+    bool valid = true;
+    response.outputs_.resize(output_count);
+    for (auto& output : response.outputs_) {
+      uint32_t datatype;
+      valid = reader.ReadString(&output.name_) && reader.Read(&datatype) &&
+              reader.ReadShape(&output.shape_) &&
+              reader.Read(&output.offset_) && reader.Read(&output.byte_size_);
+      if (!valid) {
+        break;
+      }
+      output.datatype_ = static_cast<TRITONSERVER_DataType>(datatype);
+    }
+    if (!valid) {
+      response.status_ =
+          Status(Status::Code::INTERNAL, "malformed reply from server");
+      response.outputs_.clear();
+    }
+
+    const bool final =
+        ((response.flags_ & TRITONSERVER_RESPONSE_COMPLETE_FINAL) != 0);
+    ResponseFn response_fn;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto itr = pending_.find(tag);
+      if (itr == pending_.end()) {
+        continue;
+      }
+      if (final) {
+        response_fn = std::move(itr->second);
+        pending_.erase(itr);
+      } else {
+        response_fn = itr->second;
+      }
+    }
+    response_fn(std::move(response));
+  }
+}
+
+}}  // namespace triton::core
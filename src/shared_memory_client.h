@@ -0,0 +1,150 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "constants.h"
+#include "shared_memory_ipc.h"
+#include "status.h"
+
+namespace triton { namespace core {
+
+//
+// Client side of the host shared memory transport, for processes
+// running on the same host as a server started with
+// TRITONSERVER_ServerOptionsSetSharedMemoryTransport. A transport
+// serves one connected client at a time.
+//
+class SharedMemoryClient {
+ public:
+  // A tensor held in a region registered with RegisterRegion().
+  struct Tensor {
+    std::string name_;
+    TRITONSERVER_DataType datatype_;
+    std::vector<int64_t> shape_;
+    uint64_t region_id_;
+    uint64_t offset_;
+    uint64_t byte_size_;
+  };
+
+  struct Request {
+    Request() : model_version_(-1), output_region_id_(0) {}
+
+    std::string model_name_;
+    int64_t model_version_;
+    std::string id_;
+    std::vector<Tensor> inputs_;
+    std::vector<std::string> requested_outputs_;
+
+    // The window of a registered region where the server places the
+    // output tensors. The window must not be reused until the final
+    // response of the request is received.
+    uint64_t output_region_id_;
+    uint64_t output_offset_;
+    uint64_t output_byte_size_;
+  };
+
+  struct Response {
+    // TRITONSERVER_ResponseCompleteFlag flags of the response.
+    uint32_t flags_;
+    Status status_;
+    // The outputs, their 'offset_' is relative to the base of the
+    // output region.
+    std::vector<Tensor> outputs_;
+    // The ID assigned by the reply to a region registration.
+    uint64_t region_id_;
+  };
+
+  using ResponseFn = std::function<void(Response&&)>;
+
+  // Connect to the transport named 'name'.
+  static Status Connect(
+      const std::string& name, std::unique_ptr<SharedMemoryClient>* client);
+
+  ~SharedMemoryClient();
+
+  // Register the shared memory region named 'name', created by the
+  // client, with the server.
+  Status RegisterRegion(const std::string& name, uint64_t* region_id);
+
+  Status UnregisterRegion(const uint64_t region_id);
+
+  // Submit 'request'. 'response_fn' is called from the receive thread
+  // of the client for each response, the last one has the
+  // TRITONSERVER_RESPONSE_COMPLETE_FINAL flag.
+  Status InferAsync(const Request& request, ResponseFn response_fn);
+
+  // Submit 'request' and wait for its final response. Intended for
+  // models that produce exactly one response per request. Returns
+  // UNAVAILABLE if the final response is not received within
+  // 'timeout_ms', later responses of the request are then ignored.
+  static constexpr uint64_t kDefaultInferTimeoutMs = 60000;
+  Status Infer(
+      const Request& request, Response* response,
+      const uint64_t timeout_ms = kDefaultInferTimeoutMs);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryClient);
+  SharedMemoryClient() : next_tag_(1), exiting_(false) {}
+
+  Status InferAsync(
+      const Request& request, const uint64_t tag, ResponseFn response_fn);
+
+  // Send 'message' tagged with 'tag'. 'response_fn' is called for
+  // every reply to the message.
+  Status Send(
+      const std::string& message, const uint64_t tag, ResponseFn response_fn);
+
+  // Send 'message' tagged with 'tag' and wait for the final reply.
+  Status Call(
+      const std::string& message, const uint64_t tag, Response* response);
+
+  // Stop waiting for the replies to the message tagged with 'tag'.
+  void Cancel(const uint64_t tag);
+
+  void ReceiveThread();
+
+  std::unique_ptr<SharedMemoryRegion> region_;
+  std::unique_ptr<SharedMemoryRing> requests_;
+  std::unique_ptr<SharedMemoryRing> responses_;
+
+  // Pending requests keyed by tag.
+  std::mutex mu_;
+  std::unordered_map<uint64_t, ResponseFn> pending_;
+  std::atomic<uint64_t> next_tag_;
+
+  std::atomic<bool> exiting_;
+  std::unique_ptr<std::thread> receive_thread_;
+};
+
+}}  // namespace triton::core
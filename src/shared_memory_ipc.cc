@@ -0,0 +1,434 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "shared_memory_ipc.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
+namespace triton { namespace core {
+
+#ifdef _WIN32
+// Host shared memory transport is only supported on POSIX systems.
+struct SharedMemoryRing::Header {
+};
+
+Status
+SharedMemoryRegion::Create(
+    const std::string& name, const size_t byte_size,
+    std::unique_ptr<SharedMemoryRegion>* region)
+{
+  return Status(
+      Status::Code::UNSUPPORTED, "shared memory transport is not supported");
+}
+
+Status
+SharedMemoryRegion::Open(
+    const std::string& name, std::unique_ptr<SharedMemoryRegion>* region)
+{
+  return Status(
+      Status::Code::UNSUPPORTED, "shared memory transport is not supported");
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {}
+
+size_t
+SharedMemoryRing::RequiredByteSize(
+    const uint32_t slot_count, const uint32_t slot_byte_size)
+{
+  return 0;
+}
+
+Status
+SharedMemoryRing::Initialize(
+    char* base, const uint32_t slot_count, const uint32_t slot_byte_size,
+    std::unique_ptr<SharedMemoryRing>* ring)
+{
+  return Status(
+      Status::Code::UNSUPPORTED, "shared memory transport is not supported");
+}
+
+Status
+SharedMemoryRing::Attach(
+    char* base, const size_t byte_size, std::unique_ptr<SharedMemoryRing>* ring)
+{
+  return Status(
+      Status::Code::UNSUPPORTED, "shared memory transport is not supported");
+}
+
+SharedMemoryRing::~SharedMemoryRing() {}
+
+uint32_t
+SharedMemoryRing::SlotByteSize() const
+{
+  return 0;
+}
+
+Status
+SharedMemoryRing::Produce(const std::string& message, const uint64_t timeout_ms)
+{
+  return Status(
+      Status::Code::UNSUPPORTED, "shared memory transport is not supported");
+}
+
+Status
+SharedMemoryRing::Consume(std::string* message, const uint64_t timeout_ms)
+{
+  return Status(
+      Status::Code::UNSUPPORTED, "shared memory transport is not supported");
+}
+
+void
+SharedMemoryTransportLayout::PublishHeader(
+    char* base, const uint32_t slot_count, const uint32_t slot_byte_size)
+{
+}
+
+Status
+SharedMemoryTransportLayout::ReadHeader(
+    const char* base, const size_t byte_size, uint32_t* slot_count,
+    uint32_t* slot_byte_size)
+{
+  return Status(
+      Status::Code::UNSUPPORTED, "shared memory transport is not supported");
+}
+#else
+namespace {
+
+constexpr uint32_t kRingMagic = 0x52534d31;  // "RSM1"
+constexpr size_t kCacheLineByteSize = 64;
+
+size_t
+RoundUp(const size_t value, const size_t alignment)
+{
+  return ((value + alignment - 1) / alignment) * alignment;
+}
+
+size_t
+SlotStride(const uint32_t slot_byte_size)
+{
+  return RoundUp(sizeof(uint32_t) + slot_byte_size, kCacheLineByteSize);
+}
+
+// Wait on 'sem' for at most 'timeout_ms'.
+Status
+TimedWait(sem_t* sem, const uint64_t timeout_ms)
+{
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  const uint64_t nanos = deadline.tv_nsec + (timeout_ms % 1000) * 1000000;
+  deadline.tv_sec += (timeout_ms / 1000) + (nanos / 1000000000);
+  deadline.tv_nsec = nanos % 1000000000;
+  while (sem_timedwait(sem, &deadline) != 0) {
+    if (errno == ETIMEDOUT) {
+      return Status(Status::Code::UNAVAILABLE, "timed out");
+    }
+    if (errno != EINTR) {
+      return Status(
+          Status::Code::INTERNAL,
+          "failed to wait on shared memory ring: " +
+              std::string(strerror(errno)));
+    }
+  }
+  return Status::Success;
+}
+
+}  // namespace
+
+struct SharedMemoryRing::Header {
+  uint32_t magic_;
+  uint32_t slot_count_;
+  uint32_t slot_byte_size_;
+  // Counts the messages ready to be consumed.
+  sem_t items_;
+  // Counts the free slots.
+  sem_t spaces_;
+};
+
+Status
+SharedMemoryRegion::Create(
+    const std::string& name, const size_t byte_size,
+    std::unique_ptr<SharedMemoryRegion>* region)
+{
+  // Remove a region left behind by a process that didn't exit cleanly.
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd == -1) {
+    return Status(
+        Status::Code::INTERNAL, "failed to create shared memory region '" +
+                                    name + "': " + strerror(errno));
+  }
+  if (ftruncate(fd, byte_size) == -1) {
+    const std::string err = strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to size shared memory region '" + name + "': " + err);
+  }
+  void* base =
+      mmap(nullptr, byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    const std::string err = strerror(errno);
+    shm_unlink(name.c_str());
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to map shared memory region '" + name + "': " + err);
+  }
+
+  region->reset(new SharedMemoryRegion(
+      name, reinterpret_cast<char*>(base), byte_size, true /* owner */));
+  return Status::Success;
+}
+
+Status
+SharedMemoryRegion::Open(
+    const std::string& name, std::unique_ptr<SharedMemoryRegion>* region)
+{
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1) {
+    return Status(
+        Status::Code::NOT_FOUND, "failed to open shared memory region '" +
+                                     name + "': " + strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    const std::string err = strerror(errno);
+    close(fd);
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to query shared memory region '" + name + "': " + err);
+  }
+  if (st.st_uid != geteuid()) {
+    close(fd);
+    return Status(
+        Status::Code::INVALID_ARG,
+        "shared memory region '" + name + "' is owned by another user");
+  }
+  const size_t byte_size = st.st_size;
+  void* base = nullptr;
+  if (byte_size > 0) {
+    base = mmap(nullptr, byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if ((byte_size == 0) || (base == MAP_FAILED)) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "failed to map shared memory region '" + name + "'");
+  }
+
+  region->reset(new SharedMemoryRegion(
+      name, reinterpret_cast<char*>(base), byte_size, false /* owner */));
+  return Status::Success;
+}
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+  munmap(base_, byte_size_);
+  if (owner_) {
+    shm_unlink(name_.c_str());
+  }
+}
+
+size_t
+SharedMemoryRing::RequiredByteSize(
+    const uint32_t slot_count, const uint32_t slot_byte_size)
+{
+  return RoundUp(sizeof(Header), kCacheLineByteSize) +
+         slot_count * SlotStride(slot_byte_size);
+}
+
+SharedMemoryRing::SharedMemoryRing(
+    Header* header, const uint32_t slot_count, const uint32_t slot_byte_size,
+    const bool owner)
+    : header_(header), slot_count_(slot_count),
+      slot_byte_size_(slot_byte_size), owner_(owner), produce_idx_(0),
+      consume_idx_(0)
+{
+}
+
+Status
+SharedMemoryRing::Initialize(
+    char* base, const uint32_t slot_count, const uint32_t slot_byte_size,
+    std::unique_ptr<SharedMemoryRing>* ring)
+{
+  if ((slot_count == 0) || (slot_byte_size == 0)) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "shared memory ring must have at least one non-empty slot");
+  }
+
+  Header* header = reinterpret_cast<Header*>(base);
+  header->slot_count_ = slot_count;
+  header->slot_byte_size_ = slot_byte_size;
+  if ((sem_init(&header->items_, 1 /* pshared */, 0) != 0) ||
+      (sem_init(&header->spaces_, 1 /* pshared */, slot_count) != 0)) {
+    return Status(
+        Status::Code::INTERNAL, "failed to initialize shared memory ring: " +
+                                    std::string(strerror(errno)));
+  }
+  // Publish the ring only once it is fully initialized.
+  __atomic_store_n(&header->magic_, kRingMagic, __ATOMIC_RELEASE);
+
+  ring->reset(new SharedMemoryRing(
+      header, slot_count, slot_byte_size, true /* owner */));
+  return Status::Success;
+}
+
+Status
+SharedMemoryRing::Attach(
+    char* base, const size_t byte_size, std::unique_ptr<SharedMemoryRing>* ring)
+{
+  Header* header = reinterpret_cast<Header*>(base);
+  if ((byte_size < sizeof(Header)) ||
+      (__atomic_load_n(&header->magic_, __ATOMIC_ACQUIRE) != kRingMagic)) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "shared memory does not hold an initialized ring");
+  }
+  const uint32_t slot_count =
+      __atomic_load_n(&header->slot_count_, __ATOMIC_RELAXED);
+  const uint32_t slot_byte_size =
+      __atomic_load_n(&header->slot_byte_size_, __ATOMIC_RELAXED);
+  if ((slot_count == 0) || (slot_byte_size == 0) ||
+      (slot_count > byte_size) || (slot_byte_size > byte_size) ||
+      (byte_size < RequiredByteSize(slot_count, slot_byte_size))) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "shared memory does not hold a valid ring");
+  }
+
+  ring->reset(new SharedMemoryRing(
+      header, slot_count, slot_byte_size, false /* owner */));
+  return Status::Success;
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+  if (owner_) {
+    sem_destroy(&header_->items_);
+    sem_destroy(&header_->spaces_);
+  }
+}
+
+uint32_t
+SharedMemoryRing::SlotByteSize() const
+{
+  return slot_byte_size_;
+}
+
+char*
+SharedMemoryRing::Slot(const uint64_t idx) const
+{
+  return reinterpret_cast<char*>(header_) +
+         RoundUp(sizeof(Header), kCacheLineByteSize) +
+         (idx % slot_count_) * SlotStride(slot_byte_size_);
+}
+
+Status
+SharedMemoryRing::Produce(const std::string& message, const uint64_t timeout_ms)
+{
+  if (message.size() > slot_byte_size_) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "message of " + std::to_string(message.size()) +
+            " bytes exceeds the shared memory ring slot size of " +
+            std::to_string(slot_byte_size_) + " bytes");
+  }
+
+  std::lock_guard<std::mutex> lock(produce_mu_);
+  RETURN_IF_ERROR(TimedWait(&header_->spaces_, timeout_ms));
+  char* slot = Slot(produce_idx_++);
+  const uint32_t byte_size = message.size();
+  memcpy(slot, &byte_size, sizeof(uint32_t));
+  memcpy(slot + sizeof(uint32_t), message.data(), byte_size);
+  sem_post(&header_->items_);
+  return Status::Success;
+}
+
+Status
+SharedMemoryRing::Consume(std::string* message, const uint64_t timeout_ms)
+{
+  RETURN_IF_ERROR(TimedWait(&header_->items_, timeout_ms));
+  const char* slot = Slot(consume_idx_++);
+  uint32_t byte_size;
+  memcpy(&byte_size, slot, sizeof(uint32_t));
+  message->assign(
+      slot + sizeof(uint32_t), std::min(byte_size, slot_byte_size_));
+  sem_post(&header_->spaces_);
+  return Status::Success;
+}
+
+void
+SharedMemoryTransportLayout::PublishHeader(
+    char* base, const uint32_t slot_count, const uint32_t slot_byte_size)
+{
+  Header* header = reinterpret_cast<Header*>(base);
+  header->slot_count_ = slot_count;
+  header->slot_byte_size_ = slot_byte_size;
+  __atomic_store_n(&header->magic_, kMagic, __ATOMIC_RELEASE);
+}
+
+Status
+SharedMemoryTransportLayout::ReadHeader(
+    const char* base, const size_t byte_size, uint32_t* slot_count,
+    uint32_t* slot_byte_size)
+{
+  const Header* header = reinterpret_cast<const Header*>(base);
+  if ((byte_size < kHeaderByteSize) ||
+      (__atomic_load_n(&header->magic_, __ATOMIC_ACQUIRE) != kMagic)) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "shared memory does not hold an initialized transport");
+  }
+  const uint32_t count =
+      __atomic_load_n(&header->slot_count_, __ATOMIC_RELAXED);
+  const uint32_t size =
+      __atomic_load_n(&header->slot_byte_size_, __ATOMIC_RELAXED);
+  if ((count == 0) || (size == 0) || (count > byte_size) ||
+      (size > byte_size) || (byte_size < RegionByteSize(count, size))) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "shared memory does not hold a valid transport");
+  }
+
+  *slot_count = count;
+  *slot_byte_size = size;
+  return Status::Success;
+}
+#endif  // _WIN32
+
+}}  // namespace triton::core
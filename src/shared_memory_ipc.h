@@ -0,0 +1,326 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "constants.h"
+#include "status.h"
+
+namespace triton { namespace core {
+
+//
+// A named region of host shared memory, used by the shared memory
+// transport that lets a process on the same host submit inference
+// requests without copying tensor data through a socket.
+//
+class SharedMemoryRegion {
+ public:
+  // Create a region named 'name' of 'byte_size' bytes. The region is
+  // removed from the system when the returned object is destroyed.
+  static Status Create(
+      const std::string& name, const size_t byte_size,
+      std::unique_ptr<SharedMemoryRegion>* region);
+
+  // Map the existing region named 'name'. The region must be owned by
+  // the effective user of the calling process.
+  static Status Open(
+      const std::string& name, std::unique_ptr<SharedMemoryRegion>* region);
+
+  ~SharedMemoryRegion();
+
+  const std::string& Name() const { return name_; }
+  char* Base() const { return base_; }
+  size_t ByteSize() const { return byte_size_; }
+
+  // Return true if ['offset', 'offset' + 'byte_size') lies within the
+  // region.
+  bool Contains(const uint64_t offset, const uint64_t byte_size) const
+  {
+    return (offset <= byte_size_) && (byte_size <= (byte_size_ - offset));
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryRegion);
+  SharedMemoryRegion(
+      const std::string& name, char* base, const size_t byte_size,
+      const bool owner)
+      : name_(name), base_(base), byte_size_(byte_size), owner_(owner)
+  {
+  }
+
+  const std::string name_;
+  char* base_;
+  const size_t byte_size_;
+  const bool owner_;
+};
+
+//
+// A ring of fixed-size message slots placed in shared memory. Exactly
+// one process produces messages and exactly one process consumes
+// them. Within the producing process any number of threads may
+// produce; within the consuming process only one thread may consume.
+// Messages are copied into and out of the slots, so they should only
+// hold metadata while tensor data is passed by reference to
+// registered regions.
+//
+class SharedMemoryRing {
+ public:
+  // The number of bytes needed for a ring of 'slot_count' slots that
+  // each hold a message of up to 'slot_byte_size' bytes.
+  static size_t RequiredByteSize(
+      const uint32_t slot_count, const uint32_t slot_byte_size);
+
+  // Initialize a new ring at 'base'. The ring must be initialized
+  // before it is attached.
+  static Status Initialize(
+      char* base, const uint32_t slot_count, const uint32_t slot_byte_size,
+      std::unique_ptr<SharedMemoryRing>* ring);
+
+  // Attach to the ring initialized at 'base', which is followed by at
+  // least 'byte_size' bytes. The geometry of the ring is read once
+  // here, the other process can't change it afterwards.
+  static Status Attach(
+      char* base, const size_t byte_size,
+      std::unique_ptr<SharedMemoryRing>* ring);
+
+  ~SharedMemoryRing();
+
+  // The largest message the ring can hold.
+  uint32_t SlotByteSize() const;
+
+  // Copy 'message' into the next slot, waiting up to 'timeout_ms' for
+  // a slot to be free. Return UNAVAILABLE on timeout.
+  Status Produce(const std::string& message, const uint64_t timeout_ms);
+
+  // Copy the next message into 'message', waiting up to 'timeout_ms'
+  // for one to arrive. Return UNAVAILABLE on timeout.
+  Status Consume(std::string* message, const uint64_t timeout_ms);
+
+ private:
+  struct Header;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryRing);
+  SharedMemoryRing(
+      Header* header, const uint32_t slot_count, const uint32_t slot_byte_size,
+      const bool owner);
+
+  char* Slot(const uint64_t idx) const;
+
+  // The header lives in memory the other process can write, so the
+  // slot count and size used to address the slots are private copies.
+  Header* header_;
+  const uint32_t slot_count_;
+  const uint32_t slot_byte_size_;
+  const bool owner_;
+
+  // Serializes the producers of this process.
+  std::mutex produce_mu_;
+
+  // The indices of the next slot to produce into and to consume from.
+  // Each is only used by one side of the ring.
+  uint64_t produce_idx_;
+  uint64_t consume_idx_;
+};
+
+//
+// Serialization of the messages exchanged over a shared memory
+// transport. Values are written in host byte order since both ends
+// run on the same host.
+//
+class SharedMemoryMessageWriter {
+ public:
+  template <typename T>
+  void Append(const T& value)
+  {
+    message_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void AppendString(const std::string& value)
+  {
+    Append(static_cast<uint32_t>(value.size()));
+    message_.append(value);
+  }
+
+  void AppendShape(const std::vector<int64_t>& shape)
+  {
+    Append(static_cast<uint32_t>(shape.size()));
+    message_.append(
+        reinterpret_cast<const char*>(shape.data()),
+        shape.size() * sizeof(int64_t));
+  }
+
+  // Append the content of 'other' as is.
+  void AppendMessage(const SharedMemoryMessageWriter& other)
+  {
+    message_.append(other.message_);
+  }
+
+  const std::string& Message() const { return message_; }
+
+ private:
+  std::string message_;
+};
+
+class SharedMemoryMessageReader {
+ public:
+  explicit SharedMemoryMessageReader(const std::string& message)
+      : message_(message), offset_(0)
+  {
+  }
+
+  template <typename T>
+  bool Read(T* value)
+  {
+    if ((message_.size() - offset_) < sizeof(T)) {
+      return false;
+    }
+    memcpy(value, message_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool ReadString(std::string* value)
+  {
+    uint32_t size;
+    if (!Read(&size) || ((message_.size() - offset_) < size)) {
+      return false;
+    }
+    value->assign(message_.data() + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool ReadShape(std::vector<int64_t>* shape)
+  {
+    uint32_t dim_count;
+    if (!Read(&dim_count) ||
+        (((message_.size() - offset_) / sizeof(int64_t)) < dim_count)) {
+      return false;
+    }
+    shape->resize(dim_count);
+    memcpy(
+        shape->data(), message_.data() + offset_, dim_count * sizeof(int64_t));
+    offset_ += dim_count * sizeof(int64_t);
+    return true;
+  }
+
+ private:
+  const std::string& message_;
+  size_t offset_;
+};
+
+//
+// Layout of a shared memory transport. The server creates a region
+// holding a header followed by the request ring, produced by the
+// client, and the response ring, produced by the server.
+//
+// Request messages start with the message type and a client chosen
+// tag. A REGISTER_REGION request holds the name of a region created
+// by the client. An UNREGISTER_REGION request holds the ID of a
+// registered region. An INFER request holds the model name and
+// version, the request ID, the inputs each as name, datatype, shape,
+// region ID, offset and byte size, the names of the requested outputs
+// and the region ID, offset and byte size of the window where the
+// server places the output tensors.
+//
+// The regions a client registers must be named after the transport,
+// '<transport name>_<suffix>', so that a client can only make the
+// server map regions created for that purpose.
+//
+// Every response message is a REPLY holding the tag of the request,
+// the TRITONSERVER_ResponseCompleteFlag flags, the status code and
+// message, a region ID for REGISTER_REGION and the outputs each as
+// name, datatype, shape, offset in the output window region and byte
+// size. An INFER request may receive several replies, the last one
+// has the TRITONSERVER_RESPONSE_COMPLETE_FINAL flag.
+//
+struct SharedMemoryTransportLayout {
+  enum MessageType : uint32_t {
+    REGISTER_REGION = 1,
+    UNREGISTER_REGION = 2,
+    INFER = 3,
+    REPLY = 4
+  };
+
+  static constexpr uint32_t kMagic = 0x54534d31;  // "TSM1"
+  static constexpr size_t kHeaderByteSize = 64;
+
+  struct Header {
+    uint32_t magic_;
+    uint32_t slot_count_;
+    uint32_t slot_byte_size_;
+  };
+
+  // Publish the header of a transport whose rings are initialized.
+  static void PublishHeader(
+      char* base, const uint32_t slot_count, const uint32_t slot_byte_size);
+
+  // Read the header published at 'base', which is followed by at
+  // least 'byte_size' bytes.
+  static Status ReadHeader(
+      const char* base, const size_t byte_size, uint32_t* slot_count,
+      uint32_t* slot_byte_size);
+
+  // Return true if 'region_name' may be registered by a client of
+  // the transport named 'transport_name'.
+  static bool IsClientRegionName(
+      const std::string& transport_name, const std::string& region_name)
+  {
+    return (region_name.size() > transport_name.size() + 1) &&
+           (region_name.compare(
+                0, transport_name.size(), transport_name) == 0) &&
+           (region_name[transport_name.size()] == '_') &&
+           (region_name.find('/', transport_name.size()) ==
+            std::string::npos);
+  }
+
+  static size_t RingByteSize(
+      const uint32_t slot_count, const uint32_t slot_byte_size)
+  {
+    return SharedMemoryRing::RequiredByteSize(slot_count, slot_byte_size);
+  }
+
+  static size_t RegionByteSize(
+      const uint32_t slot_count, const uint32_t slot_byte_size)
+  {
+    return kHeaderByteSize + 2 * RingByteSize(slot_count, slot_byte_size);
+  }
+
+  static size_t RequestRingOffset() { return kHeaderByteSize; }
+
+  static size_t ResponseRingOffset(
+      const uint32_t slot_count, const uint32_t slot_byte_size)
+  {
+    return kHeaderByteSize + RingByteSize(slot_count, slot_byte_size);
+  }
+};
+
+}}  // namespace triton::core
@@ -0,0 +1,575 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "shared_memory_transport.h"
+
+#include "infer_request.h"
+#include "infer_response.h"
+#include "model.h"
+#include "model_config_utils.h"
+#include "server.h"
+#include "triton/common/logging.h"
+
+namespace triton { namespace core {
+
+namespace {
+
+// How long the receive thread waits for a request before checking
+// whether the transport is stopping.
+constexpr uint64_t kReceiveTimeoutMs = 100;
+
+// How long the reply thread waits for space in the response ring
+// before a reply is dropped because the client stopped consuming.
+constexpr uint64_t kReplyTimeoutMs = 5000;
+
+// Alignment of the output tensors placed in the output window.
+constexpr uint64_t kOutputAlignment = 64;
+
+}  // namespace
+
+struct SharedMemoryTransport::InferContext {
+  InferContext(
+      const std::shared_ptr<SharedMemoryTransport>& transport,
+      const uint64_t tag)
+      : transport_(transport), tag_(tag), output_offset_(0),
+        output_byte_size_(0), output_used_(0), ref_count_(2)
+  {
+  }
+
+  // Drop a reference, the request release and the final response
+  // each hold one.
+  static void Unref(InferContext* ctx)
+  {
+    if (ctx->ref_count_.fetch_sub(1) == 1) {
+      delete ctx;
+    }
+  }
+
+  std::shared_ptr<SharedMemoryTransport> transport_;
+  const uint64_t tag_;
+
+  // Keep the regions referenced by the request mapped until the
+  // request completes, even if the client unregisters them.
+  std::vector<std::shared_ptr<SharedMemoryRegion>> input_regions_;
+  std::shared_ptr<SharedMemoryRegion> output_region_;
+  uint64_t output_offset_;
+  uint64_t output_byte_size_;
+
+  // Bytes of the output window used so far, responses of a decoupled
+  // model may allocate concurrently.
+  std::mutex output_mu_;
+  uint64_t output_used_;
+
+  std::atomic<int> ref_count_;
+};
+
+Status
+SharedMemoryTransport::Create(
+    InferenceServer* server, const std::string& name,
+    const uint32_t slot_count, const uint32_t slot_byte_size,
+    std::shared_ptr<SharedMemoryTransport>* transport)
+{
+  using Layout = SharedMemoryTransportLayout;
+
+  std::shared_ptr<SharedMemoryTransport> ltransport(
+      new SharedMemoryTransport(server));
+  ltransport->max_queued_reply_count_ = slot_count;
+  RETURN_IF_ERROR(SharedMemoryRegion::Create(
+      name, Layout::RegionByteSize(slot_count, slot_byte_size),
+      &ltransport->region_));
+  char* base = ltransport->region_->Base();
+  const size_t ring_byte_size =
+      Layout::RingByteSize(slot_count, slot_byte_size);
+  RETURN_IF_ERROR(SharedMemoryRing::Initialize(
+      base + Layout::RequestRingOffset(), slot_count, slot_byte_size,
+      &ltransport->requests_));
+  RETURN_IF_ERROR(SharedMemoryRing::Initialize(
+      base + Layout::ResponseRingOffset(slot_count, slot_byte_size),
+      slot_count, slot_byte_size, &ltransport->responses_));
+
+  // Clients only attach once the header is published.
+  Layout::PublishHeader(base, slot_count, slot_byte_size);
+
+  SharedMemoryTransport* raw = ltransport.get();
+  ltransport->reply_thread_.reset(
+      new std::thread([raw]() { raw->ReplyThread(); }));
+  ltransport->receive_thread_.reset(
+      new std::thread([raw]() { raw->ReceiveThread(); }));
+
+  LOG_INFO << "Started shared memory transport '" << name << "' with "
+           << slot_count << " slots of " << slot_byte_size << " bytes ("
+           << ring_byte_size << " bytes per ring)";
+
+  *transport = std::move(ltransport);
+  return Status::Success;
+}
+
+SharedMemoryTransport::SharedMemoryTransport(InferenceServer* server)
+    : server_(server), next_region_id_(1),
+      allocator_(new ResponseAllocator(
+          ResponseAlloc, ResponseRelease, nullptr /* start_fn */)),
+      exiting_(false), max_queued_reply_count_(0), reply_exiting_(false)
+{
+}
+
+SharedMemoryTransport::~SharedMemoryTransport()
+{
+  Stop();
+
+  {
+    std::lock_guard<std::mutex> lock(reply_mu_);
+    reply_exiting_ = true;
+  }
+  reply_cv_.notify_one();
+  if ((reply_thread_ != nullptr) && reply_thread_->joinable()) {
+    reply_thread_->join();
+  }
+}
+
+void
+SharedMemoryTransport::Stop()
+{
+  exiting_ = true;
+  // The last reference may be released by a request completing on the
+  // receive thread, which can't join itself.
+  if ((receive_thread_ != nullptr) && receive_thread_->joinable()) {
+    if (receive_thread_->get_id() == std::this_thread::get_id()) {
+      receive_thread_->detach();
+    } else {
+      receive_thread_->join();
+    }
+  }
+}
+
+void
+SharedMemoryTransport::ReceiveThread()
+{
+  using Layout = SharedMemoryTransportLayout;
+
+  std::string message;
+  while (!exiting_) {
+    Status status = requests_->Consume(&message, kReceiveTimeoutMs);
+    if (!status.IsOk()) {
+      if (status.StatusCode() != Status::Code::UNAVAILABLE) {
+        LOG_ERROR << "shared memory transport: " << status.Message();
+      }
+      continue;
+    }
+
+    SharedMemoryMessageReader reader(message);
+    uint32_t type;
+    uint64_t tag;
+    if (!reader.Read(&type) || !reader.Read(&tag)) {
+      LOG_ERROR << "shared memory transport: malformed message";
+      continue;
+    }
+
+    switch (type) {
+      case Layout::REGISTER_REGION:
+        HandleRegisterRegion(reader, tag);
+        break;
+      case Layout::UNREGISTER_REGION:
+        HandleUnregisterRegion(reader, tag);
+        break;
+      case Layout::INFER:
+        HandleInfer(reader, tag);
+        break;
+      default:
+        SendReply(
+            tag, TRITONSERVER_RESPONSE_COMPLETE_FINAL,
+            Status(
+                Status::Code::INVALID_ARG,
+                "unknown shared memory transport message type " +
+                    std::to_string(type)));
+        break;
+    }
+  }
+}
+
+void
+SharedMemoryTransport::HandleRegisterRegion(
+    SharedMemoryMessageReader& reader, uint64_t tag)
+{
+  std::string name;
+  if (!reader.ReadString(&name)) {
+    SendReply(
+        tag, TRITONSERVER_RESPONSE_COMPLETE_FINAL,
+        Status(Status::Code::INVALID_ARG, "malformed register request"));
+    return;
+  }
+
+  std::unique_ptr<SharedMemoryRegion> region;
+  Status status;
+  if (!SharedMemoryTransportLayout::IsClientRegionName(region_->Name(), name)) {
+    status = Status(
+        Status::Code::INVALID_ARG, "shared memory region '" + name +
+                                       "' must be named '" + region_->Name() +
+                                       "_<suffix>'");
+  } else {
+    status = SharedMemoryRegion::Open(name, &region);
+  }
+  uint64_t region_id = 0;
+  if (status.IsOk()) {
+    std::lock_guard<std::mutex> lock(regions_mu_);
+    region_id = next_region_id_++;
+    regions_.emplace(region_id, std::move(region));
+  }
+
+  SendReply(tag, TRITONSERVER_RESPONSE_COMPLETE_FINAL, status, region_id);
+}
+
+void
+SharedMemoryTransport::HandleUnregisterRegion(
+    SharedMemoryMessageReader& reader, uint64_t tag)
+{
+  uint64_t region_id;
+  Status status;
+  if (!reader.Read(&region_id)) {
+    status = Status(Status::Code::INVALID_ARG, "malformed unregister request");
+  } else {
+    std::lock_guard<std::mutex> lock(regions_mu_);
+    if (regions_.erase(region_id) == 0) {
+      status = Status(
+          Status::Code::NOT_FOUND, "shared memory region " +
+                                       std::to_string(region_id) +
+                                       " is not registered");
+    }
+  }
+
+  SendReply(tag, TRITONSERVER_RESPONSE_COMPLETE_FINAL, status);
+}
+
+Status
+SharedMemoryTransport::GetRegion(
+    const uint64_t region_id, std::shared_ptr<SharedMemoryRegion>* region)
+{
+  std::lock_guard<std::mutex> lock(regions_mu_);
+  const auto itr = regions_.find(region_id);
+  if (itr == regions_.end()) {
+    return Status(
+        Status::Code::INVALID_ARG, "shared memory region " +
+                                       std::to_string(region_id) +
+                                       " is not registered");
+  }
+
+  *region = itr->second;
+  return Status::Success;
+}
+
+void
+SharedMemoryTransport::HandleInfer(
+    SharedMemoryMessageReader& reader, uint64_t tag)
+{
+  std::unique_ptr<InferContext> ctx(new InferContext(shared_from_this(), tag));
+  Status status = Infer(reader, ctx);
+  if (!status.IsOk()) {
+    SendReply(tag, TRITONSERVER_RESPONSE_COMPLETE_FINAL, status);
+  }
+}
+
+Status
+SharedMemoryTransport::Infer(
+    SharedMemoryMessageReader& reader, std::unique_ptr<InferContext>& ctx)
+{
+  const Status malformed(Status::Code::INVALID_ARG, "malformed infer request");
+
+  std::string model_name;
+  int64_t model_version;
+  std::string id;
+  if (!reader.ReadString(&model_name) || !reader.Read(&model_version) ||
+      !reader.ReadString(&id)) {
+    return malformed;
+  }
+
+  std::shared_ptr<Model> model;
+  RETURN_IF_ERROR(server_->GetModel(model_name, model_version, &model));
+  std::unique_ptr<InferenceRequest> request(
+      new InferenceRequest(model, model_version));
+  request->SetId(id);
+
+  uint32_t input_count;
+  if (!reader.Read(&input_count)) {
+    return malformed;
+  }
+  for (uint32_t idx = 0; idx < input_count; idx++) {
+    std::string name;
+    uint32_t datatype;
+    std::vector<int64_t> shape;
+    uint64_t region_id, offset, byte_size;
+    if (!reader.ReadString(&name) || !reader.Read(&datatype) ||
+        !reader.ReadShape(&shape) || !reader.Read(&region_id) ||
+        !reader.Read(&offset) || !reader.Read(&byte_size)) {
+      return malformed;
+    }
+
+    std::shared_ptr<SharedMemoryRegion> region;
+    RETURN_IF_ERROR(GetRegion(region_id, &region));
+    if (!region->Contains(offset, byte_size)) {
+      return Status(
+          Status::Code::INVALID_ARG,
+          "input '" + name + "' data is outside of shared memory region " +
+              std::to_string(region_id));
+    }
+
+    InferenceRequest::Input* input;
+    RETURN_IF_ERROR(request->AddOriginalInput(
+        name, TritonToDataType(static_cast<TRITONSERVER_DataType>(datatype)),
+        shape, &input));
+    RETURN_IF_ERROR(input->AppendData(
+        region->Base() + offset, byte_size, TRITONSERVER_MEMORY_CPU,
+        0 /* memory_type_id */));
+    ctx->input_regions_.emplace_back(std::move(region));
+  }
+
+  uint32_t output_count;
+  if (!reader.Read(&output_count)) {
+    return malformed;
+  }
+  for (uint32_t idx = 0; idx < output_count; idx++) {
+    std::string name;
+    if (!reader.ReadString(&name)) {
+      return malformed;
+    }
+    RETURN_IF_ERROR(request->AddOriginalRequestedOutput(name));
+  }
+
+  uint64_t output_region_id;
+  if (!reader.Read(&output_region_id) || !reader.Read(&ctx->output_offset_) ||
+      !reader.Read(&ctx->output_byte_size_)) {
+    return malformed;
+  }
+  if (output_region_id != 0) {
+    RETURN_IF_ERROR(GetRegion(output_region_id, &ctx->output_region_));
+    if (!ctx->output_region_->Contains(
+            ctx->output_offset_, ctx->output_byte_size_)) {
+      return Status(
+          Status::Code::INVALID_ARG,
+          "output window is outside of shared memory region " +
+              std::to_string(output_region_id));
+    }
+  }
+
+  RETURN_IF_ERROR(request->SetResponseCallback(
+      allocator_.get(), ctx.get(), InferResponseComplete, ctx.get()));
+  RETURN_IF_ERROR(request->SetReleaseCallback(InferRequestComplete, ctx.get()));
+  RETURN_IF_ERROR(request->PrepareForInference());
+  RETURN_IF_ERROR(server_->InferAsync(request));
+
+  // The request and its responses now own the context.
+  ctx.release();
+  return Status::Success;
+}
+
+void
+SharedMemoryTransport::SendReply(
+    const uint64_t tag, const uint32_t flags, const Status& status,
+    const uint64_t region_id)
+{
+  SharedMemoryMessageWriter writer;
+  writer.Append(static_cast<uint32_t>(SharedMemoryTransportLayout::REPLY));
+  writer.Append(tag);
+  writer.Append(flags);
+  writer.Append(static_cast<uint32_t>(status.StatusCode()));
+  writer.AppendString(status.Message());
+  writer.Append(region_id);
+  writer.Append(static_cast<uint32_t>(0) /* output_count */);
+  SendReply(std::string(writer.Message()));
+}
+
+void
+SharedMemoryTransport::SendReply(std::string&& message)
+{
+  {
+    std::lock_guard<std::mutex> lock(reply_mu_);
+    if (replies_.size() >= max_queued_reply_count_) {
+      LOG_ERROR << "shared memory transport: dropped reply, the client is "
+                   "not consuming replies";
+      return;
+    }
+    replies_.emplace_back(std::move(message));
+  }
+  reply_cv_.notify_one();
+}
+
+void
+SharedMemoryTransport::ReplyThread()
+{
+  std::unique_lock<std::mutex> lock(reply_mu_);
+  while (true) {
+    reply_cv_.wait(
+        lock, [this]() { return reply_exiting_ || !replies_.empty(); });
+    if (replies_.empty()) {
+      break;
+    }
+    std::string message = std::move(replies_.front());
+    replies_.pop_front();
+
+    // Once exiting, only send the replies that fit without waiting.
+    const uint64_t timeout_ms = reply_exiting_ ? 0 : kReplyTimeoutMs;
+    lock.unlock();
+    Status status = responses_->Produce(message, timeout_ms);
+    if (!status.IsOk()) {
+      LOG_ERROR << "shared memory transport: failed to send reply: "
+                << status.Message();
+    }
+    lock.lock();
+  }
+}
+
+TRITONSERVER_Error*
+SharedMemoryTransport::ResponseAlloc(
+    TRITONSERVER_ResponseAllocator* allocator, const char* tensor_name,
+    size_t byte_size, TRITONSERVER_MemoryType preferred_memory_type,
+    int64_t preferred_memory_type_id, void* userp, void** buffer,
+    void** buffer_userp, TRITONSERVER_MemoryType* actual_memory_type,
+    int64_t* actual_memory_type_id)
+{
+  InferContext* ctx = reinterpret_cast<InferContext*>(userp);
+  *buffer = nullptr;
+  *buffer_userp = nullptr;
+  *actual_memory_type = TRITONSERVER_MEMORY_CPU;
+  *actual_memory_type_id = 0;
+  if (byte_size == 0) {
+    return nullptr;  // Success
+  }
+
+  if (ctx->output_region_ == nullptr) {
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_INVALID_ARG,
+        (std::string("no output window provided for output '") + tensor_name +
+         "'")
+            .c_str());
+  }
+
+  std::lock_guard<std::mutex> lock(ctx->output_mu_);
+  const uint64_t offset =
+      ((ctx->output_used_ + kOutputAlignment - 1) / kOutputAlignment) *
+      kOutputAlignment;
+  if ((offset > ctx->output_byte_size_) ||
+      (byte_size > (ctx->output_byte_size_ - offset))) {
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_INVALID_ARG,
+        (std::string("output window of ") +
+         std::to_string(ctx->output_byte_size_) +
+         " bytes is too small for output '" + tensor_name + "'")
+            .c_str());
+  }
+
+  *buffer = ctx->output_region_->Base() + ctx->output_offset_ + offset;
+  ctx->output_used_ = offset + byte_size;
+  return nullptr;  // Success
+}
+
+TRITONSERVER_Error*
+SharedMemoryTransport::ResponseRelease(
+    TRITONSERVER_ResponseAllocator* allocator, void* buffer,
+    void* buffer_userp, size_t byte_size, TRITONSERVER_MemoryType memory_type,
+    int64_t memory_type_id)
+{
+  // The output window belongs to the client which reuses it once it
+  // has received the final response.
+  return nullptr;  // Success
+}
+
+void
+SharedMemoryTransport::InferResponseComplete(
+    TRITONSERVER_InferenceResponse* response, const uint32_t flags,
+    void* userp)
+{
+  InferContext* ctx = reinterpret_cast<InferContext*>(userp);
+
+  SharedMemoryMessageWriter writer;
+  writer.Append(static_cast<uint32_t>(SharedMemoryTransportLayout::REPLY));
+  writer.Append(ctx->tag_);
+  writer.Append(flags);
+  if (response == nullptr) {
+    writer.Append(static_cast<uint32_t>(Status::Code::SUCCESS));
+    writer.AppendString("");
+    writer.Append(static_cast<uint64_t>(0) /* region_id */);
+    writer.Append(static_cast<uint32_t>(0) /* output_count */);
+  } else {
+    std::unique_ptr<InferenceResponse> lresponse(
+        reinterpret_cast<InferenceResponse*>(response));
+    Status status = lresponse->ResponseStatus();
+
+    // Outputs are reported by their offset in the output region.
+    SharedMemoryMessageWriter outputs;
+    uint32_t output_count = 0;
+    if (status.IsOk()) {
+      for (const auto& output : lresponse->Outputs()) {
+        const void* base;
+        size_t byte_size;
+        TRITONSERVER_MemoryType memory_type;
+        int64_t memory_type_id;
+        void* buffer_userp;
+        status = output.DataBuffer(
+            &base, &byte_size, &memory_type, &memory_type_id, &buffer_userp);
+        if (!status.IsOk()) {
+          break;
+        }
+        outputs.AppendString(output.Name());
+        outputs.Append(static_cast<uint32_t>(DataTypeToTriton(output.DType())));
+        outputs.AppendShape(output.Shape());
+        outputs.Append(
+            (byte_size == 0)
+                ? static_cast<uint64_t>(0)
+                : static_cast<uint64_t>(
+                      reinterpret_cast<const char*>(base) -
+                      ctx->output_region_->Base()));
+        outputs.Append(static_cast<uint64_t>(byte_size));
+        output_count++;
+      }
+    }
+
+    writer.Append(static_cast<uint32_t>(status.StatusCode()));
+    writer.AppendString(status.Message());
+    writer.Append(static_cast<uint64_t>(0) /* region_id */);
+    if (status.IsOk()) {
+      writer.Append(output_count);
+      writer.AppendMessage(outputs);
+    } else {
+      writer.Append(static_cast<uint32_t>(0) /* output_count */);
+    }
+  }
+
+  ctx->transport_->SendReply(std::string(writer.Message()));
+
+  if ((flags & TRITONSERVER_RESPONSE_COMPLETE_FINAL) != 0) {
+    InferContext::Unref(ctx);
+  }
+}
+
+void
+SharedMemoryTransport::InferRequestComplete(
+    TRITONSERVER_InferenceRequest* request, const uint32_t flags, void* userp)
+{
+  if ((flags & TRITONSERVER_REQUEST_RELEASE_ALL) != 0) {
+    delete reinterpret_cast<InferenceRequest*>(request);
+    InferContext::Unref(reinterpret_cast<InferContext*>(userp));
+  }
+}
+
+}}  // namespace triton::core
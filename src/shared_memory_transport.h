@@ -0,0 +1,146 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "constants.h"
+#include "response_allocator.h"
+#include "shared_memory_ipc.h"
+#include "status.h"
+
+namespace triton { namespace core {
+
+class InferenceServer;
+
+//
+// Server side of the host shared memory transport. Processes on the
+// same host connect by name, register shared memory regions holding
+// their tensors and submit inference requests whose inputs reference
+// those regions. Input tensors are passed to the model without being
+// copied and output tensors are allocated directly in a client
+// provided window of a registered region. See
+// SharedMemoryTransportLayout for the message format.
+//
+class SharedMemoryTransport
+    : public std::enable_shared_from_this<SharedMemoryTransport> {
+ public:
+  // Create the transport named 'name' with rings of 'slot_count'
+  // slots of 'slot_byte_size' bytes and start serving requests. The
+  // requests submitted by the transport hold a reference to it, so
+  // that their responses can still be sent once the server released
+  // the transport.
+  static Status Create(
+      InferenceServer* server, const std::string& name,
+      const uint32_t slot_count, const uint32_t slot_byte_size,
+      std::shared_ptr<SharedMemoryTransport>* transport);
+
+  ~SharedMemoryTransport();
+
+  // Stop accepting new requests. Replies to the requests in flight
+  // are still sent.
+  void Stop();
+
+ private:
+  struct InferContext;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryTransport);
+  SharedMemoryTransport(InferenceServer* server);
+
+  void ReceiveThread();
+  void ReplyThread();
+  void HandleRegisterRegion(SharedMemoryMessageReader& reader, uint64_t tag);
+  void HandleUnregisterRegion(
+      SharedMemoryMessageReader& reader, uint64_t tag);
+  void HandleInfer(SharedMemoryMessageReader& reader, uint64_t tag);
+  Status Infer(
+      SharedMemoryMessageReader& reader, std::unique_ptr<InferContext>& ctx);
+
+  // Send a reply without outputs.
+  void SendReply(
+      const uint64_t tag, const uint32_t flags, const Status& status,
+      const uint64_t region_id = 0);
+
+  // Queue 'message' to be sent by the reply thread, so that the
+  // thread producing a response never waits for the client to make
+  // room in the response ring.
+  void SendReply(std::string&& message);
+
+  Status GetRegion(
+      const uint64_t region_id, std::shared_ptr<SharedMemoryRegion>* region);
+
+  static TRITONSERVER_Error* ResponseAlloc(
+      TRITONSERVER_ResponseAllocator* allocator, const char* tensor_name,
+      size_t byte_size, TRITONSERVER_MemoryType preferred_memory_type,
+      int64_t preferred_memory_type_id, void* userp, void** buffer,
+      void** buffer_userp, TRITONSERVER_MemoryType* actual_memory_type,
+      int64_t* actual_memory_type_id);
+  static TRITONSERVER_Error* ResponseRelease(
+      TRITONSERVER_ResponseAllocator* allocator, void* buffer,
+      void* buffer_userp, size_t byte_size, TRITONSERVER_MemoryType memory_type,
+      int64_t memory_type_id);
+  static void InferResponseComplete(
+      TRITONSERVER_InferenceResponse* response, const uint32_t flags,
+      void* userp);
+  static void InferRequestComplete(
+      TRITONSERVER_InferenceRequest* request, const uint32_t flags,
+      void* userp);
+
+  InferenceServer* server_;
+
+  std::unique_ptr<SharedMemoryRegion> region_;
+  std::unique_ptr<SharedMemoryRing> requests_;
+  std::unique_ptr<SharedMemoryRing> responses_;
+
+  // Regions registered by the client, keyed by the ID returned to the
+  // client.
+  std::mutex regions_mu_;
+  std::unordered_map<uint64_t, std::shared_ptr<SharedMemoryRegion>> regions_;
+  uint64_t next_region_id_;
+
+  std::unique_ptr<ResponseAllocator> allocator_;
+
+  std::atomic<bool> exiting_;
+  std::unique_ptr<std::thread> receive_thread_;
+
+  // Replies waiting for space in the response ring. At most
+  // 'max_queued_reply_count_' replies are queued, further replies are
+  // dropped as the client is not consuming them.
+  std::mutex reply_mu_;
+  std::condition_variable reply_cv_;
+  std::deque<std::string> replies_;
+  size_t max_queued_reply_count_;
+  bool reply_exiting_;
+  std::unique_ptr<std::thread> reply_thread_;
+};
+
+}}  // namespace triton::core
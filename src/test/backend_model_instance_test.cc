@@ -0,0 +1,510 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "backend_config.h"
+#include "backend_manager.h"
+#include "backend_model.h"
+#include "backend_model_instance.h"
+#include "model_repository_manager.h"
+#include "rate_limiter.h"
+#include "server.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Called by the backend to initialize each instance, with the name of
+// the instance. The instance fails to initialize if an error is
+// returned.
+std::function<tc::Status(const std::string&)> init_hook;
+
+// The names of the instances initialized and not yet finalized.
+std::mutex live_mu;
+std::vector<std::string> live_instances;
+
+TRITONSERVER_Error*
+InitInstance(TRITONBACKEND_ModelInstance* instance)
+{
+  const std::string name =
+      reinterpret_cast<tc::TritonModelInstance*>(instance)->Name();
+  if (init_hook) {
+    tc::Status status = init_hook(name);
+    if (!status.IsOk()) {
+      return TRITONSERVER_ErrorNew(
+          tc::StatusCodeToTritonCode(status.StatusCode()),
+          status.Message().c_str());
+    }
+  }
+  std::lock_guard<std::mutex> lk(live_mu);
+  live_instances.push_back(name);
+  return nullptr;
+}
+
+TRITONSERVER_Error*
+FiniInstance(TRITONBACKEND_ModelInstance* instance)
+{
+  const std::string name =
+      reinterpret_cast<tc::TritonModelInstance*>(instance)->Name();
+  // The instance is also finalized when its initialization failed.
+  std::lock_guard<std::mutex> lk(live_mu);
+  auto it = std::find(live_instances.begin(), live_instances.end(), name);
+  if (it != live_instances.end()) {
+    live_instances.erase(it);
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+/* Mock classes for Unit Testing */
+namespace triton { namespace core {
+
+// The model configurations are constructed by the test, skip the
+// validation and label loading done by Model::Init.
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+std::string
+JoinPath(std::initializer_list<std::string> segments)
+{
+  std::string path;
+  for (const auto& segment : segments) {
+    path += (path.empty() ? "" : "/") + segment;
+  }
+  return path;
+}
+
+Status
+ReadTextFile(const std::string& path, std::string* contents)
+{
+  return Status(Status::Code::NOT_FOUND, "no file '" + path + "'");
+}
+
+// Only the GPU instances check the memory limit.
+Status
+BackendConfigurationModelLoadGpuFraction(
+    const triton::common::BackendCmdlineConfigMap& config_map,
+    const int device_id, double* memory_limit)
+{
+  *memory_limit = 1.0;
+  return Status::Success;
+}
+
+// The server is never destroyed, so neither is its repository manager.
+ModelRepositoryManager::~ModelRepositoryManager() {}
+RepositoryWatcher::~RepositoryWatcher() {}
+
+// The server only provides the rate limiter and the instance load
+// thread count.
+InferenceServer::InferenceServer()
+    : version_("test"), model_instance_load_thread_count_(1),
+      response_cache_enabled_(false)
+{
+  std::unique_ptr<RateLimiter> rate_limiter;
+  RateLimiter::Create(
+      true /* ignore_resources_and_priority */, {}, &rate_limiter);
+  rate_limiter_ = std::move(rate_limiter);
+}
+
+// The backend initializes and finalizes the instances with the
+// functions above.
+TritonBackend::TritonBackend(
+    const std::string& name, const std::string& dir, const std::string& libpath,
+    const TritonServerMessage& backend_config)
+    : name_(name), dir_(dir), libpath_(libpath),
+      backend_config_(backend_config), state_(nullptr)
+{
+  ClearHandles();
+  inst_init_fn_ = InitInstance;
+  inst_fini_fn_ = FiniInstance;
+}
+
+TritonBackend::~TritonBackend() {}
+
+void
+TritonBackend::ClearHandles()
+{
+  dlhandle_ = nullptr;
+  backend_init_fn_ = nullptr;
+  backend_fini_fn_ = nullptr;
+  backend_attri_fn_ = nullptr;
+  model_init_fn_ = nullptr;
+  model_fini_fn_ = nullptr;
+  inst_init_fn_ = nullptr;
+  inst_fini_fn_ = nullptr;
+  inst_exec_fn_ = nullptr;
+}
+
+Status
+TritonBackend::Create(
+    const std::string& name, const std::string& dir, const std::string& libpath,
+    const triton::common::BackendCmdlineConfig& backend_cmdline_config,
+    std::shared_ptr<TritonBackend>* backend)
+{
+  backend->reset(new TritonBackend(
+      name, dir, libpath, TritonServerMessage(std::string("{}"))));
+  return Status::Success;
+}
+
+//
+// TritonModel, only holds the configuration and the instances.
+//
+TritonModel::TritonModel(
+    InferenceServer* server,
+    const std::shared_ptr<LocalizedPath>& localized_model_dir,
+    const std::shared_ptr<TritonBackend>& backend,
+    const double min_compute_capability, const int64_t version,
+    const inference::ModelConfig& config, const bool auto_complete_config,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map)
+    : Model(min_compute_capability, "", version, config), server_(server),
+      min_compute_capability_(min_compute_capability),
+      auto_complete_config_(auto_complete_config),
+      backend_cmdline_config_map_(backend_cmdline_config_map),
+      host_policy_map_(host_policy_map), device_blocking_(false),
+      localized_model_dir_(localized_model_dir), backend_(backend),
+      state_(nullptr)
+{
+}
+
+TritonModel::~TritonModel()
+{
+  instances_.clear();
+  passive_instances_.clear();
+  server_->GetRateLimiter()->UnregisterModel(this);
+}
+
+Status
+TritonModel::Create(
+    InferenceServer* server, const std::string& model_path,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map,
+    const int64_t version, inference::ModelConfig model_config,
+    const bool is_config_provided, std::unique_ptr<TritonModel>* model)
+{
+  std::shared_ptr<TritonBackend> backend;
+  RETURN_IF_ERROR(TritonBackend::Create("test", "", "", {}, &backend));
+  model->reset(new TritonModel(
+      server, nullptr /* localized_model_dir */, backend,
+      0 /* min_compute_capability */, version, model_config,
+      false /* auto_complete_config */, backend_cmdline_config_map,
+      host_policy_map));
+  return TritonModelInstance::SetInstances(
+      model->get(), backend_cmdline_config_map, host_policy_map, model_config);
+}
+
+Status
+TritonModel::RegisterInstance(
+    std::shared_ptr<TritonModelInstance>&& instance, const bool passive)
+{
+  if (passive) {
+    passive_instances_.emplace_back(std::move(instance));
+  } else {
+    instances_.emplace_back(std::move(instance));
+  }
+  return Status::Success;
+}
+
+std::shared_ptr<TritonModelInstance>
+TritonModel::FindInstance(const TritonModelInstance::Signature& signature) const
+{
+  return nullptr;
+}
+
+std::vector<std::shared_ptr<TritonModelInstance>>
+TritonModel::GetInstancesByDevice(int32_t device_id) const
+{
+  return {};
+}
+
+}}  // namespace triton::core
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+class BackendModelInstanceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    // The server is never destroyed, tearing it down requires the whole
+    // server.
+    server_ = new tc::InferenceServer();
+  }
+
+  void TearDown() override
+  {
+    init_hook = nullptr;
+    std::lock_guard<std::mutex> lk(live_mu);
+    live_instances.clear();
+  }
+
+  // Create a model with a CPU instance group for each of 'counts',
+  // using 'thread_count' threads to create its instances.
+  tc::Status CreateModel(
+      const std::vector<int32_t>& counts, const uint32_t thread_count,
+      std::unique_ptr<tc::TritonModel>* model)
+  {
+    server_->SetModelInstanceLoadThreadCount(thread_count);
+    inference::ModelConfig config;
+    config.set_name("model");
+    for (size_t idx = 0; idx < counts.size(); ++idx) {
+      auto group = config.add_instance_group();
+      group->set_name("group" + std::to_string(idx));
+      group->set_kind(inference::ModelInstanceGroup::KIND_CPU);
+      group->set_count(counts[idx]);
+    }
+    return tc::TritonModel::Create(
+        server_, "", {}, {}, 1 /* version */, config,
+        true /* is_config_provided */, model);
+  }
+
+  static std::vector<std::string> InstanceNames(const tc::TritonModel& model)
+  {
+    std::vector<std::string> names;
+    for (const auto& instance : model.Instances()) {
+      names.push_back(instance->Name());
+    }
+    return names;
+  }
+
+  static std::vector<std::string> LiveInstances()
+  {
+    std::lock_guard<std::mutex> lk(live_mu);
+    return live_instances;
+  }
+
+  static tc::InferenceServer* server_;
+};
+
+tc::InferenceServer* BackendModelInstanceTest::server_ = nullptr;
+
+// Blocks the instances initializing until 'count' of them do, to
+// check how many instances initialize at once.
+class Barrier {
+ public:
+  explicit Barrier(const size_t count)
+      : count_(count), waiting_(0), max_waiting_(0)
+  {
+  }
+
+  void Wait()
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    max_waiting_ = std::max(max_waiting_, ++waiting_);
+    if (waiting_ >= count_) {
+      released_ = true;
+      cv_.notify_all();
+    }
+    // Release on timeout so that a lower concurrency fails the check
+    // on the maximum instead of hanging.
+    cv_.wait_for(lk, std::chrono::seconds(5), [this] { return released_; });
+    --waiting_;
+  }
+
+  size_t MaxWaiting()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return max_waiting_;
+  }
+
+ private:
+  const size_t count_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  size_t waiting_;
+  size_t max_waiting_;
+  bool released_ = false;
+};
+
+TEST_F(BackendModelInstanceTest, SerialCreation)
+{
+  size_t initializing = 0;
+  size_t max_initializing = 0;
+  std::mutex mu;
+  init_hook = [&](const std::string& name) {
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      max_initializing = std::max(max_initializing, ++initializing);
+    }
+    std::this_thread::yield();
+    std::lock_guard<std::mutex> lk(mu);
+    --initializing;
+    return tc::Status::Success;
+  };
+
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel({3}, 1 /* thread_count */, &model));
+  EXPECT_EQ(max_initializing, 1u);
+  EXPECT_EQ(
+      InstanceNames(*model),
+      std::vector<std::string>({"group0_0", "group0_1", "group0_2"}));
+}
+
+TEST_F(BackendModelInstanceTest, ConcurrentCreation)
+{
+  Barrier barrier(3);
+  init_hook = [&](const std::string& name) {
+    barrier.Wait();
+    return tc::Status::Success;
+  };
+
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel({4, 2}, 3 /* thread_count */, &model));
+  EXPECT_EQ(barrier.MaxWaiting(), 3u);
+  EXPECT_EQ(LiveInstances().size(), 6u);
+}
+
+TEST_F(BackendModelInstanceTest, ConfigOrder)
+{
+  // The instances are registered in config order whatever order they
+  // complete in, here the reverse order.
+  const std::vector<std::string> expected(
+      {"group0_0", "group0_1", "group0_2", "group1"});
+  std::mutex mu;
+  std::condition_variable cv;
+  std::vector<std::string> completed;
+  init_hook = [&](const std::string& name) {
+    const size_t position =
+        expected.size() - 1 -
+        (std::find(expected.begin(), expected.end(), name) - expected.begin());
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait_for(lk, std::chrono::seconds(5), [&] {
+      return completed.size() == position;
+    });
+    completed.push_back(name);
+    cv.notify_all();
+    return tc::Status::Success;
+  };
+
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel({3, 1}, 4 /* thread_count */, &model));
+  EXPECT_EQ(
+      completed, std::vector<std::string>(expected.rbegin(), expected.rend()));
+  EXPECT_EQ(InstanceNames(*model), expected);
+}
+
+TEST_F(BackendModelInstanceTest, CreationFailure)
+{
+  // 'group0_1' fails while the others are created, the created
+  // instances are finalized and the failure is returned.
+  init_hook = [&](const std::string& name) {
+    if (name == "group0_1") {
+      return tc::Status(tc::Status::Code::INTERNAL, "init failed");
+    }
+    return tc::Status::Success;
+  };
+
+  std::unique_ptr<tc::TritonModel> model;
+  tc::Status status = CreateModel({4}, 4 /* thread_count */, &model);
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::INTERNAL);
+  EXPECT_EQ(status.Message(), "init failed");
+  EXPECT_TRUE(model->Instances().empty());
+  EXPECT_TRUE(LiveInstances().empty());
+}
+
+TEST_F(BackendModelInstanceTest, SerialCreationFailure)
+{
+  // 'group0_1' fails when created one at a time, 'group0_0' is
+  // destroyed along with the model right after its warmup.
+  init_hook = [&](const std::string& name) {
+    if (name == "group0_1") {
+      return tc::Status(tc::Status::Code::INTERNAL, "init failed");
+    }
+    return tc::Status::Success;
+  };
+
+  std::unique_ptr<tc::TritonModel> model;
+  tc::Status status = CreateModel({3}, 1 /* thread_count */, &model);
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::INTERNAL);
+  EXPECT_EQ(LiveInstances(), std::vector<std::string>({"group0_0"}));
+  model.reset();
+  EXPECT_TRUE(LiveInstances().empty());
+}
+
+TEST_F(BackendModelInstanceTest, FirstFailureInConfigOrder)
+{
+  // Both 'group0_0' and 'group1' fail, 'group1' first, the failure of
+  // 'group0_0' is returned as it comes first in the config.
+  std::mutex mu;
+  std::condition_variable cv;
+  bool group1_failed = false;
+  init_hook = [&](const std::string& name) {
+    std::unique_lock<std::mutex> lk(mu);
+    if (name == "group1") {
+      group1_failed = true;
+      cv.notify_all();
+      return tc::Status(tc::Status::Code::INTERNAL, "group1 failed");
+    }
+    if (name == "group0") {
+      cv.wait_for(
+          lk, std::chrono::seconds(5), [&] { return group1_failed; });
+      return tc::Status(tc::Status::Code::INVALID_ARG, "group0 failed");
+    }
+    return tc::Status::Success;
+  };
+
+  std::unique_ptr<tc::TritonModel> model;
+  tc::Status status = CreateModel({1, 1}, 2 /* thread_count */, &model);
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::INVALID_ARG);
+  EXPECT_EQ(status.Message(), "group0 failed");
+  EXPECT_TRUE(model->Instances().empty());
+  EXPECT_TRUE(LiveInstances().empty());
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,653 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef TRITON_ENABLE_METRICS
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "backend_config.h"
+#include "backend_manager.h"
+#include "backend_model.h"
+#include "backend_model_instance.h"
+#include "cache_manager.h"
+#include "dynamic_batch_scheduler.h"
+#include "metric_model_reporter.h"
+#include "metrics.h"
+#include "model_repository_manager.h"
+#include "rate_limiter.h"
+#include "response_allocator.h"
+#include "server.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// The backend holds executions while 'exec_blocked' is set and counts
+// the requests it executes.
+std::mutex exec_mu;
+std::condition_variable exec_cv;
+bool exec_blocked = false;
+size_t executed_count = 0;
+
+TRITONSERVER_Error*
+ExecInstance(
+    TRITONBACKEND_ModelInstance* instance, TRITONBACKEND_Request** requests,
+    const uint32_t request_count)
+{
+  {
+    std::unique_lock<std::mutex> lk(exec_mu);
+    executed_count += request_count;
+    exec_cv.notify_all();
+    exec_cv.wait(lk, [] { return !exec_blocked; });
+  }
+  for (uint32_t idx = 0; idx < request_count; ++idx) {
+    tc::InferenceRequest::Release(
+        std::unique_ptr<tc::InferenceRequest>(
+            reinterpret_cast<tc::InferenceRequest*>(requests[idx])),
+        TRITONSERVER_REQUEST_RELEASE_ALL);
+  }
+  return nullptr;
+}
+
+void
+ReleaseRequest(
+    TRITONSERVER_InferenceRequest* request, const uint32_t flags, void* userp)
+{
+  delete reinterpret_cast<tc::InferenceRequest*>(request);
+}
+
+// Counts the error responses of the rejected requests.
+std::mutex response_mu;
+size_t response_count = 0;
+
+void
+CompleteResponse(
+    TRITONSERVER_InferenceResponse* response, const uint32_t flags,
+    void* userp)
+{
+  delete reinterpret_cast<tc::InferenceResponse*>(response);
+  std::lock_guard<std::mutex> lk(response_mu);
+  ++response_count;
+}
+
+// The responses only report errors, so no output is allocated.
+tc::ResponseAllocator allocator(nullptr, nullptr, nullptr);
+
+}  // namespace
+
+/* Mock classes for Unit Testing */
+namespace triton { namespace core {
+
+// The model configurations are constructed by the test, skip the
+// validation and label loading done by Model::Init.
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+std::string
+JoinPath(std::initializer_list<std::string> segments)
+{
+  std::string path;
+  for (const auto& segment : segments) {
+    path += (path.empty() ? "" : "/") + segment;
+  }
+  return path;
+}
+
+Status
+ReadTextFile(const std::string& path, std::string* contents)
+{
+  return Status(Status::Code::NOT_FOUND, "no file '" + path + "'");
+}
+
+// Only the GPU instances check the memory limit.
+Status
+BackendConfigurationModelLoadGpuFraction(
+    const triton::common::BackendCmdlineConfigMap& config_map,
+    const int device_id, double* memory_limit)
+{
+  *memory_limit = 1.0;
+  return Status::Success;
+}
+
+// The server is never destroyed, so neither is its repository manager.
+ModelRepositoryManager::~ModelRepositoryManager() {}
+RepositoryWatcher::~RepositoryWatcher() {}
+
+// The response cache is not enabled.
+Status
+TritonCache::Hash(const InferenceRequest& request, std::string* key)
+{
+  return Status(Status::Code::UNSUPPORTED, "no response cache");
+}
+
+Status
+TritonCache::Insert(InferenceResponse* response, const std::string& key)
+{
+  return Status(Status::Code::UNSUPPORTED, "no response cache");
+}
+
+Status
+TritonCache::Lookup(InferenceResponse* response, const std::string& key)
+{
+  return Status(Status::Code::UNSUPPORTED, "no response cache");
+}
+
+// The server only provides the rate limiter.
+InferenceServer::InferenceServer()
+    : version_("test"), model_instance_load_thread_count_(1),
+      response_cache_enabled_(false)
+{
+  std::unique_ptr<RateLimiter> rate_limiter;
+  RateLimiter::Create(
+      true /* ignore_resources_and_priority */, {}, &rate_limiter);
+  rate_limiter_ = std::move(rate_limiter);
+}
+
+// The backend only executes, with the function above.
+TritonBackend::TritonBackend(
+    const std::string& name, const std::string& dir, const std::string& libpath,
+    const TritonServerMessage& backend_config)
+    : name_(name), dir_(dir), libpath_(libpath),
+      backend_config_(backend_config), state_(nullptr)
+{
+  ClearHandles();
+  inst_exec_fn_ = ExecInstance;
+}
+
+TritonBackend::~TritonBackend() {}
+
+void
+TritonBackend::ClearHandles()
+{
+  dlhandle_ = nullptr;
+  backend_init_fn_ = nullptr;
+  backend_fini_fn_ = nullptr;
+  backend_attri_fn_ = nullptr;
+  model_init_fn_ = nullptr;
+  model_fini_fn_ = nullptr;
+  inst_init_fn_ = nullptr;
+  inst_fini_fn_ = nullptr;
+  inst_exec_fn_ = nullptr;
+}
+
+Status
+TritonBackend::Create(
+    const std::string& name, const std::string& dir, const std::string& libpath,
+    const triton::common::BackendCmdlineConfig& backend_cmdline_config,
+    std::shared_ptr<TritonBackend>* backend)
+{
+  backend->reset(new TritonBackend(
+      name, dir, libpath, TritonServerMessage(std::string("{}"))));
+  return Status::Success;
+}
+
+//
+// TritonModel, only holds the configuration and the instances.
+//
+TritonModel::TritonModel(
+    InferenceServer* server,
+    const std::shared_ptr<LocalizedPath>& localized_model_dir,
+    const std::shared_ptr<TritonBackend>& backend,
+    const double min_compute_capability, const int64_t version,
+    const inference::ModelConfig& config, const bool auto_complete_config,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map)
+    : Model(min_compute_capability, "", version, config), server_(server),
+      min_compute_capability_(min_compute_capability),
+      auto_complete_config_(auto_complete_config),
+      backend_cmdline_config_map_(backend_cmdline_config_map),
+      host_policy_map_(host_policy_map), device_blocking_(false),
+      localized_model_dir_(localized_model_dir), backend_(backend),
+      state_(nullptr)
+{
+}
+
+TritonModel::~TritonModel()
+{
+  instances_.clear();
+  passive_instances_.clear();
+  server_->GetRateLimiter()->UnregisterModel(this);
+}
+
+Status
+TritonModel::Create(
+    InferenceServer* server, const std::string& model_path,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map,
+    const int64_t version, inference::ModelConfig model_config,
+    const bool is_config_provided, std::unique_ptr<TritonModel>* model)
+{
+  std::shared_ptr<TritonBackend> backend;
+  RETURN_IF_ERROR(TritonBackend::Create("test", "", "", {}, &backend));
+  model->reset(new TritonModel(
+      server, nullptr /* localized_model_dir */, backend,
+      0 /* min_compute_capability */, version, model_config,
+      false /* auto_complete_config */, backend_cmdline_config_map,
+      host_policy_map));
+  RETURN_IF_ERROR((*model)->Init(is_config_provided));
+  return TritonModelInstance::SetInstances(
+      model->get(), backend_cmdline_config_map, host_policy_map, model_config);
+}
+
+Status
+TritonModel::RegisterInstance(
+    std::shared_ptr<TritonModelInstance>&& instance, const bool passive)
+{
+  if (passive) {
+    passive_instances_.emplace_back(std::move(instance));
+  } else {
+    instances_.emplace_back(std::move(instance));
+  }
+  return Status::Success;
+}
+
+std::shared_ptr<TritonModelInstance>
+TritonModel::FindInstance(const TritonModelInstance::Signature& signature) const
+{
+  return nullptr;
+}
+
+std::vector<std::shared_ptr<TritonModelInstance>>
+TritonModel::GetInstancesByDevice(int32_t device_id) const
+{
+  return {};
+}
+
+}}  // namespace triton::core
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+// Return the value of the gauge or counter of 'family_name' labelled
+// with 'model' and, if not empty, 'label_name' = 'label_value'. Return
+// -1 if there is no such metric.
+double
+MetricValue(
+    const std::string& family_name, const std::string& model,
+    const std::string& label_name = "", const std::string& label_value = "")
+{
+  for (const auto& family : tc::Metrics::GetRegistry()->Collect()) {
+    if (family.name != family_name) {
+      continue;
+    }
+    for (const auto& metric : family.metric) {
+      bool model_match = false;
+      bool label_match = label_name.empty();
+      for (const auto& label : metric.label) {
+        model_match |= ((label.name == "model") && (label.value == model));
+        label_match |=
+            ((label.name == label_name) && (label.value == label_value));
+      }
+      if (model_match && label_match) {
+        return (family.type == prometheus::MetricType::Gauge)
+                   ? metric.gauge.value
+                   : metric.counter.value;
+      }
+    }
+  }
+  return -1;
+}
+
+// Return the number of batches sent for 'model', for every reason.
+double
+BatchCount(const std::string& model)
+{
+  double count = 0;
+  for (const auto reason : tc::MetricModelReporter::kSchedulerBatchReasons) {
+    count += std::max(
+        0.0, MetricValue("nv_scheduler_batches", model, "reason", reason));
+  }
+  return count;
+}
+
+// The scheduler is observed through its metrics, which are updated
+// asynchronously, so poll until 'fn' holds.
+bool
+WaitUntil(const std::function<bool()>& fn)
+{
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!fn()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+class DynamicBatchSchedulerTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    // The server is never destroyed, tearing it down requires the whole
+    // server.
+    server_ = new tc::InferenceServer();
+    tc::Metrics::EnableMetrics();
+  }
+
+  void SetUp() override
+  {
+    tc::Metrics::SetConfigMap({{"", {{"scheduler_metrics", "true"}}}});
+  }
+
+  void TearDown() override
+  {
+    {
+      std::lock_guard<std::mutex> lk(exec_mu);
+      exec_blocked = false;
+      executed_count = 0;
+    }
+    exec_cv.notify_all();
+    tc::Metrics::SetConfigMap({});
+  }
+
+  // Create a model with a single CPU instance.
+  tc::Status CreateModel(
+      const std::string& name, std::unique_ptr<tc::TritonModel>* model)
+  {
+    inference::ModelConfig config;
+    config.set_name(name);
+    config.set_max_batch_size(8);
+    auto group = config.add_instance_group();
+    group->set_name("group");
+    group->set_kind(inference::ModelInstanceGroup::KIND_CPU);
+    group->set_count(1);
+    return tc::TritonModel::Create(
+        server_, "", {}, {}, 1 /* version */, config,
+        true /* is_config_provided */, model);
+  }
+
+  static tc::Status CreateScheduler(
+      tc::TritonModel* model,
+      const inference::ModelDynamicBatching& batcher_config,
+      std::unique_ptr<tc::Scheduler>* scheduler)
+  {
+    return tc::DynamicBatchScheduler::Create(
+        model, nullptr /* model_instance */, 0 /* nice */,
+        true /* dynamic_batching_enabled */, 8 /* max_batch_size */,
+        {} /* enforce_equal_shape_tensors */, batcher_config,
+        false /* response_cache_enable */, scheduler);
+  }
+
+  // A batcher config holding requests in the queue for long enough to
+  // observe them.
+  static inference::ModelDynamicBatching HoldingBatcherConfig()
+  {
+    inference::ModelDynamicBatching batcher_config;
+    batcher_config.add_preferred_batch_size(4);
+    batcher_config.set_max_queue_delay_microseconds(10 * 1000 * 1000);
+    return batcher_config;
+  }
+
+  static std::unique_ptr<tc::InferenceRequest> NewRequest(
+      tc::TritonModel* model)
+  {
+    std::unique_ptr<tc::InferenceRequest> request(
+        new tc::InferenceRequest(model, 1 /* requested_model_version */));
+    request->SetReleaseCallback(ReleaseRequest, nullptr);
+    request->SetResponseCallback(
+        &allocator, nullptr, CompleteResponse, nullptr);
+    return request;
+  }
+
+  static tc::InferenceServer* server_;
+};
+
+tc::InferenceServer* DynamicBatchSchedulerTest::server_ = nullptr;
+
+TEST_F(DynamicBatchSchedulerTest, QueueAndPendingSizes)
+{
+  const std::string name = "sizes";
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel(name, &model));
+
+  // Keep the reporter shared by the schedulers, so that it outlives them.
+  std::shared_ptr<tc::MetricModelReporter> reporter;
+  ASSERT_OK(tc::MetricModelReporter::Create(
+      name, 1, -1 /* device */, false /* cache */, {} /* tags */, &reporter));
+
+  // The schedulers of a model report into the same gauges, the sizes
+  // they report add up.
+  std::unique_ptr<tc::Scheduler> first, second;
+  ASSERT_OK(CreateScheduler(model.get(), HoldingBatcherConfig(), &first));
+  ASSERT_OK(CreateScheduler(model.get(), HoldingBatcherConfig(), &second));
+  auto request = NewRequest(model.get());
+  ASSERT_OK(first->Enqueue(request));
+  request = NewRequest(model.get());
+  ASSERT_OK(second->Enqueue(request));
+
+  EXPECT_TRUE(WaitUntil([&name] {
+    return (MetricValue("nv_scheduler_queue_size", name, "priority", "0") ==
+            2) &&
+           (MetricValue("nv_scheduler_pending_batch_size", name) == 2);
+  }));
+
+  // A destroyed scheduler withdraws the sizes it reported.
+  second.reset();
+  EXPECT_EQ(MetricValue("nv_scheduler_queue_size", name, "priority", "0"), 1);
+  EXPECT_EQ(MetricValue("nv_scheduler_pending_batch_size", name), 1);
+  first.reset();
+  EXPECT_EQ(MetricValue("nv_scheduler_queue_size", name, "priority", "0"), 0);
+  EXPECT_EQ(MetricValue("nv_scheduler_pending_batch_size", name), 0);
+}
+
+TEST_F(DynamicBatchSchedulerTest, Rejections)
+{
+  const std::string name = "rejections";
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel(name, &model));
+
+  // A request beyond the maximum queue size is rejected.
+  auto batcher_config = HoldingBatcherConfig();
+  batcher_config.mutable_default_queue_policy()->set_max_queue_size(1);
+  std::unique_ptr<tc::Scheduler> scheduler;
+  ASSERT_OK(CreateScheduler(model.get(), batcher_config, &scheduler));
+  auto request = NewRequest(model.get());
+  ASSERT_OK(scheduler->Enqueue(request));
+  request = NewRequest(model.get());
+  EXPECT_FALSE(scheduler->Enqueue(request).IsOk());
+  EXPECT_EQ(
+      MetricValue(
+          "nv_scheduler_rejected_requests", name, "reason", "max_queue_size"),
+      1);
+  EXPECT_EQ(
+      MetricValue("nv_scheduler_rejected_requests", name, "reason", "timeout"),
+      0);
+  scheduler.reset();
+
+  // A request waiting beyond its timeout is rejected by the batcher.
+  batcher_config = HoldingBatcherConfig();
+  auto policy = batcher_config.mutable_default_queue_policy();
+  policy->set_timeout_action(inference::ModelQueuePolicy::REJECT);
+  policy->set_default_timeout_microseconds(1000);
+  ASSERT_OK(CreateScheduler(model.get(), batcher_config, &scheduler));
+  request = NewRequest(model.get());
+  ASSERT_OK(scheduler->Enqueue(request));
+  EXPECT_TRUE(WaitUntil([&name] {
+    return MetricValue(
+               "nv_scheduler_rejected_requests", name, "reason", "timeout") ==
+           1;
+  }));
+  EXPECT_TRUE(WaitUntil([] {
+    std::lock_guard<std::mutex> lk(response_mu);
+    return response_count == 1;
+  }));
+}
+
+TEST_F(DynamicBatchSchedulerTest, BatchCountedOncePerPayload)
+{
+  const std::string name = "batches";
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel(name, &model));
+
+  // Every request is sent without delay, to be executed with the
+  // requests that join its payload while it waits for the instance.
+  inference::ModelDynamicBatching batcher_config;
+  batcher_config.add_preferred_batch_size(4);
+  std::unique_ptr<tc::Scheduler> scheduler;
+  ASSERT_OK(CreateScheduler(model.get(), batcher_config, &scheduler));
+
+  // Hold the instance in the execution of the first payload.
+  {
+    std::lock_guard<std::mutex> lk(exec_mu);
+    exec_blocked = true;
+  }
+  auto request = NewRequest(model.get());
+  ASSERT_OK(scheduler->Enqueue(request));
+  {
+    std::unique_lock<std::mutex> lk(exec_mu);
+    ASSERT_TRUE(exec_cv.wait_for(
+        lk, std::chrono::seconds(5), [] { return executed_count == 1; }));
+  }
+  EXPECT_EQ(BatchCount(name), 1);
+
+  // The second payload is handed to the rate limiter, and the third
+  // request joins it while it waits.
+  request = NewRequest(model.get());
+  ASSERT_OK(scheduler->Enqueue(request));
+  EXPECT_TRUE(WaitUntil([&name] { return BatchCount(name) == 2; }));
+  request = NewRequest(model.get());
+  ASSERT_OK(scheduler->Enqueue(request));
+  EXPECT_TRUE(WaitUntil([&name] {
+    return MetricValue("nv_scheduler_queue_size", name, "priority", "0") == 0;
+  }));
+
+  {
+    std::unique_lock<std::mutex> lk(exec_mu);
+    exec_blocked = false;
+    exec_cv.notify_all();
+    ASSERT_TRUE(exec_cv.wait_for(
+        lk, std::chrono::seconds(5), [] { return executed_count == 3; }));
+  }
+  EXPECT_EQ(BatchCount(name), 2);
+  EXPECT_EQ(MetricValue("nv_scheduler_batches", name, "reason", "no_delay"), 2);
+}
+
+TEST_F(DynamicBatchSchedulerTest, EnqueueBatch)
+{
+  const std::string name = "enqueue_batch";
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel(name, &model));
+
+  // The batcher sends without delay, it sees the requests of a batch
+  // all at once since they are queued under a single lock, and so
+  // sends each batch as a single payload. Requests queued one at a
+  // time would be picked up by the batcher as soon as it wakes.
+  inference::ModelDynamicBatching batcher_config;
+  batcher_config.add_preferred_batch_size(4);
+  std::unique_ptr<tc::Scheduler> scheduler;
+  ASSERT_OK(CreateScheduler(model.get(), batcher_config, &scheduler));
+  const size_t batch_count = 100;
+  for (size_t batch = 1; batch <= batch_count; ++batch) {
+    std::vector<std::unique_ptr<tc::InferenceRequest>> requests;
+    for (size_t idx = 0; idx < 4; ++idx) {
+      requests.emplace_back(NewRequest(model.get()));
+    }
+    scheduler->EnqueueBatch(requests);
+    for (const auto& request : requests) {
+      EXPECT_TRUE(request == nullptr);
+    }
+    {
+      std::unique_lock<std::mutex> lk(exec_mu);
+      ASSERT_TRUE(exec_cv.wait_for(lk, std::chrono::seconds(5), [batch] {
+        return executed_count == 4 * batch;
+      }));
+    }
+  }
+  EXPECT_TRUE(WaitUntil([&name] { return BatchCount(name) == batch_count; }));
+  EXPECT_EQ(BatchCount(name), batch_count);
+  EXPECT_EQ(
+      MetricValue("nv_scheduler_batches", name, "reason", "preferred_size"),
+      batch_count);
+}
+
+TEST_F(DynamicBatchSchedulerTest, EnqueueBatchRejections)
+{
+  const std::string name = "enqueue_batch_rejections";
+  std::unique_ptr<tc::TritonModel> model;
+  ASSERT_OK(CreateModel(name, &model));
+
+  // The requests beyond the maximum queue size are completed with an
+  // error response, the others stay queued.
+  auto batcher_config = HoldingBatcherConfig();
+  batcher_config.mutable_default_queue_policy()->set_max_queue_size(2);
+  std::unique_ptr<tc::Scheduler> scheduler;
+  ASSERT_OK(CreateScheduler(model.get(), batcher_config, &scheduler));
+  size_t start_response_count = 0;
+  {
+    std::lock_guard<std::mutex> lk(response_mu);
+    start_response_count = response_count;
+  }
+  std::vector<std::unique_ptr<tc::InferenceRequest>> requests;
+  for (size_t idx = 0; idx < 3; ++idx) {
+    requests.emplace_back(NewRequest(model.get()));
+  }
+  scheduler->EnqueueBatch(requests);
+  {
+    std::lock_guard<std::mutex> lk(response_mu);
+    EXPECT_EQ(response_count - start_response_count, 1u);
+  }
+  EXPECT_EQ(MetricValue("nv_scheduler_queue_size", name, "priority", "0"), 2);
+  EXPECT_EQ(
+      MetricValue(
+          "nv_scheduler_rejected_requests", name, "reason", "max_queue_size"),
+      1);
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#endif  // TRITON_ENABLE_METRICS
@@ -0,0 +1,751 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "filesystem.h"
+#include "infer_request.h"
+#include "model.h"
+#include "model_config_utils.h"
+#include "response_allocator.h"
+#include "scheduler.h"
+#include "triton/core/tritonbackend.h"
+#include "triton/core/tritonserver.h"
+
+namespace tc = triton::core;
+
+/* Mock functions for Unit Testing */
+namespace triton { namespace core {
+
+// The model configurations are constructed by the test, skip the
+// validation and label loading done by Model::Init.
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+std::string
+JoinPath(std::initializer_list<std::string> segments)
+{
+  std::string path;
+  for (const auto& segment : segments) {
+    path += (path.empty() ? "" : "/") + segment;
+  }
+  return path;
+}
+
+Status
+ReadTextFile(const std::string& path, std::string* contents)
+{
+  return Status(Status::Code::NOT_FOUND, "no file '" + path + "'");
+}
+
+}}  // namespace triton::core
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+// Create and initialize a model with a single FP32 input 'INPUT0' of
+// shape 'dims' and a single output 'OUTPUT0'.
+std::shared_ptr<tc::Model>
+CreateModel(
+    const std::string& name, const std::vector<int64_t>& dims,
+    const inference::DataType datatype = inference::TYPE_FP32)
+{
+  inference::ModelConfig config;
+  config.set_name(name);
+  auto input = config.add_input();
+  input->set_name("INPUT0");
+  input->set_data_type(datatype);
+  auto output = config.add_output();
+  output->set_name("OUTPUT0");
+  output->set_data_type(datatype);
+  for (const auto dim : dims) {
+    input->add_dims(dim);
+    output->add_dims(dim);
+  }
+  std::shared_ptr<tc::Model> model =
+      std::make_shared<tc::Model>(0.0, "", 1, config);
+  EXPECT_TRUE(model->Init(true).IsOk());
+  return model;
+}
+
+TRITONSERVER_Error*
+ResponseAlloc(
+    TRITONSERVER_ResponseAllocator* allocator, const char* tensor_name,
+    size_t byte_size, TRITONSERVER_MemoryType preferred_memory_type,
+    int64_t preferred_memory_type_id, void* userp, void** buffer,
+    void** buffer_userp, TRITONSERVER_MemoryType* actual_memory_type,
+    int64_t* actual_memory_type_id)
+{
+  *buffer = nullptr;
+  return nullptr;
+}
+
+TRITONSERVER_Error*
+ResponseRelease(
+    TRITONSERVER_ResponseAllocator* allocator, void* buffer, void* buffer_userp,
+    size_t byte_size, TRITONSERVER_MemoryType memory_type,
+    int64_t memory_type_id)
+{
+  return nullptr;
+}
+
+void
+ReleaseFn(
+    TRITONSERVER_InferenceRequest* request, const uint32_t flags, void* userp)
+{
+}
+
+void
+ResponseFn(
+    TRITONSERVER_InferenceResponse* response, const uint32_t flags, void* userp)
+{
+}
+
+class InferRequestTest : public ::testing::Test {
+ protected:
+  InferRequestTest() : allocator_(ResponseAlloc, ResponseRelease, nullptr) {}
+
+  // Set the ID, flags, correlation ID, a parameter and the callbacks
+  // of 'request'.
+  void SetRequestState(tc::InferenceRequest* request)
+  {
+    request->SetId("request");
+    request->SetFlags(TRITONSERVER_REQUEST_FLAG_SEQUENCE_START);
+    request->SetCorrelationId(tc::InferenceRequest::SequenceId(7));
+    ASSERT_OK(request->AddParameter("p0", int64_t(0)));
+    ASSERT_OK(request->SetReleaseCallback(ReleaseFn, nullptr));
+    ASSERT_OK(request->SetResponseCallback(
+        &allocator_, nullptr, ResponseFn, nullptr));
+  }
+
+  tc::ResponseAllocator allocator_;
+  std::vector<float> data_ = std::vector<float>(16, 1.0);
+};
+
+TEST_F(InferRequestTest, ResetClearsState)
+{
+  std::shared_ptr<tc::Model> model = CreateModel("reset_model", {16});
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+
+  tc::InferenceRequest::Input* input = nullptr;
+  ASSERT_OK(
+      request->AddOriginalInput("INPUT0", inference::TYPE_FP32, {16}, &input));
+  ASSERT_OK(input->AppendData(
+      data_.data(), data_.size() * sizeof(float), TRITONSERVER_MEMORY_CPU, 0));
+  SetRequestState(request.get());
+  ASSERT_OK(request->PrepareForInference());
+  EXPECT_FALSE(request->ImmutableInputs().empty());
+
+  TRITONSERVER_Error* err = TRITONSERVER_InferenceRequestReset(
+      reinterpret_cast<TRITONSERVER_InferenceRequest*>(request.get()));
+  ASSERT_TRUE(err == nullptr) << TRITONSERVER_ErrorMessage(err);
+
+  EXPECT_TRUE(request->Id().empty());
+  EXPECT_EQ(request->Flags(), 0u);
+  EXPECT_EQ(request->CorrelationId(), tc::InferenceRequest::SequenceId(0));
+  EXPECT_TRUE(request->Parameters().empty());
+  EXPECT_FALSE(request->HasReleaseCallback());
+  EXPECT_TRUE(request->ResponseFactory() == nullptr);
+  EXPECT_TRUE(request->ImmutableInputs().empty());
+
+  // The original input is kept, without its data.
+  ASSERT_EQ(request->OriginalInputs().size(), 1u);
+  EXPECT_EQ(input->DataBufferCount(), 0u);
+  EXPECT_EQ(input->Data()->TotalByteSize(), 0u);
+}
+
+TEST_F(InferRequestTest, ResetRequiresCallbacks)
+{
+  // A reset request must get its callbacks again before it is sent,
+  // which is checked before the server is used.
+  std::shared_ptr<tc::Model> model = CreateModel("reset_model", {16});
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+  tc::InferenceRequest::Input* input = nullptr;
+  ASSERT_OK(
+      request->AddOriginalInput("INPUT0", inference::TYPE_FP32, {16}, &input));
+  SetRequestState(request.get());
+  ASSERT_OK(request->Reset());
+  ASSERT_OK(input->AppendData(
+      data_.data(), data_.size() * sizeof(float), TRITONSERVER_MEMORY_CPU, 0));
+
+  TRITONSERVER_Error* err = TRITONSERVER_ServerInferAsync(
+      nullptr /* server */,
+      reinterpret_cast<TRITONSERVER_InferenceRequest*>(request.get()),
+      nullptr /* trace */);
+  ASSERT_TRUE(err != nullptr);
+  EXPECT_EQ(TRITONSERVER_ErrorCode(err), TRITONSERVER_ERROR_INVALID_ARG);
+  EXPECT_NE(
+      std::string(TRITONSERVER_ErrorMessage(err))
+          .find("callbacks must be set before inference"),
+      std::string::npos)
+      << TRITONSERVER_ErrorMessage(err);
+  TRITONSERVER_ErrorDelete(err);
+}
+
+TEST_F(InferRequestTest, ReuseKeepsNormalization)
+{
+  // Every normalization of the request looks up, and on a miss fills,
+  // the normalize cache of the model, so an emptied cache that stays
+  // empty shows that the request was not normalized again.
+  std::shared_ptr<tc::Model> model = CreateModel("reuse_model", {16});
+  tc::NormalizeCache* cache = model->MutableNormalizeCache();
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+  tc::InferenceRequest::Input* input = nullptr;
+  ASSERT_OK(
+      request->AddOriginalInput("INPUT0", inference::TYPE_FP32, {16}, &input));
+  ASSERT_OK(input->AppendData(
+      data_.data(), data_.size() * sizeof(float), TRITONSERVER_MEMORY_CPU, 0));
+  ASSERT_OK(request->PrepareForInference());
+  EXPECT_EQ(cache->Size(), 1u);
+
+  // Only the data of the non-raw input is added again.
+  cache->Clear();
+  for (size_t iter = 0; iter < 3; ++iter) {
+    ASSERT_OK(request->Reset());
+    ASSERT_OK(input->AppendData(
+        data_.data(), data_.size() * sizeof(float), TRITONSERVER_MEMORY_CPU,
+        0));
+    ASSERT_OK(request->PrepareForInference());
+    EXPECT_EQ(cache->Size(), 0u) << "iteration " << iter;
+    EXPECT_EQ(input->ShapeWithBatchDim(), std::vector<int64_t>{16});
+    EXPECT_EQ(request->ImmutableInputs().size(), 1u);
+  }
+
+  // Replacing the input does require normalization.
+  ASSERT_OK(request->Reset());
+  ASSERT_OK(request->RemoveAllOriginalInputs());
+  ASSERT_OK(
+      request->AddOriginalInput("INPUT0", inference::TYPE_FP32, {16}, &input));
+  ASSERT_OK(input->AppendData(
+      data_.data(), data_.size() * sizeof(float), TRITONSERVER_MEMORY_CPU, 0));
+  ASSERT_OK(request->PrepareForInference());
+  EXPECT_EQ(cache->Size(), 1u);
+}
+
+TEST_F(InferRequestTest, ResetRenormalizesRawInput)
+{
+  // The shape of a raw input is deduced from its data on each use.
+  std::shared_ptr<tc::Model> model = CreateModel("raw_model", {-1});
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+  tc::InferenceRequest::Input* input = nullptr;
+  ASSERT_OK(request->AddRawInput("INPUT0", &input));
+  ASSERT_OK(input->AppendData(
+      data_.data(), 4 * sizeof(float), TRITONSERVER_MEMORY_CPU, 0));
+  ASSERT_OK(request->PrepareForInference());
+  EXPECT_EQ(input->Shape(), std::vector<int64_t>{4});
+
+  ASSERT_OK(request->Reset());
+  ASSERT_OK(input->AppendData(
+      data_.data(), 8 * sizeof(float), TRITONSERVER_MEMORY_CPU, 0));
+  ASSERT_OK(request->PrepareForInference());
+  EXPECT_EQ(input->Shape(), std::vector<int64_t>{8});
+}
+
+// Scheduler recording the requests of each call and completing them
+// right away.
+class RecordingScheduler : public tc::Scheduler {
+ public:
+  tc::Status Enqueue(std::unique_ptr<tc::InferenceRequest>& request) override
+  {
+    batch_sizes_.push_back(1);
+    tc::InferenceRequest::Release(
+        std::move(request), TRITONSERVER_REQUEST_RELEASE_ALL);
+    return tc::Status::Success;
+  }
+
+  void EnqueueBatch(
+      std::vector<std::unique_ptr<tc::InferenceRequest>>& requests) override
+  {
+    batch_sizes_.push_back(requests.size());
+    for (auto& request : requests) {
+      tc::InferenceRequest::Release(
+          std::move(request), TRITONSERVER_REQUEST_RELEASE_ALL);
+    }
+  }
+
+  size_t InflightInferenceCount() override { return 0; }
+  void Stop() override {}
+
+  // The number of requests received by each call, in order.
+  std::vector<size_t> batch_sizes_;
+};
+
+// Model using a RecordingScheduler, which is not owned by any server
+// and so is given to the server only through the requests.
+class RecordingModel : public tc::Model {
+ public:
+  RecordingModel(const inference::ModelConfig& config)
+      : tc::Model(0.0, "", 1, config)
+  {
+    EXPECT_TRUE(Init(true).IsOk());
+    scheduler_raw_ = new RecordingScheduler();
+    EXPECT_TRUE(
+        SetScheduler(std::unique_ptr<tc::Scheduler>(scheduler_raw_)).IsOk());
+  }
+
+  const std::vector<size_t>& BatchSizes() const
+  {
+    return scheduler_raw_->batch_sizes_;
+  }
+
+ private:
+  RecordingScheduler* scheduler_raw_;
+};
+
+// What happened to a request sent in a batch.
+struct RequestOutcome {
+  size_t release_count_ = 0;
+  size_t error_response_count_ = 0;
+};
+
+void
+BatchReleaseFn(
+    TRITONSERVER_InferenceRequest* request, const uint32_t flags, void* userp)
+{
+  reinterpret_cast<RequestOutcome*>(userp)->release_count_++;
+  delete reinterpret_cast<tc::InferenceRequest*>(request);
+}
+
+void
+BatchResponseFn(
+    TRITONSERVER_InferenceResponse* response, const uint32_t flags, void* userp)
+{
+  TRITONSERVER_Error* err = TRITONSERVER_InferenceResponseError(response);
+  if (err != nullptr) {
+    reinterpret_cast<RequestOutcome*>(userp)->error_response_count_++;
+    TRITONSERVER_ErrorDelete(err);
+  }
+  TRITONSERVER_InferenceResponseDelete(response);
+}
+
+class InferBatchTest : public InferRequestTest {
+ protected:
+  void TearDown() override
+  {
+    if (server_ != nullptr) {
+      TRITONSERVER_Error* err = TRITONSERVER_ServerDelete(server_);
+      EXPECT_TRUE(err == nullptr) << TRITONSERVER_ErrorMessage(err);
+    }
+    if (!dir_.empty()) {
+      rmdir(dir_.c_str());
+    }
+  }
+
+  // Create a server, serving an empty model repository if 'ready' and
+  // failing to initialize, so never becoming ready, otherwise.
+  void CreateServer(const bool ready)
+  {
+    TRITONSERVER_ServerOptions* options = nullptr;
+    ASSERT_TRUE(TRITONSERVER_ServerOptionsNew(&options) == nullptr);
+    ASSERT_TRUE(
+        TRITONSERVER_ServerOptionsSetExitOnError(options, false) == nullptr);
+    if (ready) {
+      char dir_template[] = "/tmp/infer_request_testXXXXXX";
+      ASSERT_NE(mkdtemp(dir_template), nullptr);
+      dir_ = dir_template;
+      ASSERT_TRUE(
+          TRITONSERVER_ServerOptionsSetModelRepositoryPath(
+              options, dir_.c_str()) == nullptr);
+      ASSERT_TRUE(
+          TRITONSERVER_ServerOptionsSetModelControlMode(
+              options, TRITONSERVER_MODEL_CONTROL_EXPLICIT) == nullptr);
+    }
+    TRITONSERVER_Error* err = TRITONSERVER_ServerNew(&server_, options);
+    TRITONSERVER_ServerOptionsDelete(options);
+    ASSERT_TRUE(err == nullptr) << TRITONSERVER_ErrorMessage(err);
+    bool server_ready = !ready;
+    ASSERT_TRUE(TRITONSERVER_ServerIsReady(server_, &server_ready) == nullptr);
+    ASSERT_EQ(server_ready, ready);
+  }
+
+  static std::unique_ptr<RecordingModel> CreateRecordingModel(
+      const std::string& name)
+  {
+    inference::ModelConfig config;
+    config.set_name(name);
+    auto input = config.add_input();
+    input->set_name("INPUT0");
+    input->set_data_type(inference::TYPE_FP32);
+    input->add_dims(16);
+    auto output = config.add_output();
+    output->set_name("OUTPUT0");
+    output->set_data_type(inference::TYPE_FP32);
+    output->add_dims(16);
+    return std::unique_ptr<RecordingModel>(new RecordingModel(config));
+  }
+
+  // Add a request for 'model' to the batch. A request that is not
+  // 'valid' has an input shape the model does not accept.
+  void AddRequest(tc::Model* model, const bool valid, RequestOutcome* outcome)
+  {
+    const int64_t element_count = valid ? 16 : 8;
+    std::unique_ptr<tc::InferenceRequest> request(
+        new tc::InferenceRequest(model, 1));
+    tc::InferenceRequest::Input* input = nullptr;
+    ASSERT_OK(request->AddOriginalInput(
+        "INPUT0", inference::TYPE_FP32, {element_count}, &input));
+    ASSERT_OK(input->AppendData(
+        data_.data(), element_count * sizeof(float), TRITONSERVER_MEMORY_CPU,
+        0));
+    ASSERT_OK(request->SetReleaseCallback(BatchReleaseFn, outcome));
+    ASSERT_OK(request->SetResponseCallback(
+        &allocator_, nullptr, BatchResponseFn, outcome));
+    requests_.emplace_back(std::move(request));
+  }
+
+  // Send the batch, on success the server owns the requests.
+  TRITONSERVER_Error* InferBatch()
+  {
+    std::vector<TRITONSERVER_InferenceRequest*> requests;
+    for (auto& request : requests_) {
+      requests.push_back(
+          reinterpret_cast<TRITONSERVER_InferenceRequest*>(request.get()));
+    }
+    TRITONSERVER_Error* err = TRITONSERVER_ServerInferAsyncBatch(
+        server_, requests.data(), nullptr /* traces */, requests.size());
+    if (err == nullptr) {
+      for (auto& request : requests_) {
+        request.release();
+      }
+    }
+    return err;
+  }
+
+  TRITONSERVER_Server* server_ = nullptr;
+  std::string dir_;
+  std::vector<std::unique_ptr<tc::InferenceRequest>> requests_;
+};
+
+TEST_F(InferBatchTest, MixedModels)
+{
+  // Consecutive requests for the same model are enqueued together.
+  CreateServer(true /* ready */);
+  auto first = CreateRecordingModel("first");
+  auto second = CreateRecordingModel("second");
+  std::vector<RequestOutcome> outcomes(5);
+  AddRequest(first.get(), true, &outcomes[0]);
+  AddRequest(first.get(), true, &outcomes[1]);
+  AddRequest(second.get(), true, &outcomes[2]);
+  AddRequest(first.get(), true, &outcomes[3]);
+  AddRequest(second.get(), true, &outcomes[4]);
+
+  TRITONSERVER_Error* err = InferBatch();
+  ASSERT_TRUE(err == nullptr) << TRITONSERVER_ErrorMessage(err);
+  EXPECT_EQ(first->BatchSizes(), (std::vector<size_t>{2, 1}));
+  EXPECT_EQ(second->BatchSizes(), (std::vector<size_t>{1, 1}));
+  for (const auto& outcome : outcomes) {
+    EXPECT_EQ(outcome.release_count_, 1u);
+    EXPECT_EQ(outcome.error_response_count_, 0u);
+  }
+}
+
+TEST_F(InferBatchTest, PrepareFailure)
+{
+  // A request that fails to prepare is completed with an error
+  // through its own callbacks, the others are run.
+  CreateServer(true /* ready */);
+  auto model = CreateRecordingModel("model");
+  std::vector<RequestOutcome> outcomes(3);
+  AddRequest(model.get(), true, &outcomes[0]);
+  AddRequest(model.get(), false, &outcomes[1]);
+  AddRequest(model.get(), true, &outcomes[2]);
+
+  TRITONSERVER_Error* err = InferBatch();
+  ASSERT_TRUE(err == nullptr) << TRITONSERVER_ErrorMessage(err);
+  EXPECT_EQ(model->BatchSizes(), (std::vector<size_t>{2}));
+  EXPECT_EQ(outcomes[0].error_response_count_, 0u);
+  EXPECT_EQ(outcomes[1].error_response_count_, 1u);
+  EXPECT_EQ(outcomes[2].error_response_count_, 0u);
+  for (const auto& outcome : outcomes) {
+    EXPECT_EQ(outcome.release_count_, 1u);
+  }
+}
+
+TEST_F(InferBatchTest, ServerNotReady)
+{
+  // The caller keeps the ownership of all requests, including those
+  // failing to prepare, which are not completed either.
+  CreateServer(false /* ready */);
+  auto model = CreateRecordingModel("model");
+  std::vector<RequestOutcome> outcomes(2);
+  AddRequest(model.get(), true, &outcomes[0]);
+  AddRequest(model.get(), false, &outcomes[1]);
+
+  TRITONSERVER_Error* err = InferBatch();
+  ASSERT_TRUE(err != nullptr);
+  EXPECT_EQ(TRITONSERVER_ErrorCode(err), TRITONSERVER_ERROR_UNAVAILABLE);
+  EXPECT_STREQ(TRITONSERVER_ErrorMessage(err), "Server not ready");
+  TRITONSERVER_ErrorDelete(err);
+  EXPECT_TRUE(model->BatchSizes().empty());
+  for (const auto& outcome : outcomes) {
+    EXPECT_EQ(outcome.release_count_, 0u);
+    EXPECT_EQ(outcome.error_response_count_, 0u);
+  }
+  ASSERT_EQ(requests_.size(), 2u);
+  for (const auto& request : requests_) {
+    EXPECT_TRUE(request != nullptr);
+  }
+}
+
+// Serialize 'elements' as BYTES tensor data, each element preceded by
+// its 4-byte length.
+std::string
+SerializeBytes(const std::vector<std::string>& elements)
+{
+  std::string data;
+  for (const auto& element : elements) {
+    const uint32_t len = element.size();
+    data.append(reinterpret_cast<const char*>(&len), sizeof(uint32_t));
+    data.append(element);
+  }
+  return data;
+}
+
+class BytesOffsetsTest : public ::testing::Test {
+ protected:
+  BytesOffsetsTest() : input_("INPUT0", inference::TYPE_STRING, {2}) {}
+
+  // Set the data of 'input' to 'data_' split into buffers at the
+  // ascending offsets 'splits'. Each buffer is a separate copy so that
+  // reading past the end of a buffer doesn't read the next one.
+  void SetData(
+      tc::InferenceRequest::Input* input, const std::vector<size_t>& splits,
+      const TRITONSERVER_MemoryType memory_type = TRITONSERVER_MEMORY_CPU)
+  {
+    ASSERT_OK(input->RemoveAllData());
+    std::vector<size_t> ends = splits;
+    ends.push_back(data_.size());
+    size_t start = 0;
+    for (const size_t end : ends) {
+      buffers_.emplace_back(data_.substr(start, end - start));
+      ASSERT_OK(input->AppendData(
+          buffers_.back().data(), buffers_.back().size(), memory_type, 0));
+      start = end;
+    }
+  }
+
+  // Return the offsets of 'input' given to the backend, or no offsets
+  // if they are unavailable.
+  std::vector<uint64_t> BackendOffsets(tc::InferenceRequest::Input* input)
+  {
+    const uint64_t* offsets = nullptr;
+    uint64_t offset_count = 0;
+    TRITONSERVER_Error* err = TRITONBACKEND_InputBytesOffsets(
+        reinterpret_cast<TRITONBACKEND_Input*>(input), &offsets,
+        &offset_count);
+    if (err != nullptr) {
+      EXPECT_EQ(TRITONSERVER_ErrorCode(err), TRITONSERVER_ERROR_UNAVAILABLE);
+      TRITONSERVER_ErrorDelete(err);
+      EXPECT_TRUE(offsets == nullptr);
+      EXPECT_EQ(offset_count, 0u);
+      return {};
+    }
+    return std::vector<uint64_t>(offsets, offsets + offset_count);
+  }
+
+  // Index the data of 'input_' as 'element_count' elements and expect
+  // it to be rejected with a message containing 'message'.
+  void ExpectMalformed(const int64_t element_count, const std::string& message)
+  {
+    const tc::Status status = input_.IndexBytesData(element_count);
+    EXPECT_EQ(status.StatusCode(), tc::Status::Code::INVALID_ARG);
+    EXPECT_NE(status.Message().find(message), std::string::npos)
+        << status.Message();
+    EXPECT_TRUE(input_.BytesOffsets().empty());
+    EXPECT_TRUE(BackendOffsets(&input_).empty());
+  }
+
+  tc::InferenceRequest::Input input_;
+  std::string data_ = SerializeBytes({"ab", "cde"});
+  const std::vector<uint64_t> expected_ = {0, 6, 13};
+  std::list<std::string> buffers_;
+};
+
+TEST_F(BytesOffsetsTest, SingleBuffer)
+{
+  SetData(&input_, {});
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_EQ(input_.BytesOffsets(), expected_);
+  EXPECT_EQ(BackendOffsets(&input_), expected_);
+}
+
+TEST_F(BytesOffsetsTest, SplitLengthPrefix)
+{
+  // The prefix of the first element split in two, and the prefix of
+  // the second element split over three buffers.
+  SetData(&input_, {1, 7, 8});
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_EQ(BackendOffsets(&input_), expected_);
+
+  // A buffer ending right after a prefix.
+  SetData(&input_, {4, 10});
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_EQ(BackendOffsets(&input_), expected_);
+}
+
+TEST_F(BytesOffsetsTest, SplitElement)
+{
+  // An element body split across buffers, the second one also ending
+  // in the next buffer.
+  SetData(&input_, {5, 11});
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_EQ(BackendOffsets(&input_), expected_);
+
+  // An element split over every byte.
+  SetData(&input_, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_EQ(BackendOffsets(&input_), expected_);
+}
+
+TEST_F(BytesOffsetsTest, TruncatedLastElement)
+{
+  const std::string data = data_;
+  data_ = data.substr(0, data.size() - 1);
+  SetData(&input_, {8});
+  ExpectMalformed(2, "with a truncated last element");
+
+  // Truncated within the length prefix.
+  data_ = data.substr(0, 8);
+  SetData(&input_, {7});
+  ExpectMalformed(2, "found 1 elements");
+}
+
+TEST_F(BytesOffsetsTest, ExtraData)
+{
+  // Trailing bytes that don't make a whole length prefix.
+  data_ += "xy";
+  SetData(&input_, {});
+  ExpectMalformed(2, "is malformed");
+
+  // More elements than the shape holds, and fewer.
+  data_ = SerializeBytes({"ab", "cde", "f"});
+  SetData(&input_, {});
+  ExpectMalformed(2, "more than the expected 2 elements");
+  data_ = SerializeBytes({"ab"});
+  SetData(&input_, {});
+  ExpectMalformed(2, "found 1 elements");
+
+  // A failure drops the offsets of an earlier success.
+  data_ = SerializeBytes({"ab", "cde"});
+  SetData(&input_, {});
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_EQ(BackendOffsets(&input_), expected_);
+  ExpectMalformed(1, "more than the expected 1 elements");
+}
+
+TEST_F(BytesOffsetsTest, EmptyElements)
+{
+  // No elements and no data.
+  tc::InferenceRequest::Input empty("INPUT0", inference::TYPE_STRING, {0});
+  ASSERT_OK(empty.IndexBytesData(0));
+  EXPECT_EQ(BackendOffsets(&empty), std::vector<uint64_t>({0}));
+
+  // Empty strings are just a length prefix.
+  data_ = SerializeBytes({"", "", "x", ""});
+  SetData(&input_, {4, 6});
+  ASSERT_OK(input_.IndexBytesData(4));
+  EXPECT_EQ(BackendOffsets(&input_), std::vector<uint64_t>({0, 4, 8, 13, 17}));
+}
+
+TEST_F(BytesOffsetsTest, SkipGpuData)
+{
+  // The data in GPU memory is not read, nor validated, and the backend
+  // has to parse it.
+  data_ = "not a BYTES tensor";
+  SetData(&input_, {}, TRITONSERVER_MEMORY_GPU);
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_TRUE(input_.BytesOffsets().empty());
+  EXPECT_TRUE(BackendOffsets(&input_).empty());
+
+  // The same if only some of the buffers are in GPU memory.
+  ASSERT_OK(input_.RemoveAllData());
+  const std::string cpu_data = SerializeBytes({"ab"});
+  ASSERT_OK(input_.AppendData(
+      cpu_data.data(), cpu_data.size(), TRITONSERVER_MEMORY_CPU, 0));
+  ASSERT_OK(input_.AppendData(
+      data_.data(), data_.size(), TRITONSERVER_MEMORY_GPU, 0));
+  ASSERT_OK(input_.IndexBytesData(2));
+  EXPECT_TRUE(BackendOffsets(&input_).empty());
+}
+
+TEST_F(BytesOffsetsTest, PrepareForInference)
+{
+  // The BYTES inputs of a request are indexed when it is prepared.
+  std::shared_ptr<tc::Model> model =
+      CreateModel("bytes_model", {2}, inference::TYPE_STRING);
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+  tc::InferenceRequest::Input* input = nullptr;
+  ASSERT_OK(request->AddOriginalInput(
+      "INPUT0", inference::TYPE_STRING, {2}, &input));
+  SetData(input, {7});
+  ASSERT_OK(request->PrepareForInference());
+  EXPECT_EQ(BackendOffsets(input), expected_);
+
+  // And malformed data fails the request.
+  ASSERT_OK(request->Reset());
+  data_.pop_back();
+  SetData(input, {7});
+  const tc::Status status = request->PrepareForInference();
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::INVALID_ARG);
+  EXPECT_NE(
+      status.Message().find("truncated last element"), std::string::npos)
+      << status.Message();
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
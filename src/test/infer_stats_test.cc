@@ -0,0 +1,164 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "infer_stats.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Record 'iterations' successful requests and batch executions from
+// each of 'thread_count' threads.
+void
+RecordConcurrently(
+    tc::InferenceStatsAggregator* aggregator, const size_t thread_count,
+    const size_t iterations)
+{
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([aggregator, iterations, t]() {
+      for (size_t i = 0; i < iterations; ++i) {
+        aggregator->UpdateSuccess(
+            nullptr /* metric_reporter */, 1 /* batch_size */,
+            0 /* request_start_ns */, 0 /* queue_start_ns */,
+            1 /* compute_start_ns */, 3 /* compute_input_end_ns */,
+            6 /* compute_output_start_ns */, 10 /* compute_end_ns */,
+            15 /* request_end_ns */);
+        aggregator->UpdateInferBatchStats(
+            nullptr /* metric_reporter */, 1 + (t % 2) /* batch_size */,
+            1 /* compute_start_ns */, 3 /* compute_input_end_ns */,
+            6 /* compute_output_start_ns */, 10 /* compute_end_ns */);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+uint64_t
+RecordConcurrentlyNs(
+    tc::InferenceStatsAggregator* aggregator, const size_t thread_count,
+    const size_t iterations)
+{
+  const auto start = std::chrono::steady_clock::now();
+  RecordConcurrently(aggregator, thread_count, iterations);
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+TEST(InferStatsTest, MergeMatchesSingleShard)
+{
+  const size_t thread_count = 8;
+  const size_t iterations = 1000;
+  tc::InferenceStatsAggregator single(1);
+  tc::InferenceStatsAggregator sharded(8);
+  RecordConcurrently(&single, thread_count, iterations);
+  RecordConcurrently(&sharded, thread_count, iterations);
+
+  const auto expected = single.MergedSnapshot();
+  const auto actual = sharded.MergedSnapshot();
+  const uint64_t total = thread_count * iterations;
+  EXPECT_EQ(expected.inference_count_, total);
+  EXPECT_EQ(actual.inference_count_, expected.inference_count_);
+  EXPECT_EQ(actual.execution_count_, expected.execution_count_);
+  EXPECT_GE(actual.last_inference_ms_, expected.last_inference_ms_);
+
+  EXPECT_EQ(actual.infer_stats_.success_count_, total);
+  EXPECT_EQ(actual.infer_stats_.request_duration_ns_, 15 * total);
+  EXPECT_EQ(actual.infer_stats_.queue_duration_ns_, 1 * total);
+  EXPECT_EQ(actual.infer_stats_.compute_input_duration_ns_, 2 * total);
+  EXPECT_EQ(actual.infer_stats_.compute_infer_duration_ns_, 3 * total);
+  EXPECT_EQ(actual.infer_stats_.compute_output_duration_ns_, 4 * total);
+
+  ASSERT_EQ(actual.batch_stats_.size(), expected.batch_stats_.size());
+  for (const auto& batch : expected.batch_stats_) {
+    const auto it = actual.batch_stats_.find(batch.first);
+    ASSERT_NE(it, actual.batch_stats_.end());
+    EXPECT_EQ(it->second.count_, batch.second.count_);
+    EXPECT_EQ(
+        it->second.compute_infer_duration_ns_,
+        batch.second.compute_infer_duration_ns_);
+  }
+}
+
+TEST(InferStatsTest, FailureAndCache)
+{
+  tc::InferenceStatsAggregator aggregator(4);
+  aggregator.UpdateFailure(nullptr, 10, 30);
+  aggregator.UpdateSuccessCacheHit(nullptr, 1, 0, 5, 10, 20, 4);
+  aggregator.UpdateSuccessCacheMiss(nullptr, 7);
+
+  const auto stats = aggregator.InferStatsSnapshot();
+  EXPECT_EQ(stats.failure_count_, 1u);
+  EXPECT_EQ(stats.failure_duration_ns_, 20u);
+  EXPECT_EQ(stats.success_count_, 1u);
+  EXPECT_EQ(stats.request_duration_ns_, 27u);
+  EXPECT_EQ(stats.queue_duration_ns_, 5u);
+  EXPECT_EQ(stats.cache_hit_count_, 1u);
+  EXPECT_EQ(stats.cache_hit_duration_ns_, 4u);
+  EXPECT_EQ(stats.cache_miss_count_, 1u);
+  EXPECT_EQ(stats.cache_miss_duration_ns_, 7u);
+  // Cache hits do not count as inferences.
+  EXPECT_EQ(aggregator.InferenceCount(), 0u);
+}
+
+TEST(InferStatsTest, Contention)
+{
+  // Not asserted on since timings depend on the machine, only reported
+  // to compare recording into a single lock against sharded recording.
+  const size_t thread_count =
+      std::max<size_t>(4, std::thread::hardware_concurrency());
+  const size_t iterations = 100000;
+  tc::InferenceStatsAggregator single(1);
+  tc::InferenceStatsAggregator sharded(thread_count);
+  const uint64_t single_ns =
+      RecordConcurrentlyNs(&single, thread_count, iterations);
+  const uint64_t sharded_ns =
+      RecordConcurrentlyNs(&sharded, thread_count, iterations);
+  std::cout << thread_count << " threads x " << iterations
+            << " updates: single shard " << single_ns / 1000000 << " ms, "
+            << sharded.ShardCount() << " shards " << sharded_ns / 1000000
+            << " ms" << std::endl;
+
+  EXPECT_EQ(sharded.InferenceCount(), single.InferenceCount());
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
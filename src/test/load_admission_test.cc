@@ -0,0 +1,181 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "filesystem.h"
+#include "load_admission.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+class LoadAdmissionTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    ASSERT_TRUE(tc::MakeTemporaryDirectory(tc::FileSystemType::LOCAL, &dir_)
+                    .IsOk());
+  }
+  void TearDown() override { tc::DeletePath(dir_); }
+
+  void WriteFile(const std::string& path, const size_t byte_size)
+  {
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    out << std::string(byte_size, 'x');
+  }
+
+  std::string dir_;
+};
+
+TEST_F(LoadAdmissionTest, NoBudget)
+{
+  tc::LoadAdmission admission(0);
+  auto first = admission.Admit("a:1", 1 << 30);
+  auto second = admission.Admit("b:1", 1 << 30);
+  EXPECT_EQ(first->ByteSize(), 1u << 30);
+  admission.Release(std::move(first));
+  admission.Release(std::move(second));
+}
+
+TEST_F(LoadAdmissionTest, LoadsWithinBudgetRunTogether)
+{
+  tc::LoadAdmission admission(100);
+  auto first = admission.Admit("a:1", 40);
+  auto second = admission.Admit("b:1", 60);
+  admission.Release(std::move(first));
+  admission.Release(std::move(second));
+}
+
+TEST_F(LoadAdmissionTest, LoadWaitsForBudget)
+{
+  tc::LoadAdmission admission(100);
+  auto first = admission.Admit("a:1", 60);
+
+  std::mutex mu;
+  std::condition_variable cv;
+  bool started = false, released = false, admitted = false;
+  bool released_before_admitted = false;
+  std::thread waiter([&]() {
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      started = true;
+    }
+    cv.notify_all();
+    auto second = admission.Admit("b:1", 60);
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      released_before_admitted = released;
+      admitted = true;
+    }
+    cv.notify_all();
+    admission.Release(std::move(second));
+  });
+
+  {
+    std::unique_lock<std::mutex> lk(mu);
+    ASSERT_TRUE(cv.wait_for(
+        lk, std::chrono::seconds(5), [&started] { return started; }));
+    EXPECT_FALSE(cv.wait_for(
+        lk, std::chrono::milliseconds(100), [&admitted] { return admitted; }));
+    released = true;
+  }
+  admission.Release(std::move(first));
+  {
+    std::unique_lock<std::mutex> lk(mu);
+    EXPECT_TRUE(cv.wait_for(
+        lk, std::chrono::seconds(5), [&admitted] { return admitted; }));
+  }
+  waiter.join();
+  EXPECT_TRUE(released_before_admitted);
+}
+
+TEST_F(LoadAdmissionTest, OversizeLoadRunsAlone)
+{
+  tc::LoadAdmission admission(100);
+  auto ticket = admission.Admit("a:1", 1000);
+  EXPECT_EQ(ticket->Key(), "a:1");
+  admission.Release(std::move(ticket));
+}
+
+TEST_F(LoadAdmissionTest, LearnedByteSize)
+{
+  tc::LoadAdmission admission(0);
+  EXPECT_EQ(admission.LearnedByteSize("a:1"), 0u);
+
+  // A load that runs alone learns the growth of resident memory.
+  const size_t footprint = 64 << 20;
+  auto ticket = admission.Admit("a:1", 0);
+  std::unique_ptr<char[]> weights(new char[footprint]);
+  memset(weights.get(), 1, footprint);
+  admission.Release(std::move(ticket));
+  EXPECT_GE(admission.LearnedByteSize("a:1"), footprint / 2);
+  EXPECT_EQ(admission.LearnedByteSize("a:2"), 0u);
+
+  // Loads that overlap learn nothing.
+  auto first = admission.Admit("b:1", 0);
+  auto second = admission.Admit("c:1", 0);
+  std::unique_ptr<char[]> more_weights(new char[footprint]);
+  memset(more_weights.get(), 1, footprint);
+  admission.Release(std::move(first));
+  admission.Release(std::move(second));
+  EXPECT_EQ(admission.LearnedByteSize("b:1"), 0u);
+  EXPECT_EQ(admission.LearnedByteSize("c:1"), 0u);
+  EXPECT_EQ(weights[footprint - 1] + more_weights[footprint - 1], 2);
+}
+
+TEST_F(LoadAdmissionTest, LocalDirectoryByteSize)
+{
+  const std::string version_dir = tc::JoinPath({dir_, "1"});
+  ASSERT_TRUE(
+      tc::MakeDirectory(tc::JoinPath({version_dir, "sub"}), true).IsOk());
+  WriteFile(tc::JoinPath({version_dir, "model.bin"}), 1000);
+  WriteFile(tc::JoinPath({version_dir, "sub", "weights.bin"}), 24);
+
+  uint64_t byte_size = 0;
+  ASSERT_TRUE(tc::LocalDirectoryByteSize(version_dir, &byte_size).IsOk());
+  EXPECT_EQ(byte_size, 1024u);
+
+  EXPECT_FALSE(
+      tc::LocalDirectoryByteSize(tc::JoinPath({dir_, "missing"}), &byte_size)
+          .IsOk());
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,239 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include "filesystem.h"
+#include "localize_cache.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Populate function that writes a file of 'byte_size' bytes and counts
+// its invocations.
+tc::LocalizeCache::PopulateFn
+Populate(const size_t byte_size, int* count, const bool fail = false)
+{
+  return [byte_size, count, fail](const std::string& local_dir) {
+    ++(*count);
+    if (fail) {
+      return tc::Status(tc::Status::Code::INTERNAL, "download failed");
+    }
+    tc::Status status = tc::MakeDirectory(
+        tc::JoinPath({local_dir, "1"}), false /* recursive */);
+    if (!status.IsOk()) {
+      return status;
+    }
+    const std::string content(byte_size, 'x');
+    return tc::WriteBinaryFile(
+        tc::JoinPath({local_dir, "1", "model.bin"}), content.data(),
+        content.size());
+  };
+}
+
+class LocalizeCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    ASSERT_TRUE(
+        tc::MakeTemporaryDirectory(tc::FileSystemType::LOCAL, &root_).IsOk());
+  }
+  void TearDown() override { tc::DeletePath(root_); }
+
+  std::unique_ptr<tc::LocalizeCache> Create(const uint64_t max_byte_size = 0)
+  {
+    std::unique_ptr<tc::LocalizeCache> cache;
+    auto status = tc::LocalizeCache::Create(root_, max_byte_size, &cache);
+    EXPECT_TRUE(status.IsOk()) << status.Message();
+    return cache;
+  }
+
+  std::shared_ptr<const std::string> Get(
+      tc::LocalizeCache* cache, const std::string& path,
+      const std::string& fingerprint, const size_t byte_size, int* count)
+  {
+    std::shared_ptr<const std::string> local_path;
+    auto status = cache->Get(
+        path, fingerprint, Populate(byte_size, count), &local_path);
+    EXPECT_TRUE(status.IsOk()) << status.Message();
+    return local_path;
+  }
+
+  std::set<std::string> RootContents()
+  {
+    std::set<std::string> contents;
+    EXPECT_TRUE(tc::GetDirectoryContents(root_, &contents).IsOk());
+    return contents;
+  }
+
+  std::string root_;
+};
+
+TEST_F(LocalizeCacheTest, ReuseUnchangedContent)
+{
+  auto cache = Create();
+  int count = 0;
+  auto local_path = Get(cache.get(), "s3://bucket/model", "a", 100, &count);
+  ASSERT_NE(local_path, nullptr);
+  EXPECT_EQ(count, 1);
+
+  std::string content;
+  ASSERT_TRUE(
+      tc::ReadTextFile(tc::JoinPath({*local_path, "1", "model.bin"}), &content)
+          .IsOk());
+  EXPECT_EQ(content, std::string(100, 'x'));
+
+  // Held and released entries are both reused
+  auto same_path = Get(cache.get(), "s3://bucket/model", "a", 100, &count);
+  EXPECT_EQ(same_path, local_path);
+  local_path.reset();
+  same_path = Get(cache.get(), "s3://bucket/model", "a", 100, &count);
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(cache->EntryCount(), 1u);
+  EXPECT_EQ(cache->ByteSize(), 100u);
+}
+
+TEST_F(LocalizeCacheTest, ChangedContentReplacesEntry)
+{
+  auto cache = Create();
+  int count = 0;
+  auto old_path = Get(cache.get(), "s3://bucket/model", "a", 100, &count);
+
+  // The old content is kept while in use
+  auto new_path = Get(cache.get(), "s3://bucket/model", "b", 200, &count);
+  EXPECT_EQ(count, 2);
+  EXPECT_NE(*old_path, *new_path);
+  EXPECT_EQ(cache->EntryCount(), 2u);
+  bool exists = false;
+  ASSERT_TRUE(tc::FileExists(*old_path, &exists).IsOk());
+  EXPECT_TRUE(exists);
+
+  // and removed when the path is localized again after the release
+  old_path.reset();
+  new_path.reset();
+  new_path = Get(cache.get(), "s3://bucket/model", "c", 300, &count);
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(cache->EntryCount(), 1u);
+  EXPECT_EQ(cache->ByteSize(), 300u);
+}
+
+TEST_F(LocalizeCacheTest, PersistAcrossInstances)
+{
+  int count = 0;
+  std::string first_path;
+  {
+    auto cache = Create();
+    first_path = *Get(cache.get(), "gs://bucket/model", "a", 100, &count);
+  }
+
+  auto cache = Create();
+  EXPECT_EQ(cache->EntryCount(), 1u);
+  EXPECT_EQ(cache->ByteSize(), 100u);
+  auto local_path = Get(cache.get(), "gs://bucket/model", "a", 100, &count);
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(*local_path, first_path);
+}
+
+TEST_F(LocalizeCacheTest, EvictLeastRecentlyUsed)
+{
+  auto cache = Create(2500);
+  int count = 0;
+  Get(cache.get(), "s3://bucket/a", "a", 1000, &count);
+  Get(cache.get(), "s3://bucket/b", "b", 1000, &count);
+  // 'a' becomes more recently used than 'b'
+  Get(cache.get(), "s3://bucket/a", "a", 1000, &count);
+  Get(cache.get(), "s3://bucket/c", "c", 1000, &count);
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(cache->EntryCount(), 2u);
+  EXPECT_EQ(cache->ByteSize(), 2000u);
+
+  Get(cache.get(), "s3://bucket/a", "a", 1000, &count);
+  EXPECT_EQ(count, 3);
+  Get(cache.get(), "s3://bucket/b", "b", 1000, &count);
+  EXPECT_EQ(count, 4);
+}
+
+TEST_F(LocalizeCacheTest, KeepEntriesInUse)
+{
+  auto cache = Create(1500);
+  int count = 0;
+  auto a = Get(cache.get(), "s3://bucket/a", "a", 1000, &count);
+  auto b = Get(cache.get(), "s3://bucket/b", "b", 1000, &count);
+  EXPECT_EQ(cache->EntryCount(), 2u);
+
+  // Released entries are evicted on the next insertion
+  a.reset();
+  b.reset();
+  Get(cache.get(), "s3://bucket/c", "c", 1000, &count);
+  EXPECT_EQ(cache->EntryCount(), 1u);
+  EXPECT_EQ(cache->ByteSize(), 1000u);
+}
+
+TEST_F(LocalizeCacheTest, FailedPopulateLeavesNoEntry)
+{
+  auto cache = Create();
+  int count = 0;
+  std::shared_ptr<const std::string> local_path;
+  auto status = cache->Get(
+      "s3://bucket/model", "a", Populate(100, &count, true /* fail */),
+      &local_path);
+  EXPECT_FALSE(status.IsOk());
+  EXPECT_EQ(local_path, nullptr);
+  EXPECT_EQ(cache->EntryCount(), 0u);
+  EXPECT_TRUE(RootContents().empty());
+}
+
+TEST_F(LocalizeCacheTest, RemoveIncompleteEntries)
+{
+  int count = 0;
+  {
+    auto cache = Create();
+    Get(cache.get(), "s3://bucket/model", "a", 100, &count);
+  }
+  // Leftover of a terminated process and a directory without metadata
+  ASSERT_TRUE(tc::MakeDirectory(
+                  tc::JoinPath({root_, ".staging-0-1-0", "content"}),
+                  true /* recursive */)
+                  .IsOk());
+  ASSERT_TRUE(tc::MakeDirectory(tc::JoinPath({root_, "other"}), false).IsOk());
+  EXPECT_EQ(RootContents().size(), 3u);
+
+  auto cache = Create();
+  EXPECT_EQ(cache->EntryCount(), 1u);
+  EXPECT_EQ(RootContents().size(), 1u);
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,395 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "filesystem.h"
+#include "infer_request.h"
+#include "infer_response.h"
+#include "metadata_arena.h"
+#include "model.h"
+#include "model_config_utils.h"
+#include "response_allocator.h"
+
+namespace tc = triton::core;
+
+/* Mock functions for Unit Testing */
+namespace triton { namespace core {
+
+// The model configurations are constructed by the test, skip the
+// validation and label loading done by Model::Init.
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+std::string
+JoinPath(std::initializer_list<std::string> segments)
+{
+  std::string path;
+  for (const auto& segment : segments) {
+    path += (path.empty() ? "" : "/") + segment;
+  }
+  return path;
+}
+
+Status
+ReadTextFile(const std::string& path, std::string* contents)
+{
+  return Status(Status::Code::NOT_FOUND, "no file '" + path + "'");
+}
+
+}}  // namespace triton::core
+
+// Count every heap allocation made by the test process.
+static std::atomic<size_t> heap_allocation_count(0);
+
+void*
+operator new(size_t byte_size)
+{
+  heap_allocation_count++;
+  void* ptr = malloc(byte_size == 0 ? 1 : byte_size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  free(ptr);
+}
+
+namespace {
+
+// Per-input metadata as held by InferenceRequest, names are kept short
+// enough to avoid string allocations.
+struct Input {
+  Input(int64_t batch_size) : shape_{batch_size, 16} {}
+  std::vector<int64_t> shape_;
+};
+
+template <typename T>
+using ArenaMap = std::unordered_map<
+    std::string, T, std::hash<std::string>, std::equal_to<std::string>,
+    tc::MetadataArenaAllocator<std::pair<const std::string, T>>>;
+using ArenaSet = std::set<
+    std::string, std::less<std::string>,
+    tc::MetadataArenaAllocator<std::string>>;
+using ArenaDeque = std::deque<int64_t, tc::MetadataArenaAllocator<int64_t>>;
+
+// Populate the metadata of a request with 'input_count' inputs, 2
+// requested outputs and 2 parameters.
+template <typename InputMap, typename OutputSet, typename ParameterDeque>
+void
+PopulateMetadata(
+    size_t input_count, InputMap* inputs, InputMap* override_inputs,
+    OutputSet* outputs, ParameterDeque* parameters)
+{
+  for (size_t i = 0; i < input_count; ++i) {
+    inputs->emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple("INPUT" + std::to_string(i)),
+        std::forward_as_tuple(1));
+  }
+  override_inputs->emplace(
+      std::piecewise_construct, std::forward_as_tuple("STATE"),
+      std::forward_as_tuple(1));
+  outputs->insert("OUTPUT0");
+  outputs->insert("OUTPUT1");
+  parameters->push_back(0);
+  parameters->push_back(1);
+}
+
+// Return true if 'ptr' points into the storage of 'object', which is
+// where the inline part of an object's metadata arena lives.
+template <typename T>
+bool
+IsInside(const void* ptr, const T& object)
+{
+  const char* begin = reinterpret_cast<const char*>(std::addressof(object));
+  const char* p = static_cast<const char*>(ptr);
+  return (p >= begin) && (p < begin + sizeof(T));
+}
+
+std::shared_ptr<tc::Model>
+ArenaModel()
+{
+  inference::ModelConfig config;
+  config.set_name("arena_model");
+  for (const auto& name : {"INPUT0", "INPUT1"}) {
+    auto input = config.add_input();
+    input->set_name(name);
+    input->set_data_type(inference::TYPE_FP32);
+    input->add_dims(16);
+  }
+  for (const auto& name : {"OUTPUT0", "OUTPUT1"}) {
+    auto output = config.add_output();
+    output->set_name(name);
+    output->set_data_type(inference::TYPE_FP32);
+    output->add_dims(16);
+  }
+  std::shared_ptr<tc::Model> model =
+      std::make_shared<tc::Model>(0.0, "", 1, config);
+  EXPECT_TRUE(model->Init(true).IsOk());
+  return model;
+}
+
+// Populate a real request with 2 inputs, 2 requested outputs and 2
+// parameters.
+void
+PopulateRequest(
+    tc::InferenceRequest* request, tc::InferenceRequest::Input** input)
+{
+  const std::vector<int64_t> shape{16};
+  ASSERT_TRUE(
+      request->AddOriginalInput("INPUT0", inference::TYPE_FP32, shape, input)
+          .IsOk());
+  ASSERT_TRUE(
+      request->AddOriginalInput("INPUT1", inference::TYPE_FP32, shape).IsOk());
+  ASSERT_TRUE(request->AddOriginalRequestedOutput("OUTPUT0").IsOk());
+  ASSERT_TRUE(request->AddOriginalRequestedOutput("OUTPUT1").IsOk());
+  ASSERT_TRUE(request->AddParameter("p0", int64_t(0)).IsOk());
+  ASSERT_TRUE(request->AddParameter("p1", true).IsOk());
+}
+
+TRITONSERVER_Error*
+ResponseAlloc(
+    TRITONSERVER_ResponseAllocator* allocator, const char* tensor_name,
+    size_t byte_size, TRITONSERVER_MemoryType preferred_memory_type,
+    int64_t preferred_memory_type_id, void* userp, void** buffer,
+    void** buffer_userp, TRITONSERVER_MemoryType* actual_memory_type,
+    int64_t* actual_memory_type_id)
+{
+  *buffer = nullptr;
+  return nullptr;
+}
+
+TRITONSERVER_Error*
+ResponseRelease(
+    TRITONSERVER_ResponseAllocator* allocator, void* buffer, void* buffer_userp,
+    size_t byte_size, TRITONSERVER_MemoryType memory_type,
+    int64_t memory_type_id)
+{
+  return nullptr;
+}
+
+class MetadataArenaTest : public ::testing::Test {
+};
+
+TEST_F(MetadataArenaTest, AllocateAligned)
+{
+  tc::MetadataArena arena;
+  std::vector<void*> ptrs;
+  for (size_t byte_size = 1; byte_size < 2048; byte_size += 37) {
+    void* ptr = arena.Allocate(byte_size);
+    ASSERT_TRUE(ptr != nullptr);
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), 0u);
+    memset(ptr, 0xff, byte_size);
+    ptrs.push_back(ptr);
+  }
+  size_t byte_size = 1;
+  for (auto ptr : ptrs) {
+    arena.Deallocate(ptr, byte_size);
+    byte_size += 37;
+  }
+}
+
+TEST_F(MetadataArenaTest, RecycleOnReuse)
+{
+  // Repeatedly clearing and refilling containers, as when a request
+  // object is reused, must not grow the arena.
+  tc::MetadataArena arena;
+  ArenaMap<Input> inputs{tc::MetadataArenaAllocator<char>(&arena)};
+  ArenaMap<Input> override_inputs{tc::MetadataArenaAllocator<char>(&arena)};
+  ArenaSet outputs{tc::MetadataArenaAllocator<char>(&arena)};
+  ArenaDeque parameters{tc::MetadataArenaAllocator<char>(&arena)};
+
+  PopulateMetadata(4, &inputs, &override_inputs, &outputs, &parameters);
+  const size_t arena_heap_allocation_count = arena.HeapAllocationCount();
+  for (size_t iter = 0; iter < 1000; ++iter) {
+    inputs.clear();
+    override_inputs.clear();
+    outputs.clear();
+    parameters.clear();
+    PopulateMetadata(4, &inputs, &override_inputs, &outputs, &parameters);
+  }
+  EXPECT_EQ(arena.HeapAllocationCount(), arena_heap_allocation_count);
+}
+
+TEST_F(MetadataArenaTest, AllocationCount)
+{
+  // Compare the number of heap allocations needed to hold the
+  // metadata of a small request with and without the arena. Shape
+  // vectors are not placed on the arena and are counted in both cases.
+  const size_t input_count = 4;
+  size_t std_allocation_count = 0;
+  {
+    const size_t start = heap_allocation_count;
+    std::unordered_map<std::string, Input> inputs;
+    std::unordered_map<std::string, Input> override_inputs;
+    std::set<std::string> outputs;
+    std::deque<int64_t> parameters;
+    PopulateMetadata(
+        input_count, &inputs, &override_inputs, &outputs, &parameters);
+    std_allocation_count = heap_allocation_count - start;
+  }
+
+  size_t arena_allocation_count = 0;
+  {
+    const size_t start = heap_allocation_count;
+    std::unique_ptr<tc::MetadataArena> arena(new tc::MetadataArena());
+    ArenaMap<Input> inputs{tc::MetadataArenaAllocator<char>(arena.get())};
+    ArenaMap<Input> override_inputs{
+        tc::MetadataArenaAllocator<char>(arena.get())};
+    ArenaSet outputs{tc::MetadataArenaAllocator<char>(arena.get())};
+    ArenaDeque parameters{tc::MetadataArenaAllocator<char>(arena.get())};
+    PopulateMetadata(
+        input_count, &inputs, &override_inputs, &outputs, &parameters);
+    arena_allocation_count = heap_allocation_count - start;
+  }
+
+  std::cout << "heap allocations for request metadata: std::allocator "
+            << std_allocation_count << ", metadata arena "
+            << arena_allocation_count << std::endl;
+  // Only the arena itself and the shape vectors are on the heap.
+  EXPECT_EQ(arena_allocation_count, 1 + input_count + 1);
+  EXPECT_LT(arena_allocation_count, std_allocation_count);
+}
+
+TEST_F(MetadataArenaTest, RequestMetadata)
+{
+  // The metadata containers of a real request are placed on the
+  // arena, whose first allocations are inline with the request.
+  std::shared_ptr<tc::Model> model = ArenaModel();
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+
+  tc::InferenceRequest::Input* input = nullptr;
+  PopulateRequest(request.get(), &input);
+  ASSERT_TRUE(input != nullptr);
+  EXPECT_TRUE(IsInside(input, *request));
+  EXPECT_TRUE(IsInside(
+      std::addressof(*request->OriginalRequestedOutputs().begin()),
+      *request));
+  EXPECT_TRUE(IsInside(std::addressof(request->Parameters()[0]), *request));
+
+  // Preparing for inference fills the actual inputs and requested
+  // outputs, on the same arena.
+  ASSERT_TRUE(request->PrepareForInference().IsOk());
+  EXPECT_TRUE(IsInside(
+      std::addressof(*request->ImmutableInputs().begin()), *request));
+  EXPECT_TRUE(IsInside(
+      std::addressof(*request->ImmutableRequestedOutputs().begin()),
+      *request));
+}
+
+TEST_F(MetadataArenaTest, RequestReuse)
+{
+  // Repopulating a reused request recycles the arena, the metadata
+  // stays inline and no additional heap allocation is needed per use.
+  std::shared_ptr<tc::Model> model = ArenaModel();
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+
+  tc::InferenceRequest::Input* input = nullptr;
+  PopulateRequest(request.get(), &input);
+  size_t first_allocation_count = 0;
+  for (size_t iter = 0; iter < 100; ++iter) {
+    const size_t start = heap_allocation_count;
+    ASSERT_TRUE(request->Reset().IsOk());
+    ASSERT_TRUE(request->RemoveAllOriginalInputs().IsOk());
+    ASSERT_TRUE(request->RemoveAllOriginalRequestedOutputs().IsOk());
+    PopulateRequest(request.get(), &input);
+    const size_t allocation_count = heap_allocation_count - start;
+    if (iter == 0) {
+      first_allocation_count = allocation_count;
+    }
+    EXPECT_EQ(allocation_count, first_allocation_count) << "iteration " << iter;
+    EXPECT_TRUE(IsInside(input, *request));
+  }
+}
+
+TEST_F(MetadataArenaTest, ResponseMetadata)
+{
+  std::shared_ptr<tc::Model> model = ArenaModel();
+  tc::ResponseAllocator allocator(ResponseAlloc, ResponseRelease, nullptr);
+  std::unique_ptr<tc::InferenceResponse> response(new tc::InferenceResponse(
+      model, "id", &allocator, nullptr /* alloc_userp */,
+      nullptr /* response_fn */, nullptr /* response_userp */,
+      nullptr /* delegator */));
+
+  tc::InferenceResponse::Output* output = nullptr;
+  ASSERT_TRUE(
+      response->AddOutput("OUTPUT0", inference::TYPE_FP32, {16}, &output)
+          .IsOk());
+  ASSERT_TRUE(
+      response->AddOutput("OUTPUT1", inference::TYPE_FP32, {16}).IsOk());
+  ASSERT_TRUE(response->AddParameter("p0", int64_t(0)).IsOk());
+  ASSERT_TRUE(response->AddParameter("p1", "value").IsOk());
+
+  ASSERT_TRUE(output != nullptr);
+  EXPECT_TRUE(IsInside(output, *response));
+  EXPECT_TRUE(IsInside(std::addressof(response->Outputs()[1]), *response));
+  EXPECT_TRUE(IsInside(std::addressof(response->Parameters()[0]), *response));
+  EXPECT_TRUE(IsInside(std::addressof(response->Parameters()[1]), *response));
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,214 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef TRITON_ENABLE_METRICS
+
+#include "gtest/gtest.h"
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "metric_model_reporter.h"
+#include "metrics.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Return the collected metric of 'family_name' labelled with 'model',
+// nullptr if there is none.
+std::unique_ptr<prometheus::ClientMetric>
+CollectMetric(const std::string& family_name, const std::string& model)
+{
+  for (const auto& family : tc::Metrics::GetRegistry()->Collect()) {
+    if (family.name != family_name) {
+      continue;
+    }
+    for (const auto& metric : family.metric) {
+      for (const auto& label : metric.label) {
+        if ((label.name == "model") && (label.value == model)) {
+          return std::unique_ptr<prometheus::ClientMetric>(
+              new prometheus::ClientMetric(metric));
+        }
+      }
+    }
+  }
+  return nullptr;
+}
+
+class MetricModelReporterTest : public ::testing::Test {
+ protected:
+  void SetUp() override { tc::Metrics::EnableMetrics(); }
+  void TearDown() override { tc::Metrics::SetConfigMap({}); }
+
+  std::shared_ptr<tc::MetricModelReporter> CreateReporter(
+      const std::string& model)
+  {
+    std::shared_ptr<tc::MetricModelReporter> reporter;
+    EXPECT_TRUE(tc::MetricModelReporter::Create(
+                    model, 1, -1 /* device */, false /* cache */,
+                    {} /* tags */, &reporter)
+                    .IsOk());
+    return reporter;
+  }
+};
+
+TEST_F(MetricModelReporterTest, HistogramBucketBoundaries)
+{
+  tc::Metrics::SetConfigMap(
+      {{"",
+        {{"histogram_latencies", "true"}, {"histogram_buckets", "10,100"}}}});
+  auto reporter = CreateReporter("bucket_boundaries");
+
+  // Bucket 'le' bounds are inclusive.
+  for (const uint64_t value : {10, 11, 100, 101}) {
+    reporter->ObserveHistogram("queue_duration", value);
+  }
+  tc::Metrics::SerializedMetrics();
+
+  auto metric =
+      CollectMetric("nv_inference_queue_histogram_us", "bucket_boundaries");
+  ASSERT_NE(metric, nullptr);
+  const auto& histogram = metric->histogram;
+  ASSERT_EQ(histogram.bucket.size(), 3u);
+  EXPECT_EQ(histogram.bucket[0].upper_bound, 10);
+  EXPECT_EQ(histogram.bucket[0].cumulative_count, 1u);
+  EXPECT_EQ(histogram.bucket[1].upper_bound, 100);
+  EXPECT_EQ(histogram.bucket[1].cumulative_count, 3u);
+  EXPECT_EQ(
+      histogram.bucket[2].upper_bound,
+      std::numeric_limits<double>::infinity());
+  EXPECT_EQ(histogram.bucket[2].cumulative_count, 4u);
+  EXPECT_EQ(histogram.sample_count, 4u);
+  EXPECT_EQ(histogram.sample_sum, 222);
+}
+
+TEST_F(MetricModelReporterTest, PerModelBuckets)
+{
+  tc::Metrics::SetConfigMap(
+      {{"",
+        {{"histogram_latencies", "true"}, {"histogram_buckets", "10,100"}}},
+       {"override_buckets", {{"histogram_buckets", "5,50,500"}}},
+       {"no_histograms", {{"histogram_latencies", "false"}}}});
+  auto global = CreateReporter("global_buckets");
+  auto overridden = CreateReporter("override_buckets");
+  auto disabled = CreateReporter("no_histograms");
+
+  EXPECT_TRUE(global->Config().latency_histograms_enabled_);
+  EXPECT_EQ(
+      global->Config().buckets_,
+      prometheus::Histogram::BucketBoundaries({10, 100}));
+  EXPECT_TRUE(overridden->Config().latency_histograms_enabled_);
+  EXPECT_EQ(
+      overridden->Config().buckets_,
+      prometheus::Histogram::BucketBoundaries({5, 50, 500}));
+  EXPECT_FALSE(disabled->Config().latency_histograms_enabled_);
+
+  overridden->ObserveHistogram("queue_duration", 1);
+  tc::Metrics::SerializedMetrics();
+  auto metric =
+      CollectMetric("nv_inference_queue_histogram_us", "override_buckets");
+  ASSERT_NE(metric, nullptr);
+  EXPECT_EQ(metric->histogram.bucket.size(), 4u);
+  EXPECT_EQ(
+      CollectMetric("nv_inference_queue_histogram_us", "no_histograms"),
+      nullptr);
+}
+
+TEST_F(MetricModelReporterTest, ParseBuckets)
+{
+  tc::MetricReporterConfig config;
+  EXPECT_EQ(
+      config.ParseBuckets("1, 2.5,10"),
+      prometheus::Histogram::BucketBoundaries({1, 2.5, 10}));
+  // Boundaries must be strictly increasing numbers.
+  EXPECT_TRUE(config.ParseBuckets("10,10").empty());
+  EXPECT_TRUE(config.ParseBuckets("100,10").empty());
+  EXPECT_TRUE(config.ParseBuckets("10,abc").empty());
+  EXPECT_TRUE(config.ParseBuckets("1e999").empty());
+}
+
+TEST_F(MetricModelReporterTest, FlushOnScrape)
+{
+  tc::Metrics::SetConfigMap({{"", {{"histogram_latencies", "true"}}}});
+  auto reporter = CreateReporter("flush_on_scrape");
+  const std::string family = "nv_inference_compute_infer_histogram_us";
+
+  // Observations are only published to the histogram by a scrape.
+  reporter->ObserveHistogram("compute_infer_duration", 42);
+  auto metric = CollectMetric(family, "flush_on_scrape");
+  ASSERT_NE(metric, nullptr);
+  EXPECT_EQ(metric->histogram.sample_count, 0u);
+
+  tc::Metrics::SerializedMetrics();
+  metric = CollectMetric(family, "flush_on_scrape");
+  ASSERT_NE(metric, nullptr);
+  EXPECT_EQ(metric->histogram.sample_count, 1u);
+  EXPECT_EQ(metric->histogram.sample_sum, 42);
+
+  // A flushed observation is not published twice.
+  tc::Metrics::SerializedMetricsBinary();
+  metric = CollectMetric(family, "flush_on_scrape");
+  ASSERT_NE(metric, nullptr);
+  EXPECT_EQ(metric->histogram.sample_count, 1u);
+
+  // The histogram is removed with its reporter.
+  reporter.reset();
+  tc::Metrics::SerializedMetrics();
+  EXPECT_EQ(CollectMetric(family, "flush_on_scrape"), nullptr);
+}
+
+TEST_F(MetricModelReporterTest, PerModelSchedulerMetrics)
+{
+  tc::Metrics::SetConfigMap(
+      {{"", {{"scheduler_metrics", "false"}}},
+       {"scheduler_on", {{"scheduler_metrics", "true"}}}});
+  auto enabled = CreateReporter("scheduler_on");
+  auto disabled = CreateReporter("scheduler_off");
+  EXPECT_TRUE(enabled->Config().scheduler_metrics_enabled_);
+  EXPECT_FALSE(disabled->Config().scheduler_metrics_enabled_);
+
+  // Queue sizes are reported as deltas.
+  enabled->AdjustSchedulerQueueSize(0, 2);
+  enabled->AdjustSchedulerQueueSize(0, -1);
+  disabled->AdjustSchedulerQueueSize(0, 2);
+  auto metric = CollectMetric("nv_scheduler_queue_size", "scheduler_on");
+  ASSERT_NE(metric, nullptr);
+  EXPECT_EQ(metric->gauge.value, 1);
+  EXPECT_EQ(CollectMetric("nv_scheduler_queue_size", "scheduler_off"), nullptr);
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#endif  // TRITON_ENABLE_METRICS
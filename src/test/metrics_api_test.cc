@@ -26,6 +26,7 @@
 
 #ifdef TRITON_ENABLE_METRICS
 
+#include <cstring>
 #include <iostream>
 #include <thread>
 #include "gmock/gmock.h"
@@ -662,6 +663,138 @@ TEST_F(MetricsApiTest, TestChildMetricTracking)
   FAIL_TEST_IF_ERR(TRITONSERVER_MetricFamilyDelete(family), "delete family");
 }
 
+// Test that reused serialization reflects every metric update
+TEST_F(MetricsApiTest, TestSerializationCache)
+{
+  TRITONSERVER_MetricFamily* family = nullptr;
+  const char* name = "test_serialization_cache";
+  const char* description = "test reusing serialized metric families";
+  FAIL_TEST_IF_ERR(
+      TRITONSERVER_MetricFamilyNew(
+          &family, TRITONSERVER_METRIC_KIND_GAUGE, name, description),
+      "Creating new metric family");
+  TRITONSERVER_Metric* metric = nullptr;
+  std::vector<const TRITONSERVER_Parameter*> labels;
+  FAIL_TEST_IF_ERR(
+      TRITONSERVER_MetricNew(&metric, family, labels.data(), labels.size()),
+      "Creating new metric");
+
+  FAIL_TEST_IF_ERR(TRITONSERVER_MetricSet(metric, 7), "set metric");
+  const std::string sample = std::string(name) + " ";
+  ASSERT_EQ(NumMetricMatches(server_, sample + "7\n"), 1);
+  // Unchanged families are reused as is
+  ASSERT_EQ(NumMetricMatches(server_, sample + "7\n"), 1);
+
+  FAIL_TEST_IF_ERR(TRITONSERVER_MetricSet(metric, 9), "set metric");
+  ASSERT_EQ(NumMetricMatches(server_, sample + "7\n"), 0);
+  ASSERT_EQ(NumMetricMatches(server_, sample + "9\n"), 1);
+
+  FAIL_TEST_IF_ERR(TRITONSERVER_MetricDelete(metric), "delete metric");
+  FAIL_TEST_IF_ERR(TRITONSERVER_MetricFamilyDelete(family), "delete family");
+  ASSERT_EQ(NumMetricMatches(server_, description), 0);
+}
+
+// Test the compact binary metrics format
+TEST_F(MetricsApiTest, TestBinaryFormat)
+{
+  TRITONSERVER_MetricFamily* family = nullptr;
+  const char* name = "test_binary_format";
+  FAIL_TEST_IF_ERR(
+      TRITONSERVER_MetricFamilyNew(
+          &family, TRITONSERVER_METRIC_KIND_COUNTER, name,
+          "test binary metrics"),
+      "Creating new metric family");
+  TRITONSERVER_Metric* metric = nullptr;
+  std::vector<const TRITONSERVER_Parameter*> labels;
+  labels.emplace_back(TRITONSERVER_ParameterNew(
+      "model", TRITONSERVER_PARAMETER_STRING, "simple"));
+  FAIL_TEST_IF_ERR(
+      TRITONSERVER_MetricNew(&metric, family, labels.data(), labels.size()),
+      "Creating new metric");
+  for (const auto label : labels) {
+    TRITONSERVER_ParameterDelete(const_cast<TRITONSERVER_Parameter*>(label));
+  }
+  FAIL_TEST_IF_ERR(TRITONSERVER_MetricIncrement(metric, 5), "increment");
+
+  TRITONSERVER_Metrics* metrics = nullptr;
+  FAIL_TEST_IF_ERR(
+      TRITONSERVER_ServerMetrics(server_, &metrics), "fetch metrics");
+  const char* base;
+  size_t byte_size;
+  FAIL_TEST_IF_ERR(
+      TRITONSERVER_MetricsFormatted(
+          metrics, TRITONSERVER_METRIC_BINARY, &base, &byte_size),
+      "format metrics binary");
+  const std::string binary(base, byte_size);
+  TRITONSERVER_MetricsDelete(metrics);
+
+  size_t offset = 0;
+  auto read = [&binary, &offset](void* dst, const size_t size) {
+    ASSERT_LE(offset + size, binary.size());
+    memcpy(dst, binary.data() + offset, size);
+    offset += size;
+  };
+  auto read_string = [&read](std::string* str) {
+    uint32_t size = 0;
+    read(&size, sizeof(size));
+    str->resize(size);
+    read(&(*str)[0], size);
+  };
+
+  ASSERT_EQ(binary.substr(0, 8), "TRTMETRC");
+  offset = 8;
+  uint32_t version = 0, family_count = 0;
+  read(&version, sizeof(version));
+  read(&family_count, sizeof(family_count));
+  ASSERT_EQ(version, 1u);
+
+  bool found = false;
+  for (uint32_t fidx = 0; fidx < family_count; ++fidx) {
+    std::string family_name;
+    read_string(&family_name);
+    uint8_t type = 0;
+    uint32_t metric_count = 0;
+    read(&type, sizeof(type));
+    read(&metric_count, sizeof(metric_count));
+    for (uint32_t midx = 0; midx < metric_count; ++midx) {
+      uint32_t label_count = 0;
+      read(&label_count, sizeof(label_count));
+      std::vector<std::pair<std::string, std::string>> metric_labels(
+          label_count);
+      for (auto& label : metric_labels) {
+        read_string(&label.first);
+        read_string(&label.second);
+      }
+      int64_t timestamp_ms = 0;
+      read(&timestamp_ms, sizeof(timestamp_ms));
+      double value = 0;
+      uint64_t count = 0;
+      uint32_t entry_count = 0;
+      if (type == 2 || type == 4) {
+        read(&count, sizeof(count));
+        read(&value, sizeof(value));
+        read(&entry_count, sizeof(entry_count));
+        offset += entry_count * 16;
+      } else {
+        read(&value, sizeof(value));
+      }
+      if (family_name == name) {
+        found = true;
+        EXPECT_EQ(type, 0);
+        ASSERT_EQ(metric_labels.size(), 1u);
+        EXPECT_EQ(metric_labels[0].first, "model");
+        EXPECT_EQ(metric_labels[0].second, "simple");
+        EXPECT_EQ(value, 5);
+      }
+    }
+  }
+  EXPECT_TRUE(found);
+  EXPECT_EQ(offset, binary.size());
+
+  FAIL_TEST_IF_ERR(TRITONSERVER_MetricDelete(metric), "delete metric");
+  FAIL_TEST_IF_ERR(TRITONSERVER_MetricFamilyDelete(family), "delete family");
+}
+
 }  // namespace
 
 int
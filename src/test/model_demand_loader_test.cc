@@ -0,0 +1,467 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "model_demand_loader.h"
+#include "model_repository_manager.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// The state of the model repository faked by the mock manager below.
+struct FakeRepository {
+  void Reset()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    models_.clear();
+    loaded_.clear();
+    inflight_.clear();
+    failing_.clear();
+    log_.clear();
+    max_loaded_ = 0;
+    hook_ = nullptr;
+  }
+
+  std::vector<std::string> Log()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return log_;
+  }
+
+  bool IsLoaded(const std::string& name)
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    return loaded_.find(name) != loaded_.end();
+  }
+
+  std::mutex mu_;
+  // The models in the repository.
+  std::set<std::string> models_;
+  std::set<std::string> loaded_;
+  // The number of requests in flight for each model.
+  std::map<std::string, size_t> inflight_;
+  // The models that fail to load.
+  std::set<std::string> failing_;
+  // The loads and unloads, as "load:<name>" and "unload:<name>".
+  std::vector<std::string> log_;
+  // The maximum number of models loaded at the same time.
+  size_t max_loaded_;
+  // Called without holding 'mu_' with the log entry of every load,
+  // before the load, and of every unload, after the unload.
+  std::function<void(const std::string&)> hook_;
+};
+
+FakeRepository repository;
+
+}  // namespace
+
+/* Mock classes for Unit Testing */
+namespace triton { namespace core {
+
+ModelRepositoryManager::ModelRepositoryManager(
+    const std::set<std::string>& repository_paths, const bool autofill,
+    const bool polling_enabled, const bool model_control_enabled,
+    const double min_compute_capability, const bool enable_model_namespacing,
+    std::unique_ptr<ModelLifeCycle> life_cycle)
+    : autofill_(autofill), polling_enabled_(polling_enabled),
+      model_control_enabled_(model_control_enabled),
+      min_compute_capability_(min_compute_capability),
+      dependency_graph_(&global_map_),
+      enable_model_namespacing_(enable_model_namespacing),
+      repository_paths_(repository_paths),
+      model_life_cycle_(std::move(life_cycle))
+{
+}
+
+ModelRepositoryManager::~ModelRepositoryManager() {}
+
+Status
+ModelRepositoryManager::Create(
+    InferenceServer* server, const std::string& server_version,
+    const std::set<std::string>& repository_paths,
+    const std::set<std::string>& startup_models, const bool strict_model_config,
+    const bool polling_enabled, const bool model_control_enabled,
+    const ModelLifeCycleOptions& life_cycle_options,
+    const bool enable_model_namespacing, const std::string& snapshot_path,
+    std::unique_ptr<ModelRepositoryManager>* model_repository_manager)
+{
+  model_repository_manager->reset(new ModelRepositoryManager(
+      repository_paths, !strict_model_config, polling_enabled,
+      model_control_enabled, 0.0 /* min_compute_capability */,
+      enable_model_namespacing, nullptr /* life_cycle */));
+  return Status::Success;
+}
+
+Status
+ModelRepositoryManager::LoadUnloadModel(
+    const std::unordered_map<
+        std::string, std::vector<const InferenceParameter*>>& models,
+    const ActionType type, const bool unload_dependents)
+{
+  for (const auto& model : models) {
+    const std::string& name = model.first;
+    if (type == ActionType::UNLOAD) {
+      {
+        std::lock_guard<std::mutex> lk(repository.mu_);
+        repository.log_.push_back("unload:" + name);
+        repository.loaded_.erase(name);
+      }
+      if (repository.hook_) {
+        repository.hook_("unload:" + name);
+      }
+      continue;
+    }
+
+    if (repository.hook_) {
+      repository.hook_("load:" + name);
+    }
+    std::lock_guard<std::mutex> lk(repository.mu_);
+    repository.log_.push_back("load:" + name);
+    if (repository.models_.find(name) == repository.models_.end()) {
+      return Status(Status::Code::NOT_FOUND, "no model '" + name + "'");
+    }
+    if (repository.failing_.find(name) != repository.failing_.end()) {
+      return Status(Status::Code::INTERNAL, "failed to load '" + name + "'");
+    }
+    repository.loaded_.insert(name);
+    repository.max_loaded_ =
+        std::max(repository.max_loaded_, repository.loaded_.size());
+  }
+  return Status::Success;
+}
+
+const std::set<std::tuple<ModelIdentifier, int64_t, size_t>>
+ModelRepositoryManager::InflightStatus()
+{
+  std::lock_guard<std::mutex> lk(repository.mu_);
+  std::set<std::tuple<ModelIdentifier, int64_t, size_t>> inflight;
+  for (const auto& count : repository.inflight_) {
+    if ((count.second > 0) &&
+        (repository.loaded_.find(count.first) != repository.loaded_.end())) {
+      inflight.emplace(ModelIdentifier("", count.first), 1, count.second);
+    }
+  }
+  return inflight;
+}
+
+const ModelStateMap
+ModelRepositoryManager::LiveModelStates(bool strict_readiness)
+{
+  std::lock_guard<std::mutex> lk(repository.mu_);
+  ModelStateMap states;
+  for (const auto& name : repository.loaded_) {
+    states[ModelIdentifier("", name)][1] =
+        std::make_pair(ModelReadyState::READY, std::string());
+  }
+  return states;
+}
+
+const VersionStateMap
+ModelRepositoryManager::VersionStates(const std::string& model_name)
+{
+  std::lock_guard<std::mutex> lk(repository.mu_);
+  VersionStateMap states;
+  if (repository.loaded_.find(model_name) != repository.loaded_.end()) {
+    states[1] = std::make_pair(ModelReadyState::READY, std::string());
+  }
+  return states;
+}
+
+Status
+ModelRepositoryManager::GetModel(
+    const std::string& model_name, const int64_t model_version,
+    std::shared_ptr<Model>* model)
+{
+  std::lock_guard<std::mutex> lk(repository.mu_);
+  if (repository.loaded_.find(model_name) == repository.loaded_.end()) {
+    return Status(
+        Status::Code::UNAVAILABLE, "'" + model_name + "' is not loaded");
+  }
+  model->reset();
+  return Status::Success;
+}
+
+Status
+ModelRepositoryManager::RepositoryIndex(
+    const bool ready_only, std::vector<ModelIndex>* index)
+{
+  std::lock_guard<std::mutex> lk(repository.mu_);
+  for (const auto& name : repository.models_) {
+    index->emplace_back(ModelIdentifier("", name));
+  }
+  return Status::Success;
+}
+
+}}  // namespace triton::core
+
+namespace {
+
+class ModelDemandLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    repository.Reset();
+    repository.models_ = {"a", "b", "c", "d", "e"};
+    ASSERT_TRUE(tc::ModelRepositoryManager::Create(
+                    nullptr /* server */, "" /* server_version */,
+                    {} /* repository_paths */, {} /* startup_models */,
+                    true /* strict_model_config */, false /* polling_enabled */,
+                    true /* model_control_enabled */,
+                    tc::ModelLifeCycleOptions(
+                        0.0 /* min_compute_capability */, {}, {},
+                        1 /* model_load_thread_count */,
+                        false /* version_swap_enabled */,
+                        0 /* version_drain_timeout_ms */,
+                        0 /* model_load_memory_budget */),
+                    false /* enable_model_namespacing */,
+                    "" /* snapshot_path */, &manager_)
+                    .IsOk());
+  }
+
+  void CreateLoader(
+      const uint32_t max_loaded_models, const uint32_t max_pending_requests,
+      const tc::ModelEvictionPolicy policy = tc::ModelEvictionPolicy::LRU)
+  {
+    ASSERT_TRUE(tc::ModelDemandLoader::Create(
+                    manager_.get(), max_loaded_models, max_pending_requests,
+                    policy, &loader_)
+                    .IsOk());
+  }
+
+  tc::Status GetModel(const std::string& name)
+  {
+    std::shared_ptr<tc::Model> model;
+    return loader_->GetModel(name, -1 /* model_version */, &model);
+  }
+
+  // Fetch 'names' in order, failing the test if any of them fails.
+  void Use(const std::vector<std::string>& names)
+  {
+    for (const auto& name : names) {
+      tc::Status status = GetModel(name);
+      ASSERT_TRUE(status.IsOk()) << status.AsString();
+    }
+  }
+
+  std::unique_ptr<tc::ModelRepositoryManager> manager_;
+  std::unique_ptr<tc::ModelDemandLoader> loader_;
+};
+
+TEST_F(ModelDemandLoaderTest, LoadOnDemand)
+{
+  CreateLoader(2 /* max_loaded_models */, 0 /* max_pending_requests */);
+  Use({"a", "a", "b"});
+  EXPECT_EQ(
+      repository.Log(), std::vector<std::string>({"load:a", "load:b"}));
+}
+
+TEST_F(ModelDemandLoaderTest, UnknownModel)
+{
+  // A model that is not in the repository must not unload other models.
+  CreateLoader(1 /* max_loaded_models */, 0 /* max_pending_requests */);
+  Use({"a"});
+  tc::Status status = GetModel("missing");
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::NOT_FOUND)
+      << status.AsString();
+  EXPECT_TRUE(repository.IsLoaded("a"));
+  EXPECT_EQ(repository.Log(), std::vector<std::string>({"load:a"}));
+}
+
+TEST_F(ModelDemandLoaderTest, LoadFailure)
+{
+  CreateLoader(2 /* max_loaded_models */, 0 /* max_pending_requests */);
+  repository.failing_.insert("c");
+  Use({"a", "b"});
+  EXPECT_FALSE(GetModel("c").IsOk());
+
+  // The failed load doesn't hold a place in the budget.
+  Use({"d"});
+  EXPECT_EQ(repository.max_loaded_, 2u);
+  EXPECT_TRUE(repository.IsLoaded("b"));
+  EXPECT_TRUE(repository.IsLoaded("d"));
+}
+
+TEST_F(ModelDemandLoaderTest, EvictLeastRecentlyUsed)
+{
+  CreateLoader(
+      2 /* max_loaded_models */, 0 /* max_pending_requests */,
+      tc::ModelEvictionPolicy::LRU);
+  Use({"a", "a", "a", "b", "c"});
+  EXPECT_FALSE(repository.IsLoaded("a"));
+  EXPECT_TRUE(repository.IsLoaded("b"));
+  EXPECT_TRUE(repository.IsLoaded("c"));
+  EXPECT_EQ(repository.max_loaded_, 2u);
+}
+
+TEST_F(ModelDemandLoaderTest, EvictLeastFrequentlyUsed)
+{
+  CreateLoader(
+      2 /* max_loaded_models */, 0 /* max_pending_requests */,
+      tc::ModelEvictionPolicy::LFU);
+  Use({"a", "a", "a", "b", "c"});
+  EXPECT_TRUE(repository.IsLoaded("a"));
+  EXPECT_FALSE(repository.IsLoaded("b"));
+  EXPECT_TRUE(repository.IsLoaded("c"));
+  EXPECT_EQ(repository.max_loaded_, 2u);
+}
+
+TEST_F(ModelDemandLoaderTest, BusyModelNotEvicted)
+{
+  CreateLoader(2 /* max_loaded_models */, 0 /* max_pending_requests */);
+  Use({"a", "b"});
+
+  // 'a' is the least recently used but has a request in flight.
+  repository.inflight_["a"] = 1;
+  Use({"c"});
+  EXPECT_TRUE(repository.IsLoaded("a"));
+  EXPECT_FALSE(repository.IsLoaded("b"));
+  EXPECT_TRUE(repository.IsLoaded("c"));
+
+  // Every model is busy, the load exceeds the budget rather than
+  // unloading a model serving requests.
+  repository.inflight_["c"] = 1;
+  Use({"d"});
+  EXPECT_TRUE(repository.IsLoaded("a"));
+  EXPECT_TRUE(repository.IsLoaded("c"));
+  EXPECT_TRUE(repository.IsLoaded("d"));
+}
+
+TEST_F(ModelDemandLoaderTest, ConcurrentLoadsWithinBudget)
+{
+  CreateLoader(2 /* max_loaded_models */, 0 /* max_pending_requests */);
+  Use({"a", "b"});
+
+  // Hold the load of 'c' until the load of 'd' starts, so that both
+  // loads are in progress together. The load of 'd' must count 'c'
+  // toward the budget even though 'c' is not loaded yet.
+  std::mutex mu;
+  std::condition_variable cv;
+  bool a_unloaded = false;
+  bool d_loading = false;
+  repository.hook_ = [&](const std::string& entry) {
+    std::unique_lock<std::mutex> lk(mu);
+    if (entry == "unload:a") {
+      a_unloaded = true;
+      cv.notify_all();
+    } else if (entry == "load:d") {
+      d_loading = true;
+      cv.notify_all();
+    } else if (entry == "load:c") {
+      cv.wait_for(lk, std::chrono::seconds(5), [&] { return d_loading; });
+    }
+  };
+
+  tc::Status c_status;
+  std::thread c_thread([&] { c_status = GetModel("c"); });
+  {
+    // Start 'd' once 'a' is unloaded to make room for 'c'.
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait(lk, [&] { return a_unloaded; });
+  }
+  tc::Status d_status = GetModel("d");
+  c_thread.join();
+
+  EXPECT_TRUE(c_status.IsOk()) << c_status.AsString();
+  EXPECT_TRUE(d_status.IsOk()) << d_status.AsString();
+  EXPECT_TRUE(repository.IsLoaded("c"));
+  EXPECT_TRUE(repository.IsLoaded("d"));
+  EXPECT_EQ(repository.max_loaded_, 2u);
+}
+
+TEST_F(ModelDemandLoaderTest, SharedLoad)
+{
+  CreateLoader(0 /* max_loaded_models */, 0 /* max_pending_requests */);
+  std::vector<std::thread> threads;
+  std::vector<tc::Status> statuses(8);
+  for (size_t i = 0; i < statuses.size(); ++i) {
+    threads.emplace_back([this, &statuses, i] { statuses[i] = GetModel("a"); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& status : statuses) {
+    EXPECT_TRUE(status.IsOk()) << status.AsString();
+  }
+  EXPECT_EQ(repository.Log(), std::vector<std::string>({"load:a"}));
+}
+
+TEST_F(ModelDemandLoaderTest, PendingRequestLimit)
+{
+  CreateLoader(0 /* max_loaded_models */, 1 /* max_pending_requests */);
+
+  std::mutex mu;
+  std::condition_variable cv;
+  bool loading = false;
+  bool release = false;
+  repository.hook_ = [&](const std::string& entry) {
+    std::unique_lock<std::mutex> lk(mu);
+    loading = true;
+    cv.notify_all();
+    cv.wait(lk, [&] { return release; });
+  };
+
+  tc::Status a_status;
+  std::thread a_thread([&] { a_status = GetModel("a"); });
+  {
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait(lk, [&] { return loading; });
+  }
+
+  tc::Status status = GetModel("b");
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::UNAVAILABLE)
+      << status.AsString();
+
+  {
+    std::lock_guard<std::mutex> lk(mu);
+    release = true;
+  }
+  cv.notify_all();
+  a_thread.join();
+  EXPECT_TRUE(a_status.IsOk()) << a_status.AsString();
+  EXPECT_FALSE(repository.IsLoaded("b"));
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
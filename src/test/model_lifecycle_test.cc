@@ -0,0 +1,350 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include "backend_model.h"
+#include "filesystem.h"
+#include "model_config_utils.h"
+#include "model_lifecycle.h"
+#include "repo_agent.h"
+#include "scheduler.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// The in-flight inference count reported by each version, and the
+// versions whose model has been destroyed.
+struct FakeModels {
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::map<int64_t, size_t> inflight_;
+  std::set<int64_t> destroyed_;
+};
+
+FakeModels fake_models;
+
+// Only reports the in-flight inference count of its version.
+class FakeScheduler : public tc::Scheduler {
+ public:
+  explicit FakeScheduler(const int64_t version) : version_(version) {}
+
+  tc::Status Enqueue(std::unique_ptr<tc::InferenceRequest>& request) override
+  {
+    return tc::Status(
+        tc::Status::Code::UNSUPPORTED, "inference is not mocked");
+  }
+
+  size_t InflightInferenceCount() override
+  {
+    std::lock_guard<std::mutex> lk(fake_models.mu_);
+    return fake_models.inflight_[version_];
+  }
+
+  void Stop() override {}
+
+ private:
+  const int64_t version_;
+};
+
+}  // namespace
+
+/* Mock classes for Unit Testing */
+namespace triton { namespace core {
+
+// The model configurations are constructed by the test, skip their
+// validation.
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+// The versions are only loaded in full, never updated in place.
+bool
+EquivalentInNonInstanceGroupConfig(
+    const inference::ModelConfig& old_config,
+    const inference::ModelConfig& new_config)
+{
+  return false;
+}
+
+// The models are loaded without repo agents.
+Status
+TritonRepoAgentModel::InvokeAgent(const TRITONREPOAGENT_ActionType action_type)
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+TritonModel::TritonModel(
+    InferenceServer* server,
+    const std::shared_ptr<LocalizedPath>& localized_model_dir,
+    const std::shared_ptr<TritonBackend>& backend,
+    const double min_compute_capability, const int64_t version,
+    const inference::ModelConfig& config, const bool auto_complete_config,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map)
+    : Model(min_compute_capability, "", version, config), server_(server),
+      min_compute_capability_(min_compute_capability),
+      auto_complete_config_(auto_complete_config),
+      backend_cmdline_config_map_(backend_cmdline_config_map),
+      host_policy_map_(host_policy_map), device_blocking_(false),
+      localized_model_dir_(localized_model_dir), backend_(backend),
+      state_(nullptr)
+{
+  SetScheduler(std::unique_ptr<Scheduler>(new FakeScheduler(version)));
+}
+
+TritonModel::~TritonModel()
+{
+  std::lock_guard<std::mutex> lk(fake_models.mu_);
+  fake_models.destroyed_.insert(Version());
+  fake_models.cv_.notify_all();
+}
+
+Status
+TritonModel::Create(
+    InferenceServer* server, const std::string& model_path,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map,
+    const int64_t version, inference::ModelConfig model_config,
+    const bool is_config_provided, std::unique_ptr<TritonModel>* model)
+{
+  model->reset(new TritonModel(
+      server, nullptr /* localized_model_dir */, nullptr /* backend */,
+      0 /* min_compute_capability */, version, model_config,
+      false /* auto_complete_config */, backend_cmdline_config_map,
+      host_policy_map));
+  return Status::Success;
+}
+
+Status
+TritonModel::UpdateInstanceGroup(
+    const inference::ModelConfig& new_model_config,
+    std::unique_lock<std::mutex>* caller_lock)
+{
+  return Status::Success;
+}
+
+}}  // namespace triton::core
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+class ModelLifeCycleTest : public ::testing::Test {
+ protected:
+  // Create a repository holding version 1 of model 'm', served under
+  // the latest version policy.
+  void SetUp() override
+  {
+    {
+      std::lock_guard<std::mutex> lk(fake_models.mu_);
+      fake_models.inflight_.clear();
+      fake_models.destroyed_.clear();
+    }
+    ASSERT_OK(tc::MakeTemporaryDirectory(tc::FileSystemType::LOCAL, &dir_));
+    model_path_ = tc::JoinPath({dir_, "m"});
+    ASSERT_OK(tc::MakeDirectory(
+        tc::JoinPath({model_path_, "1"}), true /* recursive */));
+    config_.set_name("m");
+    config_.set_backend("fake");
+    config_.mutable_version_policy()->mutable_latest()->set_num_versions(1);
+  }
+
+  void TearDown() override { tc::DeletePath(dir_); }
+
+  // The life cycles are never destroyed, the models unloaded last may
+  // still be reporting their destruction to them.
+  void CreateLifeCycle(
+      const bool version_swap_enabled, const uint64_t drain_timeout_ms)
+  {
+    std::unique_ptr<tc::ModelLifeCycle> life_cycle;
+    ASSERT_OK(tc::ModelLifeCycle::Create(
+        nullptr /* server */,
+        tc::ModelLifeCycleOptions(
+            0.0 /* min_compute_capability */, cmdline_config_map_,
+            host_policy_map_, 1 /* model_load_thread_count */,
+            version_swap_enabled, drain_timeout_ms,
+            0 /* model_load_memory_budget */),
+        &life_cycle));
+    life_cycle_ = life_cycle.release();
+  }
+
+  // Load the versions present in the repository and wait for the load
+  // to complete.
+  void Load()
+  {
+    std::promise<tc::Status> loaded;
+    ASSERT_OK(life_cycle_->AsyncLoad(
+        model_id_, model_path_, config_, true /* is_config_provided */,
+        false /* is_model_file_updated */, nullptr /* agent_model_list */,
+        [&loaded](tc::Status status) { loaded.set_value(status); }));
+    ASSERT_OK(loaded.get_future().get());
+  }
+
+  // Replace version 1 by version 2, with 'inflight' inferences still
+  // running on version 1.
+  void Swap(const size_t inflight)
+  {
+    Load();
+    SetInflight(1, inflight);
+    ASSERT_OK(tc::MakeDirectory(
+        tc::JoinPath({model_path_, "2"}), false /* recursive */));
+    Load();
+  }
+
+  void SetInflight(const int64_t version, const size_t inflight)
+  {
+    std::lock_guard<std::mutex> lk(fake_models.mu_);
+    fake_models.inflight_[version] = inflight;
+  }
+
+  // Return true if the model of 'version' is destroyed within 'timeout'.
+  bool WaitDestroyed(
+      const int64_t version, const std::chrono::milliseconds& timeout)
+  {
+    std::unique_lock<std::mutex> lk(fake_models.mu_);
+    return fake_models.cv_.wait_for(lk, timeout, [version] {
+      return fake_models.destroyed_.count(version) != 0;
+    });
+  }
+
+  std::pair<tc::ModelReadyState, std::string> VersionState(
+      const int64_t version)
+  {
+    auto states = life_cycle_->VersionStates(model_id_);
+    return states[version];
+  }
+
+  const tc::ModelIdentifier model_id_{"", "m"};
+  const triton::common::BackendCmdlineConfigMap cmdline_config_map_;
+  const triton::common::HostPolicyCmdlineConfigMap host_policy_map_;
+  std::string dir_;
+  std::string model_path_;
+  inference::ModelConfig config_;
+  tc::ModelLifeCycle* life_cycle_;
+};
+
+TEST_F(ModelLifeCycleTest, NoSwap)
+{
+  // Without swap the replaced version is unloaded right away.
+  CreateLifeCycle(false /* version_swap_enabled */, 0 /* drain_timeout_ms */);
+  Swap(1 /* inflight */);
+
+  EXPECT_TRUE(WaitDestroyed(1, std::chrono::seconds(5)));
+  std::shared_ptr<tc::Model> model;
+  EXPECT_FALSE(life_cycle_->GetModel(model_id_, 1, &model).IsOk());
+  ASSERT_OK(life_cycle_->GetModel(model_id_, -1, &model));
+  EXPECT_EQ(model->Version(), 2);
+}
+
+TEST_F(ModelLifeCycleTest, DrainUntilIdle)
+{
+  CreateLifeCycle(
+      true /* version_swap_enabled */, 60000 /* drain_timeout_ms */);
+  Swap(1 /* inflight */);
+
+  // The draining version is reported unavailable, the latest version is
+  // served by the new version but the draining one still serves the
+  // requests naming it.
+  EXPECT_EQ(VersionState(1).first, tc::ModelReadyState::UNAVAILABLE);
+  EXPECT_EQ(VersionState(1).second, "draining");
+  EXPECT_EQ(VersionState(2).first, tc::ModelReadyState::READY);
+  tc::ModelReadyState state;
+  ASSERT_OK(life_cycle_->ModelState(model_id_, 1, &state));
+  EXPECT_EQ(state, tc::ModelReadyState::UNAVAILABLE);
+  auto live_states = life_cycle_->LiveModelStates(true /* strict */);
+  EXPECT_EQ(live_states[model_id_].count(1), 0u);
+  {
+    std::shared_ptr<tc::Model> model;
+    ASSERT_OK(life_cycle_->GetModel(model_id_, -1, &model));
+    EXPECT_EQ(model->Version(), 2);
+    ASSERT_OK(life_cycle_->GetModel(model_id_, 1, &model));
+    EXPECT_EQ(model->Version(), 1);
+  }
+
+  // The version is unloaded once its in-flight inferences complete.
+  EXPECT_FALSE(WaitDestroyed(1, std::chrono::milliseconds(300)));
+  SetInflight(1, 0);
+  EXPECT_TRUE(WaitDestroyed(1, std::chrono::seconds(5)));
+  std::shared_ptr<tc::Model> model;
+  EXPECT_FALSE(life_cycle_->GetModel(model_id_, 1, &model).IsOk());
+}
+
+TEST_F(ModelLifeCycleTest, DrainTimeout)
+{
+  // The version is unloaded on timeout even though it is still busy.
+  CreateLifeCycle(true /* version_swap_enabled */, 200 /* drain_timeout_ms */);
+  const auto start = std::chrono::steady_clock::now();
+  Swap(1 /* inflight */);
+
+  EXPECT_TRUE(WaitDestroyed(1, std::chrono::seconds(5)));
+  EXPECT_GE(
+      std::chrono::steady_clock::now() - start,
+      std::chrono::milliseconds(200));
+  EXPECT_FALSE(WaitDestroyed(2, std::chrono::milliseconds(0)));
+}
+
+TEST_F(ModelLifeCycleTest, UnloadEndsDrain)
+{
+  CreateLifeCycle(
+      true /* version_swap_enabled */, 60000 /* drain_timeout_ms */);
+  Swap(1 /* inflight */);
+
+  ASSERT_OK(life_cycle_->AsyncUnload(model_id_));
+  EXPECT_TRUE(WaitDestroyed(1, std::chrono::seconds(5)));
+  EXPECT_TRUE(WaitDestroyed(2, std::chrono::seconds(5)));
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,758 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "filesystem.h"
+#include "model_config_utils.h"
+#include "model_lifecycle.h"
+#include "model_repository_manager.h"
+#include "repo_agent.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Counts the configurations normalized and validated, and records the
+// configuration of the models loaded, by the mocks below. The loads
+// of the models in 'load_delay_ms_' take that long and the loads of
+// the models in 'failing_loads_' fail.
+struct Recorder {
+  void Reset()
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    normalize_count_ = 0;
+    validate_count_ = 0;
+    load_count_ = 0;
+    loaded_.clear();
+    load_delay_ms_.clear();
+    failing_loads_.clear();
+    inflight_count_ = 0;
+    max_inflight_count_ = 0;
+    events_.clear();
+  }
+
+  std::mutex mu_;
+  size_t normalize_count_;
+  size_t validate_count_;
+  size_t load_count_;
+  std::map<std::string, inference::ModelConfig> loaded_;
+  std::map<std::string, unsigned int> load_delay_ms_;
+  std::set<std::string> failing_loads_;
+  size_t inflight_count_;
+  size_t max_inflight_count_;
+  // "load", "loaded", "failed" and "unload" events, followed by the
+  // model name, in the order they happen.
+  std::vector<std::string> events_;
+};
+
+Recorder recorder;
+
+}  // namespace
+
+/* Mock classes for Unit Testing */
+namespace triton { namespace core {
+
+// Normalization only marks the configuration so that the tests can
+// tell a normalized configuration from a parsed one.
+Status
+GetNormalizedModelConfig(
+    const std::string& model_name, const std::string& path,
+    const double min_compute_capability, inference::ModelConfig* config)
+{
+  std::lock_guard<std::mutex> lk(recorder.mu_);
+  ++recorder.normalize_count_;
+  config->set_backend("normalized");
+  return Status::Success;
+}
+
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  std::lock_guard<std::mutex> lk(recorder.mu_);
+  ++recorder.validate_count_;
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+Status
+JsonToModelConfig(
+    const std::string& json_config, const uint32_t config_version,
+    inference::ModelConfig* protobuf_config)
+{
+  return Status(Status::Code::UNSUPPORTED, "config override is not mocked");
+}
+
+// The models are loaded on the load threads and unloaded synchronously,
+// every version of a loaded model becoming ready. A model failing to
+// load has no version ready.
+Status
+ModelLifeCycle::Create(
+    InferenceServer* server, const ModelLifeCycleOptions& options,
+    std::unique_ptr<ModelLifeCycle>* life_cycle)
+{
+  life_cycle->reset(new ModelLifeCycle(server, options));
+  return Status::Success;
+}
+
+void
+ModelLifeCycle::DrainThread()
+{
+}
+
+Status
+ModelLifeCycle::AsyncLoad(
+    const ModelIdentifier& model_id, const std::string& model_path,
+    const inference::ModelConfig& model_config, const bool is_config_provided,
+    const bool is_model_file_updated,
+    const std::shared_ptr<TritonRepoAgentModelList>& agent_model_list,
+    std::function<void(Status)>&& OnComplete)
+{
+  unsigned int delay_ms = 0;
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    ++recorder.load_count_;
+    ++recorder.inflight_count_;
+    recorder.max_inflight_count_ =
+        std::max(recorder.max_inflight_count_, recorder.inflight_count_);
+    recorder.events_.emplace_back("load " + model_id.name_);
+    const auto itr = recorder.load_delay_ms_.find(model_id.name_);
+    if (itr != recorder.load_delay_ms_.end()) {
+      delay_ms = itr->second;
+    }
+  }
+  load_pool_->Enqueue([model_id, model_config, delay_ms, OnComplete]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    Status status;
+    {
+      std::lock_guard<std::mutex> lk(recorder.mu_);
+      --recorder.inflight_count_;
+      if (recorder.failing_loads_.find(model_id.name_) ==
+          recorder.failing_loads_.end()) {
+        recorder.loaded_[model_id.name_] = model_config;
+        recorder.events_.emplace_back("loaded " + model_id.name_);
+      } else {
+        recorder.loaded_.erase(model_id.name_);
+        recorder.events_.emplace_back("failed " + model_id.name_);
+        status = Status(Status::Code::INTERNAL, "load failure is mocked");
+      }
+    }
+    OnComplete(status);
+  });
+  return Status::Success;
+}
+
+Status
+ModelLifeCycle::AsyncUnload(const ModelIdentifier& model_id)
+{
+  std::lock_guard<std::mutex> lk(recorder.mu_);
+  recorder.loaded_.erase(model_id.name_);
+  recorder.events_.emplace_back("unload " + model_id.name_);
+  return Status::Success;
+}
+
+Status
+ModelLifeCycle::GetModel(
+    const ModelIdentifier& model_id, const int64_t version,
+    std::shared_ptr<Model>* model)
+{
+  return Status(Status::Code::UNAVAILABLE, "models are not mocked");
+}
+
+const ModelStateMap
+ModelLifeCycle::LiveModelStates(bool strict_readiness)
+{
+  return ModelStates();
+}
+
+const ModelStateMap
+ModelLifeCycle::ModelStates()
+{
+  std::lock_guard<std::mutex> lk(recorder.mu_);
+  ModelStateMap states;
+  for (const auto& model : recorder.loaded_) {
+    states[ModelIdentifier("", model.first)][1] =
+        std::make_pair(ModelReadyState::READY, std::string());
+  }
+  return states;
+}
+
+const VersionStateMap
+ModelLifeCycle::VersionStates(const ModelIdentifier& model_id)
+{
+  std::lock_guard<std::mutex> lk(recorder.mu_);
+  VersionStateMap states;
+  if (recorder.loaded_.find(model_id.name_) != recorder.loaded_.end()) {
+    states[1] = std::make_pair(ModelReadyState::READY, std::string());
+  }
+  return states;
+}
+
+Status
+ModelLifeCycle::ModelState(
+    const ModelIdentifier& model_id, const int64_t model_version,
+    ModelReadyState* state)
+{
+  std::lock_guard<std::mutex> lk(recorder.mu_);
+  *state = (recorder.loaded_.find(model_id.name_) != recorder.loaded_.end())
+               ? ModelReadyState::READY
+               : ModelReadyState::UNKNOWN;
+  return Status::Success;
+}
+
+Status
+ModelLifeCycle::StopAllModels()
+{
+  return Status::Success;
+}
+
+const std::set<std::tuple<ModelIdentifier, int64_t, size_t>>
+ModelLifeCycle::InflightStatus()
+{
+  return {};
+}
+
+// The models of the tests have no repository agents.
+TritonRepoAgent::~TritonRepoAgent() {}
+
+Status
+TritonRepoAgentManager::CreateAgent(
+    const std::string& agent_name, std::shared_ptr<TritonRepoAgent>* agent)
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+Status
+TritonRepoAgentModel::Create(
+    const TRITONREPOAGENT_ArtifactType type, const std::string& location,
+    const inference::ModelConfig& config,
+    const std::shared_ptr<TritonRepoAgent>& agent,
+    const TritonRepoAgent::Parameters& agent_parameters,
+    std::unique_ptr<TritonRepoAgentModel>* agent_model)
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+TritonRepoAgentModel::~TritonRepoAgentModel() {}
+
+Status
+TritonRepoAgentModel::InvokeAgent(const TRITONREPOAGENT_ActionType action_type)
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+Status
+TritonRepoAgentModel::SetLocation(
+    const TRITONREPOAGENT_ArtifactType type, const std::string& location)
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+Status
+TritonRepoAgentModel::Location(
+    TRITONREPOAGENT_ArtifactType* type, const char** location)
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+Status
+TritonRepoAgentModel::AcquireMutableLocation(
+    const TRITONREPOAGENT_ArtifactType type, const char** location)
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+Status
+TritonRepoAgentModel::DeleteMutableLocation()
+{
+  return Status(Status::Code::UNSUPPORTED, "repo agents are not mocked");
+}
+
+}}  // namespace triton::core
+
+// Only reached when overriding model files, which the tests don't do.
+TRITONSERVER_Error*
+TRITONSERVER_ErrorNew(TRITONSERVER_Error_Code code, const char* msg)
+{
+  return nullptr;
+}
+
+const char*
+TRITONSERVER_ParameterTypeString(TRITONSERVER_ParameterType paramtype)
+{
+  return "<unknown>";
+}
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+#ifdef __linux__
+class ModelRepositoryManagerTest : public ::testing::Test {
+ protected:
+  // Create a repository holding model 'model_a' with a version
+  // directory and a configuration.
+  void SetUp() override
+  {
+    recorder.Reset();
+    mtime_s_ = 0;
+    ASSERT_OK(tc::MakeTemporaryDirectory(tc::FileSystemType::LOCAL, &dir_));
+    repo_ = tc::JoinPath({dir_, "models"});
+    snapshot_path_ = tc::JoinPath({dir_, "snapshot"});
+    ASSERT_OK(tc::MakeDirectory(
+        tc::JoinPath({repo_, "model_a", "1"}), true /* recursive */));
+    WriteFile({"model_a", "config.pbtxt"}, "name: \"model_a\"");
+    WriteFile({"model_a", "1", "model.txt"}, "weights");
+  }
+
+  void TearDown() override
+  {
+    manager_.reset();
+    tc::DeletePath(dir_);
+  }
+
+  // Write a file of the repository and move its modification time, and
+  // the one of its directory, forward. The modification times are set
+  // explicitly as the file system clock may not advance between two
+  // changes.
+  void WriteFile(
+      std::initializer_list<std::string> segments, const std::string& contents)
+  {
+    std::vector<std::string> path({repo_});
+    path.insert(path.end(), segments.begin(), segments.end());
+    const std::string full_path = Join(path);
+    ASSERT_OK(
+        tc::WriteBinaryFile(full_path, contents.data(), contents.size()));
+    Touch(full_path);
+    Touch(tc::DirName(full_path));
+  }
+
+  void MakeVersion(const std::string& model, const std::string& version)
+  {
+    const std::string path = tc::JoinPath({repo_, model, version});
+    ASSERT_OK(tc::MakeDirectory(path, false /* recursive */));
+    Touch(path);
+    Touch(tc::JoinPath({repo_, model}));
+  }
+
+  // Add model 'model' to the repository, as an ensemble of the
+  // 'composing' models if any.
+  void AddModel(
+      const std::string& model, const std::vector<std::string>& composing = {})
+  {
+    ASSERT_OK(tc::MakeDirectory(
+        tc::JoinPath({repo_, model, "1"}), true /* recursive */));
+    std::string config = "name: \"" + model + "\"";
+    if (!composing.empty()) {
+      config += " platform: \"ensemble\" ensemble_scheduling {";
+      for (const auto& step : composing) {
+        config += " step { model_name: \"" + step + "\" model_version: -1 }";
+      }
+      config += " }";
+    }
+    WriteFile({model, "config.pbtxt"}, config);
+  }
+
+  // Create the manager, in explicit model control mode, using the
+  // repository snapshot if 'snapshot' and loading 'startup_models'.
+  void CreateManager(
+      const bool snapshot = false, const unsigned int load_thread_count = 1,
+      const std::set<std::string>& startup_models = {})
+  {
+    manager_.reset();
+    ASSERT_OK(tc::ModelRepositoryManager::Create(
+        nullptr /* server */, "test" /* server_version */, {repo_},
+        startup_models, true /* strict_model_config */,
+        false /* polling_enabled */, true /* model_control_enabled */,
+        tc::ModelLifeCycleOptions(
+            0.0 /* min_compute_capability */, {}, {}, load_thread_count,
+            false /* version_swap_enabled */, 0 /* version_drain_timeout_ms */,
+            0 /* model_load_memory_budget */),
+        false /* enable_model_namespacing */,
+        snapshot ? snapshot_path_ : "", &manager_));
+  }
+
+  void Load(const std::string& model)
+  {
+    ASSERT_OK(manager_->LoadUnloadModel(
+        {{model, {}}}, tc::ActionType::LOAD, false /* unload_dependents */));
+  }
+
+  inference::ModelConfig LoadedConfig(const std::string& model)
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    return recorder.loaded_[model];
+  }
+
+  size_t NormalizeCount()
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    return recorder.normalize_count_;
+  }
+
+  size_t ValidateCount()
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    return recorder.validate_count_;
+  }
+
+  size_t LoadCount()
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    return recorder.load_count_;
+  }
+
+  bool IsLoaded(const std::string& model)
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    return recorder.loaded_.find(model) != recorder.loaded_.end();
+  }
+
+  // The position of 'event' in the recorded events, the number of
+  // events if it didn't happen.
+  size_t EventIndex(const std::string& event)
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    return std::find(recorder.events_.begin(), recorder.events_.end(), event) -
+           recorder.events_.begin();
+  }
+
+  size_t EventCount()
+  {
+    std::lock_guard<std::mutex> lk(recorder.mu_);
+    return recorder.events_.size();
+  }
+
+  std::string dir_;
+  std::string repo_;
+  std::string snapshot_path_;
+  std::unique_ptr<tc::ModelRepositoryManager> manager_;
+
+ private:
+  static std::string Join(const std::vector<std::string>& segments)
+  {
+    std::string path = segments[0];
+    for (size_t i = 1; i < segments.size(); ++i) {
+      path = tc::JoinPath({path, segments[i]});
+    }
+    return path;
+  }
+
+  void Touch(const std::string& path)
+  {
+    // Ahead of the file system clock so that the directories changed
+    // implicitly never appear more recent.
+    struct timespec times[2];
+    times[0].tv_sec = time(nullptr) + 3600 + (++mtime_s_);
+    times[0].tv_nsec = 0;
+    times[1] = times[0];
+    utimensat(AT_FDCWD, path.c_str(), times, 0 /* flags */);
+  }
+
+  time_t mtime_s_;
+};
+
+TEST_F(ModelRepositoryManagerTest, ConfigCacheReuse)
+{
+  CreateManager();
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 1u);
+  EXPECT_EQ(ValidateCount(), 1u);
+  EXPECT_EQ(LoadedConfig("model_a").backend(), "normalized");
+
+  // Only a model file changed, the model is reloaded with the cached
+  // configuration.
+  WriteFile({"model_a", "1", "model.txt"}, "new weights");
+  Load("model_a");
+  EXPECT_EQ(LoadCount(), 2u);
+  EXPECT_EQ(NormalizeCount(), 1u);
+  EXPECT_EQ(ValidateCount(), 1u);
+  EXPECT_EQ(LoadedConfig("model_a").name(), "model_a");
+  EXPECT_EQ(LoadedConfig("model_a").backend(), "normalized");
+}
+
+TEST_F(ModelRepositoryManagerTest, ConfigCacheConfigChange)
+{
+  CreateManager();
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 1u);
+
+  WriteFile(
+      {"model_a", "config.pbtxt"}, "name: \"model_a\" max_batch_size: 8");
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 2u);
+  EXPECT_EQ(ValidateCount(), 2u);
+  EXPECT_EQ(LoadedConfig("model_a").max_batch_size(), 8);
+
+  // The changed configuration is cached in turn.
+  WriteFile({"model_a", "1", "model.txt"}, "new weights");
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 2u);
+  EXPECT_EQ(LoadedConfig("model_a").max_batch_size(), 8);
+}
+
+TEST_F(ModelRepositoryManagerTest, ConfigCacheLayoutChange)
+{
+  // Normalization depends on the version directories, adding one
+  // invalidates the cached configuration.
+  CreateManager();
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 1u);
+
+  MakeVersion("model_a", "2");
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 2u);
+  EXPECT_EQ(ValidateCount(), 2u);
+}
+
+TEST_F(ModelRepositoryManagerTest, ConfigCacheInvalidConfig)
+{
+  CreateManager();
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 1u);
+
+  // A configuration that can't be parsed fails the load instead of
+  // being served from the cache.
+  WriteFile({"model_a", "config.pbtxt"}, "name: ");
+  EXPECT_FALSE(manager_
+                   ->LoadUnloadModel(
+                       {{"model_a", {}}}, tc::ActionType::LOAD,
+                       false /* unload_dependents */)
+                   .IsOk());
+  EXPECT_EQ(NormalizeCount(), 1u);
+}
+
+TEST_F(ModelRepositoryManagerTest, SnapshotRestore)
+{
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  ASSERT_OK(manager_->WriteSnapshot());
+  EXPECT_EQ(NormalizeCount(), 1u);
+  EXPECT_EQ(ValidateCount(), 1u);
+
+  // The model is unchanged since the snapshot, it is restored without
+  // normalizing or validating its configuration.
+  recorder.Reset();
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  EXPECT_EQ(LoadCount(), 1u);
+  EXPECT_EQ(NormalizeCount(), 0u);
+  EXPECT_EQ(ValidateCount(), 0u);
+  EXPECT_EQ(LoadedConfig("model_a").name(), "model_a");
+  EXPECT_EQ(LoadedConfig("model_a").backend(), "normalized");
+}
+
+TEST_F(ModelRepositoryManagerTest, SnapshotModifiedConfig)
+{
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  ASSERT_OK(manager_->WriteSnapshot());
+
+  WriteFile(
+      {"model_a", "config.pbtxt"}, "name: \"model_a\" max_batch_size: 8");
+  recorder.Reset();
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 1u);
+  EXPECT_EQ(ValidateCount(), 1u);
+  EXPECT_EQ(LoadedConfig("model_a").max_batch_size(), 8);
+}
+
+TEST_F(ModelRepositoryManagerTest, SnapshotModifiedLayout)
+{
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  ASSERT_OK(manager_->WriteSnapshot());
+
+  // The configuration is unchanged but the modification time of the
+  // model directory moved, the model is not restored and its
+  // configuration is normalized against the new layout.
+  MakeVersion("model_a", "2");
+  recorder.Reset();
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 1u);
+  EXPECT_EQ(ValidateCount(), 1u);
+}
+
+TEST_F(ModelRepositoryManagerTest, SnapshotMovedRepository)
+{
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  ASSERT_OK(manager_->WriteSnapshot());
+  manager_.reset();
+
+  // The model files keep their modification time but not their path.
+  const std::string moved = tc::JoinPath({dir_, "moved"});
+  ASSERT_EQ(std::rename(repo_.c_str(), moved.c_str()), 0);
+  repo_ = moved;
+  recorder.Reset();
+  CreateManager(true /* snapshot */);
+  Load("model_a");
+  EXPECT_EQ(NormalizeCount(), 1u);
+  EXPECT_EQ(ValidateCount(), 1u);
+}
+
+TEST_F(ModelRepositoryManagerTest, DependentLoadNotBlocked)
+{
+  // The ensemble is loaded as soon as its composing model is, while
+  // the unrelated slow model is still loading.
+  AddModel("model_b");
+  AddModel("ensemble_c", {"model_b"});
+  AddModel("model_slow");
+  recorder.load_delay_ms_["model_b"] = 20;
+  recorder.load_delay_ms_["model_slow"] = 500;
+  CreateManager(false /* snapshot */, 4 /* load_thread_count */, {"*"});
+
+  EXPECT_EQ(LoadCount(), 4u);
+  EXPECT_TRUE(IsLoaded("ensemble_c"));
+  EXPECT_LT(EventIndex("loaded model_b"), EventIndex("load ensemble_c"));
+  EXPECT_LT(EventIndex("loaded ensemble_c"), EventIndex("loaded model_slow"));
+}
+
+TEST_F(ModelRepositoryManagerTest, LoadThreadCountBound)
+{
+  // Loads waiting for a load thread, including the ensembles released
+  // by a completed load, never exceed the number of load threads.
+  for (size_t idx = 0; idx < 6; ++idx) {
+    const std::string model = "model_" + std::to_string(idx);
+    AddModel(model);
+    AddModel("ensemble_" + std::to_string(idx), {model});
+    recorder.load_delay_ms_[model] = 20;
+  }
+  CreateManager(false /* snapshot */, 2 /* load_thread_count */, {"*"});
+
+  EXPECT_EQ(LoadCount(), 13u);
+  std::lock_guard<std::mutex> lk(recorder.mu_);
+  EXPECT_EQ(recorder.max_inflight_count_, 2u);
+  EXPECT_EQ(recorder.inflight_count_, 0u);
+}
+
+TEST_F(ModelRepositoryManagerTest, FailedUpstream)
+{
+  AddModel("model_b");
+  AddModel("ensemble_c", {"model_b"});
+  AddModel("ensemble_d", {"ensemble_c"});
+  CreateManager();
+
+  // The ensembles depending, directly or not, on a model failing to
+  // load are not loaded and the load fails.
+  recorder.failing_loads_.insert("model_b");
+  const tc::Status status = manager_->LoadUnloadModel(
+      {{"ensemble_d", {}}}, tc::ActionType::LOAD,
+      false /* unload_dependents */);
+  EXPECT_FALSE(status.IsOk());
+  EXPECT_NE(
+      status.Message().find("load failed for model 'ensemble_d'"),
+      std::string::npos)
+      << status.Message();
+  EXPECT_LT(EventIndex("failed model_b"), EventCount());
+  EXPECT_EQ(EventIndex("load ensemble_c"), EventCount());
+  EXPECT_EQ(EventIndex("load ensemble_d"), EventCount());
+  EXPECT_FALSE(IsLoaded("ensemble_c"));
+  EXPECT_FALSE(IsLoaded("ensemble_d"));
+
+  // Loaded ensembles are unloaded when their composing model fails to
+  // load again.
+  recorder.Reset();
+  Load("ensemble_d");
+  EXPECT_TRUE(IsLoaded("ensemble_c"));
+  EXPECT_TRUE(IsLoaded("ensemble_d"));
+  recorder.failing_loads_.insert("model_b");
+  WriteFile({"model_b", "1", "model.txt"}, "new weights");
+  EXPECT_FALSE(manager_
+                   ->LoadUnloadModel(
+                       {{"ensemble_d", {}}}, tc::ActionType::LOAD,
+                       false /* unload_dependents */)
+                   .IsOk());
+  EXPECT_LT(EventIndex("unload ensemble_c"), EventCount());
+  EXPECT_LT(EventIndex("unload ensemble_d"), EventCount());
+  EXPECT_FALSE(IsLoaded("ensemble_c"));
+  EXPECT_FALSE(IsLoaded("ensemble_d"));
+}
+
+TEST_F(ModelRepositoryManagerTest, CriticalPathLog)
+{
+  // The chain of the two ensembles, each loaded after the previous
+  // model, takes longer than the slowest model alone.
+  AddModel("model_b");
+  AddModel("ensemble_c", {"model_b"});
+  AddModel("ensemble_d", {"ensemble_c"});
+  AddModel("model_slow");
+  recorder.load_delay_ms_["model_b"] = 100;
+  recorder.load_delay_ms_["ensemble_c"] = 100;
+  recorder.load_delay_ms_["ensemble_d"] = 100;
+  recorder.load_delay_ms_["model_slow"] = 200;
+
+  std::stringstream log;
+  std::streambuf* cerr_buf = std::cerr.rdbuf(log.rdbuf());
+  CreateManager(false /* snapshot */, 4 /* load_thread_count */, {"*"});
+  std::cerr.rdbuf(cerr_buf);
+
+  EXPECT_NE(log.str().find("Loaded 5 model(s)"), std::string::npos)
+      << log.str();
+  EXPECT_NE(
+      log.str().find(" ms: model_b -> ensemble_c -> ensemble_d"),
+      std::string::npos)
+      << log.str();
+}
+#endif  // __linux__
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,417 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "filesystem.h"
+#include "infer_request.h"
+#include "model.h"
+#include "model_config_utils.h"
+#include "normalize_cache.h"
+
+namespace tc = triton::core;
+
+/* Mock functions for Unit Testing */
+namespace triton { namespace core {
+
+// The model configurations are constructed by the test, skip the
+// validation and label loading done by Model::Init.
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+std::string
+JoinPath(std::initializer_list<std::string> segments)
+{
+  std::string path;
+  for (const auto& segment : segments) {
+    path += (path.empty() ? "" : "/") + segment;
+  }
+  return path;
+}
+
+Status
+ReadTextFile(const std::string& path, std::string* contents)
+{
+  return Status(Status::Code::NOT_FOUND, "no file '" + path + "'");
+}
+
+}}  // namespace triton::core
+
+namespace {
+
+struct TestInput {
+  std::string name_;
+  int32_t datatype_;
+  std::vector<int64_t> shape_;
+};
+
+std::string
+Signature(
+    const std::vector<TestInput>& inputs,
+    const std::vector<std::string>& outputs = {})
+{
+  std::string signature;
+  for (const auto& input : inputs) {
+    tc::NormalizeCache::AppendInputSignature(
+        input.name_, input.datatype_, input.shape_, &signature);
+  }
+  for (const auto& output : outputs) {
+    tc::NormalizeCache::AppendOutputSignature(output, &signature);
+  }
+  return signature;
+}
+
+std::shared_ptr<const tc::NormalizeCache::Entry>
+Entry(const uint64_t batch_size)
+{
+  std::shared_ptr<tc::NormalizeCache::Entry> entry =
+      std::make_shared<tc::NormalizeCache::Entry>();
+  entry->batch_size_ = batch_size;
+  return entry;
+}
+
+// A batching model with a reshaped input and a shape tensor input.
+inference::ModelConfig
+BatchingConfig()
+{
+  inference::ModelConfig config;
+  config.set_name("normalize_model");
+  config.set_max_batch_size(8);
+  auto input = config.add_input();
+  input->set_name("INPUT0");
+  input->set_data_type(inference::TYPE_FP32);
+  input->add_dims(16);
+  input->mutable_reshape()->add_shape(4);
+  input->mutable_reshape()->add_shape(4);
+  input = config.add_input();
+  input->set_name("SHAPE0");
+  input->set_data_type(inference::TYPE_INT32);
+  input->add_dims(2);
+  input->set_is_shape_tensor(true);
+  auto output = config.add_output();
+  output->set_name("OUTPUT0");
+  output->set_data_type(inference::TYPE_FP32);
+  output->add_dims(16);
+  return config;
+}
+
+// Model exposing how a backend updates the model configuration.
+class TestModel : public tc::Model {
+ public:
+  using tc::Model::Model;
+  using tc::Model::SetModelConfig;
+};
+
+std::shared_ptr<TestModel>
+InitModel(const inference::ModelConfig& config)
+{
+  std::shared_ptr<TestModel> model =
+      std::make_shared<TestModel>(0.0, "", 1, config);
+  EXPECT_TRUE(model->Init(true).IsOk());
+  return model;
+}
+
+// Create a request for 'model' with a batch of 'batch_size', adding
+// the inputs in the given order, and prepare it for inference.
+std::unique_ptr<tc::InferenceRequest>
+PreparedRequest(
+    const std::shared_ptr<tc::Model>& model, const int64_t batch_size,
+    const bool shape_first, tc::Status* status)
+{
+  std::unique_ptr<tc::InferenceRequest> request(
+      new tc::InferenceRequest(model, 1));
+  const std::vector<int64_t> input_shape{batch_size, 16};
+  const std::vector<int64_t> shape_tensor_shape{2};
+  if (shape_first) {
+    request->AddOriginalInput(
+        "SHAPE0", inference::TYPE_INT32, shape_tensor_shape);
+  }
+  request->AddOriginalInput("INPUT0", inference::TYPE_FP32, input_shape);
+  if (!shape_first) {
+    request->AddOriginalInput(
+        "SHAPE0", inference::TYPE_INT32, shape_tensor_shape);
+  }
+  request->AddOriginalRequestedOutput("OUTPUT0");
+  *status = request->PrepareForInference();
+  return request;
+}
+
+// Check the normalization of a request created by PreparedRequest().
+void
+ExpectNormalized(const tc::InferenceRequest& request, const int64_t batch_size)
+{
+  EXPECT_EQ(request.BatchSize(), batch_size);
+  const auto& inputs = request.OriginalInputs();
+  const auto& input = inputs.at("INPUT0");
+  EXPECT_EQ(input.Shape(), std::vector<int64_t>({4, 4}));
+  EXPECT_EQ(
+      input.ShapeWithBatchDim(), std::vector<int64_t>({batch_size, 4, 4}));
+  EXPECT_FALSE(input.IsShapeTensor());
+  const auto& shape_tensor = inputs.at("SHAPE0");
+  EXPECT_EQ(shape_tensor.Shape(), std::vector<int64_t>({2}));
+  EXPECT_TRUE(shape_tensor.IsShapeTensor());
+}
+
+class NormalizeCacheTest : public ::testing::Test {};
+
+TEST_F(NormalizeCacheTest, LookupAfterInsert)
+{
+  tc::NormalizeCache cache;
+  const std::string signature = Signature({{"INPUT0", 8, {4, 16}}});
+
+  EXPECT_EQ(cache.Lookup(signature), nullptr);
+  cache.Insert(signature, cache.Generation(), Entry(4));
+  auto entry = cache.Lookup(signature);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->batch_size_, 4u);
+}
+
+TEST_F(NormalizeCacheTest, SignatureDistinguishesInputs)
+{
+  const std::string base = Signature({{"INPUT0", 8, {4, 16}}});
+  EXPECT_NE(base, Signature({{"INPUT1", 8, {4, 16}}}));
+  EXPECT_NE(base, Signature({{"INPUT0", 9, {4, 16}}}));
+  EXPECT_NE(base, Signature({{"INPUT0", 8, {4, 17}}}));
+  EXPECT_NE(base, Signature({{"INPUT0", 8, {4, 16, 1}}}));
+  EXPECT_NE(base, Signature({{"INPUT0", 8, {4, 16}}}, {"OUTPUT0"}));
+
+  // Length prefixes keep the boundary between names unambiguous.
+  EXPECT_NE(
+      Signature({{"AB", 8, {}}, {"C", 8, {}}}),
+      Signature({{"A", 8, {}}, {"BC", 8, {}}}));
+}
+
+TEST_F(NormalizeCacheTest, ClearWhenFull)
+{
+  tc::NormalizeCache cache(2 /* max_entry_count */);
+  cache.Insert(Signature({{"INPUT0", 8, {1}}}), cache.Generation(), Entry(1));
+  cache.Insert(Signature({{"INPUT0", 8, {2}}}), cache.Generation(), Entry(2));
+  EXPECT_EQ(cache.Size(), 2u);
+
+  // Replacing an existing signature doesn't empty the cache.
+  cache.Insert(Signature({{"INPUT0", 8, {2}}}), cache.Generation(), Entry(2));
+  EXPECT_EQ(cache.Size(), 2u);
+
+  cache.Insert(Signature({{"INPUT0", 8, {3}}}), cache.Generation(), Entry(3));
+  EXPECT_EQ(cache.Size(), 1u);
+  EXPECT_NE(cache.Lookup(Signature({{"INPUT0", 8, {3}}})), nullptr);
+
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0u);
+}
+
+TEST_F(NormalizeCacheTest, DropStaleGeneration)
+{
+  tc::NormalizeCache cache;
+  const std::string signature = Signature({{"INPUT0", 8, {4, 16}}});
+
+  // An entry computed while the cache is cleared is not added.
+  const uint64_t generation = cache.Generation();
+  cache.Clear();
+  cache.Insert(signature, generation, Entry(4));
+  EXPECT_EQ(cache.Lookup(signature), nullptr);
+  EXPECT_EQ(cache.Size(), 0u);
+
+  cache.Insert(signature, cache.Generation(), Entry(4));
+  EXPECT_NE(cache.Lookup(signature), nullptr);
+
+  // Emptying a full cache doesn't start a new generation.
+  tc::NormalizeCache full(1 /* max_entry_count */);
+  const uint64_t full_generation = full.Generation();
+  full.Insert(Signature({{"INPUT0", 8, {1}}}), full_generation, Entry(1));
+  full.Insert(Signature({{"INPUT0", 8, {2}}}), full_generation, Entry(2));
+  EXPECT_EQ(full.Size(), 1u);
+  EXPECT_EQ(full.Generation(), full_generation);
+}
+
+TEST_F(NormalizeCacheTest, NormalizeHit)
+{
+  std::shared_ptr<TestModel> model = InitModel(BatchingConfig());
+  tc::NormalizeCache* cache = model->MutableNormalizeCache();
+
+  tc::Status status;
+  auto first = PreparedRequest(model, 2, false /* shape_first */, &status);
+  ASSERT_TRUE(status.IsOk()) << status.AsString();
+  ExpectNormalized(*first, 2);
+  EXPECT_EQ(cache->Size(), 1u);
+
+  // A new request with the same signature, its inputs added in a
+  // different order, is given the cached shapes and shape tensor
+  // flags without adding an entry.
+  auto second = PreparedRequest(model, 2, true /* shape_first */, &status);
+  ASSERT_TRUE(status.IsOk()) << status.AsString();
+  ExpectNormalized(*second, 2);
+  EXPECT_EQ(cache->Size(), 1u);
+
+  // A different batch size is a different signature.
+  auto third = PreparedRequest(model, 3, false /* shape_first */, &status);
+  ASSERT_TRUE(status.IsOk()) << status.AsString();
+  ExpectNormalized(*third, 3);
+  EXPECT_EQ(cache->Size(), 2u);
+}
+
+TEST_F(NormalizeCacheTest, NormalizeUsesCachedEntry)
+{
+  // The cached result is applied as is, which shows that a hit skips
+  // the validation against the model configuration.
+  std::shared_ptr<TestModel> model = InitModel(BatchingConfig());
+  std::string signature;
+  tc::NormalizeCache::AppendInputSignature(
+      "INPUT0", inference::TYPE_FP32, {2, 16}, &signature);
+  tc::NormalizeCache::AppendInputSignature(
+      "SHAPE0", inference::TYPE_INT32, {2}, &signature);
+  tc::NormalizeCache::AppendOutputSignature("OUTPUT0", &signature);
+  std::shared_ptr<tc::NormalizeCache::Entry> entry =
+      std::make_shared<tc::NormalizeCache::Entry>();
+  entry->batch_size_ = 5;
+  entry->inputs_.emplace_back(tc::NormalizeCache::Input{{7}, {5, 7}, false});
+  entry->inputs_.emplace_back(tc::NormalizeCache::Input{{9}, {9}, true});
+  tc::NormalizeCache* cache = model->MutableNormalizeCache();
+  cache->Insert(signature, cache->Generation(), std::move(entry));
+
+  tc::Status status;
+  auto request = PreparedRequest(model, 2, false /* shape_first */, &status);
+  ASSERT_TRUE(status.IsOk()) << status.AsString();
+  EXPECT_EQ(request->BatchSize(), 5u);
+  const auto& inputs = request->OriginalInputs();
+  EXPECT_EQ(inputs.at("INPUT0").Shape(), std::vector<int64_t>({7}));
+  EXPECT_EQ(
+      inputs.at("INPUT0").ShapeWithBatchDim(), std::vector<int64_t>({5, 7}));
+  EXPECT_FALSE(inputs.at("INPUT0").IsShapeTensor());
+  EXPECT_EQ(inputs.at("SHAPE0").Shape(), std::vector<int64_t>({9}));
+  EXPECT_TRUE(inputs.at("SHAPE0").IsShapeTensor());
+}
+
+TEST_F(NormalizeCacheTest, InvalidateOnConfigChange)
+{
+  // Initializing the model clears anything cached before.
+  std::shared_ptr<TestModel> model =
+      std::make_shared<TestModel>(0.0, "", 1, BatchingConfig());
+  tc::NormalizeCache* cache = model->MutableNormalizeCache();
+  cache->Insert(
+      Signature({{"INPUT0", 8, {2, 16}}}), cache->Generation(), Entry(2));
+  EXPECT_EQ(cache->Size(), 1u);
+  ASSERT_TRUE(model->Init(true).IsOk());
+  EXPECT_EQ(cache->Size(), 0u);
+
+  tc::Status status;
+  PreparedRequest(model, 2, false /* shape_first */, &status);
+  ASSERT_TRUE(status.IsOk()) << status.AsString();
+  EXPECT_EQ(cache->Size(), 1u);
+
+  // Without batching the same request is no longer valid, and must
+  // not be accepted from the cache once the configuration is set.
+  inference::ModelConfig config = BatchingConfig();
+  config.set_max_batch_size(0);
+  ASSERT_TRUE(model->SetModelConfig(config).IsOk());
+  EXPECT_EQ(cache->Size(), 0u);
+  PreparedRequest(model, 2, false /* shape_first */, &status);
+  EXPECT_FALSE(status.IsOk());
+  EXPECT_EQ(cache->Size(), 0u);
+
+  // A result derived from the configuration that was replaced while
+  // the request was being normalized is dropped.
+  const uint64_t generation = cache->Generation();
+  ASSERT_TRUE(model->SetModelConfig(BatchingConfig()).IsOk());
+  cache->Insert(Signature({{"INPUT0", 8, {2, 16}}}), generation, Entry(2));
+  EXPECT_EQ(cache->Size(), 0u);
+}
+
+TEST_F(NormalizeCacheTest, NormalizeCost)
+{
+  // Compare the per-request cost of normalizing a typical request
+  // with and without the cache. The request is reused, adding the
+  // inputs again marks it for normalization on every iteration.
+  inference::ModelConfig config;
+  config.set_name("normalize_cost_model");
+  config.set_max_batch_size(8);
+  const std::vector<std::string> names{
+      "input_ids", "attention_mask", "token_type_ids", "position_ids"};
+  for (const auto& name : names) {
+    auto input = config.add_input();
+    input->set_name(name);
+    input->set_data_type(inference::TYPE_INT64);
+    input->add_dims(128);
+  }
+  auto output = config.add_output();
+  output->set_name("logits");
+  output->set_data_type(inference::TYPE_FP32);
+  output->add_dims(2);
+  std::shared_ptr<TestModel> model = InitModel(config);
+
+  tc::InferenceRequest request(model, 1);
+  ASSERT_TRUE(request.AddOriginalRequestedOutput("logits").IsOk());
+  const std::vector<int64_t> shape{8, 128};
+  auto normalize = [&](const bool cached) -> uint64_t {
+    const size_t iterations = 10000;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+      request.RemoveAllOriginalInputs();
+      for (const auto& name : names) {
+        request.AddOriginalInput(name, inference::TYPE_INT64, shape);
+      }
+      if (!cached) {
+        model->MutableNormalizeCache()->Clear();
+      }
+      EXPECT_TRUE(request.PrepareForInference().IsOk());
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start)
+               .count() /
+           iterations;
+  };
+
+  const uint64_t uncached_ns = normalize(false);
+  const uint64_t cached_ns = normalize(true);
+  EXPECT_EQ(request.BatchSize(), 8u);
+  std::cout << "prepare for inference: " << uncached_ns
+            << " ns per request validated, " << cached_ns
+            << " ns per request cached" << std::endl;
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,243 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "filesystem.h"
+#include "parallel_download.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// In-memory object store standing in for a remote file system. Tracks
+// the requests made and the peak number of concurrent reads.
+class MockObjectStore {
+ public:
+  void Put(const std::string& path, const std::string& content)
+  {
+    objects_[path] = content;
+  }
+
+  tc::Status ByteSize(const std::string& path, uint64_t* byte_size)
+  {
+    auto it = objects_.find(path);
+    if (it == objects_.end()) {
+      return tc::Status(tc::Status::Code::NOT_FOUND, "no object " + path);
+    }
+    *byte_size = it->second.size();
+    return tc::Status::Success;
+  }
+
+  tc::Status ReadRange(
+      const std::string& path, const uint64_t offset, const uint64_t byte_size,
+      std::ostream* out)
+  {
+    const int concurrent = ++concurrent_reads_;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      peak_concurrent_reads_ = std::max(peak_concurrent_reads_, concurrent);
+      ranges_.emplace_back(path, std::make_pair(offset, byte_size));
+    }
+    // Simulate the latency of a remote read
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    --concurrent_reads_;
+
+    if (path == fail_path_) {
+      return tc::Status(tc::Status::Code::INTERNAL, "read failed");
+    }
+    const auto& content = objects_.at(path);
+    if ((offset + byte_size) > content.size()) {
+      return tc::Status(tc::Status::Code::INVALID_ARG, "invalid range");
+    }
+    // Short read if requested
+    const uint64_t size = (path == short_path_) ? (byte_size / 2) : byte_size;
+    out->write(content.data() + offset, size);
+    return tc::Status::Success;
+  }
+
+  tc::ParallelDownloader::ByteSizeFn ByteSizeFn()
+  {
+    return [this](const std::string& path, uint64_t* byte_size) {
+      return ByteSize(path, byte_size);
+    };
+  }
+  tc::ParallelDownloader::ReadRangeFn ReadRangeFn()
+  {
+    return [this](
+               const std::string& path, const uint64_t offset,
+               const uint64_t byte_size, std::ostream* out) {
+      return ReadRange(path, offset, byte_size, out);
+    };
+  }
+
+  std::map<std::string, std::string> objects_;
+  std::string fail_path_;
+  std::string short_path_;
+
+  std::atomic<int> concurrent_reads_{0};
+  std::mutex mu_;
+  int peak_concurrent_reads_ = 0;
+  std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> ranges_;
+};
+
+std::string
+Content(const size_t byte_size, const char seed)
+{
+  std::string content(byte_size, '\0');
+  for (size_t i = 0; i < byte_size; ++i) {
+    content[i] = static_cast<char>(seed + (i % 61));
+  }
+  return content;
+}
+
+std::string
+ReadFile(const std::string& path)
+{
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+class ParallelDownloadTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    ASSERT_TRUE(tc::MakeTemporaryDirectory(tc::FileSystemType::LOCAL, &dir_)
+                    .IsOk());
+  }
+  void TearDown() override { tc::DeletePath(dir_); }
+
+  std::string dir_;
+  MockObjectStore store_;
+};
+
+TEST_F(ParallelDownloadTest, DownloadFilesConcurrently)
+{
+  std::vector<std::pair<std::string, std::string>> files;
+  for (int i = 0; i < 8; ++i) {
+    const std::string name = "file" + std::to_string(i);
+    store_.Put("mock://bucket/" + name, Content(100 + i, 'a' + i));
+    files.emplace_back("mock://bucket/" + name, tc::JoinPath({dir_, name}));
+  }
+  store_.Put("mock://bucket/empty", "");
+  files.emplace_back("mock://bucket/empty", tc::JoinPath({dir_, "empty"}));
+
+  tc::ParallelDownloader downloader(4, 1024);
+  auto status =
+      downloader.Download(files, store_.ByteSizeFn(), store_.ReadRangeFn());
+  ASSERT_TRUE(status.IsOk()) << status.Message();
+
+  for (const auto& file : files) {
+    EXPECT_EQ(ReadFile(file.second), store_.objects_[file.first])
+        << file.first;
+  }
+  // Each non-empty file is fetched with a single request
+  EXPECT_EQ(store_.ranges_.size(), 8u);
+  EXPECT_GT(store_.peak_concurrent_reads_, 1);
+  EXPECT_LE(store_.peak_concurrent_reads_, 4);
+}
+
+TEST_F(ParallelDownloadTest, DownloadLargeFileInParts)
+{
+  const std::string content = Content(10 * 1000 + 500, 'A');
+  store_.Put("mock://bucket/model.bin", content);
+  const auto local_path = tc::JoinPath({dir_, "model.bin"});
+
+  tc::ParallelDownloader downloader(4, 1000);
+  auto status = downloader.Download(
+      {{"mock://bucket/model.bin", local_path}}, store_.ByteSizeFn(),
+      store_.ReadRangeFn());
+  ASSERT_TRUE(status.IsOk()) << status.Message();
+  EXPECT_EQ(ReadFile(local_path), content);
+
+  // The parts cover the object without overlap
+  ASSERT_EQ(store_.ranges_.size(), 11u);
+  std::sort(store_.ranges_.begin(), store_.ranges_.end());
+  uint64_t next_offset = 0;
+  for (const auto& range : store_.ranges_) {
+    EXPECT_EQ(range.second.first, next_offset);
+    EXPECT_LE(range.second.second, 1000u);
+    next_offset += range.second.second;
+  }
+  EXPECT_EQ(next_offset, content.size());
+  EXPECT_GT(store_.peak_concurrent_reads_, 1);
+}
+
+TEST_F(ParallelDownloadTest, ReportFailure)
+{
+  std::vector<std::pair<std::string, std::string>> files;
+  for (int i = 0; i < 4; ++i) {
+    const std::string name = "file" + std::to_string(i);
+    store_.Put("mock://bucket/" + name, Content(5000, 'a'));
+    files.emplace_back("mock://bucket/" + name, tc::JoinPath({dir_, name}));
+  }
+  files.emplace_back("mock://bucket/missing", tc::JoinPath({dir_, "missing"}));
+
+  tc::ParallelDownloader downloader(2, 1000);
+  auto status =
+      downloader.Download(files, store_.ByteSizeFn(), store_.ReadRangeFn());
+  EXPECT_FALSE(status.IsOk());
+  EXPECT_NE(status.Message().find("missing"), std::string::npos)
+      << status.Message();
+
+  store_.fail_path_ = "mock://bucket/file1";
+  files.pop_back();
+  status =
+      downloader.Download(files, store_.ByteSizeFn(), store_.ReadRangeFn());
+  EXPECT_FALSE(status.IsOk());
+  EXPECT_EQ(status.Message(), "read failed");
+}
+
+TEST_F(ParallelDownloadTest, ReportShortRead)
+{
+  store_.Put("mock://bucket/model.bin", Content(3000, 'a'));
+  store_.short_path_ = "mock://bucket/model.bin";
+
+  tc::ParallelDownloader downloader(2, 1000);
+  auto status = downloader.Download(
+      {{"mock://bucket/model.bin", tc::JoinPath({dir_, "model.bin"})}},
+      store_.ByteSizeFn(), store_.ReadRangeFn());
+  EXPECT_FALSE(status.IsOk());
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -26,7 +26,9 @@
 #include "gtest/gtest.h"
 
 #include <cuda_runtime_api.h>
+#include <chrono>
 #include <condition_variable>
+#include <cstring>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -136,10 +138,15 @@ RunMemoryWork(
   }
 }
 
-// Wrapper of PinnedMemoryManager class to expose Reset() for unit testing
+// Wrapper of PinnedMemoryManager class to expose Reset() and
+// IsHugePageMemory() for unit testing
 class TestingPinnedMemoryManager : public tc::PinnedMemoryManager {
  public:
   static void Reset() { PinnedMemoryManager::Reset(); }
+  static bool IsHugePageMemory(const void* ptr)
+  {
+    return PinnedMemoryManager::IsHugePageMemory(ptr);
+  }
 };
 
 class PinnedMemoryManagerTest : public ::testing::Test {
@@ -230,6 +237,99 @@ TEST_F(PinnedMemoryManagerTest, AllocFail)
   ASSERT_FALSE(status.IsOk()) << "Unexpected successful allocation";
 }
 
+TEST_F(PinnedMemoryManagerTest, AllocHugePageFallback)
+{
+  options_.huge_page_pool_byte_size_ = uint64_t(1) << 23 /* 8 MB */;
+  options_.huge_page_threshold_byte_size_ = uint64_t(1) << 20 /* 1 MB */;
+  auto status = tc::PinnedMemoryManager::Create(options_);
+  ASSERT_TRUE(status.IsOk()) << status.Message();
+
+  // Allocations above the threshold come from the huge page pool until
+  // it is exhausted, then from regular system memory. The pool keeps
+  // a header and a per-allocation header out of its 8 MB, so it holds
+  // 7 of the 1 MB allocations.
+  const size_t pool_alloc_count = 7;
+  std::vector<void*> ptrs;
+  for (size_t idx = 0; idx < 10; idx++) {
+    void* ptr = nullptr;
+    TRITONSERVER_MemoryType allocated_type = TRITONSERVER_MEMORY_GPU;
+    status = tc::PinnedMemoryManager::Alloc(
+        &ptr, uint64_t(1) << 20, &allocated_type,
+        true /* allow_nonpinned_fallback */);
+    ASSERT_TRUE(status.IsOk()) << status.Message();
+    ASSERT_TRUE(ptr) << "Expect pointer to allocated buffer";
+    ASSERT_TRUE(allocated_type == TRITONSERVER_MEMORY_CPU)
+        << "Expect pointer to non-pinned memory";
+    CHECK_POINTER_ATTRIBUTES(ptr, cudaMemoryTypeUnregistered, 0);
+    EXPECT_EQ(
+        TestingPinnedMemoryManager::IsHugePageMemory(ptr),
+        idx < pool_alloc_count)
+        << "allocation " << idx;
+    memset(ptr, idx, uint64_t(1) << 20);
+    ptrs.push_back(ptr);
+  }
+
+  // Allocation below the threshold
+  void* small_ptr = nullptr;
+  TRITONSERVER_MemoryType allocated_type = TRITONSERVER_MEMORY_GPU;
+  status = tc::PinnedMemoryManager::Alloc(
+      &small_ptr, 2048, &allocated_type, true /* allow_nonpinned_fallback */);
+  ASSERT_TRUE(status.IsOk()) << status.Message();
+  EXPECT_FALSE(TestingPinnedMemoryManager::IsHugePageMemory(small_ptr));
+  ptrs.push_back(small_ptr);
+
+  // Freed pool memory is reused for the next large allocation.
+  status = tc::PinnedMemoryManager::Free(ptrs[0]);
+  EXPECT_TRUE(status.IsOk()) << status.Message();
+  status = tc::PinnedMemoryManager::Alloc(
+      &ptrs[0], uint64_t(1) << 20, &allocated_type,
+      true /* allow_nonpinned_fallback */);
+  ASSERT_TRUE(status.IsOk()) << status.Message();
+  EXPECT_TRUE(TestingPinnedMemoryManager::IsHugePageMemory(ptrs[0]));
+
+  for (auto ptr : ptrs) {
+    status = tc::PinnedMemoryManager::Free(ptr);
+    EXPECT_TRUE(status.IsOk()) << status.Message();
+  }
+}
+
+TEST_F(PinnedMemoryManagerTest, HugePageFirstTouch)
+{
+  // Compare the time to allocate and first touch a large non-pinned
+  // buffer with and without the huge page pool. The pool needs room
+  // for its own headers besides the allocation, one more huge page.
+  const uint64_t alloc_size = uint64_t(1) << 28 /* 256 MB */;
+  const uint64_t pool_size = alloc_size + (uint64_t(1) << 21) /* 2 MB */;
+  std::chrono::nanoseconds durations[2];
+  for (size_t use_huge_page = 0; use_huge_page < 2; use_huge_page++) {
+    options_.huge_page_pool_byte_size_ = use_huge_page ? pool_size : 0;
+    options_.huge_page_threshold_byte_size_ = uint64_t(1) << 20;
+    auto status = tc::PinnedMemoryManager::Create(options_);
+    ASSERT_TRUE(status.IsOk()) << status.Message();
+
+    auto start = std::chrono::steady_clock::now();
+    void* ptr = nullptr;
+    TRITONSERVER_MemoryType allocated_type = TRITONSERVER_MEMORY_GPU;
+    status = tc::PinnedMemoryManager::Alloc(
+        &ptr, alloc_size, &allocated_type,
+        true /* allow_nonpinned_fallback */);
+    ASSERT_TRUE(status.IsOk()) << status.Message();
+    memset(ptr, 1, alloc_size);
+    durations[use_huge_page] = std::chrono::steady_clock::now() - start;
+    // Otherwise both arms would time malloc.
+    ASSERT_EQ(
+        TestingPinnedMemoryManager::IsHugePageMemory(ptr), use_huge_page == 1)
+        << "the huge page arm must be served from the pool";
+
+    status = tc::PinnedMemoryManager::Free(ptr);
+    EXPECT_TRUE(status.IsOk()) << status.Message();
+    TestingPinnedMemoryManager::Reset();
+  }
+  std::cout << "256 MB alloc and first touch: regular pages "
+            << durations[0].count() / 1000 << " us, huge page pool "
+            << durations[1].count() / 1000 << " us" << std::endl;
+}
+
 TEST_F(PinnedMemoryManagerTest, MultipleAlloc)
 {
   auto status = tc::PinnedMemoryManager::Create(options_);
@@ -0,0 +1,587 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "backend_model.h"
+#include "backend_model_instance.h"
+#include "rate_limiter.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Called by every instance for each payload it executes, with the
+// instance executing it.
+std::function<void(tc::TritonModelInstance*)> schedule_hook;
+
+}  // namespace
+
+/* Mock classes for Unit Testing */
+namespace triton { namespace core {
+
+// The model configurations are constructed by the test, skip the
+// validation and label loading done by Model::Init.
+Status
+ValidateModelConfig(
+    const inference::ModelConfig& config, const double min_compute_capability)
+{
+  return Status::Success;
+}
+
+Status
+ValidateModelIOConfig(const inference::ModelConfig& config)
+{
+  return Status::Success;
+}
+
+std::string
+JoinPath(std::initializer_list<std::string> segments)
+{
+  std::string path;
+  for (const auto& segment : segments) {
+    path += (path.empty() ? "" : "/") + segment;
+  }
+  return path;
+}
+
+Status
+ReadTextFile(const std::string& path, std::string* contents)
+{
+  return Status(Status::Code::NOT_FOUND, "no file '" + path + "'");
+}
+
+//
+// TritonModel, only holds the configuration and the instances.
+//
+TritonModel::TritonModel(
+    InferenceServer* server,
+    const std::shared_ptr<LocalizedPath>& localized_model_dir,
+    const std::shared_ptr<TritonBackend>& backend,
+    const double min_compute_capability, const int64_t version,
+    const inference::ModelConfig& config, const bool auto_complete_config,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map)
+    : Model(min_compute_capability, "", version, config), server_(server),
+      min_compute_capability_(min_compute_capability),
+      auto_complete_config_(auto_complete_config),
+      backend_cmdline_config_map_(backend_cmdline_config_map),
+      host_policy_map_(host_policy_map), device_blocking_(false),
+      localized_model_dir_(localized_model_dir), backend_(backend),
+      state_(nullptr)
+{
+}
+
+TritonModel::~TritonModel()
+{
+  instances_.clear();
+}
+
+Status
+TritonModel::Create(
+    InferenceServer* server, const std::string& model_path,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map,
+    const int64_t version, inference::ModelConfig model_config,
+    const bool is_config_provided, std::unique_ptr<TritonModel>* model)
+{
+  model->reset(new TritonModel(
+      server, nullptr /* localized_model_dir */, nullptr /* backend */,
+      0 /* min_compute_capability */, version, model_config,
+      false /* auto_complete_config */, backend_cmdline_config_map,
+      host_policy_map));
+  return TritonModelInstance::SetInstances(
+      model->get(), backend_cmdline_config_map, host_policy_map, model_config);
+}
+
+Status
+TritonModel::RegisterInstance(
+    std::shared_ptr<TritonModelInstance>&& instance, const bool passive)
+{
+  instances_.emplace_back(std::move(instance));
+  return Status::Success;
+}
+
+//
+// TritonModelInstance, executes payloads by calling 'schedule_hook'.
+//
+TritonModelInstance::TritonModelInstance(
+    TritonModel* model, const std::string& name, const Signature& signature,
+    const TRITONSERVER_InstanceGroupKind kind, const int32_t device_id,
+    const std::vector<std::string>& profile_names, const bool passive,
+    const triton::common::HostPolicyCmdlineConfig& host_policy,
+    const TritonServerMessage& host_policy_message,
+    const std::vector<SecondaryDevice>& secondary_devices)
+    : model_(model), name_(name), signature_(signature), kind_(kind),
+      device_id_(device_id), host_policy_(host_policy),
+      host_policy_message_(host_policy_message),
+      profile_names_(profile_names), passive_(passive),
+      secondary_devices_(secondary_devices), state_(nullptr),
+      warmup_duration_ns_(0)
+{
+}
+
+TritonModelInstance::~TritonModelInstance() {}
+
+// Creates 'count' instances of the first instance group, using the
+// host policy named after the group if there is one.
+Status
+TritonModelInstance::SetInstances(
+    TritonModel* model,
+    const triton::common::BackendCmdlineConfigMap& backend_cmdline_config_map,
+    const triton::common::HostPolicyCmdlineConfigMap& host_policy_map,
+    const inference::ModelConfig& model_config)
+{
+  const auto& group = model_config.instance_group(0);
+  triton::common::HostPolicyCmdlineConfig host_policy;
+  const auto itr = host_policy_map.find(group.name());
+  if (itr != host_policy_map.end()) {
+    host_policy = itr->second;
+  }
+  for (int32_t c = 0; c < group.count(); ++c) {
+    const std::string name = group.name() + "_" + std::to_string(c);
+    std::shared_ptr<TritonModelInstance> instance(new TritonModelInstance(
+        model, name, Signature(group, 0 /* device_id */),
+        TRITONSERVER_INSTANCEGROUPKIND_CPU, 0 /* device_id */,
+        {} /* profile_names */, false /* passive */, host_policy,
+        TritonServerMessage(std::string("{}")), {} /* secondary_devices */));
+    RETURN_IF_ERROR(model->RegisterInstance(std::move(instance), false));
+  }
+  return Status::Success;
+}
+
+Status
+TritonModelInstance::Initialize()
+{
+  return Status::Success;
+}
+
+Status
+TritonModelInstance::WarmUp()
+{
+  return Status::Success;
+}
+
+void
+TritonModelInstance::Schedule(
+    std::vector<std::unique_ptr<InferenceRequest>>&& requests,
+    const std::function<void()>& OnCompletion)
+{
+  if (schedule_hook) {
+    schedule_hook(this);
+  }
+  OnCompletion();
+}
+
+}}  // namespace triton::core
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+// Simple latch to hold a payload in execution.
+class Gate {
+ public:
+  Gate() : open_(false) {}
+  void Open()
+  {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      open_ = true;
+    }
+    cv_.notify_all();
+  }
+  void Wait()
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this]() { return open_; });
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool open_;
+};
+
+class RateLimiterTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    ASSERT_OK(tc::RateLimiter::Create(
+        true /* ignore_resources_and_priority */, {}, &rate_limiter_));
+  }
+
+  void TearDown() override
+  {
+    for (auto& thread : backend_threads_) {
+      thread.join();
+    }
+    schedule_hook = nullptr;
+  }
+
+  // Create a model named 'name' with 'count' instances registered with
+  // the rate limiter, using 'host_policy_map' for the instances.
+  void CreateModel(
+      const std::string& name, const int32_t count,
+      std::unique_ptr<tc::TritonModel>* model,
+      const triton::common::HostPolicyCmdlineConfigMap& host_policy_map = {})
+  {
+    inference::ModelConfig config;
+    config.set_name(name);
+    auto group = config.add_instance_group();
+    group->set_name(name);
+    group->set_count(count);
+    ASSERT_OK(tc::TritonModel::Create(
+        nullptr /* server */, "", {}, host_policy_map, 1, config,
+        true /* is_config_provided */, model));
+    for (const auto& instance : (*model)->Instances()) {
+      ASSERT_OK(rate_limiter_->RegisterModelInstance(
+          instance.get(), tc::RateLimiter::RateLimiterConfig()));
+    }
+  }
+
+  // Start a thread dequeuing payloads for 'instances' until it receives
+  // an EXIT payload, as the backend thread of the instances does.
+  void StartBackendThread(std::deque<tc::TritonModelInstance*> instances)
+  {
+    backend_threads_.emplace_back([this, instances]() mutable {
+      bool should_exit = false;
+      while (!should_exit) {
+        std::shared_ptr<tc::Payload> payload;
+        rate_limiter_->DequeuePayload(instances, &payload);
+        payload->Execute(&should_exit);
+        instances.push_back(payload->GetInstance());
+        rate_limiter_->PayloadRelease(payload);
+      }
+    });
+  }
+
+  void StopBackendThread(tc::TritonModelInstance* instance)
+  {
+    auto payload =
+        rate_limiter_->GetPayload(tc::Payload::Operation::EXIT, instance);
+    ASSERT_OK(rate_limiter_->EnqueuePayload(instance->Model(), payload));
+  }
+
+  std::shared_ptr<tc::Payload> InferPayload(
+      tc::TritonModelInstance* instance = nullptr)
+  {
+    return rate_limiter_->GetPayload(
+        tc::Payload::Operation::INFER_RUN, instance);
+  }
+
+  // Retry direct execution of 'payload' until a backend thread of
+  // 'model' waits for work.
+  bool ExecuteWhenIdle(
+      tc::TritonModel* model, std::shared_ptr<tc::Payload>& payload)
+  {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+      if (rate_limiter_->ExecutePayloadIfIdle(model, payload)) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  }
+
+  // Wait until the backend thread of 'instance' executed a payload and
+  // had the time to wait for the next one.
+  void WaitUntilIdle(tc::TritonModel* model, tc::TritonModelInstance* instance)
+  {
+    auto payload = InferPayload(instance);
+    ASSERT_OK(rate_limiter_->EnqueuePayload(model, payload));
+    ASSERT_OK(payload->Wait());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  std::unique_ptr<tc::RateLimiter> rate_limiter_;
+  std::vector<std::thread> backend_threads_;
+};
+
+TEST_F(RateLimiterTest, DequeueSpecificPayload)
+{
+  std::unique_ptr<tc::TritonModel> model;
+  CreateModel("specific", 2, &model);
+  auto first = model->Instances()[0].get();
+  auto second = model->Instances()[1].get();
+
+  std::mutex mu;
+  std::vector<tc::TritonModelInstance*> executed;
+  schedule_hook = [&mu, &executed](tc::TritonModelInstance* instance) {
+    std::lock_guard<std::mutex> lk(mu);
+    executed.push_back(instance);
+  };
+
+  // A single thread serves both instances, a payload for one of them
+  // is dequeued for that instance only.
+  StartBackendThread({first, second});
+  auto payload = InferPayload(second);
+  ASSERT_OK(rate_limiter_->EnqueuePayload(model.get(), payload));
+  ASSERT_OK(payload->Wait());
+  payload = InferPayload(first);
+  ASSERT_OK(rate_limiter_->EnqueuePayload(model.get(), payload));
+  ASSERT_OK(payload->Wait());
+  StopBackendThread(first);
+  backend_threads_.back().join();
+  backend_threads_.pop_back();
+
+  ASSERT_EQ(executed.size(), 2u);
+  EXPECT_EQ(executed[0], second);
+  EXPECT_EQ(executed[1], first);
+}
+
+TEST_F(RateLimiterTest, DirectExecution)
+{
+  std::unique_ptr<tc::TritonModel> model;
+  CreateModel("direct", 1, &model);
+  auto instance = model->Instances()[0].get();
+
+  std::thread::id executed_on;
+  schedule_hook = [&executed_on](tc::TritonModelInstance*) {
+    executed_on = std::this_thread::get_id();
+  };
+
+  // Nothing waits for the model until its backend thread started.
+  auto payload = InferPayload();
+  EXPECT_FALSE(rate_limiter_->ExecutePayloadIfIdle(model.get(), payload));
+
+  StartBackendThread({instance});
+  ASSERT_TRUE(ExecuteWhenIdle(model.get(), payload));
+  EXPECT_EQ(executed_on, std::this_thread::get_id());
+
+  StopBackendThread(instance);
+}
+
+TEST_F(RateLimiterTest, DirectInstanceNotDequeued)
+{
+  std::unique_ptr<tc::TritonModel> model;
+  CreateModel("busy", 1, &model);
+  auto instance = model->Instances()[0].get();
+
+  // Hold the direct execution while a payload for the same instance
+  // is enqueued, the backend thread must wait for the direct execution
+  // to finish before taking it.
+  Gate direct_started, release_direct;
+  std::atomic<bool> direct_running(false);
+  std::atomic<bool> queued_executed(false);
+  std::atomic<bool> overlapped(false);
+  const std::thread::id caller = std::this_thread::get_id();
+  schedule_hook = [&](tc::TritonModelInstance*) {
+    if (std::this_thread::get_id() == caller) {
+      direct_running = true;
+      direct_started.Open();
+      release_direct.Wait();
+      direct_running = false;
+    } else {
+      overlapped = overlapped || direct_running;
+      queued_executed = true;
+    }
+  };
+
+  StartBackendThread({instance});
+  auto queued = InferPayload(instance);
+  std::thread enqueuer([&]() {
+    direct_started.Wait();
+    EXPECT_TRUE(rate_limiter_->EnqueuePayload(model.get(), queued).IsOk());
+    // Give the backend thread the chance to wrongly take the payload.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(queued_executed);
+    release_direct.Open();
+  });
+
+  auto payload = InferPayload();
+  ASSERT_TRUE(ExecuteWhenIdle(model.get(), payload));
+  enqueuer.join();
+
+  // The end of the direct execution wakes the backend thread.
+  ASSERT_OK(queued->Wait());
+  EXPECT_TRUE(queued_executed);
+  EXPECT_FALSE(overlapped);
+
+  StopBackendThread(instance);
+}
+
+TEST_F(RateLimiterTest, GenericPayloadSkipsDirectInstance)
+{
+  std::unique_ptr<tc::TritonModel> model;
+  CreateModel("generic", 2, &model);
+  auto first = model->Instances()[0].get();
+  auto second = model->Instances()[1].get();
+
+  // While one instance executes directly, a generic payload is given to
+  // the other instance served by the same thread.
+  Gate direct_started, release_direct;
+  tc::TritonModelInstance* direct_instance = nullptr;
+  tc::TritonModelInstance* queued_instance = nullptr;
+  const std::thread::id caller = std::this_thread::get_id();
+  schedule_hook = [&](tc::TritonModelInstance* instance) {
+    if (std::this_thread::get_id() == caller) {
+      direct_instance = instance;
+      direct_started.Open();
+      release_direct.Wait();
+    } else {
+      queued_instance = instance;
+    }
+  };
+
+  StartBackendThread({first, second});
+  std::thread enqueuer([&]() {
+    direct_started.Wait();
+    auto queued = InferPayload();
+    EXPECT_TRUE(rate_limiter_->EnqueuePayload(model.get(), queued).IsOk());
+    EXPECT_TRUE(queued->Wait().IsOk());
+    release_direct.Open();
+  });
+
+  auto payload = InferPayload();
+  ASSERT_TRUE(ExecuteWhenIdle(model.get(), payload));
+  enqueuer.join();
+  ASSERT_NE(direct_instance, nullptr);
+  ASSERT_NE(queued_instance, nullptr);
+  EXPECT_NE(direct_instance, queued_instance);
+
+  StopBackendThread(first);
+}
+
+TEST_F(RateLimiterTest, NoDirectExecutionOnBackendThread)
+{
+  std::unique_ptr<tc::TritonModel> model_a, model_b;
+  CreateModel("model_a", 1, &model_a);
+  CreateModel("model_b", 1, &model_b);
+  auto instance_a = model_a->Instances()[0].get();
+  auto instance_b = model_b->Instances()[0].get();
+  StartBackendThread({instance_b});
+
+  // A payload of model B enqueued while model A executes, as an
+  // ensemble does from the response callback, is not executed on the
+  // backend thread of model A.
+  std::atomic<bool> tried(false);
+  std::atomic<bool> executed_directly(false);
+  schedule_hook = [&](tc::TritonModelInstance* instance) {
+    if (instance == instance_a) {
+      auto payload = InferPayload();
+      const auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+      while (std::chrono::steady_clock::now() < deadline) {
+        if (rate_limiter_->ExecutePayloadIfIdle(model_b.get(), payload)) {
+          executed_directly = true;
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      tried = true;
+    }
+  };
+
+  StartBackendThread({instance_a});
+  auto payload = InferPayload();
+  ASSERT_OK(rate_limiter_->EnqueuePayload(model_a.get(), payload));
+  ASSERT_OK(payload->Wait());
+  EXPECT_TRUE(tried);
+  EXPECT_FALSE(executed_directly);
+
+  StopBackendThread(instance_a);
+  StopBackendThread(instance_b);
+}
+
+TEST_F(RateLimiterTest, NoDirectExecutionWithHostPolicy)
+{
+  std::unique_ptr<tc::TritonModel> model;
+  CreateModel("numa", 1, &model, {{"numa", {{"numa-node", "0"}}}});
+  auto instance = model->Instances()[0].get();
+  StartBackendThread({instance});
+
+  WaitUntilIdle(model.get(), instance);
+
+  // The payload is left for the backend thread bound by the policy.
+  auto payload = InferPayload();
+  EXPECT_FALSE(rate_limiter_->ExecutePayloadIfIdle(model.get(), payload));
+
+  StopBackendThread(instance);
+}
+
+#ifndef _WIN32
+TEST_F(RateLimiterTest, NoDirectExecutionAtOtherNice)
+{
+  std::unique_ptr<tc::TritonModel> model;
+  CreateModel("nice", 1, &model);
+  auto instance = model->Instances()[0].get();
+  StartBackendThread({instance});
+  WaitUntilIdle(model.get(), instance);
+
+  bool executed = false;
+  std::thread caller([&]() {
+    ASSERT_EQ(setpriority(PRIO_PROCESS, syscall(SYS_gettid), 5), 0);
+    auto payload = InferPayload();
+    executed = rate_limiter_->ExecutePayloadIfIdle(model.get(), payload);
+  });
+  caller.join();
+  EXPECT_FALSE(executed);
+
+  StopBackendThread(instance);
+}
+#endif  // !_WIN32
+
+TEST_F(RateLimiterTest, NoDirectExecutionWithResources)
+{
+  std::unique_ptr<tc::RateLimiter> rate_limiter;
+  ASSERT_OK(tc::RateLimiter::Create(
+      false /* ignore_resources_and_priority */, {}, &rate_limiter));
+  std::unique_ptr<tc::TritonModel> model;
+  CreateModel("resources", 1, &model);
+  auto payload = InferPayload();
+  EXPECT_FALSE(rate_limiter->ExecutePayloadIfIdle(model.get(), payload));
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,178 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "repository_snapshot.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+class RepositorySnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    char dir_template[] = "/tmp/repository_snapshot_testXXXXXX";
+    ASSERT_NE(mkdtemp(dir_template), nullptr);
+    dir_ = dir_template;
+    path_ = dir_ + "/snapshot";
+  }
+  void TearDown() override
+  {
+    std::remove(path_.c_str());
+    rmdir(dir_.c_str());
+  }
+
+  static tc::RepositorySnapshot::Entry MakeEntry(const std::string& name)
+  {
+    tc::RepositorySnapshot::Entry entry;
+    entry.namespace_ = "";
+    entry.name_ = name;
+    entry.model_path_ = "/models/" + name;
+    entry.mtime_nsec_ = std::make_pair(1234567890123456789, -1);
+    entry.is_config_provided_ = true;
+    entry.config_content_ = "name: \"" + name + "\"\n";
+    entry.layout_ = "/models/" + name + "\n1\n\n" + std::string(1, '\0');
+    entry.parsed_config_ = std::string("\x0a\x01x", 3);
+    entry.normalized_config_ = std::string(300, '\xff');
+    return entry;
+  }
+
+  std::string dir_;
+  std::string path_;
+};
+
+TEST_F(RepositorySnapshotTest, RoundTrip)
+{
+  std::vector<tc::RepositorySnapshot::Entry> entries{
+      MakeEntry("a"), MakeEntry("b")};
+  entries[1].is_config_provided_ = false;
+  entries[1].config_content_.clear();
+  ASSERT_TRUE(tc::RepositorySnapshot::Write(path_, "key", entries).IsOk());
+
+  std::vector<tc::RepositorySnapshot::Entry> read_entries;
+  auto status = tc::RepositorySnapshot::Read(path_, "key", &read_entries);
+  ASSERT_TRUE(status.IsOk()) << status.Message();
+  ASSERT_EQ(read_entries.size(), entries.size());
+  for (size_t idx = 0; idx < entries.size(); ++idx) {
+    const auto& expected = entries[idx];
+    const auto& actual = read_entries[idx];
+    EXPECT_EQ(actual.namespace_, expected.namespace_);
+    EXPECT_EQ(actual.name_, expected.name_);
+    EXPECT_EQ(actual.model_path_, expected.model_path_);
+    EXPECT_EQ(actual.mtime_nsec_, expected.mtime_nsec_);
+    EXPECT_EQ(actual.is_config_provided_, expected.is_config_provided_);
+    EXPECT_EQ(actual.config_content_, expected.config_content_);
+    EXPECT_EQ(actual.layout_, expected.layout_);
+    EXPECT_EQ(actual.parsed_config_, expected.parsed_config_);
+    EXPECT_EQ(actual.normalized_config_, expected.normalized_config_);
+  }
+}
+
+TEST_F(RepositorySnapshotTest, Missing)
+{
+  std::vector<tc::RepositorySnapshot::Entry> entries;
+  auto status = tc::RepositorySnapshot::Read(path_, "key", &entries);
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::NOT_FOUND);
+}
+
+TEST_F(RepositorySnapshotTest, KeyMismatch)
+{
+  ASSERT_TRUE(
+      tc::RepositorySnapshot::Write(path_, "key", {MakeEntry("a")}).IsOk());
+
+  std::vector<tc::RepositorySnapshot::Entry> entries;
+  auto status = tc::RepositorySnapshot::Read(path_, "other", &entries);
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::INVALID_ARG);
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST_F(RepositorySnapshotTest, Truncated)
+{
+  ASSERT_TRUE(
+      tc::RepositorySnapshot::Write(path_, "key", {MakeEntry("a")}).IsOk());
+  std::string contents;
+  {
+    std::ifstream in(path_, std::ios::binary);
+    contents.assign(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  // Every prefix of the snapshot, and the snapshot with trailing data,
+  // is malformed.
+  for (size_t size = 0; size < contents.size(); ++size) {
+    {
+      std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+      out.write(contents.data(), size);
+    }
+    std::vector<tc::RepositorySnapshot::Entry> entries;
+    auto status = tc::RepositorySnapshot::Read(path_, "key", &entries);
+    EXPECT_EQ(status.StatusCode(), tc::Status::Code::INVALID_ARG)
+        << "prefix of " << size << " bytes";
+    EXPECT_TRUE(entries.empty()) << "prefix of " << size << " bytes";
+  }
+  {
+    std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size());
+    out.put('x');
+  }
+  std::vector<tc::RepositorySnapshot::Entry> entries;
+  auto status = tc::RepositorySnapshot::Read(path_, "key", &entries);
+  EXPECT_EQ(status.StatusCode(), tc::Status::Code::INVALID_ARG);
+}
+
+TEST_F(RepositorySnapshotTest, Replace)
+{
+  ASSERT_TRUE(tc::RepositorySnapshot::Write(
+                  path_, "key", {MakeEntry("a"), MakeEntry("b")})
+                  .IsOk());
+  ASSERT_TRUE(
+      tc::RepositorySnapshot::Write(path_, "key", {MakeEntry("c")}).IsOk());
+
+  std::vector<tc::RepositorySnapshot::Entry> entries;
+  ASSERT_TRUE(tc::RepositorySnapshot::Read(path_, "key", &entries).IsOk());
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0].name_, "c");
+
+  // No temporary file is left behind.
+  std::ifstream temp(path_ + ".tmp." + std::to_string(getpid()));
+  EXPECT_FALSE(temp.good());
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
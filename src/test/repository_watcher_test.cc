@@ -0,0 +1,177 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include "filesystem.h"
+#include "repository_watcher.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+#ifdef __linux__
+tc::Status
+WriteFile(const std::string& path, const std::string& contents)
+{
+  return tc::WriteBinaryFile(path, contents.data(), contents.size());
+}
+
+class RepositoryWatcherTest : public ::testing::Test {
+ protected:
+  // Create a repository holding models 'model_a' and 'model_b', each
+  // with a version directory and a configuration, and watch it.
+  void SetUp() override
+  {
+    ASSERT_OK(tc::MakeTemporaryDirectory(tc::FileSystemType::LOCAL, &repo_));
+    for (const auto& model : {"model_a", "model_b"}) {
+      ASSERT_OK(tc::MakeDirectory(
+          tc::JoinPath({repo_, model, "1"}), true /* recursive */));
+      ASSERT_OK(WriteFile(
+          tc::JoinPath({repo_, model, "config.pbtxt"}),
+          std::string("name: \"") + model + "\""));
+      ASSERT_OK(WriteFile(
+          tc::JoinPath({repo_, model, "1", "model.txt"}), "weights"));
+    }
+    ASSERT_OK(tc::RepositoryWatcher::Create({repo_}, &watcher_));
+  }
+
+  void TearDown() override { tc::DeletePath(repo_); }
+
+  std::string ModelPath(const std::string& model)
+  {
+    return tc::JoinPath({repo_, model});
+  }
+
+  // Expect the changes collected since the last call to be tracked
+  // precisely and to be 'expected'.
+  void ExpectChanges(const std::set<std::string>& expected)
+  {
+    std::set<std::string> changed;
+    ASSERT_TRUE(watcher_->CollectChanges(&changed));
+    EXPECT_EQ(changed, expected);
+  }
+
+  std::string repo_;
+  std::unique_ptr<tc::RepositoryWatcher> watcher_;
+};
+
+TEST_F(RepositoryWatcherTest, NoChanges)
+{
+  ExpectChanges({});
+  ExpectChanges({});
+}
+
+TEST_F(RepositoryWatcherTest, ModifyFile)
+{
+  ASSERT_OK(WriteFile(
+      tc::JoinPath({ModelPath("model_a"), "1", "model.txt"}), "new weights"));
+  ExpectChanges({ModelPath("model_a")});
+
+  // Changes are only reported once.
+  ExpectChanges({});
+
+  ASSERT_OK(WriteFile(
+      tc::JoinPath({ModelPath("model_b"), "config.pbtxt"}),
+      "name: \"model_b\"\nmax_batch_size: 8"));
+  ExpectChanges({ModelPath("model_b")});
+}
+
+TEST_F(RepositoryWatcherTest, CreateFiles)
+{
+  // A new version of an existing model.
+  ASSERT_OK(tc::MakeDirectory(
+      tc::JoinPath({ModelPath("model_a"), "2"}), false /* recursive */));
+  ExpectChanges({ModelPath("model_a")});
+
+  // Directories created below the model are watched as well.
+  ASSERT_OK(WriteFile(
+      tc::JoinPath({ModelPath("model_a"), "2", "model.txt"}), "weights"));
+  ExpectChanges({ModelPath("model_a")});
+
+  // A new model.
+  ASSERT_OK(tc::MakeDirectory(ModelPath("model_c"), false /* recursive */));
+  ExpectChanges({ModelPath("model_c")});
+  ASSERT_OK(tc::MakeDirectory(
+      tc::JoinPath({ModelPath("model_c"), "1"}), false /* recursive */));
+  ASSERT_OK(WriteFile(
+      tc::JoinPath({ModelPath("model_c"), "1", "model.txt"}), "weights"));
+  ExpectChanges({ModelPath("model_c")});
+}
+
+TEST_F(RepositoryWatcherTest, RemoveFiles)
+{
+  ASSERT_OK(
+      tc::DeletePath(tc::JoinPath({ModelPath("model_a"), "1", "model.txt"})));
+  ExpectChanges({ModelPath("model_a")});
+
+  ASSERT_OK(tc::DeletePath(ModelPath("model_b")));
+  ExpectChanges({ModelPath("model_b")});
+
+  // The removed model no longer reports changes, the other one does.
+  ASSERT_OK(WriteFile(
+      tc::JoinPath({ModelPath("model_a"), "1", "model.txt"}), "weights"));
+  ExpectChanges({ModelPath("model_a")});
+}
+
+TEST_F(RepositoryWatcherTest, SeveralModels)
+{
+  ASSERT_OK(WriteFile(
+      tc::JoinPath({ModelPath("model_a"), "config.pbtxt"}), ""));
+  ASSERT_OK(WriteFile(
+      tc::JoinPath({ModelPath("model_b"), "1", "model.txt"}), ""));
+  ExpectChanges({ModelPath("model_a"), ModelPath("model_b")});
+}
+
+TEST_F(RepositoryWatcherTest, RemoveRepository)
+{
+  // Which models are affected can't be told, so a full rescan is
+  // requested once, after which the watcher tracks changes again.
+  ASSERT_OK(tc::DeletePath(repo_));
+  std::set<std::string> changed;
+  EXPECT_FALSE(watcher_->CollectChanges(&changed));
+  EXPECT_TRUE(changed.empty());
+  ExpectChanges({});
+}
+#endif  // __linux__
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,132 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "response_batcher.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Records the batches delivered by a ResponseBatcher. Responses are
+// fake pointers that encode their send order.
+struct Delivered {
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<std::vector<uintptr_t>> batches_;
+  std::vector<std::vector<uint32_t>> flags_;
+};
+
+void
+BatchFn(
+    TRITONSERVER_InferenceResponse** responses, const uint32_t* flags,
+    const uint32_t response_count, void* userp)
+{
+  auto delivered = reinterpret_cast<Delivered*>(userp);
+  std::lock_guard<std::mutex> lock(delivered->mu_);
+  delivered->batches_.emplace_back();
+  delivered->flags_.emplace_back(flags, flags + response_count);
+  for (uint32_t i = 0; i < response_count; i++) {
+    delivered->batches_.back().push_back(
+        reinterpret_cast<uintptr_t>(responses[i]));
+  }
+  delivered->cv_.notify_all();
+}
+
+TRITONSERVER_InferenceResponse*
+Response(const uintptr_t idx)
+{
+  return reinterpret_cast<TRITONSERVER_InferenceResponse*>(idx);
+}
+
+class ResponseBatcherTest : public ::testing::Test {};
+
+TEST_F(ResponseBatcherTest, DeliverOnCount)
+{
+  Delivered delivered;
+  auto batcher = std::make_shared<tc::ResponseBatcher>(
+      BatchFn, &delivered, 3 /* max_batch_count */,
+      60000000 /* max_delay_us */);
+  for (uintptr_t i = 1; i <= 7; i++) {
+    batcher->Send(Response(i), 0);
+  }
+
+  ASSERT_EQ(delivered.batches_.size(), 2u);
+  EXPECT_EQ(delivered.batches_[0], (std::vector<uintptr_t>{1, 2, 3}));
+  EXPECT_EQ(delivered.batches_[1], (std::vector<uintptr_t>{4, 5, 6}));
+
+  // Destroying the batcher delivers what is still pending.
+  batcher.reset();
+  ASSERT_EQ(delivered.batches_.size(), 3u);
+  EXPECT_EQ(delivered.batches_[2], (std::vector<uintptr_t>{7}));
+}
+
+TEST_F(ResponseBatcherTest, DeliverOnFinal)
+{
+  Delivered delivered;
+  auto batcher = std::make_shared<tc::ResponseBatcher>(
+      BatchFn, &delivered, 16 /* max_batch_count */,
+      60000000 /* max_delay_us */);
+  batcher->Send(Response(1), 0);
+  batcher->Send(Response(2), 0);
+  EXPECT_TRUE(delivered.batches_.empty());
+
+  batcher->Send(nullptr, TRITONSERVER_RESPONSE_COMPLETE_FINAL);
+  ASSERT_EQ(delivered.batches_.size(), 1u);
+  EXPECT_EQ(delivered.batches_[0], (std::vector<uintptr_t>{1, 2, 0}));
+  EXPECT_EQ(
+      delivered.flags_[0],
+      (std::vector<uint32_t>{0, 0, TRITONSERVER_RESPONSE_COMPLETE_FINAL}));
+}
+
+TEST_F(ResponseBatcherTest, DeliverOnDelay)
+{
+  Delivered delivered;
+  auto batcher = std::make_shared<tc::ResponseBatcher>(
+      BatchFn, &delivered, 16 /* max_batch_count */, 1000 /* max_delay_us */);
+  batcher->Send(Response(1), 0);
+  batcher->Send(Response(2), 0);
+
+  std::unique_lock<std::mutex> lock(delivered.mu_);
+  ASSERT_TRUE(delivered.cv_.wait_for(lock, std::chrono::seconds(5), [&]() {
+    return !delivered.batches_.empty();
+  }));
+  EXPECT_EQ(delivered.batches_[0], (std::vector<uintptr_t>{1, 2}));
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
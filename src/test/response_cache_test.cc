@@ -46,7 +46,7 @@ InferenceResponseFactory::CreateResponse(
 {
   response->reset(new InferenceResponse(
       model_, id_, allocator_, alloc_userp_, response_fn_, response_userp_,
-      response_delegator_));
+      response_delegator_, batcher_));
 
   return Status::Success;
 }
@@ -58,7 +58,13 @@ InferenceRequest::InferenceRequest(
     Model* model, const int64_t requested_model_version)
     : needs_normalization_(true), model_raw_(model),
       requested_model_version_(requested_model_version), flags_(0),
-      correlation_id_(0), batch_size_(0), timeout_us_(0), collect_stats_(true)
+      correlation_id_(0), batch_size_(0), timeout_us_(0),
+      original_inputs_(MetadataArenaAllocator<char>(&arena_)),
+      override_inputs_(MetadataArenaAllocator<char>(&arena_)),
+      inputs_(MetadataArenaAllocator<char>(&arena_)),
+      original_requested_outputs_(MetadataArenaAllocator<char>(&arena_)),
+      requested_outputs_(MetadataArenaAllocator<char>(&arena_)),
+      collect_stats_(true), parameters_(MetadataArenaAllocator<char>(&arena_))
 {
   // Unit test doesn't need actual response factory logic
   // or other priority/request_counting logic, it just needs
@@ -180,10 +186,14 @@ InferenceResponse::InferenceResponse(
     TRITONSERVER_InferenceResponseCompleteFn_t response_fn,
     void* response_userp,
     const std::function<
-        void(std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator)
-    : model_(model), id_(id), allocator_(allocator), alloc_userp_(alloc_userp),
-      response_fn_(response_fn), response_userp_(response_userp),
-      response_delegator_(delegator), null_response_(false)
+        void(std::unique_ptr<InferenceResponse>&&, const uint32_t)>& delegator,
+    const std::shared_ptr<ResponseBatcher>& batcher)
+    : model_(model), id_(id),
+      parameters_(MetadataArenaAllocator<char>(&arena_)),
+      outputs_(MetadataArenaAllocator<char>(&arena_)), allocator_(allocator),
+      alloc_userp_(alloc_userp), response_fn_(response_fn),
+      response_userp_(response_userp), response_delegator_(delegator),
+      batcher_(batcher), null_response_(false)
 {
   // Skip allocator logic / references in unit test
 }
@@ -0,0 +1,494 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "shared_memory_client.h"
+#include "shared_memory_ipc.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+#define ASSERT_OK(X)                      \
+  do {                                    \
+    const tc::Status s = (X);             \
+    ASSERT_TRUE(s.IsOk()) << s.Message(); \
+  } while (false)
+
+std::string
+UniqueName(const std::string& prefix)
+{
+  return "/" + prefix + "_" + std::to_string(getpid());
+}
+
+//
+// Minimal stand-in for the server side of the transport. Registers
+// regions and answers INFER requests by adding 1 to every byte of the
+// single input and placing the result at the start of the output
+// window. If 'reply_to_infer' is false INFER requests are never
+// answered.
+//
+class FakeServer {
+ public:
+  FakeServer(
+      const std::string& name, uint32_t slot_count, uint32_t slot_size,
+      bool reply_to_infer = true)
+      : name_(name), reply_to_infer_(reply_to_infer), exiting_(false)
+  {
+    using Layout = tc::SharedMemoryTransportLayout;
+    EXPECT_TRUE(tc::SharedMemoryRegion::Create(
+                    name, Layout::RegionByteSize(slot_count, slot_size),
+                    &region_)
+                    .IsOk());
+    char* base = region_->Base();
+    EXPECT_TRUE(tc::SharedMemoryRing::Initialize(
+                    base + Layout::RequestRingOffset(), slot_count, slot_size,
+                    &requests_)
+                    .IsOk());
+    EXPECT_TRUE(tc::SharedMemoryRing::Initialize(
+                    base + Layout::ResponseRingOffset(slot_count, slot_size),
+                    slot_count, slot_size, &responses_)
+                    .IsOk());
+    Layout::PublishHeader(base, slot_count, slot_size);
+    thread_ = std::thread([this]() { Serve(); });
+  }
+
+  ~FakeServer()
+  {
+    exiting_ = true;
+    thread_.join();
+  }
+
+ private:
+  void Serve()
+  {
+    using Layout = tc::SharedMemoryTransportLayout;
+    std::string message;
+    while (!exiting_) {
+      if (!requests_->Consume(&message, 10).IsOk()) {
+        continue;
+      }
+      tc::SharedMemoryMessageReader reader(message);
+      uint32_t type;
+      uint64_t tag;
+      ASSERT_TRUE(reader.Read(&type) && reader.Read(&tag));
+
+      tc::SharedMemoryMessageWriter reply;
+      reply.Append(static_cast<uint32_t>(Layout::REPLY));
+      reply.Append(tag);
+      reply.Append(
+          static_cast<uint32_t>(TRITONSERVER_RESPONSE_COMPLETE_FINAL));
+      if (type == Layout::REGISTER_REGION) {
+        std::string name;
+        ASSERT_TRUE(reader.ReadString(&name));
+        if (!Layout::IsClientRegionName(name_, name)) {
+          reply.Append(static_cast<uint32_t>(tc::Status::Code::INVALID_ARG));
+          reply.AppendString("unexpected region name");
+          reply.Append(static_cast<uint64_t>(0));
+        } else {
+          std::unique_ptr<tc::SharedMemoryRegion> region;
+          ASSERT_TRUE(tc::SharedMemoryRegion::Open(name, &region).IsOk());
+          regions_.emplace_back(std::move(region));
+          reply.Append(static_cast<uint32_t>(tc::Status::Code::SUCCESS));
+          reply.AppendString("");
+          reply.Append(static_cast<uint64_t>(regions_.size()));
+        }
+        reply.Append(static_cast<uint32_t>(0));
+      } else if (!reply_to_infer_) {
+        continue;
+      } else {
+        ASSERT_EQ(type, static_cast<uint32_t>(Layout::INFER));
+        std::string model_name, id, input_name, output_name;
+        int64_t version;
+        uint32_t count, datatype;
+        std::vector<int64_t> shape;
+        uint64_t region_id, offset, byte_size;
+        uint64_t out_region_id, out_offset, out_byte_size;
+        ASSERT_TRUE(
+            reader.ReadString(&model_name) && reader.Read(&version) &&
+            reader.ReadString(&id) && reader.Read(&count) && (count == 1) &&
+            reader.ReadString(&input_name) && reader.Read(&datatype) &&
+            reader.ReadShape(&shape) && reader.Read(&region_id) &&
+            reader.Read(&offset) && reader.Read(&byte_size) &&
+            reader.Read(&count) && (count == 1) &&
+            reader.ReadString(&output_name) && reader.Read(&out_region_id) &&
+            reader.Read(&out_offset) && reader.Read(&out_byte_size));
+        const char* in = regions_[region_id - 1]->Base() + offset;
+        char* out = regions_[out_region_id - 1]->Base() + out_offset;
+        for (uint64_t i = 0; i < byte_size; ++i) {
+          out[i] = in[i] + 1;
+        }
+        reply.Append(static_cast<uint32_t>(tc::Status::Code::SUCCESS));
+        reply.AppendString("");
+        reply.Append(static_cast<uint64_t>(0));
+        reply.Append(static_cast<uint32_t>(1));
+        reply.AppendString(output_name);
+        reply.Append(datatype);
+        reply.AppendShape(shape);
+        reply.Append(out_offset);
+        reply.Append(byte_size);
+      }
+      ASSERT_TRUE(responses_->Produce(reply.Message(), 1000).IsOk());
+    }
+  }
+
+  std::unique_ptr<tc::SharedMemoryRegion> region_;
+  std::unique_ptr<tc::SharedMemoryRing> requests_;
+  std::unique_ptr<tc::SharedMemoryRing> responses_;
+  std::vector<std::unique_ptr<tc::SharedMemoryRegion>> regions_;
+  const std::string name_;
+  const bool reply_to_infer_;
+  std::atomic<bool> exiting_;
+  std::thread thread_;
+};
+
+class SharedMemoryIpcTest : public ::testing::Test {
+};
+
+TEST_F(SharedMemoryIpcTest, MessageCodec)
+{
+  tc::SharedMemoryMessageWriter writer;
+  writer.Append(static_cast<uint32_t>(3));
+  writer.AppendString("INPUT0");
+  writer.AppendShape({1, -1, 16});
+  writer.Append(static_cast<uint64_t>(1) << 40);
+
+  uint32_t u32;
+  std::string str;
+  std::vector<int64_t> shape;
+  uint64_t u64;
+  tc::SharedMemoryMessageReader reader(writer.Message());
+  ASSERT_TRUE(reader.Read(&u32));
+  ASSERT_TRUE(reader.ReadString(&str));
+  ASSERT_TRUE(reader.ReadShape(&shape));
+  ASSERT_TRUE(reader.Read(&u64));
+  EXPECT_EQ(u32, 3u);
+  EXPECT_EQ(str, "INPUT0");
+  EXPECT_EQ(shape, std::vector<int64_t>({1, -1, 16}));
+  EXPECT_EQ(u64, static_cast<uint64_t>(1) << 40);
+  EXPECT_FALSE(reader.Read(&u32));
+
+  // Truncated messages must be rejected.
+  const std::string truncated = writer.Message().substr(0, 10);
+  tc::SharedMemoryMessageReader truncated_reader(truncated);
+  ASSERT_TRUE(truncated_reader.Read(&u32));
+  EXPECT_FALSE(truncated_reader.ReadString(&str));
+}
+
+TEST_F(SharedMemoryIpcTest, RingAcrossProcesses)
+{
+  const uint32_t slot_count = 4;
+  const uint32_t slot_size = 64;
+  std::unique_ptr<tc::SharedMemoryRegion> region;
+  ASSERT_OK(tc::SharedMemoryRegion::Create(
+      UniqueName("ring_test"),
+      tc::SharedMemoryRing::RequiredByteSize(slot_count, slot_size), &region));
+  std::unique_ptr<tc::SharedMemoryRing> ring;
+  ASSERT_OK(tc::SharedMemoryRing::Initialize(
+      region->Base(), slot_count, slot_size, &ring));
+
+  // Full and empty rings time out, oversized messages are rejected.
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    ASSERT_OK(ring->Produce(std::to_string(i), 0));
+  }
+  EXPECT_EQ(
+      ring->Produce("x", 10).StatusCode(), tc::Status::Code::UNAVAILABLE);
+  EXPECT_EQ(
+      ring->Produce(std::string(slot_size + 1, 'x'), 10).StatusCode(),
+      tc::Status::Code::INVALID_ARG);
+  std::string message;
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    ASSERT_OK(ring->Consume(&message, 0));
+    EXPECT_EQ(message, std::to_string(i));
+  }
+  EXPECT_EQ(
+      ring->Consume(&message, 10).StatusCode(), tc::Status::Code::UNAVAILABLE);
+
+  // A child process produces through the inherited mapping.
+  const size_t message_count = 1000;
+  const pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    std::unique_ptr<tc::SharedMemoryRing> producer;
+    if (!tc::SharedMemoryRing::Attach(
+             region->Base(), region->ByteSize(), &producer)
+             .IsOk()) {
+      _exit(1);
+    }
+    for (size_t i = 0; i < message_count; ++i) {
+      if (!producer->Produce(std::to_string(i), 5000).IsOk()) {
+        _exit(1);
+      }
+    }
+    _exit(0);
+  }
+  for (size_t i = 0; i < message_count; ++i) {
+    ASSERT_OK(ring->Consume(&message, 5000));
+    EXPECT_EQ(message, std::to_string(i));
+  }
+  int wstatus;
+  ASSERT_EQ(waitpid(pid, &wstatus, 0), pid);
+  EXPECT_TRUE(WIFEXITED(wstatus) && (WEXITSTATUS(wstatus) == 0));
+}
+
+TEST_F(SharedMemoryIpcTest, TamperedRingHeader)
+{
+  const uint32_t slot_count = 4;
+  const uint32_t slot_size = 64;
+  const size_t byte_size =
+      tc::SharedMemoryRing::RequiredByteSize(slot_count, slot_size);
+  std::unique_ptr<tc::SharedMemoryRegion> region;
+  ASSERT_OK(tc::SharedMemoryRegion::Create(
+      UniqueName("tampered_test"), byte_size, &region));
+  std::unique_ptr<tc::SharedMemoryRing> ring;
+  ASSERT_OK(tc::SharedMemoryRing::Initialize(
+      region->Base(), slot_count, slot_size, &ring));
+
+  // An attached peer rewrites the geometry in the header after both
+  // sides checked it, the rings keep using the geometry they checked.
+  std::unique_ptr<tc::SharedMemoryRing> peer;
+  ASSERT_OK(tc::SharedMemoryRing::Attach(region->Base(), byte_size, &peer));
+  const uint32_t huge = 0x7fffffff;
+  memcpy(region->Base() + 4, &huge, sizeof(huge));
+  memcpy(region->Base() + 8, &huge, sizeof(huge));
+  EXPECT_EQ(peer->SlotByteSize(), slot_size);
+  EXPECT_EQ(
+      peer->Produce(std::string(slot_size + 1, 'x'), 0).StatusCode(),
+      tc::Status::Code::INVALID_ARG);
+  for (uint32_t i = 0; i < 2 * slot_count; ++i) {
+    ASSERT_OK(peer->Produce(std::string(slot_size, 'a' + i), 0));
+    std::string message;
+    ASSERT_OK(ring->Consume(&message, 0));
+    EXPECT_EQ(message, std::string(slot_size, 'a' + i));
+  }
+
+  // A length prefix larger than the slot is clamped to the slot size.
+  const std::string marker = "length prefix";
+  ASSERT_OK(peer->Produce(marker, 0));
+  char* length_prefix = nullptr;
+  for (size_t offset = 0; offset + 4 + marker.size() <= byte_size; ++offset) {
+    if (memcmp(region->Base() + offset + 4, marker.data(), marker.size()) ==
+        0) {
+      length_prefix = region->Base() + offset;
+      break;
+    }
+  }
+  ASSERT_NE(length_prefix, nullptr);
+  memcpy(length_prefix, &huge, sizeof(huge));
+  std::string message;
+  ASSERT_OK(ring->Consume(&message, 0));
+  EXPECT_EQ(message.size(), slot_size);
+
+  // Rings whose header is corrupted before attaching are rejected.
+  const uint32_t zero = 0;
+  memcpy(region->Base() + 4, &zero, sizeof(zero));
+  EXPECT_FALSE(
+      tc::SharedMemoryRing::Attach(region->Base(), byte_size, &peer).IsOk());
+  memcpy(region->Base() + 4, &slot_count, sizeof(slot_count));
+  memcpy(region->Base() + 8, &huge, sizeof(huge));
+  EXPECT_FALSE(
+      tc::SharedMemoryRing::Attach(region->Base(), byte_size, &peer).IsOk());
+}
+
+TEST_F(SharedMemoryIpcTest, ClientRegionNames)
+{
+  using Layout = tc::SharedMemoryTransportLayout;
+  EXPECT_TRUE(Layout::IsClientRegionName("/triton", "/triton_tensors"));
+  EXPECT_TRUE(Layout::IsClientRegionName("/triton", "/triton_a_b"));
+  EXPECT_FALSE(Layout::IsClientRegionName("/triton", "/triton"));
+  EXPECT_FALSE(Layout::IsClientRegionName("/triton", "/triton_"));
+  EXPECT_FALSE(Layout::IsClientRegionName("/triton", "/tritonx_tensors"));
+  EXPECT_FALSE(Layout::IsClientRegionName("/triton", "/other_tensors"));
+  EXPECT_FALSE(Layout::IsClientRegionName("/triton", "/triton_a/b"));
+
+  const std::string name = UniqueName("names_test");
+  FakeServer server(name, 16, 1024);
+  std::unique_ptr<tc::SharedMemoryClient> client;
+  ASSERT_OK(tc::SharedMemoryClient::Connect(name, &client));
+  std::unique_ptr<tc::SharedMemoryRegion> other;
+  ASSERT_OK(tc::SharedMemoryRegion::Create(
+      UniqueName("names_test_other"), 4096, &other));
+  uint64_t region_id;
+  EXPECT_EQ(
+      client->RegisterRegion(other->Name(), &region_id).StatusCode(),
+      tc::Status::Code::INVALID_ARG);
+}
+
+TEST_F(SharedMemoryIpcTest, InferTimeout)
+{
+  const std::string name = UniqueName("timeout_test");
+  FakeServer server(name, 16, 1024, false /* reply_to_infer */);
+  std::unique_ptr<tc::SharedMemoryClient> client;
+  ASSERT_OK(tc::SharedMemoryClient::Connect(name, &client));
+  std::unique_ptr<tc::SharedMemoryRegion> tensors;
+  ASSERT_OK(
+      tc::SharedMemoryRegion::Create(name + "_tensors", 4096, &tensors));
+  uint64_t region_id;
+  ASSERT_OK(client->RegisterRegion(tensors->Name(), &region_id));
+
+  tc::SharedMemoryClient::Request request;
+  request.model_name_ = "never_replies";
+  request.inputs_.push_back(tc::SharedMemoryClient::Tensor{
+      "INPUT0", TRITONSERVER_TYPE_UINT8, {16}, region_id, 0, 16});
+  request.requested_outputs_.push_back("OUTPUT0");
+
+  tc::SharedMemoryClient::Response response;
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(
+      client->Infer(request, &response, 100).StatusCode(),
+      tc::Status::Code::UNAVAILABLE);
+  EXPECT_LT(
+      std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST_F(SharedMemoryIpcTest, ClientInfer)
+{
+  const std::string name = UniqueName("transport_test");
+  FakeServer server(name, 16, 1024);
+  std::unique_ptr<tc::SharedMemoryClient> client;
+  ASSERT_OK(tc::SharedMemoryClient::Connect(name, &client));
+
+  std::unique_ptr<tc::SharedMemoryRegion> tensors;
+  ASSERT_OK(tc::SharedMemoryRegion::Create(
+      name + "_tensors", 4096, &tensors));
+  uint64_t region_id;
+  ASSERT_OK(client->RegisterRegion(tensors->Name(), &region_id));
+  for (size_t i = 0; i < 16; ++i) {
+    tensors->Base()[i] = i;
+  }
+
+  tc::SharedMemoryClient::Request request;
+  request.model_name_ = "add_one";
+  request.inputs_.push_back(tc::SharedMemoryClient::Tensor{
+      "INPUT0", TRITONSERVER_TYPE_UINT8, {16}, region_id, 0, 16});
+  request.requested_outputs_.push_back("OUTPUT0");
+  request.output_region_id_ = region_id;
+  request.output_offset_ = 2048;
+  request.output_byte_size_ = 2048;
+
+  tc::SharedMemoryClient::Response response;
+  ASSERT_OK(client->Infer(request, &response));
+  ASSERT_OK(response.status_);
+  EXPECT_TRUE((response.flags_ & TRITONSERVER_RESPONSE_COMPLETE_FINAL) != 0);
+  ASSERT_EQ(response.outputs_.size(), 1u);
+  const auto& output = response.outputs_[0];
+  EXPECT_EQ(output.name_, "OUTPUT0");
+  EXPECT_EQ(output.shape_, std::vector<int64_t>({16}));
+  EXPECT_EQ(output.region_id_, region_id);
+  ASSERT_EQ(output.byte_size_, 16u);
+  for (size_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(tensors->Base()[output.offset_ + i], static_cast<char>(i + 1));
+  }
+}
+
+TEST_F(SharedMemoryIpcTest, Benchmark)
+{
+  // Round trips of requests referencing a 1 MB tensor, compared with
+  // the cost of copying the tensor once as a socket based transport
+  // would at least do.
+  const size_t tensor_byte_size = 1 << 20;
+  const size_t iterations = 2000;
+  const std::string name = UniqueName("transport_bench");
+  FakeServer server(name, 64, 1024);
+  std::unique_ptr<tc::SharedMemoryClient> client;
+  ASSERT_OK(tc::SharedMemoryClient::Connect(name, &client));
+  std::unique_ptr<tc::SharedMemoryRegion> tensors;
+  ASSERT_OK(tc::SharedMemoryRegion::Create(
+      name + "_tensors", 2 * tensor_byte_size, &tensors));
+  uint64_t region_id;
+  ASSERT_OK(client->RegisterRegion(tensors->Name(), &region_id));
+
+  // Only the message is exchanged, the fake server skips the tensor.
+  tc::SharedMemoryClient::Request request;
+  request.model_name_ = "bench";
+  request.inputs_.push_back(tc::SharedMemoryClient::Tensor{
+      "INPUT0", TRITONSERVER_TYPE_UINT8, {0}, region_id, 0, 0});
+  request.requested_outputs_.push_back("OUTPUT0");
+  request.output_region_id_ = region_id;
+  request.output_offset_ = tensor_byte_size;
+  request.output_byte_size_ = tensor_byte_size;
+
+  tc::SharedMemoryClient::Response response;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    ASSERT_OK(client->Infer(request, &response));
+  }
+  const double sync_us =
+      std::chrono::duration<double, std::micro>(
+          std::chrono::steady_clock::now() - start)
+          .count() /
+      iterations;
+
+  std::atomic<size_t> completed(0);
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    ASSERT_OK(client->InferAsync(
+        request, [&completed](tc::SharedMemoryClient::Response&&) {
+          completed++;
+        }));
+  }
+  while (completed < iterations) {
+    std::this_thread::yield();
+  }
+  const double async_per_sec =
+      iterations / std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  std::vector<char> copy(tensor_byte_size);
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    memcpy(copy.data(), tensors->Base(), tensor_byte_size);
+  }
+  const double copy_us = std::chrono::duration<double, std::micro>(
+                             std::chrono::steady_clock::now() - start)
+                             .count() /
+                         iterations;
+
+  std::cout << "shared memory transport: " << sync_us
+            << " us per round trip, " << async_per_sec
+            << " requests/s pipelined; copying a " << tensor_byte_size
+            << " byte tensor once: " << copy_us << " us" << std::endl;
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
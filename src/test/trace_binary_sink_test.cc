@@ -0,0 +1,313 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "infer_trace.h"
+#include "trace_binary_sink.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+using Record = tc::TraceBinarySink::Record;
+
+// Content of a binary trace file.
+struct TraceFile {
+  std::vector<Record> activities_;
+  std::vector<Record> models_;
+  std::map<uint32_t, std::string> strings_;
+  uint64_t dropped_ = 0;
+};
+
+void
+ReadTraceFile(const std::string& path, TraceFile* file)
+{
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  ASSERT_TRUE(in.good()) << "failed to open " << path;
+  tc::TraceBinarySink::FileHeader header;
+  ASSERT_TRUE(in.read(reinterpret_cast<char*>(&header), sizeof(header)));
+  ASSERT_EQ(memcmp(header.magic_, "TRTTRACE", 8), 0);
+  ASSERT_EQ(header.version_, 1u);
+  ASSERT_EQ(header.record_size_, sizeof(Record));
+
+  Record record;
+  while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    if (record.type_ < tc::TraceBinarySink::RECORD_MODEL) {
+      file->activities_.push_back(record);
+    } else if (record.type_ == tc::TraceBinarySink::RECORD_MODEL) {
+      file->models_.push_back(record);
+    } else if (record.type_ == tc::TraceBinarySink::RECORD_STRING) {
+      const size_t padded =
+          ((record.arg0_ + sizeof(Record) - 1) / sizeof(Record)) *
+          sizeof(Record);
+      std::string str(padded, '\0');
+      ASSERT_TRUE(in.read(&str[0], padded));
+      str.resize(record.arg0_);
+      file->strings_[record.arg1_] = str;
+    } else if (record.type_ == tc::TraceBinarySink::RECORD_DROPPED) {
+      file->dropped_ += record.arg0_;
+    } else {
+      FAIL() << "unexpected record type " << record.type_;
+    }
+  }
+}
+
+std::string
+ReadText(const std::string& path)
+{
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+void
+ReleaseTrace(TRITONSERVER_InferenceTrace* trace, void* userp)
+{
+  delete reinterpret_cast<tc::InferenceTrace*>(trace);
+}
+
+class TraceBinarySinkTest : public ::testing::Test {
+ protected:
+  void SetUp() override
+  {
+    char dir[] = "/tmp/trace_binary_sink_test_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    dir_ = dir;
+  }
+
+  void TearDown() override
+  {
+    tc::TraceBinarySink::Get()->Stop();
+    system(("rm -rf " + dir_).c_str());
+  }
+
+  std::string Path(const std::string& name) { return dir_ + "/" + name; }
+
+  std::string dir_;
+};
+
+TEST_F(TraceBinarySinkTest, TraceToJson)
+{
+  auto sink = tc::TraceBinarySink::Get();
+  ASSERT_TRUE(sink->Start(Path("trace.bin"), 64).IsOk());
+  EXPECT_FALSE(sink->Start(Path("other.bin"), 64).IsOk());
+
+  auto trace = new tc::InferenceTrace(
+      TRITONSERVER_TRACE_LEVEL_TIMESTAMPS, 7 /* parent_id */,
+      nullptr /* activity_fn */, nullptr /* tensor_activity_fn */,
+      ReleaseTrace, nullptr /* userp */);
+  const uint64_t trace_id = trace->Id();
+  trace->SetModelName("sim\"ple");
+  trace->SetModelVersion(3);
+  for (uint32_t activity = TRITONSERVER_TRACE_REQUEST_START;
+       activity <= TRITONSERVER_TRACE_REQUEST_END; ++activity) {
+    trace->Report(
+        static_cast<TRITONSERVER_InferenceTraceActivity>(activity),
+        1000000 + activity * 1500);
+  }
+  trace->Release();
+  sink->Stop();
+
+  TraceFile file;
+  ReadTraceFile(Path("trace.bin"), &file);
+  ASSERT_EQ(file.activities_.size(), 7u);
+  for (uint32_t idx = 0; idx < file.activities_.size(); ++idx) {
+    EXPECT_EQ(file.activities_[idx].trace_id_, trace_id);
+    EXPECT_EQ(file.activities_[idx].arg0_, 7u);
+    EXPECT_EQ(file.activities_[idx].type_, idx);
+    EXPECT_EQ(file.activities_[idx].timestamp_ns_, 1000000 + idx * 1500);
+  }
+  ASSERT_EQ(file.models_.size(), 1u);
+  EXPECT_EQ(file.models_[0].trace_id_, trace_id);
+  EXPECT_EQ(file.models_[0].arg0_, 3u);
+  EXPECT_EQ(file.strings_[file.models_[0].arg1_], "sim\"ple");
+  EXPECT_EQ(file.dropped_, 0u);
+
+  ASSERT_TRUE(
+      tc::TraceBinarySink::ToJson(Path("trace.bin"), Path("trace.json"))
+          .IsOk());
+  const std::string json = ReadText(Path("trace.json"));
+  const std::string tid = "\"tid\":" + std::to_string(trace_id);
+  EXPECT_NE(
+      json.find(
+          "{\"name\":\"request\",\"cat\":\"sim\\\"ple\",\"ph\":\"X\","
+          "\"pid\":1," +
+          tid + ",\"ts\":1000.000,\"dur\":9.000,"),
+      std::string::npos)
+      << json;
+  EXPECT_NE(
+      json.find("\"name\":\"queue\",\"cat\":\"sim\\\"ple\",\"ph\":\"X\","
+                "\"pid\":1," +
+                tid + ",\"ts\":1001.500,\"dur\":1.500,"),
+      std::string::npos)
+      << json;
+  EXPECT_NE(json.find("\"name\":\"compute_infer\""), std::string::npos);
+  EXPECT_NE(
+      json.find("\"parent_id\":7,\"model_name\":\"sim\\\"ple\","
+                "\"model_version\":3}"),
+      std::string::npos)
+      << json;
+  EXPECT_NE(json.find("\"dropped_records\":0}"), std::string::npos);
+
+  EXPECT_FALSE(
+      tc::TraceBinarySink::ToJson(Path("trace.json"), Path("bad.json"))
+          .IsOk());
+}
+
+TEST_F(TraceBinarySinkTest, CorruptStringSize)
+{
+  auto sink = tc::TraceBinarySink::Get();
+  ASSERT_TRUE(sink->Start(Path("trace.bin"), 16).IsOk());
+  sink->Stop();
+
+  // Append a string record claiming far more bytes than the file has.
+  {
+    std::ofstream out(
+        Path("trace.bin"), std::ios::out | std::ios::binary | std::ios::app);
+    Record record{};
+    record.type_ = tc::TraceBinarySink::RECORD_STRING;
+    record.arg0_ = std::numeric_limits<uint64_t>::max() - 1;
+    out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    out.write(std::string(sizeof(Record), 'x').data(), sizeof(Record));
+  }
+
+  ASSERT_TRUE(
+      tc::TraceBinarySink::ToJson(Path("trace.bin"), Path("trace.json"))
+          .IsOk());
+  EXPECT_NE(
+      ReadText(Path("trace.json")).find("\"dropped_records\":0}"),
+      std::string::npos);
+}
+
+TEST_F(TraceBinarySinkTest, DropWhenFull)
+{
+  auto sink = tc::TraceBinarySink::Get();
+  ASSERT_TRUE(sink->Start(Path("trace.bin"), 4).IsOk());
+  const uint64_t count = 1000;
+  for (uint64_t idx = 0; idx < count; ++idx) {
+    sink->WriteActivity(
+        idx + 1, 0 /* parent_id */, TRITONSERVER_TRACE_REQUEST_START, idx);
+  }
+  sink->Stop();
+
+  // Records that did not fit in the ring are accounted for.
+  TraceFile file;
+  ReadTraceFile(Path("trace.bin"), &file);
+  EXPECT_GT(file.dropped_, 0u);
+  EXPECT_EQ(file.activities_.size() + file.dropped_, count);
+}
+
+TEST_F(TraceBinarySinkTest, ConcurrentThreads)
+{
+  auto sink = tc::TraceBinarySink::Get();
+  ASSERT_TRUE(sink->Start(Path("trace.bin"), 4096).IsOk());
+  const size_t thread_count = 4;
+  const uint64_t count = 2000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([sink, t, count]() {
+      for (uint64_t idx = 0; idx < count; ++idx) {
+        sink->WriteActivity(
+            (t << 32) | idx, 0 /* parent_id */,
+            TRITONSERVER_TRACE_COMPUTE_START, idx);
+        sink->WriteModel(
+            (t << 32) | idx, "model_" + std::to_string(t), t, idx);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  sink->Stop();
+
+  TraceFile file;
+  ReadTraceFile(Path("trace.bin"), &file);
+  EXPECT_EQ(file.dropped_, 0u);
+  ASSERT_EQ(file.activities_.size(), thread_count * count);
+  ASSERT_EQ(file.models_.size(), thread_count * count);
+
+  // Records of each thread are written in the order they are reported.
+  std::map<uint32_t, uint64_t> next;
+  for (const auto& record : file.activities_) {
+    const uint64_t t = record.trace_id_ >> 32;
+    EXPECT_EQ(record.trace_id_ & 0xffffffff, next[t]++);
+  }
+  for (const auto& record : file.models_) {
+    EXPECT_EQ(
+        file.strings_[record.arg1_],
+        "model_" + std::to_string(record.trace_id_ >> 32));
+  }
+}
+
+TEST_F(TraceBinarySinkTest, Restart)
+{
+  auto sink = tc::TraceBinarySink::Get();
+  ASSERT_TRUE(sink->Start(Path("first.bin"), 16).IsOk());
+  sink->WriteActivity(1, 0, TRITONSERVER_TRACE_REQUEST_START, 10);
+  sink->WriteModel(1, "first", 1, 11);
+  sink->Stop();
+
+  // Records reported while stopped are not written anywhere.
+  sink->WriteActivity(2, 0, TRITONSERVER_TRACE_REQUEST_START, 20);
+
+  ASSERT_TRUE(sink->Start(Path("second.bin"), 16).IsOk());
+  sink->WriteActivity(3, 0, TRITONSERVER_TRACE_REQUEST_START, 30);
+  sink->WriteModel(3, "first", 1, 31);
+  sink->Stop();
+
+  TraceFile first;
+  ReadTraceFile(Path("first.bin"), &first);
+  ASSERT_EQ(first.activities_.size(), 1u);
+  EXPECT_EQ(first.activities_[0].trace_id_, 1u);
+
+  // The string table starts over with the new file.
+  TraceFile second;
+  ReadTraceFile(Path("second.bin"), &second);
+  ASSERT_EQ(second.activities_.size(), 1u);
+  EXPECT_EQ(second.activities_[0].trace_id_, 3u);
+  ASSERT_EQ(second.models_.size(), 1u);
+  EXPECT_EQ(second.strings_[second.models_[0].arg1_], "first");
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,256 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "gtest/gtest.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "infer_trace.h"
+#include "trace_tensor_stager.h"
+
+namespace tc = triton::core;
+
+namespace {
+
+// Tensor activities and releases observed through the trace callbacks.
+struct Observed {
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::vector<std::string> events_;
+  std::vector<std::thread::id> threads_;
+  size_t released_ = 0;
+
+  // Hold deliveries until 'blocked_' is cleared.
+  bool blocked_ = false;
+};
+
+void
+TimelineActivity(
+    TRITONSERVER_InferenceTrace* trace,
+    TRITONSERVER_InferenceTraceActivity activity, uint64_t timestamp_ns,
+    void* userp)
+{
+}
+
+void
+TensorActivity(
+    TRITONSERVER_InferenceTrace* trace,
+    TRITONSERVER_InferenceTraceActivity activity, const char* name,
+    TRITONSERVER_DataType datatype, const void* base, size_t byte_size,
+    const int64_t* shape, uint64_t dim_count,
+    TRITONSERVER_MemoryType memory_type, int64_t memory_type_id, void* userp)
+{
+  auto observed = reinterpret_cast<Observed*>(userp);
+  std::unique_lock<std::mutex> lk(observed->mu_);
+  observed->cv_.wait(lk, [observed] { return !observed->blocked_; });
+  const uint64_t id = reinterpret_cast<tc::InferenceTrace*>(trace)->Id();
+  std::string event =
+      std::to_string(id) + ":" + name + ":" +
+      std::string(reinterpret_cast<const char*>(base), byte_size);
+  for (uint64_t idx = 0; idx < dim_count; ++idx) {
+    event += ":" + std::to_string(shape[idx]);
+  }
+  EXPECT_EQ(memory_type, TRITONSERVER_MEMORY_CPU);
+  observed->events_.push_back(event);
+  observed->threads_.push_back(std::this_thread::get_id());
+}
+
+void
+ReleaseTrace(TRITONSERVER_InferenceTrace* trace, void* userp)
+{
+  auto observed = reinterpret_cast<Observed*>(userp);
+  auto ltrace = reinterpret_cast<tc::InferenceTrace*>(trace);
+  const std::string event = std::to_string(ltrace->Id()) + ":released";
+  delete ltrace;
+  std::lock_guard<std::mutex> lk(observed->mu_);
+  observed->events_.push_back(event);
+  observed->released_++;
+  // Notify while holding the lock, the waiter destroys 'observed' once
+  // it sees the release.
+  observed->cv_.notify_all();
+}
+
+tc::InferenceTrace*
+NewTrace(Observed* observed, const uint64_t byte_limit)
+{
+  auto trace = new tc::InferenceTrace(
+      TRITONSERVER_TRACE_LEVEL_TENSORS, 0 /* parent_id */, TimelineActivity,
+      TensorActivity, ReleaseTrace, observed);
+  trace->SetAsyncTensors(byte_limit);
+  return trace;
+}
+
+void
+ReportTensor(
+    tc::InferenceTrace* trace, const char* name, const std::string& data)
+{
+  const int64_t shape[] = {1, static_cast<int64_t>(data.size())};
+  trace->ReportTensor(
+      TRITONSERVER_TRACE_TENSOR_QUEUE_INPUT, name, TRITONSERVER_TYPE_UINT8,
+      data.data(), data.size(), shape, 2, TRITONSERVER_MEMORY_CPU, 0);
+}
+
+void
+WaitReleased(Observed* observed, const size_t count)
+{
+  std::unique_lock<std::mutex> lk(observed->mu_);
+  observed->cv_.wait(
+      lk, [observed, count] { return observed->released_ == count; });
+}
+
+class TraceTensorStagerTest : public ::testing::Test {
+ protected:
+  void TearDown() override { tc::TraceTensorStager::Get()->Stop(); }
+};
+
+TEST_F(TraceTensorStagerTest, DeliverCopies)
+{
+  auto stager = tc::TraceTensorStager::Get();
+  ASSERT_TRUE(stager->Start(1024).IsOk());
+  EXPECT_FALSE(stager->Start(1024).IsOk());
+
+  Observed observed;
+  auto trace = NewTrace(&observed, 0 /* byte_limit */);
+  const std::string id = std::to_string(trace->Id());
+  auto child = trace->SpawnChildTrace();
+  const std::string child_id = std::to_string(child->Id());
+
+  // The reported buffers are reused right away, the callback must see
+  // the content at the time of the report.
+  std::string data = "abc";
+  ReportTensor(trace, "INPUT0", data);
+  data = "xyz";
+  ReportTensor(child, "INPUT1", data);
+  data.clear();
+  child->Release();
+  trace->Release();
+  WaitReleased(&observed, 2);
+
+  // Delivered in order, on a thread other than the reporting thread,
+  // and each trace is released after its tensors.
+  std::lock_guard<std::mutex> lk(observed.mu_);
+  ASSERT_EQ(observed.events_.size(), 4u);
+  EXPECT_EQ(observed.events_[0], id + ":INPUT0:abc:1:3");
+  EXPECT_EQ(observed.events_[1], child_id + ":INPUT1:xyz:1:3");
+  EXPECT_EQ(observed.events_[2], child_id + ":released");
+  EXPECT_EQ(observed.events_[3], id + ":released");
+  for (const auto& thread : observed.threads_) {
+    EXPECT_NE(thread, std::this_thread::get_id());
+  }
+  EXPECT_EQ(stager->ReservedByteSize(), 0u);
+  EXPECT_EQ(stager->DroppedTraceCount(), 0u);
+}
+
+TEST_F(TraceTensorStagerTest, TraceByteLimit)
+{
+  auto stager = tc::TraceTensorStager::Get();
+  ASSERT_TRUE(stager->Start(1024).IsOk());
+
+  // Tensors after the one exceeding the limit are dropped too, the
+  // limit applies to each trace separately.
+  Observed observed;
+  auto limited = NewTrace(&observed, 6 /* byte_limit */);
+  const std::string id = std::to_string(limited->Id());
+  ReportTensor(limited, "A", "1234");
+  ReportTensor(limited, "B", "567");
+  ReportTensor(limited, "C", "8");
+  auto other = NewTrace(&observed, 6 /* byte_limit */);
+  const std::string other_id = std::to_string(other->Id());
+  ReportTensor(other, "D", "12345");
+  limited->Release();
+  other->Release();
+  WaitReleased(&observed, 2);
+
+  std::lock_guard<std::mutex> lk(observed.mu_);
+  ASSERT_EQ(observed.events_.size(), 4u);
+  EXPECT_EQ(observed.events_[0], id + ":A:1234:1:4");
+  EXPECT_EQ(observed.events_[1], other_id + ":D:12345:1:5");
+  EXPECT_EQ(observed.events_[2], id + ":released");
+  EXPECT_EQ(observed.events_[3], other_id + ":released");
+  EXPECT_EQ(stager->DroppedTraceCount(), 1u);
+}
+
+TEST_F(TraceTensorStagerTest, PoolFull)
+{
+  auto stager = tc::TraceTensorStager::Get();
+  ASSERT_TRUE(stager->Start(8).IsOk());
+
+  // While deliveries are held the pool fills up and reporting drops
+  // the trace instead of waiting.
+  Observed observed;
+  observed.blocked_ = true;
+  auto first = NewTrace(&observed, 0 /* byte_limit */);
+  ReportTensor(first, "A", "123456");
+  auto second = NewTrace(&observed, 0 /* byte_limit */);
+  ReportTensor(second, "B", "123");
+  EXPECT_EQ(stager->ReservedByteSize(), 6u);
+  EXPECT_EQ(stager->DroppedTraceCount(), 1u);
+
+  {
+    std::lock_guard<std::mutex> lk(observed.mu_);
+    observed.blocked_ = false;
+  }
+  observed.cv_.notify_all();
+  first->Release();
+  second->Release();
+  WaitReleased(&observed, 2);
+  EXPECT_EQ(stager->ReservedByteSize(), 0u);
+
+  // Once delivered the pool has room again.
+  auto third = NewTrace(&observed, 0 /* byte_limit */);
+  const std::string id = std::to_string(third->Id());
+  ReportTensor(third, "C", "1234567");
+  third->Release();
+  WaitReleased(&observed, 3);
+
+  std::lock_guard<std::mutex> lk(observed.mu_);
+  ASSERT_EQ(observed.events_.size(), 5u);
+  EXPECT_EQ(observed.events_[3], id + ":C:1234567:1:7");
+}
+
+TEST_F(TraceTensorStagerTest, ReleaseWhenStopped)
+{
+  // Without a running stager the trace is released right away.
+  Observed observed;
+  auto trace = NewTrace(&observed, 0 /* byte_limit */);
+  ReportTensor(trace, "A", "1");
+  trace->Release();
+  std::lock_guard<std::mutex> lk(observed.mu_);
+  EXPECT_EQ(observed.released_, 1u);
+  ASSERT_EQ(observed.events_.size(), 1u);
+}
+
+}  // namespace
+
+int
+main(int argc, char** argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,521 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "trace_binary_sink.h"
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <map>
+#include "triton/common/logging.h"
+#include "tritonserver_apis.h"
+
+namespace triton { namespace core {
+
+#ifdef TRITON_ENABLE_TRACING
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'R', 'T', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t kVersion = 1;
+
+// How often the drain thread writes the reported records to the file.
+constexpr uint64_t kDrainIntervalMs = 10;
+
+constexpr uint32_t kActivityCount =
+    TRITONSERVER_TRACE_TENSOR_BACKEND_OUTPUT + 1;
+
+uint64_t
+NowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Chrome trace events use microsecond timestamps, keep the nanosecond
+// precision as the fraction.
+std::string
+Microseconds(const uint64_t ns)
+{
+  std::string frac = std::to_string(ns % 1000);
+  return std::to_string(ns / 1000) + "." +
+         std::string(3 - frac.size(), '0') + frac;
+}
+
+std::string
+JsonEscape(const std::string& str)
+{
+  std::string escaped;
+  for (const char c : str) {
+    if ((c == '"') || (c == '\\')) {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      escaped += buf;
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+//
+// Single-producer single-consumer ring of the records reported by
+// one thread. Only the reporting thread advances 'head_' and only the
+// drain thread advances 'tail_'.
+//
+struct TraceBinarySink::Ring {
+  Ring(const size_t capacity, const uint32_t thread_index)
+      : records_(new Record[capacity]), mask_(capacity - 1),
+        thread_index_(thread_index), head_(0), tail_(0), dropped_(0)
+  {
+  }
+
+  std::unique_ptr<Record[]> records_;
+  const uint64_t mask_;
+  const uint32_t thread_index_;
+  std::atomic<uint64_t> head_;
+  // Keep the producer and consumer positions on separate cache lines.
+  char padding_[64];
+  std::atomic<uint64_t> tail_;
+  std::atomic<uint64_t> dropped_;
+};
+
+TraceBinarySink*
+TraceBinarySink::Get()
+{
+  // Never destroyed so that threads reporting during process exit do
+  // not touch a destroyed sink.
+  static TraceBinarySink* sink = new TraceBinarySink();
+  return sink;
+}
+
+TraceBinarySink::TraceBinarySink()
+    : enabled_(false), generation_(0), ring_capacity_(0),
+      next_thread_index_(0), exiting_(false)
+{
+}
+
+Status
+TraceBinarySink::Start(
+    const std::string& path, const uint32_t records_per_thread)
+{
+  std::lock_guard<std::mutex> start_lk(start_mu_);
+  if (drain_thread_.joinable()) {
+    return Status(
+        Status::Code::ALREADY_EXISTS, "binary trace sink is already started");
+  }
+  if (records_per_thread == 0) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "binary trace sink records per thread must be greater than 0");
+  }
+
+  file_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to open binary trace file '" + path + "'");
+  }
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic_, kMagic, sizeof(kMagic));
+  header.version_ = kVersion;
+  header.record_size_ = sizeof(Record);
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  size_t capacity = 1;
+  while (capacity < records_per_thread) {
+    capacity <<= 1;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    ring_capacity_ = capacity;
+    next_thread_index_ = 0;
+    string_ids_.clear();
+    pending_strings_.clear();
+    exiting_ = false;
+    // Threads holding a ring or string ids from an earlier run
+    // register again when they see the new generation.
+    generation_++;
+    enabled_ = true;
+  }
+  drain_thread_ = std::thread(&TraceBinarySink::DrainThread, this);
+
+  return Status::Success;
+}
+
+void
+TraceBinarySink::Stop()
+{
+  std::lock_guard<std::mutex> start_lk(start_mu_);
+  if (!drain_thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    enabled_ = false;
+    exiting_ = true;
+  }
+  cv_.notify_one();
+  drain_thread_.join();
+  file_.close();
+
+  std::lock_guard<std::mutex> lk(mu_);
+  rings_.clear();
+}
+
+TraceBinarySink::Ring*
+TraceBinarySink::LocalRing()
+{
+  thread_local std::shared_ptr<Ring> ring;
+  thread_local uint64_t generation = 0;
+  if (generation != generation_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!enabled_) {
+      return nullptr;
+    }
+    ring = std::make_shared<Ring>(ring_capacity_, next_thread_index_++);
+    rings_.push_back(ring);
+    generation = generation_;
+  }
+  return ring.get();
+}
+
+uint32_t
+TraceBinarySink::StringId(const std::string& str)
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = string_ids_.find(str);
+  if (it == string_ids_.end()) {
+    it = string_ids_.emplace(str, string_ids_.size()).first;
+    pending_strings_.emplace_back(it->second, str);
+  }
+  return it->second;
+}
+
+void
+TraceBinarySink::Push(Ring* ring, const Record& record)
+{
+  const uint64_t head = ring->head_.load(std::memory_order_relaxed);
+  if ((head - ring->tail_.load(std::memory_order_acquire)) > ring->mask_) {
+    ring->dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ring->records_[head & ring->mask_] = record;
+  ring->head_.store(head + 1, std::memory_order_release);
+}
+
+void
+TraceBinarySink::WriteActivity(
+    const uint64_t trace_id, const uint64_t parent_id,
+    const uint32_t activity, const uint64_t timestamp_ns)
+{
+  if (!Enabled()) {
+    return;
+  }
+  Ring* ring = LocalRing();
+  if (ring != nullptr) {
+    Push(
+        ring,
+        Record{trace_id, timestamp_ns, parent_id, activity,
+               ring->thread_index_});
+  }
+}
+
+void
+TraceBinarySink::WriteModel(
+    const uint64_t trace_id, const std::string& model_name,
+    const int64_t model_version, const uint64_t timestamp_ns)
+{
+  if (!Enabled()) {
+    return;
+  }
+  Ring* ring = LocalRing();
+  if (ring == nullptr) {
+    return;
+  }
+
+  // Most threads report traces of the same model back to back, only
+  // look up the string table when the model changes.
+  thread_local std::string last_name;
+  thread_local uint32_t last_id = 0;
+  thread_local uint64_t last_generation = 0;
+  const uint64_t generation = generation_.load(std::memory_order_acquire);
+  if ((last_generation != generation) || (last_name != model_name)) {
+    last_id = StringId(model_name);
+    last_name = model_name;
+    last_generation = generation;
+  }
+  Push(
+      ring, Record{trace_id, timestamp_ns,
+                   static_cast<uint64_t>(model_version), RECORD_MODEL,
+                   last_id});
+}
+
+void
+TraceBinarySink::DrainThread()
+{
+  while (true) {
+    bool exiting;
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_.wait_for(
+          lk, std::chrono::milliseconds(kDrainIntervalMs),
+          [this] { return exiting_; });
+      exiting = exiting_;
+    }
+    Drain();
+    if (exiting) {
+      break;
+    }
+  }
+}
+
+void
+TraceBinarySink::Drain()
+{
+  std::vector<std::pair<uint32_t, std::string>> strings;
+  std::vector<std::shared_ptr<Ring>> rings;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    // Strings are collected before the rings so that a model record is
+    // never written ahead of its name.
+    strings.swap(pending_strings_);
+    // Only the sink still references the ring of an exited thread, it
+    // can be released once it is drained.
+    for (auto it = rings_.begin(); it != rings_.end();) {
+      const auto& ring = *it;
+      if ((ring.use_count() == 1) &&
+          (ring->head_.load(std::memory_order_acquire) ==
+           ring->tail_.load(std::memory_order_relaxed)) &&
+          (ring->dropped_.load(std::memory_order_relaxed) == 0)) {
+        it = rings_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    rings = rings_;
+  }
+
+  std::vector<Record> records;
+  for (const auto& str : strings) {
+    records.push_back(
+        Record{0, 0, str.second.size(), RECORD_STRING, str.first});
+    const size_t offset = records.size();
+    records.resize(
+        offset + (str.second.size() + sizeof(Record) - 1) / sizeof(Record));
+    memset(
+        records.data() + offset, 0, (records.size() - offset) * sizeof(Record));
+    memcpy(records.data() + offset, str.second.data(), str.second.size());
+  }
+  for (const auto& ring : rings) {
+    const uint64_t tail = ring->tail_.load(std::memory_order_relaxed);
+    const uint64_t head = ring->head_.load(std::memory_order_acquire);
+    for (uint64_t idx = tail; idx < head; ++idx) {
+      records.push_back(ring->records_[idx & ring->mask_]);
+    }
+    ring->tail_.store(head, std::memory_order_release);
+    const uint64_t dropped =
+        ring->dropped_.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+      records.push_back(
+          Record{0, NowNs(), dropped, RECORD_DROPPED, ring->thread_index_});
+    }
+  }
+
+  if (!records.empty()) {
+    file_.write(
+        reinterpret_cast<const char*>(records.data()),
+        records.size() * sizeof(Record));
+    file_.flush();
+    if (!file_) {
+      LOG_ERROR << "failed to write binary trace file, "
+                << records.size() << " trace records are lost";
+      file_.clear();
+    }
+  }
+}
+
+Status
+TraceBinarySink::ToJson(
+    const std::string& binary_path, const std::string& json_path)
+{
+  std::ifstream in(binary_path, std::ios::in | std::ios::binary);
+  if (!in) {
+    return Status(
+        Status::Code::NOT_FOUND,
+        "failed to open binary trace file '" + binary_path + "'");
+  }
+  FileHeader header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      (memcmp(header.magic_, kMagic, sizeof(kMagic)) != 0)) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "'" + binary_path + "' is not a binary trace file");
+  }
+  if ((header.version_ != kVersion) ||
+      (header.record_size_ != sizeof(Record))) {
+    return Status(
+        Status::Code::UNSUPPORTED,
+        "unsupported binary trace file version " +
+            std::to_string(header.version_) + " with record size " +
+            std::to_string(header.record_size_));
+  }
+
+  struct TraceInfo {
+    TraceInfo()
+        : parent_id_(0), model_version_(-1),
+          model_name_id_(std::numeric_limits<uint32_t>::max()), reported_(0)
+    {
+    }
+    uint64_t parent_id_;
+    int64_t model_version_;
+    uint32_t model_name_id_;
+    uint32_t reported_;
+    uint64_t timestamp_ns_[kActivityCount];
+  };
+  std::map<uint64_t, TraceInfo> traces;
+  std::map<uint32_t, std::string> strings;
+  uint64_t dropped = 0;
+
+  // The size of a string comes from the file, so it is checked against
+  // what is left of the file before allocating for it.
+  in.seekg(0, std::ios::end);
+  const uint64_t file_size = in.tellg();
+  in.seekg(sizeof(header), std::ios::beg);
+
+  Record record;
+  while (in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    if (record.type_ < kActivityCount) {
+      auto& trace = traces[record.trace_id_];
+      trace.parent_id_ = record.arg0_;
+      trace.timestamp_ns_[record.type_] = record.timestamp_ns_;
+      trace.reported_ |= (1u << record.type_);
+    } else if (record.type_ == RECORD_MODEL) {
+      auto& trace = traces[record.trace_id_];
+      trace.model_version_ = static_cast<int64_t>(record.arg0_);
+      trace.model_name_id_ = record.arg1_;
+    } else if (record.type_ == RECORD_STRING) {
+      const uint64_t remaining = file_size - in.tellg();
+      if (record.arg0_ > remaining) {
+        break;
+      }
+      const size_t padded = ((record.arg0_ + sizeof(Record) - 1) /
+                             sizeof(Record)) *
+                            sizeof(Record);
+      std::string str(padded, '\0');
+      if (!in.read(&str[0], padded)) {
+        break;
+      }
+      str.resize(record.arg0_);
+      strings[record.arg1_] = std::move(str);
+    } else if (record.type_ == RECORD_DROPPED) {
+      dropped += record.arg0_;
+    }
+  }
+
+  std::ofstream out(json_path, std::ios::out | std::ios::trunc);
+  if (!out) {
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to open trace JSON file '" + json_path + "'");
+  }
+
+  // Each span starts and ends at a pair of activities. The spans of a
+  // trace are placed on their own track so that they nest.
+  struct Span {
+    const char* name_;
+    uint32_t start_;
+    uint32_t end_;
+  };
+  static const Span spans[] = {
+      {"request", TRITONSERVER_TRACE_REQUEST_START,
+       TRITONSERVER_TRACE_REQUEST_END},
+      {"queue", TRITONSERVER_TRACE_QUEUE_START,
+       TRITONSERVER_TRACE_COMPUTE_START},
+      {"compute", TRITONSERVER_TRACE_COMPUTE_START,
+       TRITONSERVER_TRACE_COMPUTE_END},
+      {"compute_input", TRITONSERVER_TRACE_COMPUTE_START,
+       TRITONSERVER_TRACE_COMPUTE_INPUT_END},
+      {"compute_infer", TRITONSERVER_TRACE_COMPUTE_INPUT_END,
+       TRITONSERVER_TRACE_COMPUTE_OUTPUT_START},
+      {"compute_output", TRITONSERVER_TRACE_COMPUTE_OUTPUT_START,
+       TRITONSERVER_TRACE_COMPUTE_END}};
+
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& pr : traces) {
+    const auto& trace = pr.second;
+    std::string model_name;
+    const auto sit = strings.find(trace.model_name_id_);
+    if (sit != strings.end()) {
+      model_name = JsonEscape(sit->second);
+    }
+    for (const auto& span : spans) {
+      const uint32_t mask = (1u << span.start_) | (1u << span.end_);
+      if (((trace.reported_ & mask) != mask) ||
+          (trace.timestamp_ns_[span.end_] <
+           trace.timestamp_ns_[span.start_])) {
+        continue;
+      }
+      if (!first) {
+        out << ",";
+      }
+      first = false;
+      out << "{\"name\":\"" << span.name_ << "\",\"cat\":\"" << model_name
+          << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pr.first
+          << ",\"ts\":" << Microseconds(trace.timestamp_ns_[span.start_])
+          << ",\"dur\":"
+          << Microseconds(
+                 trace.timestamp_ns_[span.end_] -
+                 trace.timestamp_ns_[span.start_])
+          << ",\"args\":{\"trace_id\":" << pr.first
+          << ",\"parent_id\":" << trace.parent_id_ << ",\"model_name\":\""
+          << model_name << "\",\"model_version\":" << trace.model_version_
+          << "}}";
+    }
+  }
+  out << "],\"otherData\":{\"dropped_records\":" << dropped << "}}";
+  out.close();
+  if (!out) {
+    return Status(
+        Status::Code::INTERNAL,
+        "failed to write trace JSON file '" + json_path + "'");
+  }
+
+  return Status::Success;
+}
+
+#endif  // TRITON_ENABLE_TRACING
+
+}}  // namespace triton::core
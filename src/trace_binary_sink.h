@@ -0,0 +1,145 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "constants.h"
+#include "status.h"
+
+namespace triton { namespace core {
+
+#ifdef TRITON_ENABLE_TRACING
+
+//
+// Process-wide sink for trace activities created with
+// TRITONSERVER_InferenceTraceBinaryNew. Each reporting thread writes
+// fixed-size records into its own single-producer ring buffer without
+// taking a lock or calling out of the core, and a background thread
+// drains the rings to a binary file. When a ring is full new records
+// are dropped and the number dropped is recorded in the file instead
+// of stalling the reporting thread. Use ToJson to convert the file to
+// the Chrome trace event format understood by chrome://tracing and
+// Perfetto.
+//
+// The file starts with a FileHeader followed by Records. A
+// RECORD_STRING record is followed by the bytes of the string padded
+// to a multiple of the record size.
+//
+class TraceBinarySink {
+ public:
+  // 'magic_' is "TRTTRACE".
+  struct FileHeader {
+    char magic_[8];
+    uint32_t version_;
+    uint32_t record_size_;
+    uint8_t reserved_[16];
+  };
+
+  // Values below RECORD_MODEL are TRITONSERVER_InferenceTraceActivity.
+  enum RecordType : uint32_t {
+    RECORD_MODEL = 0x100,
+    RECORD_STRING = 0x101,
+    RECORD_DROPPED = 0x102
+  };
+
+  // For an activity 'arg0_' is the parent trace id and 'arg1_' the
+  // index of the reporting thread. For RECORD_MODEL 'arg0_' is the
+  // model version and 'arg1_' the id of the model name string. For
+  // RECORD_STRING 'arg0_' is the byte size and 'arg1_' the id of the
+  // string. For RECORD_DROPPED 'arg0_' is the number of records
+  // dropped and 'arg1_' the index of the thread that dropped them.
+  struct Record {
+    uint64_t trace_id_;
+    uint64_t timestamp_ns_;
+    uint64_t arg0_;
+    uint32_t type_;
+    uint32_t arg1_;
+  };
+
+  static TraceBinarySink* Get();
+
+  // Start writing to 'path' using rings of at least
+  // 'records_per_thread' records for each reporting thread.
+  Status Start(const std::string& path, const uint32_t records_per_thread);
+
+  // Drain the records reported so far and close the file.
+  void Stop();
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  void WriteActivity(
+      const uint64_t trace_id, const uint64_t parent_id,
+      const uint32_t activity, const uint64_t timestamp_ns);
+  void WriteModel(
+      const uint64_t trace_id, const std::string& model_name,
+      const int64_t model_version, const uint64_t timestamp_ns);
+
+  // Convert the binary trace file at 'binary_path' to a Chrome trace
+  // event JSON file at 'json_path'.
+  static Status ToJson(
+      const std::string& binary_path, const std::string& json_path);
+
+ private:
+  struct Ring;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBinarySink);
+  TraceBinarySink();
+
+  Ring* LocalRing();
+  uint32_t StringId(const std::string& str);
+  void Push(Ring* ring, const Record& record);
+  void DrainThread();
+  void Drain();
+
+  std::atomic<bool> enabled_;
+  std::atomic<uint64_t> generation_;
+  std::mutex start_mu_;
+
+  // Protects 'rings_', 'ring_capacity_' and the string table.
+  std::mutex mu_;
+  std::vector<std::shared_ptr<Ring>> rings_;
+  size_t ring_capacity_;
+  uint32_t next_thread_index_;
+  std::unordered_map<std::string, uint32_t> string_ids_;
+  std::vector<std::pair<uint32_t, std::string>> pending_strings_;
+
+  std::ofstream file_;
+  bool exiting_;
+  std::condition_variable cv_;
+  std::thread drain_thread_;
+};
+
+#endif  // TRITON_ENABLE_TRACING
+
+}}  // namespace triton::core
@@ -0,0 +1,154 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include "trace_tensor_stager.h"
+
+#include "triton/common/logging.h"
+
+namespace triton { namespace core {
+
+#ifdef TRITON_ENABLE_TRACING
+
+TraceTensorStager*
+TraceTensorStager::Get()
+{
+  // Never destroyed so that traces released during process exit do
+  // not touch a destroyed stager.
+  static TraceTensorStager* stager = new TraceTensorStager();
+  return stager;
+}
+
+TraceTensorStager::TraceTensorStager()
+    : enabled_(false), pool_byte_size_(0), reserved_byte_size_(0),
+      dropped_trace_count_(0), exiting_(true)
+{
+}
+
+Status
+TraceTensorStager::Start(const uint64_t pool_byte_size)
+{
+  std::lock_guard<std::mutex> start_lk(start_mu_);
+  if (delivery_thread_.joinable()) {
+    return Status(
+        Status::Code::ALREADY_EXISTS, "trace tensor stager is already started");
+  }
+  if (pool_byte_size == 0) {
+    return Status(
+        Status::Code::INVALID_ARG,
+        "trace tensor staging pool byte size must be greater than 0");
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    pool_byte_size_ = pool_byte_size;
+    exiting_ = false;
+    enabled_ = true;
+  }
+  delivery_thread_ = std::thread(&TraceTensorStager::DeliveryThread, this);
+
+  return Status::Success;
+}
+
+void
+TraceTensorStager::Stop()
+{
+  std::lock_guard<std::mutex> start_lk(start_mu_);
+  if (!delivery_thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    enabled_ = false;
+    exiting_ = true;
+  }
+  cv_.notify_one();
+  delivery_thread_.join();
+
+  const uint64_t dropped = dropped_trace_count_.exchange(0);
+  if (dropped > 0) {
+    LOG_INFO << "Dropped the tensors of " << dropped
+             << " traces that exceeded their byte limit or the trace tensor "
+                "staging pool";
+  }
+}
+
+bool
+TraceTensorStager::Reserve(const uint64_t byte_size)
+{
+  const uint64_t pool_byte_size = pool_byte_size_.load();
+  uint64_t reserved = reserved_byte_size_.load();
+  do {
+    if ((byte_size > pool_byte_size) ||
+        (reserved > (pool_byte_size - byte_size))) {
+      return false;
+    }
+  } while (!reserved_byte_size_.compare_exchange_weak(
+      reserved, reserved + byte_size));
+  return true;
+}
+
+bool
+TraceTensorStager::Enqueue(
+    std::function<void()>&& fn, const uint64_t reserved_byte_size)
+{
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!exiting_) {
+      queue_.emplace_back(Entry{std::move(fn), reserved_byte_size});
+      cv_.notify_one();
+      return true;
+    }
+  }
+  Unreserve(reserved_byte_size);
+  return false;
+}
+
+void
+TraceTensorStager::DeliveryThread()
+{
+  std::unique_lock<std::mutex> lk(mu_);
+  while (true) {
+    cv_.wait(lk, [this] { return exiting_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // Only reached when exiting, every queued entry is delivered
+      // before the stager stops.
+      break;
+    }
+
+    Entry entry = std::move(queue_.front());
+    queue_.pop_front();
+    lk.unlock();
+    entry.fn_();
+    // Release the staged copy before returning its bytes to the pool.
+    entry.fn_ = nullptr;
+    Unreserve(entry.reserved_byte_size_);
+    lk.lock();
+  }
+}
+
+#endif  // TRITON_ENABLE_TRACING
+
+}}  // namespace triton::core
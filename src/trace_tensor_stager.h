@@ -0,0 +1,121 @@
+// Copyright 2023, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "constants.h"
+#include "status.h"
+
+namespace triton { namespace core {
+
+#ifdef TRITON_ENABLE_TRACING
+
+//
+// Process-wide staging pool for traces created with
+// TRITONSERVER_InferenceTraceTensorAsyncNew. A reported tensor is
+// copied into memory reserved from a pool of bounded byte size and
+// the tensor activity callback is invoked for the copy on a delivery
+// thread, so the request does not wait for the callback. Callbacks are
+// invoked in the order they are queued.
+//
+class TraceTensorStager {
+ public:
+  static TraceTensorStager* Get();
+
+  // Start delivering with a staging pool of 'pool_byte_size' bytes.
+  Status Start(const uint64_t pool_byte_size);
+
+  // Deliver everything queued so far and stop.
+  void Stop();
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Reserve 'byte_size' bytes of the staging pool. Return false
+  // without waiting if the pool does not have room.
+  bool Reserve(const uint64_t byte_size);
+  void Unreserve(const uint64_t byte_size)
+  {
+    reserved_byte_size_.fetch_sub(byte_size);
+  }
+
+  // Queue 'fn' to be invoked on the delivery thread. The
+  // 'reserved_byte_size' bytes are returned to the pool once 'fn'
+  // returns. Return false if the stager is stopped, in which case
+  // the reservation is returned and 'fn' is not invoked.
+  bool Enqueue(std::function<void()>&& fn, const uint64_t reserved_byte_size);
+
+  // Count a trace whose tensors are dropped because its byte limit is
+  // reached or the pool is full.
+  void RecordDroppedTrace()
+  {
+    dropped_trace_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  uint64_t DroppedTraceCount() const
+  {
+    return dropped_trace_count_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t PoolByteSize() const
+  {
+    return pool_byte_size_.load(std::memory_order_relaxed);
+  }
+  uint64_t ReservedByteSize() const
+  {
+    return reserved_byte_size_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Entry {
+    std::function<void()> fn_;
+    uint64_t reserved_byte_size_;
+  };
+
+  DISALLOW_COPY_AND_ASSIGN(TraceTensorStager);
+  TraceTensorStager();
+
+  void DeliveryThread();
+
+  std::atomic<bool> enabled_;
+  std::atomic<uint64_t> pool_byte_size_;
+  std::atomic<uint64_t> reserved_byte_size_;
+  std::atomic<uint64_t> dropped_trace_count_;
+  std::mutex start_mu_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<Entry> queue_;
+  bool exiting_;
+  std::thread delivery_thread_;
+};
+
+#endif  // TRITON_ENABLE_TRACING
+
+}}  // namespace triton::core
@@ -43,6 +43,8 @@
 #include "server.h"
 #include "server_message.h"
 #include "status.h"
+#include "trace_binary_sink.h"
+#include "trace_tensor_stager.h"
 #include "triton/common/logging.h"
 #include "triton/common/model_config.h"
 #include "triton/common/nvtx.h"
@@ -166,17 +168,21 @@ TritonServerError::Create(const tc::Status& status)
 class TritonServerMetrics {
  public:
   TritonServerMetrics() = default;
-  TRITONSERVER_Error* Serialize(const char** base, size_t* byte_size);
+  TRITONSERVER_Error* Serialize(
+      TRITONSERVER_MetricFormat format, const char** base, size_t* byte_size);
 
  private:
   std::string serialized_;
 };
 
 TRITONSERVER_Error*
-TritonServerMetrics::Serialize(const char** base, size_t* byte_size)
+TritonServerMetrics::Serialize(
+    TRITONSERVER_MetricFormat format, const char** base, size_t* byte_size)
 {
 #ifdef TRITON_ENABLE_METRICS
-  serialized_ = tc::Metrics::SerializedMetrics();
+  serialized_ = (format == TRITONSERVER_METRIC_BINARY)
+                    ? tc::Metrics::SerializedMetricsBinary()
+                    : tc::Metrics::SerializedMetrics();
   *base = serialized_.c_str();
   *byte_size = serialized_.size();
   return nullptr;  // Success
@@ -212,6 +218,35 @@ class TritonServerOptions {
   const std::set<std::string>& StartupModels() const { return models_; }
   void SetStartupModel(const char* m) { models_.insert(m); }
 
+  bool ModelLoadOnDemand() const { return load_on_demand_; }
+  uint32_t ModelLoadOnDemandMaxModels() const
+  {
+    return load_on_demand_max_models_;
+  }
+  uint32_t ModelLoadOnDemandMaxPending() const
+  {
+    return load_on_demand_max_pending_;
+  }
+  tc::ModelEvictionPolicy ModelEvictionPolicy() const
+  {
+    return model_eviction_policy_;
+  }
+  void SetModelLoadOnDemand(
+      bool e, uint32_t max_models, uint32_t max_pending,
+      tc::ModelEvictionPolicy policy)
+  {
+    load_on_demand_ = e;
+    load_on_demand_max_models_ = max_models;
+    load_on_demand_max_pending_ = max_pending;
+    model_eviction_policy_ = policy;
+  }
+
+  const std::string& ModelRepositorySnapshotPath() const
+  {
+    return snapshot_path_;
+  }
+  void SetModelRepositorySnapshotPath(const char* p) { snapshot_path_ = p; }
+
   bool ExitOnError() const { return exit_on_error_; }
   void SetExitOnError(bool b) { exit_on_error_ = b; }
 
@@ -234,6 +269,63 @@ class TritonServerOptions {
   uint64_t PinnedMemoryPoolByteSize() const { return pinned_memory_pool_size_; }
   void SetPinnedMemoryPoolByteSize(uint64_t s) { pinned_memory_pool_size_ = s; }
 
+  uint64_t HugePageMemoryPoolByteSize() const
+  {
+    return huge_page_memory_pool_size_;
+  }
+  uint64_t HugePageMemoryThresholdByteSize() const
+  {
+    return huge_page_memory_threshold_;
+  }
+  void SetHugePageMemoryPool(uint64_t s, uint64_t t)
+  {
+    huge_page_memory_pool_size_ = s;
+    huge_page_memory_threshold_ = t;
+  }
+
+  const std::string& SharedMemoryTransportName() const
+  {
+    return shm_transport_name_;
+  }
+  uint32_t SharedMemoryTransportSlotCount() const
+  {
+    return shm_transport_slot_count_;
+  }
+  uint32_t SharedMemoryTransportSlotByteSize() const
+  {
+    return shm_transport_slot_byte_size_;
+  }
+  void SetSharedMemoryTransport(
+      const std::string& name, uint32_t slot_count, uint32_t slot_byte_size)
+  {
+    shm_transport_name_ = name;
+    shm_transport_slot_count_ = slot_count;
+    shm_transport_slot_byte_size_ = slot_byte_size;
+  }
+
+  const std::string& TraceBinarySinkPath() const
+  {
+    return trace_binary_sink_path_;
+  }
+  uint32_t TraceBinarySinkRecordsPerThread() const
+  {
+    return trace_binary_sink_records_per_thread_;
+  }
+  void SetTraceBinarySink(const std::string& path, uint32_t records)
+  {
+    trace_binary_sink_path_ = path;
+    trace_binary_sink_records_per_thread_ = records;
+  }
+
+  uint64_t TraceTensorStagingPoolByteSize() const
+  {
+    return trace_tensor_staging_pool_size_;
+  }
+  void SetTraceTensorStagingPoolByteSize(uint64_t s)
+  {
+    trace_tensor_staging_pool_size_ = s;
+  }
+
   const std::map<int, uint64_t>& CudaMemoryPoolByteSize() const
   {
     return cuda_memory_pool_size_;
@@ -270,6 +362,28 @@ class TritonServerOptions {
   unsigned int ModelLoadThreadCount() const { return model_load_thread_count_; }
   void SetModelLoadThreadCount(unsigned int c) { model_load_thread_count_ = c; }
 
+  uint64_t ModelLoadMemoryBudget() const { return model_load_memory_budget_; }
+  void SetModelLoadMemoryBudget(uint64_t s) { model_load_memory_budget_ = s; }
+  unsigned int ModelInstanceLoadThreadCount() const
+  {
+    return model_instance_load_thread_count_;
+  }
+  void SetModelInstanceLoadThreadCount(unsigned int c)
+  {
+    model_instance_load_thread_count_ = c;
+  }
+
+  bool ModelVersionSwap() const { return version_swap_; }
+  uint64_t ModelVersionDrainTimeoutMs() const
+  {
+    return version_drain_timeout_ms_;
+  }
+  void SetModelVersionSwap(const bool enable, const uint64_t drain_timeout_ms)
+  {
+    version_swap_ = enable;
+    version_drain_timeout_ms_ = drain_timeout_ms;
+  }
+
   bool ModelNamespacingEnabled() { return enable_model_namespacing_; }
   void SetModelNamespacingEnabled(const bool e)
   {
@@ -333,6 +447,11 @@ class TritonServerOptions {
   std::set<std::string> repo_paths_;
   tc::ModelControlMode model_control_mode_;
   std::set<std::string> models_;
+  bool load_on_demand_;
+  uint32_t load_on_demand_max_models_;
+  uint32_t load_on_demand_max_pending_;
+  tc::ModelEvictionPolicy model_eviction_policy_;
+  std::string snapshot_path_;
   bool exit_on_error_;
   bool strict_model_config_;
   bool strict_readiness_;
@@ -344,8 +463,20 @@ class TritonServerOptions {
   uint64_t metrics_interval_;
   unsigned int exit_timeout_;
   uint64_t pinned_memory_pool_size_;
+  uint64_t huge_page_memory_pool_size_;
+  uint64_t huge_page_memory_threshold_;
+  std::string shm_transport_name_;
+  uint32_t shm_transport_slot_count_;
+  uint32_t shm_transport_slot_byte_size_;
+  std::string trace_binary_sink_path_;
+  uint32_t trace_binary_sink_records_per_thread_;
+  uint64_t trace_tensor_staging_pool_size_;
   unsigned int buffer_manager_thread_count_;
   unsigned int model_load_thread_count_;
+  uint64_t model_load_memory_budget_;
+  unsigned int model_instance_load_thread_count_;
+  bool version_swap_;
+  uint64_t version_drain_timeout_ms_;
   bool enable_model_namespacing_;
   std::map<int, uint64_t> cuda_memory_pool_size_;
   double min_compute_capability_;
@@ -363,11 +494,20 @@ class TritonServerOptions {
 TritonServerOptions::TritonServerOptions()
     : server_id_("triton"),
       model_control_mode_(tc::ModelControlMode::MODE_POLL),
+      load_on_demand_(false), load_on_demand_max_models_(0),
+      load_on_demand_max_pending_(0),
+      model_eviction_policy_(tc::ModelEvictionPolicy::LRU),
       exit_on_error_(true), strict_model_config_(true), strict_readiness_(true),
       rate_limit_mode_(tc::RateLimitMode::RL_OFF), metrics_(true),
       gpu_metrics_(true), cpu_metrics_(true), metrics_interval_(2000),
       exit_timeout_(30), pinned_memory_pool_size_(1 << 28),
+      huge_page_memory_pool_size_(0), huge_page_memory_threshold_(0),
+      shm_transport_slot_count_(0), shm_transport_slot_byte_size_(0),
+      trace_binary_sink_records_per_thread_(0),
+      trace_tensor_staging_pool_size_(0),
       buffer_manager_thread_count_(0), model_load_thread_count_(4),
+      model_load_memory_budget_(0), model_instance_load_thread_count_(1),
+      version_swap_(false), version_drain_timeout_ms_(0),
       enable_model_namespacing_(false),
 #ifdef TRITON_ENABLE_GPU
       min_compute_capability_(TRITON_MIN_COMPUTE_CAPABILITY),
@@ -854,8 +994,9 @@ TRITONSERVER_MetricsFormatted(
       reinterpret_cast<TritonServerMetrics*>(metrics);
 
   switch (format) {
-    case TRITONSERVER_METRIC_PROMETHEUS: {
-      return lmetrics->Serialize(base, byte_size);
+    case TRITONSERVER_METRIC_PROMETHEUS:
+    case TRITONSERVER_METRIC_BINARY: {
+      return lmetrics->Serialize(format, base, byte_size);
     }
 
     default:
@@ -978,6 +1119,89 @@ TRITONSERVER_InferenceTraceTensorNew(
 #endif  // TRITON_ENABLE_TRACING
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_InferenceTraceTensorAsyncNew(
+    TRITONSERVER_InferenceTrace** trace, TRITONSERVER_InferenceTraceLevel level,
+    uint64_t parent_id, TRITONSERVER_InferenceTraceActivityFn_t activity_fn,
+    TRITONSERVER_InferenceTraceTensorActivityFn_t tensor_activity_fn,
+    TRITONSERVER_InferenceTraceReleaseFn_t release_fn, void* trace_userp,
+    uint64_t tensor_byte_limit)
+{
+#ifdef TRITON_ENABLE_TRACING
+  if (!tc::TraceTensorStager::Get()->Enabled()) {
+    *trace = nullptr;
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_UNAVAILABLE,
+        "trace tensor staging pool is not enabled");
+  }
+  TRITONSERVER_Error* err = TRITONSERVER_InferenceTraceTensorNew(
+      trace, level, parent_id, activity_fn, tensor_activity_fn, release_fn,
+      trace_userp);
+  if (err != nullptr) {
+    return err;
+  }
+  reinterpret_cast<tc::InferenceTrace*>(*trace)->SetAsyncTensors(
+      tensor_byte_limit);
+  return nullptr;  // Success
+#else
+  *trace = nullptr;
+  return TRITONSERVER_ErrorNew(
+      TRITONSERVER_ERROR_UNSUPPORTED, "inference tracing not supported");
+#endif  // TRITON_ENABLE_TRACING
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_InferenceTraceBinaryNew(
+    TRITONSERVER_InferenceTrace** trace, TRITONSERVER_InferenceTraceLevel level,
+    uint64_t parent_id, TRITONSERVER_InferenceTraceReleaseFn_t release_fn,
+    void* trace_userp)
+{
+#ifdef TRITON_ENABLE_TRACING
+  if (!tc::TraceBinarySink::Get()->Enabled()) {
+    *trace = nullptr;
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_UNAVAILABLE, "binary trace sink is not enabled");
+  }
+  if ((level & TRITONSERVER_TRACE_LEVEL_MIN) > 0) {
+    level = static_cast<TRITONSERVER_InferenceTraceLevel>(
+        (level ^ TRITONSERVER_TRACE_LEVEL_MIN) |
+        TRITONSERVER_TRACE_LEVEL_TIMESTAMPS);
+  }
+  if ((level & TRITONSERVER_TRACE_LEVEL_MAX) > 0) {
+    level = static_cast<TRITONSERVER_InferenceTraceLevel>(
+        (level ^ TRITONSERVER_TRACE_LEVEL_MAX) |
+        TRITONSERVER_TRACE_LEVEL_TIMESTAMPS);
+  }
+  // Tensor activities carry the tensor contents and are not written to
+  // the binary trace file.
+  level = static_cast<TRITONSERVER_InferenceTraceLevel>(
+      level & ~TRITONSERVER_TRACE_LEVEL_TENSORS);
+  tc::InferenceTrace* ltrace = new tc::InferenceTrace(
+      level, parent_id, nullptr /* activity_fn */,
+      nullptr /* tensor_activity_fn */, release_fn, trace_userp);
+  *trace = reinterpret_cast<TRITONSERVER_InferenceTrace*>(ltrace);
+  return nullptr;  // Success
+#else
+  *trace = nullptr;
+  return TRITONSERVER_ErrorNew(
+      TRITONSERVER_ERROR_UNSUPPORTED, "inference tracing not supported");
+#endif  // TRITON_ENABLE_TRACING
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_InferenceTraceBinaryToJson(
+    const char* binary_path, const char* json_path)
+{
+#ifdef TRITON_ENABLE_TRACING
+  RETURN_IF_STATUS_ERROR(
+      tc::TraceBinarySink::ToJson(binary_path, json_path));
+  return nullptr;  // Success
+#else
+  return TRITONSERVER_ErrorNew(
+      TRITONSERVER_ERROR_UNSUPPORTED, "inference tracing not supported");
+#endif  // TRITON_ENABLE_TRACING
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONSERVER_InferenceTraceDelete(TRITONSERVER_InferenceTrace* trace)
 {
@@ -1142,6 +1366,52 @@ TRITONSERVER_ServerOptionsSetStartupModel(
   return nullptr;  // Success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelLoadOnDemand(
+    TRITONSERVER_ServerOptions* options, bool enable,
+    uint32_t max_loaded_models, uint32_t max_pending_requests,
+    TRITONSERVER_ModelEvictionPolicy policy)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+
+  // convert policy from TRITONSERVER_ to triton::core
+  tc::ModelEvictionPolicy eviction_policy;
+  switch (policy) {
+    case TRITONSERVER_MODEL_EVICTION_LRU: {
+      eviction_policy = tc::ModelEvictionPolicy::LRU;
+      break;
+    }
+    case TRITONSERVER_MODEL_EVICTION_LFU: {
+      eviction_policy = tc::ModelEvictionPolicy::LFU;
+      break;
+    }
+    default: {
+      return TRITONSERVER_ErrorNew(
+          TRITONSERVER_ERROR_INVALID_ARG,
+          std::string(
+              "unknown model eviction policy '" + std::to_string(policy) +
+              "'")
+              .c_str());
+    }
+  }
+
+  loptions->SetModelLoadOnDemand(
+      enable, max_loaded_models, max_pending_requests, eviction_policy);
+  return nullptr;  // Success
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelRepositorySnapshot(
+    TRITONSERVER_ServerOptions* options, const char* snapshot_path)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  loptions->SetModelRepositorySnapshotPath(
+      (snapshot_path == nullptr) ? "" : snapshot_path);
+  return nullptr;  // Success
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONSERVER_ServerOptionsSetExitOnError(
     TRITONSERVER_ServerOptions* options, bool exit)
@@ -1210,6 +1480,63 @@ TRITONSERVER_ServerOptionsSetPinnedMemoryPoolByteSize(
   return nullptr;  // Success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetHugePageMemoryPool(
+    TRITONSERVER_ServerOptions* options, uint64_t pool_byte_size,
+    uint64_t threshold_byte_size)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  loptions->SetHugePageMemoryPool(pool_byte_size, threshold_byte_size);
+  return nullptr;  // Success
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetSharedMemoryTransport(
+    TRITONSERVER_ServerOptions* options, const char* name,
+    uint32_t slot_count, uint32_t slot_byte_size)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  if ((name != nullptr) && (name[0] != '\0') &&
+      ((slot_count == 0) || (slot_byte_size == 0))) {
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_INVALID_ARG,
+        "shared memory transport slot count and byte size must be greater "
+        "than 0");
+  }
+  loptions->SetSharedMemoryTransport(
+      (name == nullptr) ? "" : name, slot_count, slot_byte_size);
+  return nullptr;  // Success
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetTraceBinarySink(
+    TRITONSERVER_ServerOptions* options, const char* path,
+    uint32_t records_per_thread)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  if ((path != nullptr) && (path[0] != '\0') && (records_per_thread == 0)) {
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_INVALID_ARG,
+        "binary trace sink records per thread must be greater than 0");
+  }
+  loptions->SetTraceBinarySink(
+      (path == nullptr) ? "" : path, records_per_thread);
+  return nullptr;  // Success
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetTraceTensorStagingPool(
+    TRITONSERVER_ServerOptions* options, uint64_t pool_byte_size)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  loptions->SetTraceTensorStagingPoolByteSize(pool_byte_size);
+  return nullptr;  // Success
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONSERVER_ServerOptionsSetCudaMemoryPoolByteSize(
     TRITONSERVER_ServerOptions* options, int gpu_device, uint64_t size)
@@ -1310,6 +1637,36 @@ TRITONSERVER_ServerOptionsSetModelLoadThreadCount(
   return nullptr;  // Success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelLoadMemoryBudget(
+    TRITONSERVER_ServerOptions* options, uint64_t byte_size)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  loptions->SetModelLoadMemoryBudget(byte_size);
+  return nullptr;  // Success
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelInstanceLoadThreadCount(
+    TRITONSERVER_ServerOptions* options, unsigned int thread_count)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  loptions->SetModelInstanceLoadThreadCount(thread_count);
+  return nullptr;  // Success
+}
+
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerOptionsSetModelVersionSwap(
+    TRITONSERVER_ServerOptions* options, bool enable, uint64_t drain_timeout_ms)
+{
+  TritonServerOptions* loptions =
+      reinterpret_cast<TritonServerOptions*>(options);
+  loptions->SetModelVersionSwap(enable, drain_timeout_ms);
+  return nullptr;  // Success
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONSERVER_ServerOptionsSetModelNamespacing(
     TRITONSERVER_ServerOptions* options, bool enable_namespace)
@@ -1569,7 +1926,8 @@ TRITONSERVER_InferenceRequestNew(
   tc::InferenceServer* lserver = reinterpret_cast<tc::InferenceServer*>(server);
 
   std::shared_ptr<tc::Model> model;
-  RETURN_IF_STATUS_ERROR(lserver->GetModel(model_name, model_version, &model));
+  RETURN_IF_STATUS_ERROR(
+      lserver->GetModelForInference(model_name, model_version, &model));
 
   *inference_request = reinterpret_cast<TRITONSERVER_InferenceRequest*>(
       new tc::InferenceRequest(model, model_version));
@@ -1587,6 +1945,16 @@ TRITONSERVER_InferenceRequestDelete(
   return nullptr;  // Success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_InferenceRequestReset(
+    TRITONSERVER_InferenceRequest* inference_request)
+{
+  tc::InferenceRequest* lrequest =
+      reinterpret_cast<tc::InferenceRequest*>(inference_request);
+  RETURN_IF_STATUS_ERROR(lrequest->Reset());
+  return nullptr;  // Success
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONSERVER_InferenceRequestId(
     TRITONSERVER_InferenceRequest* inference_request, const char** id)
@@ -1898,6 +2266,31 @@ TRITONSERVER_InferenceRequestSetResponseCallback(
   return nullptr;  // Success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_InferenceRequestSetResponseBatchCallback(
+    TRITONSERVER_InferenceRequest* inference_request,
+    TRITONSERVER_ResponseAllocator* response_allocator,
+    void* response_allocator_userp,
+    TRITONSERVER_InferenceResponseBatchCompleteFn_t response_fn,
+    void* response_userp, const uint32_t max_batch_count,
+    const uint64_t max_delay_us)
+{
+  if (max_batch_count == 0) {
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_INVALID_ARG,
+        "response batch count must be greater than 0");
+  }
+
+  tc::InferenceRequest* lrequest =
+      reinterpret_cast<tc::InferenceRequest*>(inference_request);
+  tc::ResponseAllocator* lallocator =
+      reinterpret_cast<tc::ResponseAllocator*>(response_allocator);
+  RETURN_IF_STATUS_ERROR(lrequest->SetResponseBatchCallback(
+      lallocator, response_allocator_userp, response_fn, response_userp,
+      max_batch_count, max_delay_us));
+  return nullptr;  // Success
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONSERVER_InferenceRequestSetStringParameter(
     TRITONSERVER_InferenceRequest* request, const char* name, const char* value)
@@ -2226,11 +2619,28 @@ TRITONSERVER_ServerNew(
   lserver->SetModelRepositoryPaths(loptions->ModelRepositoryPaths());
   lserver->SetModelControlMode(loptions->ModelControlMode());
   lserver->SetStartupModels(loptions->StartupModels());
+  lserver->SetModelLoadOnDemand(
+      loptions->ModelLoadOnDemand(), loptions->ModelLoadOnDemandMaxModels(),
+      loptions->ModelLoadOnDemandMaxPending(), loptions->ModelEvictionPolicy());
+  lserver->SetModelRepositorySnapshotPath(
+      loptions->ModelRepositorySnapshotPath());
   bool strict_model_config = loptions->StrictModelConfig();
   lserver->SetStrictModelConfigEnabled(strict_model_config);
   lserver->SetRateLimiterMode(loptions->RateLimiterMode());
   lserver->SetRateLimiterResources(loptions->RateLimiterResources());
   lserver->SetPinnedMemoryPoolByteSize(loptions->PinnedMemoryPoolByteSize());
+  lserver->SetHugePageMemoryPool(
+      loptions->HugePageMemoryPoolByteSize(),
+      loptions->HugePageMemoryThresholdByteSize());
+  lserver->SetSharedMemoryTransport(
+      loptions->SharedMemoryTransportName(),
+      loptions->SharedMemoryTransportSlotCount(),
+      loptions->SharedMemoryTransportSlotByteSize());
+  lserver->SetTraceBinarySink(
+      loptions->TraceBinarySinkPath(),
+      loptions->TraceBinarySinkRecordsPerThread());
+  lserver->SetTraceTensorStagingPoolByteSize(
+      loptions->TraceTensorStagingPoolByteSize());
   lserver->SetCudaMemoryPoolByteSize(loptions->CudaMemoryPoolByteSize());
   bool cache_enabled = !loptions->CacheConfig().empty();
   lserver->SetResponseCacheEnabled(cache_enabled);
@@ -2244,6 +2654,11 @@ TRITONSERVER_ServerNew(
   lserver->SetRepoAgentDir(loptions->RepoAgentDir());
   lserver->SetBufferManagerThreadCount(loptions->BufferManagerThreadCount());
   lserver->SetModelLoadThreadCount(loptions->ModelLoadThreadCount());
+  lserver->SetModelLoadMemoryBudget(loptions->ModelLoadMemoryBudget());
+  lserver->SetModelInstanceLoadThreadCount(
+      loptions->ModelInstanceLoadThreadCount());
+  lserver->SetModelVersionSwap(
+      loptions->ModelVersionSwap(), loptions->ModelVersionDrainTimeoutMs());
   lserver->SetModelNamespacingEnabled(loptions->ModelNamespacingEnabled());
 
   // SetBackendCmdlineConfig must be called after all AddBackendConfig calls
@@ -2343,6 +2758,28 @@ TRITONSERVER_ServerNew(
         "startup_models_" + std::to_string(i), startup_model});
     ++i;
   }
+  if (!lserver->ModelRepositorySnapshotPath().empty()) {
+    options_table.InsertRow(std::vector<std::string>{
+        "model_repository_snapshot", lserver->ModelRepositorySnapshotPath()});
+  }
+  if (lserver->ModelLoadOnDemandEnabled()) {
+    options_table.InsertRow(std::vector<std::string>{
+        "model_load_on_demand_max_models",
+        std::to_string(lserver->ModelLoadOnDemandMaxModels())});
+  }
+  if (lserver->ModelLoadMemoryBudget() != 0) {
+    options_table.InsertRow(std::vector<std::string>{
+        "model_load_memory_budget",
+        std::to_string(lserver->ModelLoadMemoryBudget())});
+  }
+  options_table.InsertRow(std::vector<std::string>{
+      "model_instance_load_thread_count",
+      std::to_string(lserver->ModelInstanceLoadThreadCount())});
+  if (lserver->ModelVersionSwapEnabled()) {
+    options_table.InsertRow(std::vector<std::string>{
+        "model_version_drain_timeout_ms",
+        std::to_string(lserver->ModelVersionDrainTimeoutMs())});
+  }
   options_table.InsertRow(std::vector<std::string>{
       "strict_model_config",
       std::to_string(lserver->StrictModelConfigEnabled())});
@@ -2361,6 +2798,22 @@ TRITONSERVER_ServerNew(
   options_table.InsertRow(std::vector<std::string>{
       "pinned_memory_pool_byte_size",
       std::to_string(lserver->PinnedMemoryPoolByteSize())});
+  options_table.InsertRow(std::vector<std::string>{
+      "huge_page_memory_pool_byte_size",
+      std::to_string(lserver->HugePageMemoryPoolByteSize())});
+  if (!lserver->SharedMemoryTransportName().empty()) {
+    options_table.InsertRow(std::vector<std::string>{
+        "shared_memory_transport", lserver->SharedMemoryTransportName()});
+  }
+  if (!lserver->TraceBinarySinkPath().empty()) {
+    options_table.InsertRow(std::vector<std::string>{
+        "trace_binary_sink", lserver->TraceBinarySinkPath()});
+  }
+  if (lserver->TraceTensorStagingPoolByteSize() > 0) {
+    options_table.InsertRow(std::vector<std::string>{
+        "trace_tensor_staging_pool_byte_size",
+        std::to_string(lserver->TraceTensorStagingPoolByteSize())});
+  }
   for (const auto& cuda_memory_pool : lserver->CudaMemoryPoolByteSize()) {
     options_table.InsertRow(std::vector<std::string>{
         "cuda_memory_pool_byte_size{" + std::to_string(cuda_memory_pool.first) +
@@ -2481,6 +2934,14 @@ TRITONSERVER_ServerPollModelRepository(TRITONSERVER_Server* server)
   return nullptr;  // Success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerWriteModelRepositorySnapshot(TRITONSERVER_Server* server)
+{
+  tc::InferenceServer* lserver = reinterpret_cast<tc::InferenceServer*>(server);
+  RETURN_IF_STATUS_ERROR(lserver->WriteModelRepositorySnapshot());
+  return nullptr;  // Success
+}
+
 TRITONAPI_DECLSPEC TRITONSERVER_Error*
 TRITONSERVER_ServerIsLive(TRITONSERVER_Server* server, bool* live)
 {
@@ -2755,9 +3216,9 @@ TRITONSERVER_ServerModelStatistics(
     for (const auto& version : mv_pair.second) {
       std::shared_ptr<tc::Model> model;
       RETURN_IF_STATUS_ERROR(lserver->GetModel(mv_pair.first, version, &model));
-      const auto& infer_stats = model->StatsAggregator().ImmutableInferStats();
-      const auto& infer_batch_stats =
-          model->StatsAggregator().ImmutableInferBatchStats();
+      const auto stats = model->StatsAggregator().MergedSnapshot();
+      const auto& infer_stats = stats.infer_stats_;
+      const auto& infer_batch_stats = stats.batch_stats_;
 
       triton::common::TritonJson::Value inference_stats(
           metadata, triton::common::TritonJson::ValueType::OBJECT);
@@ -2810,6 +3271,22 @@ TRITONSERVER_ServerModelStatistics(
         RETURN_IF_STATUS_ERROR(batch_stats.Append(std::move(batch_stat)));
       }
 
+      triton::common::TritonJson::Value instance_load_stats(
+          metadata, triton::common::TritonJson::ValueType::ARRAY);
+      for (const auto& instance :
+           model->StatsAggregator().InstanceLoadStatsSnapshot()) {
+        triton::common::TritonJson::Value instance_stat(
+            metadata, triton::common::TritonJson::ValueType::OBJECT);
+        RETURN_IF_STATUS_ERROR(
+            instance_stat.AddString("name", instance.first));
+        RETURN_IF_STATUS_ERROR(instance_stat.AddUInt(
+            "init_ns", instance.second.init_duration_ns_));
+        RETURN_IF_STATUS_ERROR(instance_stat.AddUInt(
+            "warmup_ns", instance.second.warmup_duration_ns_));
+        RETURN_IF_STATUS_ERROR(
+            instance_load_stats.Append(std::move(instance_stat)));
+      }
+
       triton::common::TritonJson::Value model_stat(
           metadata, triton::common::TritonJson::ValueType::OBJECT);
       RETURN_IF_STATUS_ERROR(
@@ -2817,17 +3294,19 @@ TRITONSERVER_ServerModelStatistics(
       RETURN_IF_STATUS_ERROR(
           model_stat.AddString("version", std::move(std::to_string(version))));
 
-      RETURN_IF_STATUS_ERROR(model_stat.AddUInt(
-          "last_inference", model->StatsAggregator().LastInferenceMs()));
-      RETURN_IF_STATUS_ERROR(model_stat.AddUInt(
-          "inference_count", model->StatsAggregator().InferenceCount()));
-      RETURN_IF_STATUS_ERROR(model_stat.AddUInt(
-          "execution_count", model->StatsAggregator().ExecutionCount()));
+      RETURN_IF_STATUS_ERROR(
+          model_stat.AddUInt("last_inference", stats.last_inference_ms_));
+      RETURN_IF_STATUS_ERROR(
+          model_stat.AddUInt("inference_count", stats.inference_count_));
+      RETURN_IF_STATUS_ERROR(
+          model_stat.AddUInt("execution_count", stats.execution_count_));
 
       RETURN_IF_STATUS_ERROR(
           model_stat.Add("inference_stats", std::move(inference_stats)));
       RETURN_IF_STATUS_ERROR(
           model_stat.Add("batch_stats", std::move(batch_stats)));
+      RETURN_IF_STATUS_ERROR(model_stat.Add(
+          "instance_load_stats", std::move(instance_load_stats)));
 
       RETURN_IF_STATUS_ERROR(model_stats_json.Append(std::move(model_stat)));
     }
@@ -2997,6 +3476,15 @@ TRITONSERVER_ServerInferAsync(
   tc::InferenceRequest* lrequest =
       reinterpret_cast<tc::InferenceRequest*>(inference_request);
 
+  if ((lrequest->ResponseFactory() == nullptr) ||
+      (!lrequest->HasReleaseCallback())) {
+    return TRITONSERVER_ErrorNew(
+        TRITONSERVER_ERROR_INVALID_ARG,
+        (lrequest->LogRequest() +
+         "release and response callbacks must be set before inference")
+            .c_str());
+  }
+
   RETURN_IF_STATUS_ERROR(lrequest->PrepareForInference());
 
   // Set the trace object in the request so that activity associated
@@ -3041,6 +3529,94 @@ TRITONSERVER_ServerInferAsync(
   return nullptr;  // Success
 }
 
+TRITONAPI_DECLSPEC TRITONSERVER_Error*
+TRITONSERVER_ServerInferAsyncBatch(
+    TRITONSERVER_Server* server,
+    TRITONSERVER_InferenceRequest** inference_requests,
+    TRITONSERVER_InferenceTrace** traces, const uint32_t request_count)
+{
+  tc::InferenceServer* lserver = reinterpret_cast<tc::InferenceServer*>(server);
+
+  // Validate everything that must be reported to the caller before
+  // any request is submitted, once submitted errors can only be
+  // reported through the request callbacks.
+  for (uint32_t idx = 0; idx < request_count; idx++) {
+    tc::InferenceRequest* lrequest =
+        reinterpret_cast<tc::InferenceRequest*>(inference_requests[idx]);
+    if (lrequest == nullptr) {
+      return TRITONSERVER_ErrorNew(
+          TRITONSERVER_ERROR_INVALID_ARG,
+          ("inference request " + std::to_string(idx) + " is null").c_str());
+    }
+    if ((lrequest->ResponseFactory() == nullptr) ||
+        (!lrequest->HasReleaseCallback())) {
+      return TRITONSERVER_ErrorNew(
+          TRITONSERVER_ERROR_INVALID_ARG,
+          (lrequest->LogRequest() +
+           "release and response callbacks must be set before inference")
+              .c_str());
+    }
+#ifndef TRITON_ENABLE_TRACING
+    if ((traces != nullptr) && (traces[idx] != nullptr)) {
+      return TRITONSERVER_ErrorNew(
+          TRITONSERVER_ERROR_UNSUPPORTED, "inference tracing not supported");
+    }
+#endif  // TRITON_ENABLE_TRACING
+  }
+
+  // Requests that fail to prepare are responded to only once the
+  // batch has been accepted by the server.
+  std::vector<std::unique_ptr<tc::InferenceRequest>> ureqs;
+  std::vector<std::pair<tc::InferenceRequest*, tc::Status>> failed;
+  ureqs.reserve(request_count);
+  for (uint32_t idx = 0; idx < request_count; idx++) {
+    tc::InferenceRequest* lrequest =
+        reinterpret_cast<tc::InferenceRequest*>(inference_requests[idx]);
+    tc::Status status = lrequest->PrepareForInference();
+    if (!status.IsOk()) {
+      failed.emplace_back(lrequest, status);
+      continue;
+    }
+
+#ifdef TRITON_ENABLE_TRACING
+    if ((traces != nullptr) && (traces[idx] != nullptr)) {
+      tc::InferenceTrace* ltrace =
+          reinterpret_cast<tc::InferenceTrace*>(traces[idx]);
+      ltrace->SetModelName(lrequest->ModelName());
+      ltrace->SetModelVersion(lrequest->ActualModelVersion());
+      ltrace->SetRequestId(lrequest->Id());
+
+      lrequest->SetTrace(std::make_shared<tc::InferenceTraceProxy>(ltrace));
+    }
+#endif  // TRITON_ENABLE_TRACING
+
+    ureqs.emplace_back(lrequest);
+  }
+
+  tc::Status status = lserver->InferAsyncBatch(ureqs);
+
+  // If there is an error then the caller retains ownership of all the
+  // requests, so release them from the unique_ptrs along with any
+  // trace object associated with them above.
+  if (!status.IsOk()) {
+    for (auto& ureq : ureqs) {
+#ifdef TRITON_ENABLE_TRACING
+      ureq->ReleaseTrace();
+#endif  // TRITON_ENABLE_TRACING
+      ureq.release();
+    }
+    RETURN_IF_STATUS_ERROR(status);
+  }
+
+  for (auto& pr : failed) {
+    std::unique_ptr<tc::InferenceRequest> ureq(pr.first);
+    tc::InferenceRequest::RespondIfError(
+        ureq, pr.second, true /* release_request */);
+  }
+
+  return nullptr;  // Success
+}
+
 //
 // TRITONSERVER_MetricFamily
 //
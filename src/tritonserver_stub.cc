@@ -154,6 +154,18 @@ TRITONSERVER_InferenceTraceTensorNew()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_InferenceTraceTensorAsyncNew()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_InferenceTraceBinaryNew()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_InferenceTraceBinaryToJson()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONSERVER_InferenceTraceDelete()
 {
 }
@@ -186,6 +198,10 @@ TRITONSERVER_InferenceRequestDelete()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_InferenceRequestReset()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONSERVER_InferenceRequestId()
 {
 }
@@ -282,6 +298,10 @@ TRITONSERVER_InferenceRequestSetResponseCallback()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_InferenceRequestSetResponseBatchCallback()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONSERVER_InferenceResponseDelete()
 {
 }
@@ -342,6 +362,14 @@ TRITONSERVER_ServerOptionsSetStartupModel()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetModelLoadOnDemand()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetModelRepositorySnapshot()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONSERVER_ServerOptionsSetStrictModelConfig()
 {
 }
@@ -358,6 +386,22 @@ TRITONSERVER_ServerOptionsSetPinnedMemoryPoolByteSize()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetHugePageMemoryPool()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetSharedMemoryTransport()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetTraceBinarySink()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetTraceTensorStagingPool()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONSERVER_ServerOptionsSetCudaMemoryPoolByteSize()
 {
 }
@@ -399,6 +443,18 @@ TRITONSERVER_ServerOptionsSetModelLoadThreadCount()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetModelLoadMemoryBudget()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetModelInstanceLoadThreadCount()
+{
+}
+TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerOptionsSetModelVersionSwap()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONSERVER_ServerOptionsSetModelNamespacing()
 {
 }
@@ -523,6 +579,10 @@ TRITONSERVER_ServerPollModelRepository()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerWriteModelRepositorySnapshot()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONSERVER_ServerIsLive()
 {
 }
@@ -595,6 +655,10 @@ TRITONSERVER_ServerInferAsync()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONSERVER_ServerInferAsyncBatch()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONBACKEND_ApiVersion()
 {
 }
@@ -627,6 +691,10 @@ TRITONBACKEND_InputBufferAttributes()
 {
 }
 TRITONAPI_DECLSPEC void
+TRITONBACKEND_InputBytesOffsets()
+{
+}
+TRITONAPI_DECLSPEC void
 TRITONBACKEND_OutputBuffer()
 {
 }